@@ -0,0 +1,1021 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "bmp_band.h"
+#include "bmp_strm.h"
+#include "checksum.h"
+#include "cpufeat.h"
+#include "exe_head.h"
+#include "exe_strm.h"
+#include "memalloc.h"
+#include "pixconv.h"
+#include "resample.h"
+#include "bmp_png.h"
+#include "resource.h"
+#include "rt_btmap.h"
+#include "rt_font.h"
+#include "rt_icon.h"
+#include "rt_cursr.h"
+#include "stats.h"
+#include "taskpool.h"
+
+#include "corpus.h"
+#include "profile.h"
+#include "xcheck.h"
+
+#define BENCH_WARMUP_ITERATIONS 3
+#define BENCH_MAX_VARIANTS      64
+#define BENCH_STREAM_CHUNK      0x1000
+
+// Options
+
+typedef struct _bench_options_t {
+    uint32_t iterations;
+    uint32_t bitmaps_num;
+    uint32_t fonts_num;
+    uint32_t resource_size;
+    uint32_t bitmap_width;
+    uint32_t bitmap_height;
+    uint32_t threads_num;
+    bool_e   use_arena;
+    bool_e   csv_output;
+    bool_e   use_profile;
+    bool_e   use_cross_check;
+    char_t** files;
+    uint32_t files_num;
+} bench_options_t;
+
+// Input of single operation
+
+typedef struct _bench_input_t {
+    FILE*             stream;
+    uint32_t          offset;
+    uint32_t          size;
+    uint32_t          bytes; // Bytes processed by one operation (for MB/s)
+    exe_info_t*       exe_info;
+    rt_bitmap_t*      rt_bitmap;
+    rt_font_t*        rt_font;
+    rt_icon_t*        rt_icon;
+    rt_anicursor_t*   rt_anicursor;
+    rt_bitmap_data_t* rt_bitmap_data;
+    rt_bitmap_data_t* rt_bitmap_quads;
+    rt_bitmap_data_t* rt_bitmap_pixels;
+    rt_bitmap_data_t* rt_bitmap_resampled;
+    pixel_format_e    pixel_format;
+    resample_filter_e resample_filter;
+    deflate_level_e   deflate_level;
+    uint8_t*          memory;
+    uint32_t          resources_num; // Expected to be delivered by streaming parser
+    FILE*             output;
+    rt_bitmap_data_t  region; // Dimensions of region (data is not used)
+    task_pool_t*      task_pool;
+} bench_input_t;
+
+typedef sint_t (*bench_op_t)(bench_input_t* input);
+
+// Allocation counter (wraps allocator which is current at start of benchmark)
+
+static mem_allocator_t* bench_backing     = NULL;
+static mem_arena_t*     bench_arena       = NULL;
+static uint64_t         bench_allocs      = 0;
+static uint64_t         bench_alloc_bytes = 0;
+
+static void_t* count_alloc(void_t* context, size_t size)
+{
+    bench_allocs      ++;
+    bench_alloc_bytes += size;
+
+    return bench_backing->alloc(bench_backing->context, size);
+}
+
+static void_t* count_realloc(void_t* context, void_t* block, size_t size)
+{
+    bench_allocs      ++;
+    bench_alloc_bytes += size;
+
+    return bench_backing->realloc(bench_backing->context, block, size);
+}
+
+static void_t count_free(void_t* context, void_t* block)
+{
+    bench_backing->free(bench_backing->context, block);
+}
+
+static mem_allocator_t count_allocator = {
+    count_alloc,
+    count_realloc,
+    count_free,
+    NULL
+};
+
+// Operations (every operation releases everything it gets)
+
+static sint_t op_validate_mz_checksum(bench_input_t* input)
+{
+    return (validate_mz_checksum(input->stream, input->size) == 0xFFFF) ? 0 : -1;
+}
+
+static sint_t op_get_exe_info(bench_input_t* input)
+{
+    exe_info_t* exe_info = get_exe_info(input->stream, 0);
+
+    if ((! exe_info) || (! exe_info->ne_header))
+        return -1;
+
+    if (! bench_arena)
+        del_exe_info(exe_info);
+
+    return 0;
+}
+
+static sint_t op_get_resource_table_info(bench_input_t* input)
+{
+    resource_table_info_t* table = get_resource_table_info(input->stream, input->offset);
+
+    if (! table)
+        return -1;
+
+    if (! bench_arena)
+        del_resource_table_info(table);
+
+    return 0;
+}
+
+// Every resource must be delivered with place and bytes it has in module
+typedef struct _stream_check_t {
+    const uint8_t* memory;
+    uint32_t       size;
+    uint32_t       resources_num;
+    uint32_t       errors;
+} stream_check_t;
+
+static sint_t check_stream_resource(void_t* context, const resource_entry_t* entry, const uint8_t* data)
+{
+    stream_check_t* check = (stream_check_t*) context;
+
+    if ((entry->content_offset > check->size) || (entry->content_size > check->size - entry->content_offset)
+    ||  (memcmp(data, check->memory + entry->content_offset, entry->content_size)))
+        check->errors ++;
+
+    check->resources_num ++;
+    return 0;
+}
+
+static sint_t op_put_exe_stream(bench_input_t* input)
+{
+    stream_check_t check = { input->memory, input->size, 0, 0 };
+    uint32_t       offset;
+    exe_stream_t*  exe_stream = new_exe_stream(check_stream_resource, &check);
+
+    if (! exe_stream)
+        return -1;
+
+    // Module arrives in chunks (as from pipe)
+    for (offset = 0; offset < input->size; offset += BENCH_STREAM_CHUNK)
+    {
+        uint32_t size = ((input->size - offset) < BENCH_STREAM_CHUNK) ? (input->size - offset) : BENCH_STREAM_CHUNK;
+
+        if (put_exe_stream(exe_stream, input->memory + offset, size) < 0)
+            break;
+    }
+
+    sint_t result = ((end_exe_stream(exe_stream) == 0) && (check.resources_num == input->resources_num) && (! check.errors)) ? 0 : -1;
+
+    if (! bench_arena)
+        del_exe_stream(exe_stream);
+
+    return result;
+}
+
+static sint_t op_get_rt_bitmap(bench_input_t* input)
+{
+    rt_bitmap_t* rt_bitmap = get_rt_bitmap(input->stream, input->offset);
+
+    if (! rt_bitmap)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_bitmap(rt_bitmap);
+
+    return 0;
+}
+
+static sint_t op_get_rt_bitmap_data(bench_input_t* input)
+{
+    rt_bitmap_data_t* rt_bitmap_data = get_rt_bitmap_data(input->stream, input->rt_bitmap);
+
+    if (! rt_bitmap_data)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_bitmap_data(rt_bitmap_data);
+
+    return 0;
+}
+
+// Embedded JPEG or PNG is read as it is (forwarded without decoding)
+static sint_t op_read_rt_bitmap_payload(bench_input_t* input)
+{
+    rt_bitmap_payload_t rt_bitmap_payload;
+
+    if ((calc_rt_bitmap_payload(input->rt_bitmap, &rt_bitmap_payload) < 0)
+    ||  (fseek(input->stream, rt_bitmap_payload.offset, SEEK_SET) != 0)
+    ||  (fread(input->memory, 1, rt_bitmap_payload.size, input->stream) != rt_bitmap_payload.size))
+        return -1;
+
+    return 0;
+}
+
+// Center of image, half of its width and height
+static sint_t op_get_rt_bitmap_region(bench_input_t* input)
+{
+    rt_bitmap_data_t* rt_bitmap_region = get_rt_bitmap_region(input->stream, input->rt_bitmap, input->region.width / 2, input->region.height / 2,
+                                                              input->region.width, input->region.height);
+
+    if (! rt_bitmap_region)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_bitmap_data(rt_bitmap_region);
+
+    return 0;
+}
+
+// Bands of lines decoded by all threads of pool
+static sint_t op_load_rt_bitmap_bands(bench_input_t* input)
+{
+    return load_rt_bitmap_bands(input->stream, input->rt_bitmap, input->rt_bitmap_data, input->task_pool, 0);
+}
+
+static sint_t op_expand_rt_bitmap_data(bench_input_t* input)
+{
+    return expand_rt_bitmap_data(input->rt_bitmap, input->rt_bitmap_data, input->rt_bitmap_quads);
+}
+
+static sint_t op_convert_rt_bitmap_data(bench_input_t* input)
+{
+    return convert_rt_bitmap_data(input->rt_bitmap, input->rt_bitmap_data, input->pixel_format, input->rt_bitmap_pixels);
+}
+
+static sint_t op_convert_rt_bitmap_bands(bench_input_t* input)
+{
+    return convert_rt_bitmap_bands(input->stream, input->rt_bitmap, input->pixel_format, input->rt_bitmap_pixels, input->task_pool, 0);
+}
+
+static sint_t op_resample_rt_bitmap_pixels(bench_input_t* input)
+{
+    return resample_rt_bitmap_pixels(input->rt_bitmap_pixels, input->resample_filter, input->rt_bitmap_resampled);
+}
+
+// Decoding, conversion and resampling line by line
+static sint_t op_load_rt_bitmap_resampled(bench_input_t* input)
+{
+    return load_rt_bitmap_resampled(input->stream, input->rt_bitmap, input->pixel_format, input->resample_filter, input->rt_bitmap_resampled);
+}
+
+static sint_t op_put_rt_bitmap_png(bench_input_t* input)
+{
+    return put_rt_bitmap_png(input->output, 0, input->rt_bitmap, input->rt_bitmap_data, input->deflate_level);
+}
+
+static sint_t op_put_rt_bitmap_parts(bench_input_t* input)
+{
+    if (put_rt_bitmap(input->output, 0, input->rt_bitmap) < 0)
+        return -1;
+
+    return put_rt_bitmap_data(input->output, input->rt_bitmap->file_header->data_offset, input->rt_bitmap_data);
+}
+
+static sint_t op_put_rt_bitmap_full(bench_input_t* input)
+{
+    return put_rt_bitmap_full(input->output, 0, input->rt_bitmap, input->rt_bitmap_data);
+}
+
+// Lines of decoded data are pulled in file order
+static sint_t fill_stream_line(void_t* context, uint32_t line, void_t* data)
+{
+    rt_bitmap_data_t* rt_bitmap_data = (rt_bitmap_data_t*) context;
+
+    memcpy(data, (uint8_t*) rt_bitmap_data->data + (size_t) rt_bitmap_data->line_size * line, (rt_bitmap_data->width * rt_bitmap_data->bit_count + 7) / 8);
+
+    return 0;
+}
+
+static sint_t op_run_bitmap_stream(bench_input_t* input)
+{
+    bitmap_stream_t* bitmap_stream = new_bitmap_stream(input->output, 0, input->rt_bitmap, FALSE);
+
+    if (! bitmap_stream)
+        return -1;
+
+    sint_t result = ((run_bitmap_stream(bitmap_stream, fill_stream_line, input->rt_bitmap_data) < 0) || (end_bitmap_stream(bitmap_stream) < 0)) ? -1 : 0;
+
+    del_bitmap_stream(bitmap_stream);
+
+    return result;
+}
+
+static sint_t op_fill_rt_bitmap_full(bench_input_t* input)
+{
+    return fill_rt_bitmap_full(input->rt_bitmap, input->rt_bitmap_data, input->memory, input->bytes);
+}
+
+static sint_t op_get_rt_icon(bench_input_t* input)
+{
+    rt_icon_t* rt_icon = get_rt_icon(input->stream, input->offset, input->size);
+
+    if (! rt_icon)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_icon(rt_icon);
+
+    return 0;
+}
+
+static sint_t op_load_rt_icon_pixels(bench_input_t* input)
+{
+    return load_rt_icon_pixels(input->stream, input->rt_icon, input->rt_bitmap_pixels);
+}
+
+static sint_t op_get_rt_cursor(bench_input_t* input)
+{
+    rt_cursor_t* rt_cursor = get_rt_cursor(input->stream, input->offset, input->size);
+
+    if (! rt_cursor)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_cursor(rt_cursor);
+
+    return 0;
+}
+
+static sint_t op_get_rt_anicursor(bench_input_t* input)
+{
+    rt_anicursor_t* rt_anicursor = get_rt_anicursor(input->stream, input->offset, input->size);
+
+    if (! rt_anicursor)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_anicursor(rt_anicursor);
+
+    return 0;
+}
+
+// Whole animation, every step decoded into same buffer
+static sint_t op_load_rt_anicursor_frames(bench_input_t* input)
+{
+    ani_step_t ani_step;
+    uint32_t   i;
+
+    for (i = 0; i < input->rt_anicursor->header.steps_num; i ++)
+    {
+        if ((load_rt_anicursor_step(input->stream, input->rt_anicursor, i, &ani_step) < 0)
+        ||  (load_rt_anicursor_frame(input->stream, input->rt_anicursor, ani_step.frame, input->rt_bitmap_pixels) < 0))
+            return -1;
+    }
+
+    return 0;
+}
+
+static sint_t op_get_rt_font(bench_input_t* input)
+{
+    rt_font_t* rt_font = get_rt_font(input->stream, input->offset);
+
+    if (! rt_font)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_font(rt_font);
+
+    return 0;
+}
+
+static sint_t op_get_rt_font_bitmap_full(bench_input_t* input)
+{
+    rt_bitmap_data_t* rt_bitmap_data = get_rt_font_bitmap_full(input->stream, input->rt_font);
+
+    if (! rt_bitmap_data)
+        return -1;
+
+    if (! bench_arena)
+        del_rt_bitmap_data(rt_bitmap_data);
+
+    return 0;
+}
+
+// Runner
+
+static sint_t compare_uint64(const void_t* a, const void_t* b)
+{
+    uint64_t x = *((const uint64_t*) a);
+    uint64_t y = *((const uint64_t*) b);
+
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+static void_t print_header(bench_options_t* options)
+{
+    if (options->csv_output)
+        printf("operation,variant,ns_per_op,p50_ns,p90_ns,p99_ns,mb_per_s,allocs_per_op,alloc_bytes_per_op\n");
+    else
+        printf("%-26s %-22s %12s %10s %10s %10s %10s %9s %11s\n",
+               "operation", "variant", "ns/op", "p50", "p90", "p99", "MB/s", "allocs/op", "bytes/op");
+}
+
+static void_t run_bench(bench_options_t* options, const char_t* name, const char_t* variant, bench_op_t op, bench_input_t* input)
+{
+    uint64_t* times = (uint64_t*) malloc(sizeof(uint64_t) * options->iterations);
+    uint32_t  i;
+
+    if (! times)
+        return;
+
+    mem_allocator_t* previous = get_mem_allocator();
+
+    if (bench_arena)
+        set_mem_allocator(get_mem_arena_allocator(bench_arena));
+
+    bench_backing = get_mem_allocator();
+    set_mem_allocator(&count_allocator);
+
+    // Warm up caches (file contents, allocator)
+    sint_t result = 0;
+
+    for (i = 0; (i < BENCH_WARMUP_ITERATIONS) && (! result); i ++)
+    {
+        result = op(input);
+
+        if (bench_arena)
+            reset_mem_arena(bench_arena);
+    }
+
+    bench_allocs      = 0;
+    bench_alloc_bytes = 0;
+
+    uint64_t total = 0;
+
+    for (i = 0; (i < options->iterations) && (! result); i ++)
+    {
+        uint64_t start = get_time_ns();
+
+        result = op(input);
+
+        if (bench_arena)
+            reset_mem_arena(bench_arena);
+
+        times[i] = get_time_ns() - start;
+        total   += times[i];
+    }
+
+    set_mem_allocator(previous);
+
+    if (result)
+    {
+        if (options->csv_output)
+            printf("%s,%s,,,,,,,\n", name, variant);
+        else
+            printf("%-26s %-22s %12s\n", name, variant, "unsupported");
+
+        free(times);
+        return;
+    }
+
+    qsort(times, options->iterations, sizeof(uint64_t), compare_uint64);
+
+    double ns_per_op    = (double) total / options->iterations;
+    double mb_per_s     = (total) ? ((double) input->bytes * options->iterations * 1000.0 / (double) total) : 0.0;
+    double allocs_op    = (double) bench_allocs / options->iterations;
+    double alloc_b_op   = (double) bench_alloc_bytes / options->iterations;
+    uint64_t p50        = times[(options->iterations * 50) / 100];
+    uint64_t p90        = times[(options->iterations * 90) / 100];
+    uint64_t p99        = times[(options->iterations * 99) / 100];
+
+    if (options->csv_output)
+        printf("%s,%s,%.1f,%llu,%llu,%llu,%.2f,%.2f,%.1f\n",
+               name, variant, ns_per_op, (unsigned long long) p50, (unsigned long long) p90, (unsigned long long) p99,
+               mb_per_s, allocs_op, alloc_b_op);
+    else
+        printf("%-26s %-22s %12.1f %10llu %10llu %10llu %10.2f %9.2f %11.1f\n",
+               name, variant, ns_per_op, (unsigned long long) p50, (unsigned long long) p90, (unsigned long long) p99,
+               mb_per_s, allocs_op, alloc_b_op);
+
+    free(times);
+}
+
+// Suites
+
+static void_t bench_module(bench_options_t* options)
+{
+    FILE* stream = tmpfile();
+
+    if (! stream)
+        return;
+
+    corpus_module_t params = { options->bitmaps_num, options->fonts_num, options->resource_size };
+    uint32_t        size   = put_corpus_module(stream, &params);
+    char_t          variant [32];
+
+    snprintf(variant, sizeof(variant), "ne/%u res", params.bitmaps_num + params.fonts_num);
+
+    exe_info_t* exe_info = (size) ? get_exe_info(stream, 0) : NULL;
+
+    if ((! exe_info) || (! exe_info->ne_header))
+    {
+        fprintf(stderr, "Can not generate module\n");
+        if (exe_info) del_exe_info(exe_info);
+        fclose(stream);
+        return;
+    }
+
+    bench_input_t input;
+    memset(&input, 0, sizeof(input));
+
+    input.stream = stream;
+    input.size   = size;
+    input.bytes  = size;
+    run_bench(options, "validate_mz_checksum", variant, op_validate_mz_checksum, &input);
+
+    input.bytes  = exe_info->segmented_offset + NE_HEADER_SIZE;
+    run_bench(options, "get_exe_info", variant, op_get_exe_info, &input);
+
+    input.offset = exe_info->segmented_offset + exe_info->ne_header->resource_table_offset;
+    input.bytes  = exe_info->ne_header->resident_table_offset - exe_info->ne_header->resource_table_offset;
+    run_bench(options, "get_resource_table_info", variant, op_get_resource_table_info, &input);
+
+    // Whole module pushed through streaming parser, it must deliver every resource of table
+    resource_table_info_t* table = get_resource_table_info(stream, input.offset);
+
+    input.resources_num = (table) ? table->info_entries_num : 0;
+    input.memory        = (table) ? (uint8_t*) malloc(size) : NULL;
+
+    if (table)
+        del_resource_table_info(table);
+
+    if ((input.memory) && (fseek(stream, 0, SEEK_SET) == 0) && (fread(input.memory, 1, size, stream) == size))
+    {
+        input.bytes = size;
+        run_bench(options, "put_exe_stream", variant, op_put_exe_stream, &input);
+    }
+
+    if (input.memory)
+        free(input.memory);
+
+    del_exe_info(exe_info);
+    fclose(stream);
+}
+
+static void_t bench_bitmaps(bench_options_t* options)
+{
+    static const char_t* info_names [] = { "core", "info", "v4", "v5" };
+
+    corpus_bitmap_t variants [BENCH_MAX_VARIANTS];
+    uint32_t        i, variants_num = get_corpus_bitmap_variants(variants, BENCH_MAX_VARIANTS, options->bitmap_width, options->bitmap_height);
+    task_pool_t*    task_pool       = new_task_pool(options->threads_num);
+
+    for (i = 0; i < variants_num; i ++)
+    {
+        FILE* stream = tmpfile();
+
+        if (! stream)
+            break;
+
+        uint32_t size = put_corpus_bitmap(stream, 0, variants + i);
+        char_t   variant [32];
+
+        snprintf(variant, sizeof(variant), "%s/%ubpp/c%u", info_names[variants[i].info_type], variants[i].bit_count, variants[i].compression);
+
+        bench_input_t input;
+        memset(&input, 0, sizeof(input));
+
+        input.stream    = stream;
+        input.size      = size;
+        input.task_pool = task_pool;
+        input.rt_bitmap = get_rt_bitmap(stream, 0);
+        input.bytes     = (input.rt_bitmap) ? input.rt_bitmap->data_offset : size; // Headers and palette
+        run_bench(options, "get_rt_bitmap", variant, op_get_rt_bitmap, &input);
+
+        rt_bitmap_payload_t rt_bitmap_payload;
+
+        if ((input.rt_bitmap) && (calc_rt_bitmap_payload(input.rt_bitmap, &rt_bitmap_payload) == 0))
+        {
+            input.bytes  = rt_bitmap_payload.size;
+            input.memory = (uint8_t*) malloc(rt_bitmap_payload.size);
+
+            if (input.memory)
+            {
+                run_bench(options, "read_rt_bitmap_payload", variant, op_read_rt_bitmap_payload, &input);
+
+                free(input.memory);
+                input.memory = NULL;
+            }
+
+            del_rt_bitmap(input.rt_bitmap);
+        }
+        else if (input.rt_bitmap)
+        {
+            input.bytes = input.rt_bitmap->data_size;
+            run_bench(options, "get_rt_bitmap_data", variant, op_get_rt_bitmap_data, &input);
+
+            // Quarter of image (RLE lines are indexed by first run)
+            if (calc_rt_bitmap_region(input.rt_bitmap, 0, 0, (variants[i].width + 1) / 2, (variants[i].height + 1) / 2, 0, &input.region) == 0)
+            {
+                input.bytes = input.region.size;
+                run_bench(options, "get_rt_bitmap_region", variant, op_get_rt_bitmap_region, &input);
+            }
+
+            // Palette expansion of indexed data (into preallocated buffer)
+            input.rt_bitmap_data  = get_rt_bitmap_data(stream, input.rt_bitmap);
+            input.rt_bitmap_quads = ((input.rt_bitmap_data) && (get_colors_num(variants[i].bit_count))) ? get_rt_bitmap_quads(input.rt_bitmap, input.rt_bitmap_data) : NULL;
+
+            if (input.rt_bitmap_data)
+            {
+                input.bytes = input.rt_bitmap_data->size;
+                run_bench(options, "load_rt_bitmap_bands", variant, op_load_rt_bitmap_bands, &input);
+            }
+
+            if (input.rt_bitmap_quads)
+            {
+                input.bytes = input.rt_bitmap_quads->size;
+                run_bench(options, "expand_rt_bitmap_data", variant, op_expand_rt_bitmap_data, &input);
+
+                del_rt_bitmap_data(input.rt_bitmap_quads);
+            }
+
+            // Conversion to every pixel format (into preallocated buffer)
+            for (input.pixel_format = PIXEL_RGBA32; input.pixel_format < PIXEL_FORMAT_NUM; input.pixel_format ++)
+            {
+                input.rt_bitmap_pixels = (input.rt_bitmap_data) ? get_rt_bitmap_pixels(input.rt_bitmap, input.rt_bitmap_data, input.pixel_format) : NULL;
+
+                if (! input.rt_bitmap_pixels)
+                    continue;
+
+                char_t format_variant [48];
+                snprintf(format_variant, sizeof(format_variant), "%s/%s", variant, convert_pixel_format_to_text(input.pixel_format));
+
+                input.bytes = input.rt_bitmap_pixels->size;
+                run_bench(options, "convert_rt_bitmap_data", format_variant, op_convert_rt_bitmap_data, &input);
+                run_bench(options, "convert_rt_bitmap_bands", format_variant, op_convert_rt_bitmap_bands, &input);
+
+                // Thumbnail of quarter size by every filter (32-bit and GRAY8 pixels)
+                rt_bitmap_data_t rt_bitmap_resampled;
+
+                if ((input.pixel_format != PIXEL_RGB24)
+                &&  (calc_rt_bitmap_resampled(input.pixel_format, (variants[i].width + 3) / 4, (variants[i].height + 3) / 4, 0, &rt_bitmap_resampled) == 0)
+                &&  ((rt_bitmap_resampled.data = malloc(rt_bitmap_resampled.size)) != NULL))
+                {
+                    input.rt_bitmap_resampled = &rt_bitmap_resampled;
+
+                    for (input.resample_filter = RESAMPLE_NEAREST; input.resample_filter < RESAMPLE_FILTER_NUM; input.resample_filter ++)
+                    {
+                        char_t filter_variant [64];
+                        snprintf(filter_variant, sizeof(filter_variant), "%s/%s", format_variant, convert_resample_filter_to_text(input.resample_filter));
+
+                        run_bench(options, "resample_rt_bitmap_pixels", filter_variant, op_resample_rt_bitmap_pixels, &input);
+                        run_bench(options, "load_rt_bitmap_resampled", filter_variant, op_load_rt_bitmap_resampled, &input);
+                    }
+
+                    input.rt_bitmap_resampled = NULL;
+                    free(rt_bitmap_resampled.data);
+                }
+
+                del_rt_bitmap_data(input.rt_bitmap_pixels);
+            }
+
+            // Writing of whole file (uncompressed only), parts against single write
+            input.bytes  = calc_rt_bitmap_full_size(input.rt_bitmap);
+            input.output = ((input.rt_bitmap_data) && (input.bytes)
+                         && ((variants[i].compression == BI_RGB) || (variants[i].compression == BI_BITFIELDS))) ? tmpfile() : NULL;
+
+            if (input.output)
+            {
+                run_bench(options, "put_rt_bitmap_parts", variant, op_put_rt_bitmap_parts, &input);
+                run_bench(options, "put_rt_bitmap_full", variant, op_put_rt_bitmap_full, &input);
+                run_bench(options, "run_bitmap_stream", variant, op_run_bitmap_stream, &input);
+
+                input.memory = (uint8_t*) malloc(input.bytes);
+
+                if (input.memory)
+                {
+                    run_bench(options, "fill_rt_bitmap_full", variant, op_fill_rt_bitmap_full, &input);
+                    free(input.memory);
+                }
+
+                fclose(input.output);
+            }
+
+            // PNG of decoded data by every level (RLE as well)
+            input.output = (input.rt_bitmap_data) ? tmpfile() : NULL;
+
+            if (input.output)
+            {
+                input.bytes = input.rt_bitmap_data->size;
+
+                for (input.deflate_level = DEFLATE_STORE; input.deflate_level < DEFLATE_LEVEL_NUM; input.deflate_level ++)
+                {
+                    char_t level_variant [48];
+                    snprintf(level_variant, sizeof(level_variant), "%s/%s", variant, convert_deflate_level_to_text(input.deflate_level));
+
+                    run_bench(options, "put_rt_bitmap_png", level_variant, op_put_rt_bitmap_png, &input);
+                }
+
+                fclose(input.output);
+            }
+
+            if (input.rt_bitmap_data)
+                del_rt_bitmap_data(input.rt_bitmap_data);
+
+            del_rt_bitmap(input.rt_bitmap);
+        }
+
+        fclose(stream);
+    }
+
+    del_task_pool(task_pool);
+}
+
+static void_t bench_fonts(bench_options_t* options)
+{
+    static const uint16_t versions [] = { FONT_VERSION_2, FONT_VERSION_3 };
+
+    uint32_t i;
+
+    for (i = 0; i < sizeof(versions) / sizeof(versions[0]); i ++)
+    {
+        FILE* stream = tmpfile();
+
+        if (! stream)
+            return;
+
+        uint32_t size = put_corpus_font(stream, 0, versions[i], 16, 16);
+        char_t   variant [32];
+
+        snprintf(variant, sizeof(variant), "fnt v%u/16x16", versions[i] >> 8);
+
+        bench_input_t input;
+        memset(&input, 0, sizeof(input));
+
+        input.stream = stream;
+        input.size   = size;
+        input.bytes  = size;
+        run_bench(options, "get_rt_font", variant, op_get_rt_font, &input);
+
+        input.rt_font = get_rt_font(stream, 0);
+
+        if (input.rt_font)
+            run_bench(options, "get_rt_font_bitmap_full", variant, op_get_rt_font_bitmap_full, &input);
+        else
+            run_bench(options, "get_rt_font_bitmap_full", variant, op_get_rt_font, &input);
+
+        if (input.rt_font)
+            del_rt_font(input.rt_font);
+
+        fclose(stream);
+    }
+}
+
+static void_t bench_icons(bench_options_t* options)
+{
+    static const uint32_t bit_counts [] = { 1, 4, 8, 24, 32 };
+
+    uint32_t i;
+
+    for (i = 0; i < sizeof(bit_counts) / sizeof(bit_counts[0]); i ++)
+    {
+        FILE* stream = tmpfile();
+
+        if (! stream)
+            return;
+
+        uint32_t size = put_corpus_icon(stream, 0, bit_counts[i], 32);
+        char_t   variant [32];
+
+        snprintf(variant, sizeof(variant), "ico/%ubpp/32x32", bit_counts[i]);
+
+        bench_input_t input;
+        memset(&input, 0, sizeof(input));
+
+        input.stream = stream;
+        input.size   = size;
+        input.bytes  = size;
+        run_bench(options, "get_rt_icon", variant, op_get_rt_icon, &input);
+
+        // Compositing into preallocated buffer
+        input.rt_icon          = get_rt_icon(stream, 0, size);
+        input.rt_bitmap_pixels = (input.rt_icon) ? get_rt_icon_pixels(stream, input.rt_icon) : NULL;
+
+        if (input.rt_bitmap_pixels)
+        {
+            input.bytes = input.rt_bitmap_pixels->size;
+            run_bench(options, "load_rt_icon_pixels", variant, op_load_rt_icon_pixels, &input);
+
+            del_rt_bitmap_data(input.rt_bitmap_pixels);
+        }
+
+        if (input.rt_icon)
+            del_rt_icon(input.rt_icon);
+
+        // Cursor of same image (hotspot prefix)
+        snprintf(variant, sizeof(variant), "cur/%ubpp/32x32", bit_counts[i]);
+
+        input.size  = put_corpus_cursor(stream, 0, bit_counts[i], 32);
+        input.bytes = input.size;
+        run_bench(options, "get_rt_cursor", variant, op_get_rt_cursor, &input);
+
+        fclose(stream);
+    }
+
+    // Animated cursor (frames are decoded on demand into single buffer)
+    FILE* stream = tmpfile();
+
+    if (! stream)
+        return;
+
+    bench_input_t input;
+    memset(&input, 0, sizeof(input));
+
+    input.stream = stream;
+    input.size   = put_corpus_anicursor(stream, 0, 16, 8, 32);
+    input.bytes  = input.size;
+    run_bench(options, "get_rt_anicursor", "ani/16x8bpp/32x32", op_get_rt_anicursor, &input);
+
+    rt_bitmap_data_t rt_frame_pixels;
+
+    input.rt_anicursor = get_rt_anicursor(stream, 0, input.size);
+
+    if ((input.rt_anicursor) && (calc_rt_anicursor_pixels(stream, input.rt_anicursor, 0, &rt_frame_pixels) == 0)
+    &&  ((rt_frame_pixels.data = malloc(rt_frame_pixels.size)) != NULL))
+    {
+        input.rt_bitmap_pixels = &rt_frame_pixels;
+        input.bytes            = rt_frame_pixels.size * input.rt_anicursor->header.steps_num;
+        run_bench(options, "load_rt_anicursor_frames", "ani/16x8bpp/32x32", op_load_rt_anicursor_frames, &input);
+
+        free(rt_frame_pixels.data);
+    }
+
+    if (input.rt_anicursor)
+        del_rt_anicursor(input.rt_anicursor);
+
+    fclose(stream);
+}
+
+static sint_t profile_stream(profile_t* profile, bench_options_t* options, FILE* stream, const char_t* name)
+{
+    uint32_t i;
+
+    if (fseek(stream, 0, SEEK_END) != 0)
+        return -1;
+
+    uint32_t size = (uint32_t) ftell(stream);
+
+    for (i = 0; i < options->iterations; i ++)
+    {
+        if (run_profile(profile, stream, size) != 0)
+        {
+            fprintf(stderr, "%s: not NE module\n", name);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void_t bench_profile(bench_options_t* options)
+{
+    profile_t profile;
+    uint32_t  i;
+
+    sint_t counters_num = open_profile(&profile);
+
+    if (counters_num < PERF_COUNTERS_NUM)
+    {
+        fprintf(stderr, "Counters unavailable:");
+
+        for (i = 0; i < PERF_COUNTERS_NUM; i ++)
+        {
+            if (! profile.counters.available[i])
+                fprintf(stderr, " %s", convert_perf_counter_to_text((perf_counter_e) i));
+        }
+
+        fprintf(stderr, "%s\n", (counters_num) ? "" : " (wall time only)");
+    }
+
+    if (! options->files_num)
+    {
+        // Generated module
+        FILE* stream = tmpfile();
+
+        if (stream)
+        {
+            corpus_module_t params = { options->bitmaps_num, options->fonts_num, options->resource_size };
+
+            if (put_corpus_module(stream, &params))
+                profile_stream(&profile, options, stream, "corpus");
+
+            fclose(stream);
+        }
+    }
+
+    for (i = 0; i < options->files_num; i ++)
+    {
+        FILE* stream = fopen(options->files[i], "rb");
+
+        if (! stream)
+        {
+            fprintf(stderr, "%s: can not open\n", options->files[i]);
+            continue;
+        }
+
+        profile_stream(&profile, options, stream, options->files[i]);
+        fclose(stream);
+    }
+
+    print_profile(&profile, options->csv_output);
+    close_profile(&profile);
+}
+
+static void_t print_usage(const char_t* name)
+{
+    printf("Usage: %s [options] [files]\n", name);
+    printf("  -n <num>  Iterations per operation (default 1000)\n");
+    printf("  -b <num>  Bitmap resources in module (default 32)\n");
+    printf("  -f <num>  Font resources in module (default 32)\n");
+    printf("  -s <num>  Size of resource in module (default 4096)\n");
+    printf("  -w <num>  Width of bitmaps (default 256)\n");
+    printf("  -h <num>  Height of bitmaps (default 256)\n");
+    printf("  -t <num>  Threads of banded decoding (default number of CPUs)\n");
+    printf("  -a        Allocate from arena (reset after every operation)\n");
+    printf("  -c        CSV output\n");
+    printf("  -x        Cross-check vectorized kernels against scalar ones\n");
+    printf("  -p        Profile with performance counters (NE files, generated module if none)\n");
+}
+
+int main(int argc, char** argv)
+{
+    bench_options_t options = { 1000, 32, 32, 4096, 256, 256, 0, FALSE, FALSE, FALSE, FALSE, NULL, 0 };
+    sint_t          i;
+
+    for (i = 1; i < argc; i ++)
+    {
+        const char_t* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if      (! strcmp(argv[i], "-a")) options.use_arena       = TRUE;
+        else if (! strcmp(argv[i], "-c")) options.csv_output      = TRUE;
+        else if (! strcmp(argv[i], "-p")) options.use_profile     = TRUE;
+        else if (! strcmp(argv[i], "-x")) options.use_cross_check = TRUE;
+        else if ((! strcmp(argv[i], "-n")) && (value)) { options.iterations    = (uint32_t) atoi(value); i ++; }
+        else if ((! strcmp(argv[i], "-b")) && (value)) { options.bitmaps_num   = (uint32_t) atoi(value); i ++; }
+        else if ((! strcmp(argv[i], "-f")) && (value)) { options.fonts_num     = (uint32_t) atoi(value); i ++; }
+        else if ((! strcmp(argv[i], "-s")) && (value)) { options.resource_size = (uint32_t) atoi(value); i ++; }
+        else if ((! strcmp(argv[i], "-w")) && (value)) { options.bitmap_width  = (uint32_t) atoi(value); i ++; }
+        else if ((! strcmp(argv[i], "-h")) && (value)) { options.bitmap_height = (uint32_t) atoi(value); i ++; }
+        else if ((! strcmp(argv[i], "-t")) && (value)) { options.threads_num   = (uint32_t) atoi(value); i ++; }
+        else if (argv[i][0] != '-')
+        {
+            // Remaining arguments are input files
+            options.files     = argv + i;
+            options.files_num = argc - i;
+            break;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (! options.iterations)
+        options.iterations = 1;
+
+    if (options.use_cross_check)
+        return (run_cross_check(TRUE)) ? 1 : 0;
+
+    fprintf(stderr, "CPU level: %s (supported %s)\n", convert_cpu_level_to_text(get_cpu_level()), convert_cpu_level_to_text(get_cpu_level_supported()));
+
+    if (options.use_profile)
+    {
+        bench_profile(&options);
+        return 0;
+    }
+
+    if (options.use_arena)
+        bench_arena = new_mem_arena(0);
+
+    print_header(&options);
+
+    bench_module(&options);
+    bench_bitmaps(&options);
+    bench_fonts(&options);
+    bench_icons(&options);
+
+    if (bench_arena)
+        del_mem_arena(bench_arena);
+
+    return 0;
+}
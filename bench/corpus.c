@@ -0,0 +1,699 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "exe_head.h"
+#include "resource.h"
+#include "rt_btmap.h"
+#include "rt_font.h"
+
+#include "corpus.h"
+
+#define CORPUS_NE_OFFSET     0x0080
+#define CORPUS_FACE_NAME     "Bench"
+#define CORPUS_FIRST_SYMBOL  0x20
+#define CORPUS_LAST_SYMBOL   0xFF
+
+static sint_t put_bytes(FILE* stream, uint32_t offset, const void_t* data, uint32_t size)
+{
+    if (fseek(stream, offset, SEEK_SET) != 0)
+        return -1;
+
+    return (fwrite(data, 1, size, stream) != size) ? -1 : 0;
+}
+
+static inline uint8_t get_pixel_pattern(uint32_t x, uint32_t y)
+{
+    return (uint8_t) ((x / 8) + y * 3);
+}
+
+static uint32_t put_rle_data(FILE* stream, uint32_t offset, const corpus_bitmap_t* params)
+{
+    uint32_t x, y, size = 0;
+    uint8_t  code [2];
+
+    if (fseek(stream, offset, SEEK_SET) != 0)
+        return 0;
+
+    for (y = 0; y < params->height; y ++)
+    {
+        // Encoded runs of 8 pixels
+        for (x = 0; x < params->width; x += 8)
+        {
+            uint8_t value = get_pixel_pattern(x, y);
+
+            code[0] = (uint8_t) (((params->width - x) < 8) ? (params->width - x) : 8);
+            code[1] = (params->compression == BI_RLE4) ? (uint8_t) (((value & 0x0F) << 4) | (value & 0x0F)) : value;
+
+            if (fwrite(code, 1, 2, stream) != 2)
+                return 0;
+
+            size += 2;
+        }
+
+        // End of line (or end of bitmap)
+        code[0] = 0x00;
+        code[1] = (y + 1 < params->height) ? 0x00 : 0x01;
+
+        if (fwrite(code, 1, 2, stream) != 2)
+            return 0;
+
+        size += 2;
+    }
+
+    return size;
+}
+
+static uint32_t put_raw_data(FILE* stream, uint32_t offset, const corpus_bitmap_t* params)
+{
+    uint32_t line_size = calc_bitmap_line_size(params->width, params->bit_count);
+    uint8_t* line      = (uint8_t*) malloc(line_size);
+    uint32_t x, y;
+
+    if (! line)
+        return 0;
+
+    if (fseek(stream, offset, SEEK_SET) != 0)
+    {
+        free(line);
+        return 0;
+    }
+
+    for (y = 0; y < params->height; y ++)
+    {
+        for (x = 0; x < line_size; x ++)
+            line[x] = get_pixel_pattern(x, y);
+
+        if (fwrite(line, 1, line_size, stream) != line_size)
+        {
+            free(line);
+            return 0;
+        }
+    }
+
+    free(line);
+
+    return line_size * params->height;
+}
+
+static uint32_t put_payload_data(FILE* stream, uint32_t offset, const corpus_bitmap_t* params)
+{
+    static const uint8_t png_signature [8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    static const uint8_t jpg_signature [4] = { 0xFF, 0xD8, 0xFF, 0xE0 };
+
+    uint32_t size = params->width * params->height;
+    uint8_t* data = (uint8_t*) calloc(size + 8, 1);
+
+    if (! data)
+        return 0;
+
+    if (params->compression == BI_PNG)
+        memcpy(data, png_signature, sizeof(png_signature));
+    else
+        memcpy(data, jpg_signature, sizeof(jpg_signature));
+
+    size = (put_bytes(stream, offset, data, size + 8) < 0) ? 0 : (size + 8);
+
+    free(data);
+
+    return size;
+}
+
+uint32_t put_corpus_bitmap(FILE* stream, uint32_t offset, const corpus_bitmap_t* params)
+{
+    uint32_t colors_num = get_colors_num(params->bit_count);
+    uint32_t info_size  = 0;
+    uint32_t table_size = 0;
+
+    // Headers are written after data (sizes are not known before)
+    switch (params->info_type)
+    {
+        case BITMAP_CORE: info_size = BITMAP_CORE_HEADER_SIZE; table_size = colors_num * sizeof(rgb_triple_t); break;
+        case BITMAP_INFO: info_size = BITMAP_INFO_HEADER_SIZE; table_size = colors_num * sizeof(rgb_quad_t);   break;
+        case BITMAP_V4:   info_size = BITMAP_V4_HEADER_SIZE;   table_size = colors_num * sizeof(rgb_quad_t);   break;
+        case BITMAP_V5:   info_size = BITMAP_V5_HEADER_SIZE;   table_size = colors_num * sizeof(rgb_quad_t);   break;
+        default:
+            return 0;
+    }
+
+    // Masks follow BITMAPINFOHEADER for bit fields
+    if ((params->info_type == BITMAP_INFO) && (params->compression == BI_BITFIELDS))
+        table_size += 3 * sizeof(uint32_t);
+
+    uint32_t data_offset = BITMAP_FILE_HEADER_SIZE + info_size + table_size;
+    uint32_t data_size   = 0;
+
+    switch (params->compression)
+    {
+        case BI_RLE8:
+        case BI_RLE4:
+            data_size = put_rle_data(stream, offset + data_offset, params);
+            break;
+
+        case BI_JPEG:
+        case BI_PNG:
+            data_size = put_payload_data(stream, offset + data_offset, params);
+            break;
+
+        default:
+            data_size = put_raw_data(stream, offset + data_offset, params);
+            break;
+    }
+
+    if (! data_size)
+        return 0;
+
+    // File header
+    bitmap_file_header_t file_header = { BITMAP_FILE_HEADER_SYNC, data_offset + data_size, 0, data_offset };
+
+    if (put_bytes(stream, offset, &file_header, sizeof(file_header)) < 0)
+        return 0;
+
+    // Info header
+    bitmap_v5_header_t info_header;
+    memset(&info_header, 0, sizeof(info_header));
+
+    uint32_t mask_red   = (params->bit_count == 16) ? 0xF800 : 0x00FF0000;
+    uint32_t mask_green = (params->bit_count == 16) ? 0x07E0 : 0x0000FF00;
+    uint32_t mask_blue  = (params->bit_count == 16) ? 0x001F : 0x000000FF;
+
+    if (params->info_type == BITMAP_CORE)
+    {
+        bitmap_core_header_t core_header = { BITMAP_CORE_HEADER_SIZE, (uint16_t) params->width, (uint16_t) params->height, 1, (uint16_t) params->bit_count };
+
+        if (put_bytes(stream, offset + BITMAP_FILE_HEADER_SIZE, &core_header, sizeof(core_header)) < 0)
+            return 0;
+    }
+    else
+    {
+        info_header.info_size   = info_size;
+        info_header.data_width  = params->width;
+        info_header.data_height = params->height;
+        info_header.planes_num  = 1;
+        info_header.bit_count   = (uint16_t) params->bit_count;
+        info_header.compression = params->compression;
+        info_header.data_size   = data_size;
+
+        if ((params->info_type != BITMAP_INFO) && (params->compression == BI_BITFIELDS))
+        {
+            info_header.mask_red   = mask_red;
+            info_header.mask_green = mask_green;
+            info_header.mask_blue  = mask_blue;
+        }
+
+        if (params->info_type != BITMAP_INFO)
+            info_header.color_space = 0x73524742; // "sRGB"
+
+        if (put_bytes(stream, offset + BITMAP_FILE_HEADER_SIZE, &info_header, info_size) < 0)
+            return 0;
+
+        if ((params->info_type == BITMAP_INFO) && (params->compression == BI_BITFIELDS))
+        {
+            uint32_t masks [3] = { mask_red, mask_green, mask_blue };
+
+            if (put_bytes(stream, offset + BITMAP_FILE_HEADER_SIZE + info_size, masks, sizeof(masks)) < 0)
+                return 0;
+        }
+    }
+
+    // Color table (gray ramp)
+    if (colors_num)
+    {
+        uint32_t i, entry_size = (params->info_type == BITMAP_CORE) ? sizeof(rgb_triple_t) : sizeof(rgb_quad_t);
+
+        if (fseek(stream, offset + BITMAP_FILE_HEADER_SIZE + info_size, SEEK_SET) != 0)
+            return 0;
+
+        for (i = 0; i < colors_num; i ++)
+        {
+            uint8_t    level = (uint8_t) ((i * 255) / (colors_num - 1));
+            rgb_quad_t color = { level, level, level, 0 };
+
+            if (fwrite(&color, 1, entry_size, stream) != entry_size)
+                return 0;
+        }
+    }
+
+    return data_offset + data_size;
+}
+
+uint32_t put_corpus_icon(FILE* stream, uint32_t offset, uint32_t bit_count, uint32_t size)
+{
+    uint32_t        colors_num  = get_colors_num(bit_count);
+    uint32_t        data_offset = BITMAP_INFO_HEADER_SIZE + colors_num * sizeof(rgb_quad_t);
+    corpus_bitmap_t params      = { BITMAP_INFO, BI_RGB, bit_count, size, size };
+
+    // XOR image (alpha of 32-bit pixels is pattern too)
+    uint32_t data_size = put_raw_data(stream, offset + data_offset, &params);
+
+    if (! data_size)
+        return 0;
+
+    // AND mask (corners are transparent)
+    uint32_t mask_line = calc_bitmap_line_size(size, 1);
+    uint8_t* line      = (uint8_t*) calloc(mask_line, 1);
+    uint32_t x, y;
+
+    if (! line)
+        return 0;
+
+    for (y = 0; y < size; y ++)
+    {
+        for (x = 0; x < size; x ++)
+        {
+            bool_e corner = (((x < size / 4) || (x >= size - size / 4)) && ((y < size / 4) || (y >= size - size / 4))) ? TRUE : FALSE;
+
+            if (corner)
+                line[x / 8] |= (uint8_t) (0x80 >> (x % 8));
+            else
+                line[x / 8] &= (uint8_t) ~(0x80 >> (x % 8));
+        }
+
+        if (put_bytes(stream, offset + data_offset + data_size + y * mask_line, line, mask_line) < 0)
+        {
+            free(line);
+            return 0;
+        }
+    }
+
+    free(line);
+
+    // Info header has height of both images
+    bitmap_info_header_t info_header;
+    memset(&info_header, 0, sizeof(info_header));
+
+    info_header.info_size   = BITMAP_INFO_HEADER_SIZE;
+    info_header.data_width  = size;
+    info_header.data_height = size * 2;
+    info_header.planes_num  = 1;
+    info_header.bit_count   = (uint16_t) bit_count;
+    info_header.compression = BI_RGB;
+    info_header.data_size   = data_size + mask_line * size;
+
+    if (put_bytes(stream, offset, &info_header, sizeof(info_header)) < 0)
+        return 0;
+
+    // Color table (gray ramp)
+    uint32_t i;
+    for (i = 0; i < colors_num; i ++)
+    {
+        uint8_t    level = (uint8_t) ((i * 255) / (colors_num - 1));
+        rgb_quad_t color = { level, level, level, 0 };
+
+        if (put_bytes(stream, offset + BITMAP_INFO_HEADER_SIZE + i * sizeof(rgb_quad_t), &color, sizeof(color)) < 0)
+            return 0;
+    }
+
+    return data_offset + info_header.data_size;
+}
+
+uint32_t put_corpus_cursor(FILE* stream, uint32_t offset, uint32_t bit_count, uint32_t size)
+{
+    uint16_t hotspot [2] = { (uint16_t) (size / 2), (uint16_t) (size / 3) };
+    uint32_t image_size  = put_corpus_icon(stream, offset + sizeof(hotspot), bit_count, size);
+
+    if ((! image_size) || (put_bytes(stream, offset, hotspot, sizeof(hotspot)) < 0))
+        return 0;
+
+    return sizeof(hotspot) + image_size;
+}
+
+static sint_t put_riff_chunk(FILE* stream, uint32_t offset, const char_t* chunk_id, uint32_t chunk_size)
+{
+    uint32_t chunk_header [2] = { 0, chunk_size };
+
+    memcpy(chunk_header, chunk_id, sizeof(uint32_t));
+
+    return put_bytes(stream, offset, chunk_header, sizeof(chunk_header));
+}
+
+uint32_t put_corpus_anicursor(FILE* stream, uint32_t offset, uint32_t frames_num, uint32_t bit_count, uint32_t size)
+{
+    // Steps go forth and back through frames
+    uint32_t steps_num = (frames_num > 1) ? (frames_num * 2 - 2) : 1;
+    uint32_t position  = offset + 12; // RIFF header and form type
+    uint32_t i;
+
+    uint32_t ani_header [9] = { 36, frames_num, steps_num, 0, 0, 0, 0, 6, 0x03 };
+
+    if ((put_riff_chunk(stream, position, "anih", sizeof(ani_header)) < 0)
+    ||  (put_bytes(stream, position + 8, ani_header, sizeof(ani_header)) < 0))
+        return 0;
+
+    position += 8 + sizeof(ani_header);
+
+    // Rates and sequence
+    if ((put_riff_chunk(stream, position, "rate", steps_num * 4) < 0)
+    ||  (put_riff_chunk(stream, position + 8 + steps_num * 4, "seq ", steps_num * 4) < 0))
+        return 0;
+
+    for (i = 0; i < steps_num; i ++)
+    {
+        uint32_t rate  = 4 + (i % 3);
+        uint32_t frame = (i < frames_num) ? i : (steps_num - i);
+
+        if ((put_bytes(stream, position + 8 + i * 4, &rate, sizeof(rate)) < 0)
+        ||  (put_bytes(stream, position + 16 + steps_num * 4 + i * 4, &frame, sizeof(frame)) < 0))
+            return 0;
+    }
+
+    position += 2 * (8 + steps_num * 4);
+
+    // Frames (cursor file with single entry each)
+    uint32_t list_position = position;
+
+    position += 12;
+
+    for (i = 0; i < frames_num; i ++)
+    {
+        uint32_t image_size = put_corpus_icon(stream, position + 8 + 22, bit_count, size);
+
+        if (! image_size)
+            return 0;
+
+        uint16_t file_header [3] = { 0, 2, 1 };
+        uint8_t  file_entry [16] = { (uint8_t) size, (uint8_t) size, 0, 0, (uint8_t) i, 0, 1, 0 };
+        uint32_t entry_place [2] = { image_size, 22 };
+
+        memcpy(file_entry + 8, entry_place, sizeof(entry_place));
+
+        if ((put_riff_chunk(stream, position, "icon", 22 + image_size) < 0)
+        ||  (put_bytes(stream, position + 8, file_header, sizeof(file_header)) < 0)
+        ||  (put_bytes(stream, position + 14, file_entry, sizeof(file_entry)) < 0))
+            return 0;
+
+        position += 8 + 22 + image_size;
+
+        // Padding to even size
+        if (image_size & 1)
+        {
+            if (put_bytes(stream, position, "", 1) < 0)
+                return 0;
+
+            position ++;
+        }
+    }
+
+    if ((put_riff_chunk(stream, list_position, "LIST", position - list_position - 8) < 0)
+    ||  (put_bytes(stream, list_position + 8, "fram", 4) < 0)
+    ||  (put_riff_chunk(stream, offset, "RIFF", position - offset - 8) < 0)
+    ||  (put_bytes(stream, offset + 8, "ACON", 4) < 0))
+        return 0;
+
+    return position - offset;
+}
+
+uint32_t put_corpus_font(FILE* stream, uint32_t offset, uint16_t version, uint16_t char_width, uint16_t char_height)
+{
+    uint32_t chars_num   = CORPUS_LAST_SYMBOL - CORPUS_FIRST_SYMBOL + 1;
+    uint32_t entry_size  = (version == FONT_VERSION_2) ? 4 : 6;
+    uint32_t table_start = sizeof(font_info_t) + ((version == FONT_VERSION_2) ? 0 : sizeof(font_extention_t));
+    uint32_t face_offset = table_start + (chars_num + 1) * entry_size;
+    uint32_t data_addr   = face_offset + sizeof(CORPUS_FACE_NAME);
+    uint32_t line_size   = (char_width + 7) / 8;
+    uint32_t glyph_size  = line_size * char_height;
+    uint32_t font_size   = data_addr + glyph_size * (chars_num + 1);
+    uint32_t i;
+
+    // Offsets are 16-bit in version 2
+    if ((version == FONT_VERSION_2) && (font_size > 0xFFFF))
+        return 0;
+
+    // Font info struct
+    font_info_t font_info;
+    memset(&font_info, 0, sizeof(font_info));
+
+    font_info.version          = version;
+    font_info.data_size        = font_size;
+    font_info.file_type        = FONT_TYPE_BITMAP;
+    font_info.font_size        = char_height;
+    font_info.vertical_dpi     = 96;
+    font_info.horizontal_dpi   = 96;
+    font_info.ascent           = char_height;
+    font_info.font_weight      = 400;
+    font_info.char_width       = char_width;
+    font_info.char_height      = char_height;
+    font_info.pitch_family     = FONT_PITCH_FIXED | FONT_FAMILY_MODERN;
+    font_info.average_width    = char_width;
+    font_info.maximum_width    = char_width;
+    font_info.first_symbol     = CORPUS_FIRST_SYMBOL;
+    font_info.last_symbol      = CORPUS_LAST_SYMBOL;
+    font_info.default_symbol   = '?' - CORPUS_FIRST_SYMBOL;
+    font_info.break_symbol     = ' ' - CORPUS_FIRST_SYMBOL;
+    font_info.row_width        = (uint16_t) (line_size * (chars_num + 1));
+    font_info.font_face_offset = face_offset;
+    font_info.data_addr        = data_addr;
+
+    if (put_bytes(stream, offset, &font_info, sizeof(font_info)) < 0)
+        return 0;
+
+    if (version != FONT_VERSION_2)
+    {
+        font_extention_t font_extention;
+        memset(&font_extention, 0, sizeof(font_extention));
+
+        font_extention.glyph_flags = 0x0001 | 0x0010;
+
+        if (put_bytes(stream, offset + sizeof(font_info_t), &font_extention, sizeof(font_extention)) < 0)
+            return 0;
+    }
+
+    // Character table (last entry is for default symbol)
+    if (fseek(stream, offset + table_start, SEEK_SET) != 0)
+        return 0;
+
+    for (i = 0; i <= chars_num; i ++)
+    {
+        uint8_t  entry [6];
+        uint32_t glyph_offset = data_addr + i * glyph_size;
+
+        entry[0] = (uint8_t) (char_width);
+        entry[1] = (uint8_t) (char_width >> 8);
+        entry[2] = (uint8_t) (glyph_offset);
+        entry[3] = (uint8_t) (glyph_offset >> 8);
+        entry[4] = (uint8_t) (glyph_offset >> 16);
+        entry[5] = (uint8_t) (glyph_offset >> 24);
+
+        if (fwrite(entry, 1, entry_size, stream) != entry_size)
+            return 0;
+    }
+
+    if (put_bytes(stream, offset + face_offset, CORPUS_FACE_NAME, sizeof(CORPUS_FACE_NAME)) < 0)
+        return 0;
+
+    // Glyphs
+    if (fseek(stream, offset + data_addr, SEEK_SET) != 0)
+        return 0;
+
+    for (i = 0; i < glyph_size * (chars_num + 1); i ++)
+    {
+        if (fputc((uint8_t) (i * 7 + (i / glyph_size)), stream) == EOF)
+            return 0;
+    }
+
+    return font_size;
+}
+
+uint32_t put_corpus_module(FILE* stream, const corpus_module_t* params)
+{
+    uint32_t resources_num = params->bitmaps_num + params->fonts_num;
+    uint32_t table_offset  = CORPUS_NE_OFFSET + NE_HEADER_SIZE;
+    uint32_t table_size    = sizeof(uint16_t) + 2 * RESOURCE_TYPE_SIZE + resources_num * RESOURCE_INFO_SIZE + sizeof(uint16_t);
+    uint32_t data_offset   = table_offset + table_size;
+    uint32_t i;
+
+    // Choose alignment shift to keep 16-bit offsets (resources are never bigger than 64K here)
+    uint16_t shift = 4;
+
+    while ((((uint64_t) data_offset + (uint64_t) resources_num * (params->resource_size + 0x10000)) >> shift) > 0xFFFF)
+        shift ++;
+
+    uint32_t alignment = 1 << shift;
+
+    // Resources (bitmaps first, then fonts)
+    resource_info_t* infos = (resource_info_t*) calloc((resources_num) ? resources_num : 1, sizeof(resource_info_t));
+
+    if (! infos)
+        return 0;
+
+    uint32_t offset   = (data_offset + alignment - 1) & ~(alignment - 1);
+    uint32_t data_end = data_offset;
+
+    for (i = 0; i < resources_num; i ++)
+    {
+        uint32_t size;
+
+        if (i < params->bitmaps_num)
+        {
+            corpus_bitmap_t bitmap = { BITMAP_INFO, BI_RGB, 8, 64, 1 };
+
+            if (params->resource_size > 64 + 1078)
+                bitmap.height = (params->resource_size - 1078) / 64;
+
+            size = put_corpus_bitmap(stream, offset, &bitmap);
+        }
+        else
+        {
+            uint16_t char_height = 16;
+
+            if (params->resource_size > 225 * 2 * 16)
+                char_height = (uint16_t) (params->resource_size / (225 * 2));
+
+            if (char_height > 128)
+                char_height = 128;
+
+            size = put_corpus_font(stream, offset, FONT_VERSION_2, 16, char_height);
+        }
+
+        if (! size)
+        {
+            free(infos);
+            return 0;
+        }
+
+        infos[i].content_offset = (uint16_t) (offset >> shift);
+        infos[i].content_size   = (uint16_t) ((size + alignment - 1) >> shift);
+        infos[i].flags          = 0x0030;
+        infos[i].resource_id    = (uint16_t) (0x8001 + i);
+
+        data_end = offset + size;
+        offset   = (data_end + alignment - 1) & ~(alignment - 1);
+    }
+
+    uint32_t file_size = offset;
+
+    // Resource table
+    if (fseek(stream, table_offset, SEEK_SET) != 0)
+    {
+        free(infos);
+        return 0;
+    }
+
+    fwrite(&shift, 1, sizeof(uint16_t), stream);
+
+    resource_type_t types [2] = {
+        { 0x8000 | RT_BITMAP, (uint16_t) params->bitmaps_num, 0 },
+        { 0x8000 | RT_FONT,   (uint16_t) params->fonts_num,   0 }
+    };
+
+    fwrite(&types[0], 1, sizeof(resource_type_t), stream);
+    fwrite(infos, sizeof(resource_info_t), params->bitmaps_num, stream);
+    fwrite(&types[1], 1, sizeof(resource_type_t), stream);
+    fwrite(infos + params->bitmaps_num, sizeof(resource_info_t), params->fonts_num, stream);
+
+    free(infos);
+
+    uint16_t end_of_table = 0x0000;
+
+    if (fwrite(&end_of_table, 1, sizeof(uint16_t), stream) != sizeof(uint16_t))
+        return 0;
+
+    // NE header
+    ne_header_t ne_header;
+    memset(&ne_header, 0, sizeof(ne_header));
+
+    ne_header.syncword                  = NE_HEADER_SYNC;
+    ne_header.linker_version            = 5;
+    ne_header.resource_table_offset     = NE_HEADER_SIZE;
+    ne_header.resident_table_offset     = (uint16_t) (NE_HEADER_SIZE + table_size);
+    ne_header.resource_entries_in_table = (uint16_t) resources_num;
+    ne_header.executable_type           = 0x02;
+
+    if (put_bytes(stream, CORPUS_NE_OFFSET, &ne_header, sizeof(ne_header)) < 0)
+        return 0;
+
+    // MZ header and pointer to NE header
+    mz_header_t mz_header;
+    memset(&mz_header, 0, sizeof(mz_header));
+
+    mz_header.syncword             = MZ_HEADER_SYNC;
+    mz_header.bytes_in_last_block  = (uint16_t) (file_size % 0x0200);
+    mz_header.blocks_in_file       = (uint16_t) ((file_size + 0x01FF) / 0x0200);
+    mz_header.paragraphs_in_header = 4;
+    mz_header.reloc_table_offset   = RELOCATION_TABLE_OFFSET;
+
+    uint32_t ne_offset = CORPUS_NE_OFFSET;
+
+    if ((put_bytes(stream, 0, &mz_header, sizeof(mz_header)) < 0)
+    ||  (put_bytes(stream, SEGMENTED_HEADER_OFFSET, &ne_offset, sizeof(uint32_t)) < 0))
+        return 0;
+
+    // Pad file up to its size
+    if (fseek(stream, data_end, SEEK_SET) != 0)
+        return 0;
+
+    for (i = data_end; i < file_size; i ++)
+    {
+        if (fputc(0x00, stream) == EOF)
+            return 0;
+    }
+
+    // Checksum makes 16-bit sum of file equal to 0xFFFF
+    uint16_t sum = 0x0000, word;
+
+    if (fseek(stream, 0, SEEK_SET) != 0)
+        return 0;
+
+    for (i = 0; i < file_size / 2; i ++)
+    {
+        if (fread(&word, 1, sizeof(uint16_t), stream) != sizeof(uint16_t))
+            break;
+
+        sum += word;
+    }
+
+    mz_header.checksum = (uint16_t) (0xFFFF - sum);
+
+    if (put_bytes(stream, 0, &mz_header, sizeof(mz_header)) < 0)
+        return 0;
+
+    fflush(stream);
+
+    return file_size;
+}
+
+uint32_t get_corpus_bitmap_variants(corpus_bitmap_t* variants, uint32_t max_num, uint32_t width, uint32_t height)
+{
+    static const uint32_t formats [][2] = {
+        {  1, BI_RGB       },
+        {  4, BI_RGB       },
+        {  8, BI_RGB       },
+        { 24, BI_RGB       },
+        { 16, BI_RGB       },
+        { 32, BI_RGB       },
+        { 16, BI_BITFIELDS },
+        { 32, BI_BITFIELDS },
+        {  8, BI_RLE8      },
+        {  4, BI_RLE4      },
+        {  0, BI_JPEG      },
+        {  0, BI_PNG       }
+    };
+
+    uint32_t i, num = 0;
+    sint_t   info_type;
+
+    for (info_type = BITMAP_CORE; info_type < BITMAP_UNKNOWN; info_type ++)
+    {
+        for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i ++)
+        {
+            // Core header knows only uncompressed 1/4/8/24-bit bitmaps
+            if ((info_type == BITMAP_CORE) && ((formats[i][1] != BI_RGB) || (formats[i][0] == 16) || (formats[i][0] == 32)))
+                continue;
+
+            if (num >= max_num)
+                return num;
+
+            variants[num].info_type   = (info_types_e) info_type;
+            variants[num].bit_count   = formats[i][0];
+            variants[num].compression = formats[i][1];
+            variants[num].width       = width;
+            variants[num].height      = height;
+            num ++;
+        }
+    }
+
+    return num;
+}
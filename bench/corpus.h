@@ -0,0 +1,39 @@
+#ifndef __CORPUS_H__
+#define __CORPUS_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "rt_btmap.h"
+
+// Synthetic inputs for benchmarks
+//
+// All generators write at given offset and return number of bytes written
+// (zero on error). Pixel and glyph contents are deterministic patterns.
+
+typedef struct _corpus_bitmap_t {
+    info_types_e info_type;
+    uint32_t     compression;
+    uint32_t     bit_count;
+    uint32_t     width;
+    uint32_t     height;
+} corpus_bitmap_t;
+
+typedef struct _corpus_module_t {
+    uint32_t bitmaps_num;   // RT_BITMAP resources (8-bit, about resource_size bytes each)
+    uint32_t fonts_num;     // RT_FONT resources (version 2)
+    uint32_t resource_size; // Approximate size of every resource
+} corpus_module_t;
+
+uint32_t put_corpus_bitmap(FILE* stream, uint32_t offset, const corpus_bitmap_t* params);
+uint32_t put_corpus_icon(FILE* stream, uint32_t offset, uint32_t bit_count, uint32_t size); // Packed DIB with AND mask
+uint32_t put_corpus_cursor(FILE* stream, uint32_t offset, uint32_t bit_count, uint32_t size);
+uint32_t put_corpus_anicursor(FILE* stream, uint32_t offset, uint32_t frames_num, uint32_t bit_count, uint32_t size); // Cursor files as frames
+uint32_t put_corpus_font(FILE* stream, uint32_t offset, uint16_t version, uint16_t char_width, uint16_t char_height);
+uint32_t put_corpus_module(FILE* stream, const corpus_module_t* params);
+
+// Every info_type/bit_count/compression combination supported by BMP format
+uint32_t get_corpus_bitmap_variants(corpus_bitmap_t* variants, uint32_t max_num, uint32_t width, uint32_t height);
+
+#endif // __CORPUS_H__
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "stats.h"
+
+#include "perfctr.h"
+
+static const char_t* perf_counter_str [PERF_COUNTERS_NUM] = {
+    "cycles",
+    "instructions",
+    "cache-misses",
+    "branch-misses",
+    "page-faults"
+};
+
+#ifdef __linux__
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} perf_counter_events [PERF_COUNTERS_NUM] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES      },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS    },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES    },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES   },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS     }
+};
+
+static sint_t open_perf_event(perf_counter_e counter, sint_t leader)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    // Members follow leader, whole group is switched by leader
+    attr.size           = sizeof(attr);
+    attr.type           = perf_counter_events[counter].type;
+    attr.config         = perf_counter_events[counter].config;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    attr.disabled       = (leader < 0) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    return (sint_t) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+
+sint_t open_perf_counters(perf_counters_t* counters)
+{
+    sint_t i;
+
+    memset(counters, 0, sizeof(perf_counters_t));
+
+    counters->leader = -1;
+
+    for (i = 0; i < PERF_COUNTERS_NUM; i ++)
+    {
+        counters->fds[i]       = open_perf_event((perf_counter_e) i, counters->leader);
+        counters->available[i] = (counters->fds[i] >= 0) ? TRUE : FALSE;
+
+        if (! counters->available[i])
+            continue;
+
+        if (counters->leader < 0)
+            counters->leader = counters->fds[i];
+
+        counters->slots[i] = counters->members_num ++;
+    }
+
+    return (sint_t) counters->members_num;
+}
+
+void_t close_perf_counters(perf_counters_t* counters)
+{
+    sint_t i;
+
+    // Leader is closed last (it was opened first)
+    for (i = PERF_COUNTERS_NUM - 1; i >= 0; i --)
+    {
+        if (counters->available[i])
+            close(counters->fds[i]);
+
+        counters->available[i] = FALSE;
+    }
+
+    counters->leader      = -1;
+    counters->members_num = 0;
+}
+
+void_t start_perf_counters(perf_counters_t* counters, perf_sample_t* sample)
+{
+    if (counters->leader >= 0)
+    {
+        ioctl(counters->leader, PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+        ioctl(counters->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    sample->time_ns = get_time_ns();
+}
+
+void_t stop_perf_counters(perf_counters_t* counters, perf_sample_t* sample)
+{
+    uint64_t values [1 + PERF_COUNTERS_NUM]; // Number of members, then their values
+    size_t   size = sizeof(uint64_t) * (1 + counters->members_num);
+    sint_t   i;
+
+    sample->time_ns = get_time_ns() - sample->time_ns;
+
+    memset(sample->values, 0, sizeof(sample->values));
+
+    if (counters->leader < 0)
+        return;
+
+    ioctl(counters->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    if ((read(counters->leader, values, size) != (ssize_t) size) || (values[0] != counters->members_num))
+        return;
+
+    for (i = 0; i < PERF_COUNTERS_NUM; i ++)
+    {
+        if (counters->available[i])
+            sample->values[i] = values[1 + counters->slots[i]];
+    }
+}
+
+#else
+
+sint_t open_perf_counters(perf_counters_t* counters)
+{
+    memset(counters, 0, sizeof(perf_counters_t));
+
+    counters->leader = -1;
+
+    return 0;
+}
+
+void_t close_perf_counters(perf_counters_t* counters)
+{
+}
+
+void_t start_perf_counters(perf_counters_t* counters, perf_sample_t* sample)
+{
+    sample->time_ns = get_time_ns();
+}
+
+void_t stop_perf_counters(perf_counters_t* counters, perf_sample_t* sample)
+{
+    sample->time_ns = get_time_ns() - sample->time_ns;
+
+    memset(sample->values, 0, sizeof(sample->values));
+}
+
+#endif // __linux__
+
+const char_t* convert_perf_counter_to_text(perf_counter_e counter)
+{
+    return (counter < PERF_COUNTERS_NUM) ? perf_counter_str[counter] : NULL;
+}
@@ -0,0 +1,43 @@
+#ifndef __PERFCTR_H__
+#define __PERFCTR_H__
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Hardware performance counters (perf_event_open on Linux)
+//
+// Counters which can not be opened (no PMU in virtual machine, restricted
+// perf_event_paranoid, other OS) are marked unavailable and read as zero.
+// Available ones form single group (first of them leads it), so they are
+// enabled, disabled and read at once over same interval. Only user space is
+// counted, so syscalls of benchmark loop do not add noise.
+
+typedef enum _perf_counter_e {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_PAGE_FAULTS,
+    PERF_COUNTERS_NUM
+} perf_counter_e;
+
+typedef struct _perf_counters_t {
+    sint_t   fds       [PERF_COUNTERS_NUM];
+    bool_e   available [PERF_COUNTERS_NUM];
+    uint32_t slots     [PERF_COUNTERS_NUM]; // Position of value in read of group
+    uint32_t members_num;
+    sint_t   leader;                        // Descriptor of group leader, -1 without counters
+} perf_counters_t;
+
+typedef struct _perf_sample_t {
+    uint64_t time_ns;
+    uint64_t values [PERF_COUNTERS_NUM];
+} perf_sample_t;
+
+sint_t        open_perf_counters(perf_counters_t* counters); // Returns number of available counters
+void_t        close_perf_counters(perf_counters_t* counters);
+void_t        start_perf_counters(perf_counters_t* counters, perf_sample_t* sample);
+void_t        stop_perf_counters(perf_counters_t* counters, perf_sample_t* sample);
+const char_t* convert_perf_counter_to_text(perf_counter_e counter);
+
+#endif // __PERFCTR_H__
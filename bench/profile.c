@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "checksum.h"
+#include "exe_head.h"
+#include "resource.h"
+#include "rt_btmap.h"
+#include "rt_font.h"
+
+#include "perfctr.h"
+#include "profile.h"
+
+static const char_t* profile_op_str [PROFILE_OPS_NUM] = {
+    "validate_mz_checksum",
+    "get_exe_info",
+    "get_resource_table_info",
+    "get_rt_bitmap",
+    "get_rt_bitmap_data",
+    "get_rt_font",
+    "get_rt_font_bitmap_full"
+};
+
+static inline void_t begin_profile_op(profile_t* profile, perf_sample_t* sample)
+{
+    start_perf_counters(&profile->counters, sample);
+}
+
+static inline void_t end_profile_op(profile_t* profile, perf_sample_t* sample, profile_op_e op, bool_e success, uint32_t bytes)
+{
+    stop_perf_counters(&profile->counters, sample);
+
+    profile_op_t* profile_op = &profile->ops[op];
+    sint_t        i;
+
+    profile_op->calls   ++;
+    profile_op->time_ns += sample->time_ns;
+
+    if (! success)
+    {
+        profile_op->failures ++;
+        return;
+    }
+
+    profile_op->bytes += bytes;
+
+    for (i = 0; i < PERF_COUNTERS_NUM; i ++)
+        profile_op->values[i] += sample->values[i];
+}
+
+sint_t open_profile(profile_t* profile)
+{
+    memset(profile, 0, sizeof(profile_t));
+
+    return open_perf_counters(&profile->counters);
+}
+
+void_t close_profile(profile_t* profile)
+{
+    close_perf_counters(&profile->counters);
+}
+
+static void_t run_profile_bitmap(profile_t* profile, FILE* stream, resource_entry_t* entry)
+{
+    perf_sample_t sample;
+
+    begin_profile_op(profile, &sample);
+    rt_bitmap_t* rt_bitmap = get_rt_bitmap(stream, entry->content_offset);
+    end_profile_op(profile, &sample, PROFILE_GET_RT_BITMAP, (rt_bitmap) ? TRUE : FALSE, (rt_bitmap) ? rt_bitmap->data_offset - entry->content_offset : 0);
+
+    if (! rt_bitmap)
+        return;
+
+    begin_profile_op(profile, &sample);
+    rt_bitmap_data_t* rt_bitmap_data = get_rt_bitmap_data(stream, rt_bitmap);
+    end_profile_op(profile, &sample, PROFILE_GET_RT_BITMAP_DATA, (rt_bitmap_data) ? TRUE : FALSE, rt_bitmap->data_size);
+
+    if (rt_bitmap_data)
+        del_rt_bitmap_data(rt_bitmap_data);
+
+    del_rt_bitmap(rt_bitmap);
+}
+
+static void_t run_profile_font(profile_t* profile, FILE* stream, resource_entry_t* entry)
+{
+    perf_sample_t sample;
+
+    begin_profile_op(profile, &sample);
+    rt_font_t* rt_font = get_rt_font(stream, entry->content_offset);
+    end_profile_op(profile, &sample, PROFILE_GET_RT_FONT, (rt_font) ? TRUE : FALSE, entry->content_size);
+
+    if (! rt_font)
+        return;
+
+    begin_profile_op(profile, &sample);
+    rt_bitmap_data_t* rt_bitmap_data = get_rt_font_bitmap_full(stream, rt_font);
+    end_profile_op(profile, &sample, PROFILE_GET_RT_FONT_BITMAP_FULL, (rt_bitmap_data) ? TRUE : FALSE, (rt_bitmap_data) ? rt_bitmap_data->size : 0);
+
+    if (rt_bitmap_data)
+        del_rt_bitmap_data(rt_bitmap_data);
+
+    del_rt_font(rt_font);
+}
+
+sint_t run_profile(profile_t* profile, FILE* stream, uint32_t size)
+{
+    perf_sample_t sample;
+    uint32_t      i;
+
+    begin_profile_op(profile, &sample);
+    validate_mz_checksum(stream, size);
+    end_profile_op(profile, &sample, PROFILE_VALIDATE_MZ_CHECKSUM, TRUE, size);
+
+    begin_profile_op(profile, &sample);
+    exe_info_t* exe_info = get_exe_info(stream, 0);
+    end_profile_op(profile, &sample, PROFILE_GET_EXE_INFO, (exe_info) ? TRUE : FALSE, (exe_info) ? exe_info->segmented_offset + NE_HEADER_SIZE : 0);
+
+    if (! exe_info)
+        return -1;
+
+    if (! exe_info->ne_header)
+    {
+        del_exe_info(exe_info);
+        return -1;
+    }
+
+    uint32_t table_offset = exe_info->segmented_offset + exe_info->ne_header->resource_table_offset;
+    uint32_t table_size   = exe_info->ne_header->resident_table_offset - exe_info->ne_header->resource_table_offset;
+
+    del_exe_info(exe_info);
+
+    begin_profile_op(profile, &sample);
+    resource_table_info_t* resource_table_info = get_resource_table_info(stream, table_offset);
+    end_profile_op(profile, &sample, PROFILE_GET_RESOURCE_TABLE_INFO, (resource_table_info) ? TRUE : FALSE, table_size);
+
+    if (! resource_table_info)
+        return -1;
+
+    for (i = 0; i < resource_table_info->info_entries_num; i ++)
+    {
+        resource_entry_t* entry = &resource_table_info->info_entries[i];
+
+        switch (entry->type_id & ~0x8000)
+        {
+            case RT_BITMAP:
+                run_profile_bitmap(profile, stream, entry);
+                break;
+
+            case RT_FONT:
+                run_profile_font(profile, stream, entry);
+                break;
+        }
+    }
+
+    del_resource_table_info(resource_table_info);
+
+    return 0;
+}
+
+static void_t print_value(double value, bool_e available, bool_e csv_output)
+{
+    if (csv_output)
+    {
+        if (available)
+            printf(",%.3f", value);
+        else
+            printf(",");
+    }
+    else
+    {
+        if (available)
+            printf(" %10.3f", value);
+        else
+            printf(" %10s", "n/a");
+    }
+}
+
+void_t print_profile(profile_t* profile, bool_e csv_output)
+{
+    bool_e*  available = profile->counters.available;
+    uint32_t i;
+
+    if (csv_output)
+        printf("operation,calls,failures,ns_per_op,cycles_per_op,instructions_per_op,ipc,cache_misses_per_kb,branch_misses_per_kb,page_faults_per_op\n");
+    else
+        printf("%-26s %8s %8s %10s %10s %10s %10s %10s %10s %10s\n",
+               "operation", "calls", "failures", "ns/op", "cycles/op", "instr/op", "IPC", "cmiss/KB", "bmiss/KB", "faults/op");
+
+    for (i = 0; i < PROFILE_OPS_NUM; i ++)
+    {
+        profile_op_t* op = &profile->ops[i];
+
+        if (! op->calls)
+            continue;
+
+        // Counters are accumulated for successful calls only
+        uint64_t succeeded = op->calls - op->failures;
+        double   calls     = (succeeded) ? (double) succeeded : 1.0;
+        double   kbytes    = (op->bytes) ? (double) op->bytes / 1024.0 : 1.0;
+        double   cycles    = (double) op->values[PERF_CYCLES];
+
+        if (csv_output)
+            printf("%s,%llu,%llu,%.1f", profile_op_str[i], (unsigned long long) op->calls, (unsigned long long) op->failures, (double) op->time_ns / op->calls);
+        else
+            printf("%-26s %8llu %8llu %10.1f", profile_op_str[i], (unsigned long long) op->calls, (unsigned long long) op->failures, (double) op->time_ns / op->calls);
+
+        print_value(cycles / calls, available[PERF_CYCLES], csv_output);
+        print_value((double) op->values[PERF_INSTRUCTIONS] / calls, available[PERF_INSTRUCTIONS], csv_output);
+        print_value((cycles) ? (double) op->values[PERF_INSTRUCTIONS] / cycles : 0.0, (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS]) ? TRUE : FALSE, csv_output);
+        print_value((double) op->values[PERF_CACHE_MISSES] / kbytes, available[PERF_CACHE_MISSES], csv_output);
+        print_value((double) op->values[PERF_BRANCH_MISSES] / kbytes, available[PERF_BRANCH_MISSES], csv_output);
+        print_value((double) op->values[PERF_PAGE_FAULTS] / calls, available[PERF_PAGE_FAULTS], csv_output);
+
+        printf("\n");
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "perfctr.h"
+
+// Counter profile of parse and decode entry points
+//
+// Every call is wrapped with performance counters, totals are kept per entry
+// point. Decode entry points account decoded bytes (misses per KB decoded).
+
+typedef enum _profile_op_e {
+    PROFILE_VALIDATE_MZ_CHECKSUM,
+    PROFILE_GET_EXE_INFO,
+    PROFILE_GET_RESOURCE_TABLE_INFO,
+    PROFILE_GET_RT_BITMAP,
+    PROFILE_GET_RT_BITMAP_DATA,
+    PROFILE_GET_RT_FONT,
+    PROFILE_GET_RT_FONT_BITMAP_FULL,
+    PROFILE_OPS_NUM
+} profile_op_e;
+
+typedef struct _profile_op_t {
+    uint64_t calls;
+    uint64_t failures;
+    uint64_t bytes;
+    uint64_t time_ns;
+    uint64_t values [PERF_COUNTERS_NUM];
+} profile_op_t;
+
+typedef struct _profile_t {
+    perf_counters_t counters;
+    profile_op_t    ops [PROFILE_OPS_NUM];
+} profile_t;
+
+sint_t open_profile(profile_t* profile); // Returns number of available counters
+void_t close_profile(profile_t* profile);
+sint_t run_profile(profile_t* profile, FILE* stream, uint32_t size); // NE module
+void_t print_profile(profile_t* profile, bool_e csv_output);
+
+#endif // __PROFILE_H__
@@ -0,0 +1,751 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "memalloc.h"
+#include "cpufeat.h"
+#include "pixconv.h"
+#include "rt_btmap.h"
+#include "bmp_rle.h"
+#include "exe_head.h"
+#include "exe_strm.h"
+
+#include "corpus.h"
+#include "xcheck.h"
+
+#define XCHECK_MAX_SIZE   0x0400
+#define XCHECK_MAX_WIDTH  0x0100
+#define XCHECK_MAX_SHIFT  0x0004
+#define XCHECK_ROUNDS     0x0010
+#define XCHECK_MAX_TAPS   0x0014
+#define XCHECK_RLE_WIDTH  0x0035
+#define XCHECK_RLE_HEIGHT 0x0021
+#define XCHECK_RLE_LINES  0x0007
+
+typedef void_t (*expand_kernel_t)(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+
+static uint32_t xcheck_seed = 0x12345678;
+
+static inline uint32_t get_random(void_t)
+{
+    xcheck_seed = xcheck_seed * 1103515245 + 12345;
+    return xcheck_seed >> 8;
+}
+
+static void_t fill_random(uint8_t* buffer, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = 0; i < size; i ++)
+        buffer[i] = (uint8_t) get_random();
+}
+
+static uint32_t check_sum_words(const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    uint8_t  data [XCHECK_MAX_SIZE + XCHECK_MAX_SHIFT];
+    uint32_t size, shift, round, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random(data, sizeof(data));
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (size = 0; size <= XCHECK_MAX_SIZE; size += 2)
+            {
+                uint16_t expected = reference->sum_words(data + shift, size);
+                uint16_t result   = kernels->sum_words(data + shift, size);
+
+                if (result != expected)
+                {
+                    if (verbose)
+                        printf("%s: sum_words size %u shift %u: 0x%04X instead of 0x%04X\n",
+                               convert_cpu_level_to_text(kernels->level), size, shift, result, expected);
+                    errors ++;
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+static uint32_t check_expand(const char_t* name, expand_kernel_t reference, expand_kernel_t kernel, cpu_level_e level, bool_e verbose)
+{
+    uint8_t  src [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT];
+    uint32_t palette [256];
+    uint32_t expected [XCHECK_MAX_WIDTH + 1];
+    uint32_t result   [XCHECK_MAX_WIDTH + 1];
+    uint32_t width, shift, round, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random(src, sizeof(src));
+        fill_random((uint8_t*) palette, sizeof(palette));
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (width = 0; width <= XCHECK_MAX_WIDTH; width ++)
+            {
+                // Guard entry behind line catches overruns
+                expected[width] = result[width] = 0xDEADBEEF;
+
+                reference(src + shift, expected, width, palette);
+                kernel(src + shift, result, width, palette);
+
+                if (memcmp(expected, result, sizeof(uint32_t) * (width + 1)))
+                {
+                    if (verbose)
+                        printf("%s: %s width %u shift %u: mismatch\n", convert_cpu_level_to_text(level), name, width, shift);
+                    errors ++;
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+typedef enum _convert_kernel_e {
+    CONVERT_24_TO_32,
+    SWAP_RED_BLUE,
+    CONVERT_32_TO_24,
+    CONVERT_32_TO_GRAY,
+    CONVERT_KERNEL_NUM
+} convert_kernel_e;
+
+static const char_t* convert_kernel_str [CONVERT_KERNEL_NUM] = {
+    "convert_24_to_32",
+    "swap_red_blue",
+    "convert_32_to_24",
+    "convert_32_to_gray"
+};
+
+// 32-bit lines are aligned and shifted by whole pixels, 24-bit and 8-bit ones by bytes
+static void_t call_convert(const cpu_kernels_t* kernels, convert_kernel_e kernel, const uint8_t* src, uint32_t shift, uint8_t* dst, uint32_t width)
+{
+    switch (kernel)
+    {
+        case CONVERT_24_TO_32:   kernels->convert_24_to_32(src + shift, (uint32_t*) dst, width); break;
+        case SWAP_RED_BLUE:      kernels->swap_red_blue((const uint32_t*) src + shift, (uint32_t*) dst, width); break;
+        case CONVERT_32_TO_24:   kernels->convert_32_to_24((const uint32_t*) src + shift, dst + shift, width); break;
+        case CONVERT_32_TO_GRAY: kernels->convert_32_to_gray((const uint32_t*) src + shift, dst + shift, width); break;
+        default: break;
+    }
+}
+
+static uint32_t check_convert(convert_kernel_e kernel, const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    uint32_t src      [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT];
+    uint32_t expected [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT + 1];
+    uint32_t result   [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT + 1];
+    uint32_t width, shift, round, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random((uint8_t*) src, sizeof(src));
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (width = 0; width <= XCHECK_MAX_WIDTH; width ++)
+            {
+                // Guard bytes behind line catch overruns
+                memset(expected, 0xA5, sizeof(expected));
+                memset(result,   0xA5, sizeof(result));
+
+                call_convert(reference, kernel, (const uint8_t*) src, shift, (uint8_t*) expected, width);
+                call_convert(kernels,   kernel, (const uint8_t*) src, shift, (uint8_t*) result,   width);
+
+                if (memcmp(expected, result, sizeof(expected)))
+                {
+                    if (verbose)
+                        printf("%s: %s width %u shift %u: mismatch\n", convert_cpu_level_to_text(kernels->level), convert_kernel_str[kernel], width, shift);
+                    errors ++;
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+// Contiguous mask of random width (zero included) and position inside pixel
+static uint32_t get_random_mask(uint32_t bit_count)
+{
+    uint32_t bits = get_random() % (bit_count / 2 + 1);
+    uint32_t low  = get_random() % (bit_count - bits + 1);
+
+    return (bits) ? ((0xFFFFFFFF >> (32 - bits)) << low) : 0;
+}
+
+static uint32_t check_bitfields(uint32_t bit_count, const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    uint8_t  src      [(XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT) * 4];
+    uint32_t expected [XCHECK_MAX_WIDTH + 1];
+    uint32_t result   [XCHECK_MAX_WIDTH + 1];
+    uint32_t width, shift, round, errors = 0;
+
+    const char_t* name = (bit_count == 16) ? "expand_16_bit" : "expand_32_bit";
+
+    // Common masks first, then random ones
+    bitmap_masks_t common [3] = {
+        { 0x7C00,     0x03E0,     0x001F,     0x8000     },
+        { 0xF800,     0x07E0,     0x001F,     0          },
+        { 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 }
+    };
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        bitmap_masks_t bitmap_masks;
+        bitfields_t    bitfields;
+
+        if ((round < 2) || ((round == 2) && (bit_count == 32)))
+        {
+            bitmap_masks = common[round];
+        }
+        else
+        {
+            bitmap_masks.red   = get_random_mask(bit_count);
+            bitmap_masks.green = get_random_mask(bit_count);
+            bitmap_masks.blue  = get_random_mask(bit_count);
+            bitmap_masks.alpha = get_random_mask(bit_count);
+        }
+
+        if (calc_pixel_bitfields(&bitmap_masks, bit_count, &bitfields) < 0)
+        {
+            if (verbose)
+                printf("%s: %s masks %08X %08X %08X %08X: rejected\n", convert_cpu_level_to_text(kernels->level), name,
+                       bitmap_masks.red, bitmap_masks.green, bitmap_masks.blue, bitmap_masks.alpha);
+            errors ++;
+            continue;
+        }
+
+        fill_random(src, sizeof(src));
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (width = 0; width <= XCHECK_MAX_WIDTH; width ++)
+            {
+                // Guard entry behind line catches overruns
+                expected[width] = result[width] = 0xDEADBEEF;
+
+                if (bit_count == 16)
+                {
+                    reference->expand_16_bit(src + shift, expected, width, &bitfields);
+                    kernels->expand_16_bit(src + shift, result, width, &bitfields);
+                }
+                else
+                {
+                    reference->expand_32_bit(src + shift, expected, width, &bitfields);
+                    kernels->expand_32_bit(src + shift, result, width, &bitfields);
+                }
+
+                if (memcmp(expected, result, sizeof(uint32_t) * (width + 1)))
+                {
+                    if (verbose)
+                        printf("%s: %s width %u shift %u: mismatch\n", convert_cpu_level_to_text(kernels->level), name, width, shift);
+                    errors ++;
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+// Random taps (weights of either sign, not summing to one, so clamps are hit)
+static void_t fill_random_taps(resample_taps_t* taps, uint32_t src_width, uint32_t width)
+{
+    uint32_t x, i;
+
+    for (x = 0; x < width; x ++)
+    {
+        taps->first[x] = get_random() % (src_width - taps->taps + 1);
+
+        for (i = 0; i < taps->taps; i ++)
+            taps->weights[taps->taps * x + i] = (sint16_t) ((sint32_t) (get_random() % 0x6000) - 0x1000);
+    }
+}
+
+static uint32_t check_resample(const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    uint32_t        src      [XCHECK_MAX_WIDTH + XCHECK_MAX_TAPS];
+    uint32_t        expected [XCHECK_MAX_WIDTH + 1];
+    uint32_t        result   [XCHECK_MAX_WIDTH + 1];
+    uint32_t        first    [XCHECK_MAX_WIDTH];
+    sint16_t        weights  [XCHECK_MAX_WIDTH * XCHECK_MAX_TAPS];
+    const uint8_t*  lines    [XCHECK_MAX_TAPS];
+    resample_taps_t taps     = { 0, first, weights };
+    uint32_t        width, round, i, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random((uint8_t*) src, sizeof(src));
+
+        for (taps.taps = 1; taps.taps <= XCHECK_MAX_TAPS; taps.taps ++)
+        {
+            for (width = 0; width <= XCHECK_MAX_WIDTH; width += 1 + (width >> 4))
+            {
+                uint32_t src_width = width + XCHECK_MAX_TAPS;
+                uint32_t kernel;
+
+                fill_random_taps(&taps, src_width, width);
+
+                for (i = 0; i < taps.taps; i ++)
+                    lines[i] = (const uint8_t*) src + get_random() % (sizeof(src) - width * 4 + 1);
+
+                for (kernel = 0; kernel < 3; kernel ++)
+                {
+                    const char_t* name [3] = { "resample_32", "resample_8", "resample_lines" };
+
+                    // Guard bytes behind line catch overruns
+                    memset(expected, 0xA5, sizeof(expected));
+                    memset(result,   0xA5, sizeof(result));
+
+                    if (kernel == 0)
+                    {
+                        reference->resample_32(src, expected, width, &taps);
+                        kernels->resample_32(src, result, width, &taps);
+                    }
+                    else if (kernel == 1)
+                    {
+                        reference->resample_8((const uint8_t*) src, (uint8_t*) expected, width, &taps);
+                        kernels->resample_8((const uint8_t*) src, (uint8_t*) result, width, &taps);
+                    }
+                    else
+                    {
+                        reference->resample_lines(lines, weights, taps.taps, (uint8_t*) expected, width * 4);
+                        kernels->resample_lines(lines, weights, taps.taps, (uint8_t*) result, width * 4);
+                    }
+
+                    if (memcmp(expected, result, sizeof(expected)))
+                    {
+                        if (verbose)
+                            printf("%s: %s width %u taps %u: mismatch\n", convert_cpu_level_to_text(kernels->level), name[kernel], width, taps.taps);
+                        errors ++;
+                    }
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+// Sizes over block of sums before modulo (5552 bytes) as well
+static uint32_t check_adler_32(const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    uint8_t  data [XCHECK_MAX_SIZE * 8 + XCHECK_MAX_SHIFT];
+    uint32_t size, shift, round, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random(data, sizeof(data));
+
+        // All bytes 0xFF give largest sums
+        if (! round)
+            memset(data, 0xFF, sizeof(data));
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (size = 0; size <= XCHECK_MAX_SIZE * 8; size += 1 + (size >> 5))
+            {
+                uint32_t adler    = (round) ? (((get_random() % 65521) << 16) | (get_random() % 65521)) : 0xFFF0FFF0;
+                uint32_t expected = reference->adler_32(adler, data + shift, size);
+                uint32_t result   = kernels->adler_32(adler, data + shift, size);
+
+                if (result != expected)
+                {
+                    if (verbose)
+                        printf("%s: adler_32 size %u shift %u: 0x%08X instead of 0x%08X\n",
+                               convert_cpu_level_to_text(kernels->level), size, shift, result, expected);
+                    errors ++;
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+static uint32_t check_filter_png(const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    static const uint32_t bpps [4] = { 1, 2, 3, 4 };
+
+    uint8_t  line  [XCHECK_MAX_WIDTH * 4 + XCHECK_MAX_SHIFT];
+    uint8_t  prior [XCHECK_MAX_WIDTH * 4 + XCHECK_MAX_SHIFT];
+    uint8_t  expected [PNG_FILTER_NUM - 1][XCHECK_MAX_WIDTH * 4 + 1];
+    uint8_t  result   [PNG_FILTER_NUM - 1][XCHECK_MAX_WIDTH * 4 + 1];
+    uint8_t* expected_filtered [PNG_FILTER_NUM - 1];
+    uint8_t* result_filtered   [PNG_FILTER_NUM - 1];
+    uint32_t expected_costs [PNG_FILTER_NUM];
+    uint32_t result_costs   [PNG_FILTER_NUM];
+    uint32_t size, shift, round, i, j, errors = 0;
+
+    for (i = 0; i < PNG_FILTER_NUM - 1; i ++)
+    {
+        expected_filtered[i] = expected[i];
+        result_filtered[i]   = result[i];
+    }
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random(line,  sizeof(line));
+        fill_random(prior, sizeof(prior));
+
+        // Smooth lines take other branches of Paeth predictor
+        if (round & 1)
+        {
+            for (i = 1; i < sizeof(line); i ++)
+            {
+                line[i]  = (uint8_t) (line[i - 1]  + (line[i] & 0x07));
+                prior[i] = (uint8_t) (prior[i - 1] + (prior[i] & 0x07));
+            }
+        }
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (i = 0; i < sizeof(bpps) / sizeof(bpps[0]); i ++)
+            {
+                for (size = 0; size <= XCHECK_MAX_WIDTH * bpps[i]; size += bpps[i])
+                {
+                    // Guard bytes behind lines catch overruns
+                    memset(expected, 0xA5, sizeof(expected));
+                    memset(result,   0xA5, sizeof(result));
+
+                    reference->filter_png_line(line + shift, prior + shift, size, bpps[i], expected_filtered, expected_costs);
+                    kernels->filter_png_line(line + shift, prior + shift, size, bpps[i], result_filtered, result_costs);
+
+                    for (j = 0; (j < PNG_FILTER_NUM) && (result_costs[j] == expected_costs[j]); j ++);
+
+                    if ((j < PNG_FILTER_NUM) || (memcmp(expected, result, sizeof(expected))))
+                    {
+                        if (verbose)
+                            printf("%s: filter_png_line size %u bpp %u shift %u: mismatch\n",
+                                   convert_cpu_level_to_text(kernels->level), size, bpps[i], shift);
+                        errors ++;
+                    }
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+static uint32_t check_premultiply(const cpu_kernels_t* reference, const cpu_kernels_t* kernels, bool_e verbose)
+{
+    uint32_t src      [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT];
+    uint32_t expected [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT + 1];
+    uint32_t result   [XCHECK_MAX_WIDTH + XCHECK_MAX_SHIFT + 1];
+    uint8_t  mask     [XCHECK_MAX_WIDTH / 8 + 1];
+    uint32_t width, shift, round, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        fill_random((uint8_t*) src, sizeof(src));
+        fill_random(mask, sizeof(mask));
+
+        for (shift = 0; shift < XCHECK_MAX_SHIFT; shift ++)
+        {
+            for (width = 0; width <= XCHECK_MAX_WIDTH; width ++)
+            {
+                // Every other round without mask (alpha of pixels only)
+                const uint8_t* used = (round & 1) ? NULL : mask;
+
+                // Pixels are changed in place, guard pixel behind line catches overruns
+                memset(expected, 0xA5, sizeof(expected));
+                memcpy(expected + shift, src, width * 4);
+                memcpy(result, expected, sizeof(result));
+
+                reference->premultiply_mask(expected + shift, used, width);
+                kernels->premultiply_mask(result + shift, used, width);
+
+                if (memcmp(expected, result, sizeof(expected)))
+                {
+                    if (verbose)
+                        printf("%s: premultiply_mask width %u shift %u%s: mismatch\n",
+                               convert_cpu_level_to_text(kernels->level), width, shift, (used) ? "" : " (no mask)");
+                    errors ++;
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+// Random image of runs and noise, pixels of line beyond width stay zero
+static void_t fill_random_runs(uint8_t* image, uint32_t line_size, uint32_t width, uint32_t height, uint32_t bit_count)
+{
+    uint32_t x, y;
+
+    memset(image, 0, (size_t) line_size * height);
+
+    for (y = 0; y < height; y ++)
+    {
+        uint8_t* line = image + (size_t) line_size * y;
+
+        for (x = 0; x < width; )
+        {
+            uint32_t count = (get_random() & 3) ? 1 : (get_random() % 40 + 1);
+            uint8_t  color = (uint8_t) (get_random() & ((bit_count == 4) ? 0x0F : 0xFF));
+
+            for ( ; (count) && (x < width); count --, x ++)
+            {
+                if (bit_count == 4)
+                    line[x >> 1] |= (x & 1) ? color : (uint8_t) (color << 4);
+                else
+                    line[x] = color;
+            }
+        }
+    }
+}
+
+// Encoded random images must decode to same pixels, whole and line by line
+static uint32_t check_rle_round_trip(uint32_t compression, bool_e verbose)
+{
+    uint32_t bit_count = (compression == BI_RLE4) ? 4 : 8;
+    uint32_t width, round, errors = 0;
+
+    for (round = 0; round < XCHECK_ROUNDS; round ++)
+    {
+        for (width = 1; width <= XCHECK_MAX_WIDTH; width += 1 + (width >> 3))
+        {
+            uint32_t line_size = (width * bit_count + 7) / 8;
+            uint32_t height    = XCHECK_RLE_LINES;
+            uint32_t size      = calc_bitmap_rle_size(width, height);
+            uint8_t* image     = (uint8_t*) malloc((size_t) line_size * height);
+            uint8_t* decoded   = (uint8_t*) malloc((size_t) line_size * height);
+            uint8_t* data      = (uint8_t*) malloc(size);
+
+            if ((! image) || (! decoded) || (! data))
+            {
+                free(image);
+                free(decoded);
+                free(data);
+                return errors + 1;
+            }
+
+            fill_random_runs(image, line_size, width, height, bit_count);
+
+            uint32_t          used   = encode_bitmap_rle(image, (sint32_t) line_size, compression, width, height, data, size);
+            bitmap_rle_line_t state  = { 0, 0, 0 };
+            sint_t            result = 0;
+
+            memset(decoded, 0, (size_t) line_size * height);
+
+            if ((! used) || (decode_bitmap_rle(data, used, compression, width, height, decoded, (sint32_t) line_size) < 0)
+            ||  (memcmp(image, decoded, (size_t) line_size * height)))
+                errors ++;
+
+            memset(decoded, 0, (size_t) line_size * height);
+
+            while ((used) && (result == 0) && (state.y < height))
+                result = decode_bitmap_rle_step(data, used, compression, &state, width, state.y + 1, decoded, (sint32_t) line_size);
+
+            if ((result < 0) || (memcmp(image, decoded, (size_t) line_size * height)))
+                errors ++;
+
+            if ((errors) && (verbose))
+                printf("RLE%u round trip width %u: mismatch\n", bit_count, width);
+
+            free(image);
+            free(decoded);
+            free(data);
+
+            if (errors)
+                return errors;
+        }
+    }
+
+    return errors;
+}
+
+// Region of RLE data loaded by fresh bitmap, index is built under current allocator
+static sint_t load_region(FILE* stream, rt_bitmap_data_t* region)
+{
+    rt_bitmap_t* rt_bitmap = get_rt_bitmap(stream, 0);
+
+    if (! rt_bitmap)
+        return -1;
+
+    sint_t result = -1;
+
+    if (calc_rt_bitmap_region(rt_bitmap, 1, 1, XCHECK_RLE_WIDTH - 2, XCHECK_RLE_HEIGHT - 2, 0, region) == 0)
+    {
+        region->data = malloc(region->size);
+        result       = (region->data) ? load_rt_bitmap_region(stream, rt_bitmap, 1, 1, region) : -1;
+    }
+
+    del_rt_bitmap(rt_bitmap);
+
+    return result;
+}
+
+// Lines of RLE data are indexed by first region loading, index must be freed
+// by allocator of bitmap, not by one current at loading (arena here)
+static uint32_t check_region_allocator(uint32_t compression, bool_e verbose)
+{
+    corpus_bitmap_t  params = { BITMAP_INFO, compression, (compression == BI_RLE4) ? 4 : 8, XCHECK_RLE_WIDTH, XCHECK_RLE_HEIGHT };
+    rt_bitmap_data_t expected, result;
+    uint32_t         errors = 0;
+
+    FILE*        stream = tmpfile();
+    mem_arena_t* arena  = new_mem_arena(0);
+
+    expected.data = NULL;
+    result.data   = NULL;
+
+    if ((! stream) || (! arena) || (! put_corpus_bitmap(stream, 0, &params)) || (load_region(stream, &expected) < 0))
+        errors ++;
+    else
+    {
+        rt_bitmap_t* rt_bitmap = get_rt_bitmap(stream, 0);
+        sint_t       loaded    = -1;
+
+        if ((rt_bitmap) && (calc_rt_bitmap_region(rt_bitmap, 1, 1, XCHECK_RLE_WIDTH - 2, XCHECK_RLE_HEIGHT - 2, 0, &result) == 0)
+        &&  ((result.data = malloc(result.size)) != NULL))
+        {
+            mem_allocator_t* previous = set_mem_allocator(get_mem_arena_allocator(arena));
+
+            loaded = load_rt_bitmap_region(stream, rt_bitmap, 1, 1, &result);
+
+            set_mem_allocator(previous);
+            reset_mem_arena(arena);
+        }
+
+        if ((loaded < 0) || (result.size != expected.size) || (memcmp(result.data, expected.data, result.size)))
+            errors ++;
+
+        if (rt_bitmap)
+            del_rt_bitmap(rt_bitmap);
+    }
+
+    if ((errors) && (verbose))
+        printf("region of %s under arena: mismatch\n", (compression == BI_RLE4) ? "RLE4" : "RLE8");
+
+    free(expected.data);
+    free(result.data);
+
+    if (arena)
+        del_mem_arena(arena);
+    if (stream)
+        fclose(stream);
+
+    return errors;
+}
+
+static sint_t count_resource(void_t* context, const resource_entry_t* entry, const uint8_t* data)
+{
+    (*((uint32_t*) context)) ++;
+    return 0;
+}
+
+// Resource ending beyond 4 GB (shift 16, offset 0x10, size 0xFFFF) must fail
+// whole table instead of being delivered from window of stream
+static uint32_t check_stream_overflow(bool_e verbose)
+{
+    corpus_module_t params = { 1, 0, 0x100 };
+    uint32_t        errors = 0, resources_num = 0;
+    uint32_t        size   = 0, table = 0;
+    uint8_t*        memory = NULL;
+
+    FILE*       stream   = tmpfile();
+    exe_info_t* exe_info = ((stream) && ((size = put_corpus_module(stream, &params)) != 0)) ? get_exe_info(stream, 0) : NULL;
+
+    if (exe_info)
+    {
+        table = (exe_info->ne_header) ? exe_info->segmented_offset + exe_info->ne_header->resource_table_offset : 0;
+        del_exe_info(exe_info);
+    }
+
+    if ((table) && (table + sizeof(uint16_t) + RESOURCE_TYPE_SIZE + RESOURCE_INFO_SIZE <= size))
+        memory = (uint8_t*) malloc(size);
+
+    if ((! memory) || (fseek(stream, 0, SEEK_SET) != 0) || (fread(memory, 1, size, stream) != size))
+        errors ++;
+    else
+    {
+        uint8_t* info = memory + table + sizeof(uint16_t) + RESOURCE_TYPE_SIZE;
+
+        memory[table]     = 16;
+        memory[table + 1] = 0;
+        info[0]           = 0x10;
+        info[1]           = 0x00;
+        info[2]           = 0xFF;
+        info[3]           = 0xFF;
+
+        exe_stream_t* exe_stream = new_exe_stream(count_resource, &resources_num);
+
+        if ((! exe_stream) || (put_exe_stream(exe_stream, memory, size) == 0) || (resources_num))
+            errors ++;
+
+        if (exe_stream)
+            del_exe_stream(exe_stream);
+    }
+
+    if ((errors) && (verbose))
+        printf("stream of resource beyond 4 GB: not refused\n");
+
+    free(memory);
+
+    if (stream)
+        fclose(stream);
+
+    return errors;
+}
+
+uint32_t run_cross_check(bool_e verbose)
+{
+    const cpu_kernels_t* reference = get_cpu_kernels_level(CPU_LEVEL_SCALAR);
+    uint32_t             i, level, errors = 0;
+
+    for (level = CPU_LEVEL_SCALAR + 1; level < CPU_LEVEL_NUM; level ++)
+    {
+        const cpu_kernels_t* kernels = get_cpu_kernels_level((cpu_level_e) level);
+        uint32_t             level_errors = 0;
+
+        if (! kernels)
+        {
+            printf("%-8s not supported\n", convert_cpu_level_to_text((cpu_level_e) level));
+            continue;
+        }
+
+        level_errors += check_sum_words(reference, kernels, verbose);
+        level_errors += check_expand("expand_1_bit", reference->expand_1_bit, kernels->expand_1_bit, kernels->level, verbose);
+        level_errors += check_expand("expand_4_bit", reference->expand_4_bit, kernels->expand_4_bit, kernels->level, verbose);
+        level_errors += check_expand("expand_8_bit", reference->expand_8_bit, kernels->expand_8_bit, kernels->level, verbose);
+
+        for (i = 0; i < CONVERT_KERNEL_NUM; i ++)
+            level_errors += check_convert((convert_kernel_e) i, reference, kernels, verbose);
+
+        level_errors += check_bitfields(16, reference, kernels, verbose);
+        level_errors += check_bitfields(32, reference, kernels, verbose);
+        level_errors += check_resample(reference, kernels, verbose);
+        level_errors += check_adler_32(reference, kernels, verbose);
+        level_errors += check_filter_png(reference, kernels, verbose);
+        level_errors += check_premultiply(reference, kernels, verbose);
+
+        printf("%-8s %s (%u mismatches)\n", convert_cpu_level_to_text((cpu_level_e) level), (level_errors) ? "FAILED" : "passed", level_errors);
+
+        errors += level_errors;
+    }
+
+    uint32_t rle_errors = check_rle_round_trip(BI_RLE8, verbose) + check_rle_round_trip(BI_RLE4, verbose);
+
+    printf("%-8s %s (%u mismatches)\n", "rle", (rle_errors) ? "FAILED" : "passed", rle_errors);
+
+    uint32_t region_errors = check_region_allocator(BI_RLE8, verbose) + check_region_allocator(BI_RLE4, verbose);
+
+    printf("%-8s %s (%u mismatches)\n", "regions", (region_errors) ? "FAILED" : "passed", region_errors);
+
+    uint32_t stream_errors = check_stream_overflow(verbose);
+
+    printf("%-8s %s (%u mismatches)\n", "streams", (stream_errors) ? "FAILED" : "passed", stream_errors);
+
+    return errors + rle_errors + region_errors + stream_errors;
+}
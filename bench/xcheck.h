@@ -0,0 +1,15 @@
+#ifndef __XCHECK_H__
+#define __XCHECK_H__
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Cross-check of vectorized kernels against scalar reference
+//
+// Every CPU level supported by host runs every kernel over random inputs
+// of all small sizes and misalignments. RLE regions are loaded under other
+// allocator than one of their bitmap. Returns number of mismatches.
+
+uint32_t run_cross_check(bool_e verbose);
+
+#endif // __XCHECK_H__
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "stats.h"
+#include "budget.h"
+#include "cancel.h"
+#include "cpufeat.h"
+
+#include "taskpool.h"
+#include "rt_btmap.h"
+#include "pixconv.h"
+#include "bmp_band.h"
+
+// State of run shared by tasks (only lines_done is written)
+typedef struct _bitmap_bands_t {
+    FILE*             stream;
+    rt_bitmap_t*      rt_bitmap;
+    rt_bitmap_data_t  image;        // Dimensions and stride of lines in file
+    rt_bitmap_data_t* target;       // Lines (same as image) or pixels
+    pixel_format_e    format;
+    uint32_t          band_lines;
+    cancel_token_t*   token;        // Of calling thread
+    uint32_t          lines_done;   // Atomic
+} bitmap_bands_t;
+
+static inline uint32_t get_band_height(bitmap_bands_t* bands, uint32_t band)
+{
+    uint32_t y = band * bands->band_lines;
+
+    return ((bands->image.height - y) < bands->band_lines) ? (bands->image.height - y) : bands->band_lines;
+}
+
+static sint_t load_band(void_t* context, uint32_t band)
+{
+    bitmap_bands_t* bands = (bitmap_bands_t*) context;
+
+    if (! poll_cancel_token(bands->token))
+        return -1;
+
+    uint32_t         y     = band * bands->band_lines;
+    rt_bitmap_data_t lines = *bands->target;
+
+    lines.data   = (uint8_t*) lines.data + (size_t) lines.line_size * y;
+    lines.height = get_band_height(bands, band);
+    lines.size   = lines.line_size * lines.height;
+
+    if (load_rt_bitmap_lines(bands->stream, bands->rt_bitmap, y, &lines) < 0)
+        return -1;
+
+    ATOMIC_ADD(&bands->lines_done, lines.height);
+
+    return 0;
+}
+
+static sint_t convert_band(void_t* context, uint32_t band)
+{
+    bitmap_bands_t* bands = (bitmap_bands_t*) context;
+
+    if (! poll_cancel_token(bands->token))
+        return -1;
+
+    uint32_t y         = band * bands->band_lines;
+    uint32_t height    = get_band_height(bands, band);
+    uint32_t line_size = bands->image.line_size;
+    uint32_t part_max  = (line_size < BITMAP_BAND_PART_SIZE) ? (BITMAP_BAND_PART_SIZE / line_size) : 1;
+
+    part_max = (part_max < height) ? part_max : height;
+
+    rt_bitmap_data_t lines = bands->image;
+
+    lines.size = line_size * part_max;
+    lines.data = mem_alloc(lines.size);
+
+    pixel_conv_t* pixel_conv = new_pixel_conv(bands->rt_bitmap, lines.bit_count, lines.width, bands->format);
+
+    if ((! lines.data) || (! pixel_conv))
+    {
+        if (lines.data)
+            mem_free(lines.data);
+        if (pixel_conv)
+            del_pixel_conv(pixel_conv);
+        return -1;
+    }
+
+    uint8_t* dst = (uint8_t*) bands->target->data + (size_t) bands->target->line_size * y;
+
+    uint32_t i, j;
+    for (i = 0; i < height; i += lines.height)
+    {
+        lines.height = ((height - i) < part_max) ? (height - i) : part_max;
+
+        if ((! poll_cancel_token(bands->token))
+        ||  (load_rt_bitmap_lines(bands->stream, bands->rt_bitmap, y + i, &lines) < 0))
+            break;
+
+        for (j = 0; j < lines.height; j ++)
+        {
+            convert_pixel_line(pixel_conv, (const uint8_t*) lines.data + (size_t) line_size * j, dst);
+
+            dst += bands->target->line_size;
+        }
+    }
+
+    del_pixel_conv(pixel_conv);
+    mem_free(lines.data);
+
+    if (i < height)
+        return -1;
+
+    ATOMIC_ADD(&bands->lines_done, height);
+
+    return 0;
+}
+
+// Image is split and bands are run by pool, calling thread keeps cancel token
+// and budget
+static sint_t run_bands(bitmap_bands_t* bands, task_pool_t* task_pool, uint32_t lines_min, task_func_t func)
+{
+    uint32_t height  = bands->image.height;
+    uint32_t parts   = get_task_pool_threads(task_pool) * BITMAP_BANDS_PER_THREAD;
+    uint32_t lines   = (height + parts - 1) / parts;
+
+    if (! lines_min)
+        lines_min = BITMAP_BAND_LINES_MIN;
+
+    bands->band_lines = (lines > lines_min) ? lines : lines_min;
+    bands->token      = get_cancel_token();
+    bands->lines_done = 0;
+
+    begin_cancel_units(height);
+
+    if (! check_cancel_units(0))
+        return -1;
+
+    // Index is built once and only read by tasks
+    bitmap_rle_index_t* index = bands->rt_bitmap->rle_index;
+
+    if (index_rt_bitmap_rle(bands->stream, bands->rt_bitmap) < 0)
+        return -1;
+
+    // Whole data read by tasks is charged here once, RLE data just read by
+    // index scan was charged by it already
+    if (((! bands->rt_bitmap->rle_index) || (index)) && (! use_budget_read(bands->rt_bitmap->data_size)))
+        return -1;
+
+    // Kernels are selected before tasks use them
+    get_cpu_kernels();
+
+    // Tasks run by calling thread would charge their reads again
+    parse_budget_t* budget = set_parse_budget(NULL);
+    sint_t          result = run_task_pool(task_pool, (height + bands->band_lines - 1) / bands->band_lines, func, bands);
+
+    set_parse_budget(budget);
+
+    if (result < 0)
+    {
+        check_cancel_units(bands->lines_done);
+        return -1;
+    }
+
+    end_cancel_units();
+
+    return 0;
+}
+
+sint_t load_rt_bitmap_bands(FILE* stream, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data,
+                            task_pool_t* task_pool, uint32_t lines_min)
+{
+    STATS_SCOPE(STATS_LOAD_RT_BITMAP_BANDS);
+
+    bitmap_bands_t bands;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap_data) || (! rt_bitmap_data->data)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &bands.image) < 0))
+        return -1;
+
+    // Buffer is owned by caller, its stride can be wider than line in file
+    if ((rt_bitmap_data->bit_count != bands.image.bit_count) || (rt_bitmap_data->width != bands.image.width)
+    ||  (rt_bitmap_data->height != bands.image.height)
+    ||  (! rt_bitmap_data->line_size) || (rt_bitmap_data->line_size < rt_bitmap->data_line)
+    ||  (rt_bitmap_data->size / rt_bitmap_data->line_size < rt_bitmap_data->height))
+        return -1;
+
+    if (! bands.image.height)
+        return 0;
+
+    bands.stream    = stream;
+    bands.rt_bitmap = rt_bitmap;
+    bands.target    = rt_bitmap_data;
+    bands.format    = PIXEL_FORMAT_NUM;
+
+    return run_bands(&bands, task_pool, lines_min, load_band);
+}
+
+sint_t convert_rt_bitmap_bands(FILE* stream, rt_bitmap_t* rt_bitmap, pixel_format_e format, rt_bitmap_data_t* rt_bitmap_pixels,
+                               task_pool_t* task_pool, uint32_t lines_min)
+{
+    STATS_SCOPE(STATS_CONVERT_RT_BITMAP_BANDS);
+
+    bitmap_bands_t bands;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap_pixels) || (! rt_bitmap_pixels->data)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &bands.image) < 0))
+        return -1;
+
+    uint32_t bit_count = get_pixel_format_bit_count(format);
+
+    if ((! bit_count) || (rt_bitmap_pixels->bit_count != bit_count) || (rt_bitmap_pixels->width != bands.image.width)
+    ||  (rt_bitmap_pixels->height != bands.image.height) || (! rt_bitmap_pixels->line_size)
+    ||  (rt_bitmap_pixels->line_size < bands.image.width * (bit_count / 8))
+    ||  (rt_bitmap_pixels->size / rt_bitmap_pixels->line_size < rt_bitmap_pixels->height))
+        return -1;
+
+    if ((bit_count == 32) && (rt_bitmap_pixels->line_size % sizeof(uint32_t)))
+        return -1;
+
+    if (! bands.image.height)
+        return 0;
+
+    bands.stream    = stream;
+    bands.rt_bitmap = rt_bitmap;
+    bands.target    = rt_bitmap_pixels;
+    bands.format    = format;
+
+    return run_bands(&bands, task_pool, lines_min, convert_band);
+}
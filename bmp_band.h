@@ -0,0 +1,40 @@
+#ifndef __BMP_BAND_H__
+#define __BMP_BAND_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "taskpool.h"
+#include "rt_btmap.h"
+#include "pixconv.h"
+
+// Parallel decoding of large bitmap in bands of lines
+//
+// Pixel array (uncompressed or RLE) is split into bands of whole lines, every
+// band is task of pool (see taskpool.h) loaded by load_rt_bitmap_lines() into
+// its own lines of caller-owned buffer, so result is same for any number of
+// threads and any order of tasks. RLE lines are indexed once before split.
+//
+// Band has at least lines_min lines (zero means BITMAP_BAND_LINES_MIN), image
+// is split into up to BITMAP_BANDS_PER_THREAD bands per thread to balance load.
+// convert_rt_bitmap_bands() decodes band in parts of BITMAP_BAND_PART_SIZE
+// bytes and converts every part at once (while it is in cache), each band
+// with converter of its own. Buffers are prepared as for single thread (see
+// calc_rt_bitmap_data and calc_rt_bitmap_pixels).
+//
+// Budget of calling thread is charged with whole pixel array once (by index
+// scan for RLE data indexed by this call), tasks run without budget. Cancel
+// token of calling thread is polled before every band (and part), lines of
+// bands done are counted in token if run stops.
+
+#define BITMAP_BAND_LINES_MIN    0x10
+#define BITMAP_BANDS_PER_THREAD  4
+#define BITMAP_BAND_PART_SIZE    0x40000
+
+sint_t load_rt_bitmap_bands(FILE* stream, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data,
+                            task_pool_t* task_pool, uint32_t lines_min);
+sint_t convert_rt_bitmap_bands(FILE* stream, rt_bitmap_t* rt_bitmap, pixel_format_e format, rt_bitmap_data_t* rt_bitmap_pixels,
+                               task_pool_t* task_pool, uint32_t lines_min);
+
+#endif // __BMP_BAND_H__
@@ -0,0 +1,383 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "fileio.h"
+#include "stats.h"
+#include "cancel.h"
+#include "cpufeat.h"
+#include "checksum.h"
+
+#include "rt_btmap.h"
+#include "colortbl.h"
+#include "pixconv.h"
+#include "deflate.h"
+#include "bmp_png.h"
+
+#define PNG_SIGNATURE_SIZE 8
+#define PNG_HEADER_SIZE    13
+#define PNG_COLORS_MAX     0x100
+#define PNG_LINE_MAX       0x7FFFFFFE // Line and its filter byte are put at once
+
+typedef enum _png_color_e {
+    PNG_GRAY    = 0,
+    PNG_RGB     = 2,
+    PNG_INDEXED = 3,
+    PNG_RGBA    = 6
+} png_color_e;
+
+static const uint8_t png_signature [PNG_SIGNATURE_SIZE] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+// Line stays valid until line after it is returned (it is prior of that one)
+typedef const uint8_t* (*png_line_t)(void_t* context, uint32_t line);
+
+typedef struct _png_image_t {
+    uint32_t          width;
+    uint32_t          height;
+    uint32_t          bit_count;
+    png_color_e       color;
+    const rgb_quad_t* color_table;
+    uint32_t          colors_num;   // Of color table
+    uint32_t          colors_used;  // Entries of palette
+    png_line_t        get_line;
+    void_t*           context;
+} png_image_t;
+
+typedef struct _png_lines_t {
+    rt_bitmap_data_t* rt_bitmap_data;
+    pixel_conv_t*     pixel_conv;   // NULL if lines are written as they are
+    uint8_t*          pixels [2];   // Converted lines, every other one
+} png_lines_t;
+
+static inline void_t put_be_32(uint8_t* place, uint32_t value)
+{
+    place[0] = (uint8_t) (value >> 24);
+    place[1] = (uint8_t) (value >> 16);
+    place[2] = (uint8_t) (value >> 8);
+    place[3] = (uint8_t) value;
+}
+
+static sint_t write_chunk(FILE* stream, const char_t* type, const void_t* data, uint32_t size)
+{
+    uint8_t header [8];
+    uint8_t crc [4];
+
+    put_be_32(header, size);
+    memcpy(header + 4, type, 4);
+
+    // CRC covers type and data
+    put_be_32(crc, calc_crc32(calc_crc32(0, header + 4, 4), data, size));
+
+    if ((file_write(header, 1, sizeof(header), stream) != sizeof(header))
+    ||  ((size) && (file_write(data, 1, size, stream) != (size_t) size))
+    ||  (file_write(crc, 1, sizeof(crc), stream) != sizeof(crc)))
+        return -1;
+
+    return 0;
+}
+
+static sint_t put_image_data(void_t* context, const void_t* data, uint32_t size)
+{
+    return write_chunk((FILE*) context, "IDAT", data, size);
+}
+
+static sint_t write_headers(FILE* stream, uint32_t offset, png_image_t* image)
+{
+    uint8_t header [PNG_HEADER_SIZE];
+
+    put_be_32(header,     image->width);
+    put_be_32(header + 4, image->height);
+
+    header[8]  = (uint8_t) ((image->bit_count < 8) ? image->bit_count : 8);
+    header[9]  = (uint8_t) image->color;
+    header[10] = 0; // Deflate
+    header[11] = 0; // Adaptive filtering
+    header[12] = 0; // Not interlaced
+
+    if ((file_seek(stream, offset, SEEK_SET) != 0)
+    ||  (file_write(png_signature, 1, PNG_SIGNATURE_SIZE, stream) != PNG_SIGNATURE_SIZE)
+    ||  (write_chunk(stream, "IHDR", header, PNG_HEADER_SIZE) < 0))
+        return -1;
+
+    if (image->color != PNG_INDEXED)
+        return 0;
+
+    uint8_t  palette [PNG_COLORS_MAX * 3];
+    uint32_t i;
+
+    // Indexes past color table get black
+    memset(palette, 0, sizeof(palette));
+
+    for (i = 0; (i < image->colors_num) && (i < image->colors_used); i ++)
+    {
+        palette[i * 3]     = image->color_table[i].red;
+        palette[i * 3 + 1] = image->color_table[i].green;
+        palette[i * 3 + 2] = image->color_table[i].blue;
+    }
+
+    return write_chunk(stream, "PLTE", palette, image->colors_used * 3);
+}
+
+static sint_t write_png(FILE* stream, uint32_t offset, png_image_t* image, deflate_level_e level)
+{
+    uint64_t bits = (uint64_t) image->width * image->bit_count;
+
+    if ((! image->width) || (! image->height) || (((bits + 7) >> 3) > PNG_LINE_MAX)
+    ||  ((image->color == PNG_INDEXED) && ((! image->colors_used) || (image->colors_used > PNG_COLORS_MAX))))
+        return -1;
+
+    uint32_t line_size = (uint32_t) ((bits + 7) >> 3);
+    uint32_t bpp       = (image->bit_count < 8) ? 1 : (image->bit_count >> 3);
+
+    // Indexes are no samples, differences of them do not compress better
+    bool_e filter = ((image->color != PNG_INDEXED) && (image->bit_count >= 8) && (level != DEFLATE_STORE)) ? TRUE : FALSE;
+
+    const cpu_kernels_t* kernels = get_cpu_kernels();
+
+    if (write_headers(stream, offset, image) < 0)
+        return -1;
+
+    // Zero line is prior of first one, then buffers of sub, up, average and Paeth filters
+    uint8_t*   buffers = (filter) ? (uint8_t*) mem_calloc(PNG_FILTER_NUM, line_size) : NULL;
+    deflate_t* deflate = new_deflate(level, put_image_data, stream);
+    uint32_t   i = 0;
+
+    if ((deflate) && ((! filter) || (buffers)))
+    {
+        uint8_t*       filtered [PNG_FILTER_NUM - 1];
+        uint32_t       costs [PNG_FILTER_NUM];
+        const uint8_t* prior = buffers;
+        uint32_t       j;
+
+        for (j = 0; (filter) && (j < PNG_FILTER_NUM - 1); j ++)
+            filtered[j] = buffers + (size_t) line_size * (j + 1);
+
+        for ( ; i < image->height; i ++)
+        {
+            const uint8_t* line;
+            const uint8_t* data;
+            uint8_t        type = 0;
+
+            if ((! check_cancel_units(i)) || (! (line = image->get_line(image->context, i))))
+                break;
+
+            data = line;
+
+            if (filter)
+            {
+                // Smallest sum of bytes taken as signed, first filter on ties
+                kernels->filter_png_line(line, prior, line_size, bpp, filtered, costs);
+
+                for (j = 1; j < PNG_FILTER_NUM; j ++)
+                {
+                    if (costs[j] < costs[type])
+                        type = (uint8_t) j;
+                }
+
+                if (type)
+                    data = filtered[type - 1];
+
+                prior = line;
+            }
+
+            if ((put_deflate(deflate, &type, 1) < 0) || (put_deflate(deflate, data, line_size) < 0))
+                break;
+        }
+    }
+
+    sint_t result = ((i < image->height) || (end_deflate(deflate) < 0) || (write_chunk(stream, "IEND", NULL, 0) < 0)) ? -1 : 0;
+
+    if (buffers)
+        mem_free(buffers);
+    if (deflate)
+        del_deflate(deflate);
+
+    return result;
+}
+
+static const uint8_t* get_png_line(void_t* context, uint32_t line)
+{
+    png_lines_t*      lines          = (png_lines_t*) context;
+    rt_bitmap_data_t* rt_bitmap_data = lines->rt_bitmap_data;
+    const uint8_t*    data           = (const uint8_t*) rt_bitmap_data->data + (size_t) rt_bitmap_data->line_size * line;
+
+    if (! lines->pixel_conv)
+        return data;
+
+    uint8_t* pixels = lines->pixels[line & 1];
+
+    return (convert_pixel_line(lines->pixel_conv, data, pixels) < 0) ? NULL : pixels;
+}
+
+static sint_t check_png_data(rt_bitmap_data_t* rt_bitmap_data)
+{
+    uint64_t line_size = ((uint64_t) rt_bitmap_data->width * rt_bitmap_data->bit_count + 7) >> 3;
+
+    if ((! rt_bitmap_data->data) || (! rt_bitmap_data->line_size) || (rt_bitmap_data->line_size < line_size)
+    ||  (rt_bitmap_data->size / rt_bitmap_data->line_size < rt_bitmap_data->height))
+        return -1;
+
+    return 0;
+}
+
+// Palette needs entries up to highest index of data only
+static uint32_t calc_colors_used(rt_bitmap_data_t* rt_bitmap_data)
+{
+    uint32_t bit_count = rt_bitmap_data->bit_count;
+    uint32_t mask      = (1 << bit_count) - 1;
+    uint32_t max       = 0;
+    uint32_t x, y;
+
+    for (y = 0; (y < rt_bitmap_data->height) && (max < mask); y ++)
+    {
+        const uint8_t* line = (const uint8_t*) rt_bitmap_data->data + (size_t) rt_bitmap_data->line_size * y;
+
+        if (bit_count == 8)
+        {
+            for (x = 0; x < rt_bitmap_data->width; x ++)
+                max = (line[x] > max) ? line[x] : max;
+            continue;
+        }
+
+        // First pixel in high bits
+        for (x = 0; x < rt_bitmap_data->width; x ++)
+        {
+            uint32_t bit   = x * bit_count;
+            uint32_t index = (line[bit >> 3] >> (8 - bit_count - (bit & 7))) & mask;
+
+            max = (index > max) ? index : max;
+        }
+    }
+
+    return max + 1;
+}
+
+sint_t put_png_data(FILE* stream, uint32_t offset, rt_bitmap_data_t* rt_bitmap_data, const rgb_quad_t* color_table, uint32_t colors_num, deflate_level_e level)
+{
+    STATS_SCOPE(STATS_PUT_PNG_DATA);
+
+    png_image_t image;
+    png_lines_t lines;
+
+    if ((! stream) || (! rt_bitmap_data) || (level >= DEFLATE_LEVEL_NUM) || (check_png_data(rt_bitmap_data) < 0)
+    ||  ((color_table) && (! colors_num)))
+        return -1;
+
+    switch (rt_bitmap_data->bit_count)
+    {
+        case  1:
+        case  2:
+        case  4:
+        case  8: image.color = (color_table) ? PNG_INDEXED : PNG_GRAY; break;
+        case 24: image.color = PNG_RGB;                                 break;
+        case 32: image.color = PNG_RGBA;                                break;
+        default:
+            return -1;
+    }
+
+    image.width       = rt_bitmap_data->width;
+    image.height      = rt_bitmap_data->height;
+    image.bit_count   = rt_bitmap_data->bit_count;
+    image.color_table = (image.color == PNG_INDEXED) ? color_table : NULL;
+    image.colors_num  = (image.color == PNG_INDEXED) ? colors_num : 0;
+    image.colors_used = (image.color == PNG_INDEXED) ? calc_colors_used(rt_bitmap_data) : 0;
+    image.get_line    = get_png_line;
+    image.context     = &lines;
+
+    lines.rt_bitmap_data = rt_bitmap_data;
+    lines.pixel_conv     = NULL;
+
+    begin_cancel_units(image.height);
+
+    if (write_png(stream, offset, &image, level) < 0)
+        return -1;
+
+    end_cancel_units();
+
+    return 0;
+}
+
+sint_t put_rt_bitmap_png(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, deflate_level_e level)
+{
+    STATS_SCOPE(STATS_PUT_RT_BITMAP_PNG);
+
+    rt_bitmap_data_t layout;
+    png_image_t      image;
+    png_lines_t      lines;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap_data) || (level >= DEFLATE_LEVEL_NUM)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &layout) < 0) || (check_png_data(rt_bitmap_data) < 0)
+    ||  (rt_bitmap_data->bit_count != layout.bit_count) || (rt_bitmap_data->width != layout.width)
+    ||  (rt_bitmap_data->height != layout.height))
+        return -1;
+
+    uint32_t bit_count = rt_bitmap_data->bit_count;
+
+    image.width    = rt_bitmap_data->width;
+    image.height   = rt_bitmap_data->height;
+    image.get_line = get_png_line;
+    image.context  = &lines;
+
+    lines.rt_bitmap_data = rt_bitmap_data;
+    lines.pixel_conv     = NULL;
+    lines.pixels[0]      = NULL;
+
+    if (bit_count <= 8)
+    {
+        // Bitmap without color table uses default one of bit count
+        color_palette_t* color_palette = (rt_bitmap->color_palette) ? rt_bitmap->color_palette : get_color_palette_default(bit_count);
+
+        if (! color_palette)
+            return -1;
+
+        image.bit_count   = bit_count;
+        image.color       = PNG_INDEXED;
+        image.color_table = color_palette->colors;
+        image.colors_num  = color_palette->colors_num;
+        image.colors_used = calc_colors_used(rt_bitmap_data);
+    }
+    else
+    {
+        bitmap_masks_t bitmap_masks;
+        bool_e         alpha = ((calc_rt_bitmap_masks(rt_bitmap, &bitmap_masks) == 0) && (bitmap_masks.alpha)) ? TRUE : FALSE;
+        pixel_format_e format = (alpha) ? PIXEL_RGBA32 : PIXEL_RGB24;
+
+        image.bit_count   = get_pixel_format_bit_count(format);
+        image.color       = (alpha) ? PNG_RGBA : PNG_RGB;
+        image.color_table = NULL;
+        image.colors_num  = 0;
+        image.colors_used = 0;
+
+        size_t pixels_size = ((size_t) image.width * image.bit_count) >> 3;
+
+        lines.pixel_conv = new_pixel_conv(rt_bitmap, bit_count, image.width, format);
+        lines.pixels[0]  = (uint8_t*) mem_alloc(pixels_size * 2);
+        lines.pixels[1]  = lines.pixels[0] + pixels_size;
+
+        if ((! lines.pixel_conv) || (! lines.pixels[0]))
+        {
+            if (lines.pixel_conv)
+                del_pixel_conv(lines.pixel_conv);
+            if (lines.pixels[0])
+                mem_free(lines.pixels[0]);
+            return -1;
+        }
+    }
+
+    begin_cancel_units(image.height);
+
+    sint_t result = write_png(stream, offset, &image, level);
+
+    if (lines.pixel_conv)
+        del_pixel_conv(lines.pixel_conv);
+    if (lines.pixels[0])
+        mem_free(lines.pixels[0]);
+
+    if (result == 0)
+        end_cancel_units();
+
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef __BMP_PNG_H__
+#define __BMP_PNG_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "colortbl.h"
+#include "rt_btmap.h"
+#include "deflate.h"
+
+// Writing of bitmaps as PNG files
+//
+// File is written at offset in one pass: signature, header, palette, image
+// data in chunks of compressed stream (see deflate.h) as it comes out, end.
+// Lines are filtered one by one against line above, so no copy of image is
+// made. Lines of grayscale and color pixels get filter of smallest sum of
+// filtered bytes (all filters are computed at once, see cpufeat.h), indexed
+// lines and DEFLATE_STORE level are not filtered.
+//
+// put_png_data() writes lines top to bottom as they are: indexed (1, 2, 4 or
+// 8 bits) with color table, grayscale (8 bits) without it, RGB (24 bits) or
+// RGBA (32 bits) pixels (see pixconv.h). Palette covers highest index used.
+//
+// put_rt_bitmap_png() writes lines of bitmap (see load_rt_bitmap_data): indexed
+// ones with color table of bitmap (default table without it), deeper ones
+// converted line by line to RGB, or RGBA if color masks have alpha channel.
+//
+// Cancel token (see cancel.h) is checked on every line.
+
+sint_t put_png_data(FILE* stream, uint32_t offset, rt_bitmap_data_t* rt_bitmap_data, const rgb_quad_t* color_table, uint32_t colors_num, deflate_level_e level);
+sint_t put_rt_bitmap_png(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, deflate_level_e level);
+
+#endif // __BMP_PNG_H__
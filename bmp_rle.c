@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+
+#include "rt_btmap.h"
+#include "bmp_rle.h"
+
+#define RLE8_MIN_ENCODED  2 // Shorter runs go to absolute run
+#define RLE8_MIN_BREAK    3 // Absolute run ends before run of this length
+#define RLE4_MIN_ENCODED  4
+#define RLE4_MIN_BREAK    6
+#define RLE_MIN_ABSOLUTE  3 // Counts 0..2 are escapes
+
+static inline uint32_t get_min(uint32_t a, uint32_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static inline uint8_t get_nibble(const uint8_t* line, uint32_t x)
+{
+    return (x & 1) ? (line[x >> 1] & 0x0F) : (line[x >> 1] >> 4);
+}
+
+static inline void_t put_nibble(uint8_t* line, uint32_t x, uint8_t value)
+{
+    uint8_t* byte = line + (x >> 1);
+
+    *byte = (x & 1) ? ((*byte & 0xF0) | (value & 0x0F)) : ((*byte & 0x0F) | (uint8_t) (value << 4));
+}
+
+static void_t fill_run_4(uint8_t* line, uint32_t x, uint32_t count, uint8_t colors)
+{
+    if (! count)
+        return;
+
+    // Run starting at odd pixel continues with swapped colors
+    if (x & 1)
+    {
+        put_nibble(line, x, colors >> 4);
+        colors = (uint8_t) ((colors << 4) | (colors >> 4));
+        x     ++;
+        count --;
+    }
+
+    memset(line + (x >> 1), colors, count >> 1);
+
+    if (count & 1)
+        put_nibble(line, x + count - 1, colors >> 4);
+}
+
+// Pixels of run at x clipped to window (first pixel and count inside window)
+static inline uint32_t clip_run(uint32_t x, uint32_t count, uint32_t left, uint32_t right, uint32_t* first)
+{
+    uint32_t from = (x > left) ? x : left;
+    uint32_t to   = (x + count < right) ? (x + count) : right;
+
+    *first = from;
+
+    return (from < to) ? (to - from) : 0;
+}
+
+// Decoder stops at line last (0), end of bitmap or data (1) or on error (-1),
+// state is left at next code
+static sint_t decode_lines(const uint8_t* data, uint32_t size, uint32_t compression, bitmap_rle_line_t* state,
+                           uint32_t left, uint32_t width, uint32_t first, uint32_t last, uint8_t* line, sint32_t stride)
+{
+    bool_e   rle4   = (compression == BI_RLE4) ? TRUE : FALSE;
+    uint32_t right  = left + width;
+    uint32_t pos    = state->pos;
+    uint32_t x      = state->x;
+    uint32_t y      = state->y;
+    sint_t   result = 1;
+
+    while (pos + 2 <= size)
+    {
+        if (y >= last)
+        {
+            result = 0;
+            break;
+        }
+
+        uint8_t  count = data[pos];
+        uint8_t  value = data[pos + 1];
+        uint8_t* dst   = line + (sint64_t) stride * ((sint64_t) y - first);
+
+        pos += 2;
+
+        // Pixels outside of window (lines before it, beyond line) are dropped
+        uint32_t from = x;
+        uint32_t num = (y >= first) ? clip_run(x, (count) ? count : value, left, right, &from) : 0;
+
+        if (count)
+        {
+            if (rle4)
+                fill_run_4(dst, from - left, num, ((from - x) & 1) ? (uint8_t) ((value << 4) | (value >> 4)) : value);
+            else
+                memset(dst + from - left, value, num);
+
+            x += count;
+            continue;
+        }
+
+        switch (value)
+        {
+            case 0x00: // End of line
+                x = 0;
+                y ++;
+                break;
+
+            case 0x01: // End of bitmap
+                state->pos = size;
+                state->x   = x;
+                state->y   = y;
+                return 1;
+
+            case 0x02: // Delta
+                if (pos + 2 > size)
+                    return -1;
+
+                x   += data[pos];
+                y   += data[pos + 1];
+                pos += 2;
+                break;
+
+            default: // Absolute run
+            {
+                uint32_t bytes = (rle4) ? ((value + 1) / 2) : value;
+
+                if (pos + bytes > size)
+                    return -1;
+
+                if (rle4)
+                {
+                    uint32_t i;
+
+                    for (i = 0; i < num; i ++)
+                        put_nibble(dst, from - left + i, get_nibble(data + pos, from - x + i));
+                }
+                else
+                    memcpy(dst + from - left, data + pos + from - x, num);
+
+                x   += value;
+                pos += (bytes + 1) & ~1;
+                break;
+            }
+        }
+    }
+
+    state->pos = pos;
+    state->x   = x;
+    state->y   = y;
+
+    return result;
+}
+
+sint_t decode_bitmap_rle_lines(const uint8_t* data, uint32_t size, uint32_t compression, const bitmap_rle_line_t* start,
+                               uint32_t left, uint32_t width, uint32_t first, uint32_t height, uint8_t* line, sint32_t stride)
+{
+    if ((! data) || (! start) || (! line) || ((compression != BI_RLE8) && (compression != BI_RLE4)))
+        return -1;
+
+    // Data begins at position of start
+    bitmap_rle_line_t state = { 0, start->x, start->y };
+
+    return (decode_lines(data, size, compression, &state, left, width, first, first + height, line, stride) < 0) ? -1 : 0;
+}
+
+sint_t decode_bitmap_rle_step(const uint8_t* data, uint32_t size, uint32_t compression, bitmap_rle_line_t* state,
+                              uint32_t width, uint32_t last, uint8_t* line, sint32_t stride)
+{
+    if ((! data) || (! state) || (! line) || ((compression != BI_RLE8) && (compression != BI_RLE4)))
+        return -1;
+
+    return decode_lines(data, size, compression, state, 0, width, 0, last, line, stride);
+}
+
+sint_t decode_bitmap_rle(const uint8_t* data, uint32_t size, uint32_t compression,
+                         uint32_t width, uint32_t height, uint8_t* line, sint32_t stride)
+{
+    bitmap_rle_line_t start = { 0, 0, 0 };
+
+    return decode_bitmap_rle_lines(data, size, compression, &start, 0, width, 0, height, line, stride);
+}
+
+bitmap_rle_index_t* new_bitmap_rle_index(uint32_t compression, uint32_t height)
+{
+    if (((compression != BI_RLE8) && (compression != BI_RLE4)) || (height == 0xFFFFFFFF))
+        return NULL;
+
+    bitmap_rle_index_t* index = (bitmap_rle_index_t*) mem_alloc(sizeof(bitmap_rle_index_t) + sizeof(bitmap_rle_line_t) * ((size_t) height + 1));
+
+    if (! index)
+        return NULL;
+
+    memset(index, 0, sizeof(bitmap_rle_index_t));
+
+    index->compression = compression;
+    index->height      = height;
+    index->lines       = (bitmap_rle_line_t*) (index + 1);
+    index->lines_num   = 1;
+
+    memset(index->lines, 0, sizeof(bitmap_rle_line_t));
+
+    return index;
+}
+
+// Lines up to current one (skipped by delta too) start at current position
+static void_t index_lines(bitmap_rle_index_t* index)
+{
+    uint32_t y = (index->state.y < index->height) ? index->state.y : index->height;
+
+    while (index->lines_num <= y)
+        index->lines[index->lines_num ++] = index->state;
+}
+
+uint32_t scan_bitmap_rle_index(bitmap_rle_index_t* index, const uint8_t* data, uint32_t size, bool_e last)
+{
+    if ((! index) || (! data) || (index->done))
+        return 0;
+
+    bitmap_rle_line_t* state = &index->state;
+    uint32_t           begin = state->pos;
+    uint32_t           pos   = 0;
+
+    while ((pos + 2 <= size) && (state->y < index->height))
+    {
+        uint8_t count = data[pos];
+        uint8_t value = data[pos + 1];
+
+        if (count)
+        {
+            state->x += count;
+            pos      += 2;
+            continue;
+        }
+
+        if (value == 0x00) // End of line
+        {
+            state->x = 0;
+            state->y ++;
+            pos += 2;
+        }
+        else if (value == 0x01) // End of bitmap
+        {
+            pos += 2;
+            state->y = index->height;
+        }
+        else if (value == 0x02) // Delta
+        {
+            if (pos + 4 > size)
+                break;
+
+            state->x += data[pos + 2];
+            state->y += data[pos + 3];
+            pos      += 4;
+        }
+        else // Absolute run (its pixels can follow in next data)
+        {
+            state->x += value;
+            pos      += 2 + ((((index->compression == BI_RLE4) ? ((value + 1) / 2) : value) + 1) & ~1);
+        }
+
+        state->pos = begin + pos;
+        index_lines(index);
+    }
+
+    state->pos = begin + pos;
+
+    // Rest of lines has no data
+    if ((last) || (state->y >= index->height))
+    {
+        state->y = index->height;
+        state->x = 0;
+
+        index_lines(index);
+        index->done = TRUE;
+    }
+
+    return pos;
+}
+
+void_t del_bitmap_rle_index(bitmap_rle_index_t* index)
+{
+    mem_free(index);
+}
+
+uint32_t calc_bitmap_rle_size(uint32_t width, uint32_t height)
+{
+    // Two bytes per pixel at most (single pixels), end of every line and end of bitmap
+    uint64_t size = ((uint64_t) width * 2 + 2) * height + 2;
+
+    return (size > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t) size;
+}
+
+static inline uint8_t get_pixel(const uint8_t* line, uint32_t x, bool_e rle4)
+{
+    return (rle4) ? get_nibble(line, x) : line[x];
+}
+
+// Length of encoded run at x (RLE4 runs alternate first two pixels)
+static uint32_t get_run(const uint8_t* line, uint32_t x, uint32_t end, bool_e rle4)
+{
+    uint32_t run = 1;
+
+    end = get_min(end, x + BITMAP_RLE_MAX_RUN);
+
+    if (rle4)
+    {
+        while ((x + run < end) && ((run < 2) || (get_nibble(line, x + run) == get_nibble(line, x + (run & 1)))))
+            run ++;
+    }
+    else
+    {
+        while ((x + run < end) && (line[x + run] == line[x]))
+            run ++;
+    }
+
+    return run;
+}
+
+uint32_t encode_bitmap_rle(const uint8_t* line, sint32_t stride, uint32_t compression,
+                           uint32_t width, uint32_t height, uint8_t* data, uint32_t size)
+{
+    if ((! line) || (! data) || ((compression != BI_RLE8) && (compression != BI_RLE4)))
+        return 0;
+
+    bool_e   rle4        = (compression == BI_RLE4) ? TRUE : FALSE;
+    uint32_t min_encoded = (rle4) ? RLE4_MIN_ENCODED : RLE8_MIN_ENCODED;
+    uint32_t min_break   = (rle4) ? RLE4_MIN_BREAK   : RLE8_MIN_BREAK;
+    uint32_t pos         = 0;
+    uint32_t x, y, i;
+
+    for (y = 0; y < height; y ++)
+    {
+        const uint8_t* src = line + (sint64_t) stride * y;
+
+        for (x = 0; x < width; )
+        {
+            uint32_t run = get_run(src, x, width, rle4);
+
+            if ((run >= min_encoded) || (x + run >= width))
+            {
+                if (pos + 2 > size)
+                    return 0;
+
+                data[pos ++] = (uint8_t) run;
+                data[pos ++] = (rle4) ? (uint8_t) ((get_nibble(src, x) << 4) | ((run > 1) ? get_nibble(src, x + 1) : 0)) : src[x];
+                x += run;
+                continue;
+            }
+
+            // Absolute run lasts until next long run
+            uint32_t num = 1;
+
+            while ((num < BITMAP_RLE_MAX_RUN) && (x + num < width) && (get_run(src, x + num, get_min(width, x + num + min_break), rle4) < min_break))
+                num ++;
+
+            uint32_t bytes = (rle4) ? ((num + 1) / 2) : num;
+
+            if (pos + ((num < RLE_MIN_ABSOLUTE) ? (num * 2) : (2 + bytes + (bytes & 1))) > size)
+                return 0;
+
+            if (num < RLE_MIN_ABSOLUTE)
+            {
+                // Too short for absolute run, every pixel is run of its own
+                for (i = 0; i < num; i ++)
+                {
+                    data[pos ++] = 1;
+                    data[pos ++] = (rle4) ? (uint8_t) (get_nibble(src, x + i) << 4) : src[x + i];
+                }
+            }
+            else
+            {
+                data[pos ++] = 0x00;
+                data[pos ++] = (uint8_t) num;
+
+                if (rle4)
+                {
+                    memset(data + pos, 0, bytes);
+
+                    for (i = 0; i < num; i ++)
+                        put_nibble(data + pos, i, get_nibble(src, x + i));
+                }
+                else
+                    memcpy(data + pos, src + x, num);
+
+                pos += bytes;
+
+                if (bytes & 1)
+                    data[pos ++] = 0x00;
+            }
+
+            x += num;
+        }
+
+        if (pos + 2 > size)
+            return 0;
+
+        // Last line ends bitmap
+        data[pos ++] = 0x00;
+        data[pos ++] = (y + 1 < height) ? 0x00 : 0x01;
+    }
+
+    if (! height)
+    {
+        if (pos + 2 > size)
+            return 0;
+
+        data[pos ++] = 0x00;
+        data[pos ++] = 0x01;
+    }
+
+    return pos;
+}
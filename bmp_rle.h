@@ -0,0 +1,67 @@
+#ifndef __BMP_RLE_H__
+#define __BMP_RLE_H__
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Run-length encoding of bitmap data (BI_RLE8 and BI_RLE4)
+//
+// Encoded run : count, color (RLE4: two colors alternate, high nibble first)
+// Escape      : 0x00, 0x00             : End of line
+//               0x00, 0x01             : End of bitmap
+//               0x00, 0x02, dx, dy     : Delta (move right and up)
+//               0x00, count (3..255)   : Absolute run, padded to 16 bits
+//
+// Lines are passed as first line of file (bottom one) and stride to next line
+// in file, so negative stride puts them top to bottom. Pixels skipped by
+// delta or missing at end of data are left untouched.
+
+#define BITMAP_RLE_MAX_RUN 0xFF
+
+sint_t   decode_bitmap_rle(const uint8_t* data, uint32_t size, uint32_t compression,
+                           uint32_t width, uint32_t height, uint8_t* line, sint32_t stride);
+
+// Index of lines for decoding of some lines only
+//
+// Lines of RLE data have no fixed position, so data is scanned once (in parts
+// of any size, scan stops before incomplete escape and returns bytes scanned)
+// and state of decoder is kept for every line. Lines skipped by delta start
+// where delta ends (at its line and column). Entry after last line is end of
+// data. decode_bitmap_rle_lines() starts at entry of first line (data begins
+// at its position) and puts only pixels of window (columns left..left+width-1
+// of lines first..first+height-1), line is first line of window.
+
+typedef struct _bitmap_rle_line_t {
+    uint32_t pos;   // Offset of next code in data
+    uint32_t x;     // Position of decoder there
+    uint32_t y;
+} bitmap_rle_line_t;
+
+typedef struct _bitmap_rle_index_t {
+    uint32_t           compression;
+    uint32_t           height;
+    uint32_t           lines_num;   // Entries filled so far
+    bitmap_rle_line_t  state;       // End of scanned data
+    bool_e             done;
+    bitmap_rle_line_t* lines;       // Height + 1 entries
+} bitmap_rle_index_t;
+
+bitmap_rle_index_t* new_bitmap_rle_index(uint32_t compression, uint32_t height);
+uint32_t            scan_bitmap_rle_index(bitmap_rle_index_t* index, const uint8_t* data, uint32_t size, bool_e last); // Data begins at state position
+void_t              del_bitmap_rle_index(bitmap_rle_index_t* index);
+
+sint_t   decode_bitmap_rle_lines(const uint8_t* data, uint32_t size, uint32_t compression, const bitmap_rle_line_t* start,
+                                 uint32_t left, uint32_t width, uint32_t first, uint32_t height, uint8_t* line, sint32_t stride);
+
+// Decoding of whole image in steps: state (zeroed at start, its position is
+// counted from data) is advanced until decoder reaches line last, so caller
+// can check cancel token between steps. Result is 1 at end of bitmap or data.
+sint_t   decode_bitmap_rle_step(const uint8_t* data, uint32_t size, uint32_t compression, bitmap_rle_line_t* state,
+                                uint32_t width, uint32_t last, uint8_t* line, sint32_t stride);
+
+// Single pass encoder, returns number of bytes put into data (zero on error)
+uint32_t calc_bitmap_rle_size(uint32_t width, uint32_t height); // Upper bound of encoded size
+uint32_t encode_bitmap_rle(const uint8_t* line, sint32_t stride, uint32_t compression,
+                           uint32_t width, uint32_t height, uint8_t* data, uint32_t size);
+
+#endif // __BMP_RLE_H__
@@ -0,0 +1,389 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "fileio.h"
+#include "stats.h"
+#include "cancel.h"
+
+#include "rt_btmap.h"
+#include "bmp_rle.h"
+#include "pixconv.h"
+#include "bmp_strm.h"
+
+#define BITMAP_STREAM_UNKNOWN   0xFFFFFFFF // Position of stream after other writes
+#define BITMAP_STREAM_BAND_SIZE 0x40000    // Bytes of lines collected for single write
+
+static inline bool_e is_rle(uint32_t compression)
+{
+    return ((compression == BI_RLE8) || (compression == BI_RLE4)) ? TRUE : FALSE;
+}
+
+static sint_t write_stream(bitmap_stream_t* bitmap_stream, uint32_t position, const void_t* data, uint32_t size)
+{
+    // Writes following each other go without seek (which flushes stream)
+    if ((position != bitmap_stream->position) && (file_seek(bitmap_stream->stream, position, SEEK_SET) != 0))
+        return -1;
+
+    if (file_write(data, 1, size, bitmap_stream->stream) != (size_t) size)
+    {
+        bitmap_stream->position = BITMAP_STREAM_UNKNOWN;
+        return -1;
+    }
+
+    bitmap_stream->position = position + size;
+
+    return 0;
+}
+
+static sint_t flush_band(bitmap_stream_t* bitmap_stream)
+{
+    uint32_t used = bitmap_stream->band_used;
+
+    bitmap_stream->band_used = 0;
+
+    return (used) ? write_stream(bitmap_stream, bitmap_stream->band_position, bitmap_stream->band, used) : 0;
+}
+
+// Lines following each other in file are collected in band, so they are
+// written in large blocks. Band is flushed unless bytes at position continue
+// it, place is NULL if they do not fit into band.
+static sint_t place_in_band(bitmap_stream_t* bitmap_stream, uint32_t position, uint32_t size, uint8_t** place)
+{
+    *place = NULL;
+
+    if ((! bitmap_stream->band_used) || (position != bitmap_stream->band_position + bitmap_stream->band_used)
+    ||  (size > BITMAP_STREAM_BAND_SIZE - bitmap_stream->band_used))
+    {
+        if (flush_band(bitmap_stream) < 0)
+            return -1;
+
+        if (size > BITMAP_STREAM_BAND_SIZE)
+            return 0;
+
+        bitmap_stream->band_position = position;
+    }
+
+    *place = bitmap_stream->band + bitmap_stream->band_used;
+    bitmap_stream->band_used += size;
+
+    return 0;
+}
+
+static sint_t write_at(bitmap_stream_t* bitmap_stream, uint32_t position, const void_t* data, uint32_t size)
+{
+    uint8_t* place;
+
+    if (place_in_band(bitmap_stream, position, size, &place) < 0)
+        return -1;
+
+    if (! place)
+        return write_stream(bitmap_stream, position, data, size);
+
+    memcpy(place, data, size);
+
+    return 0;
+}
+
+static sint_t write_rle(bitmap_stream_t* bitmap_stream, const uint8_t* data, uint32_t size)
+{
+    uint32_t position = bitmap_stream->offset + bitmap_stream->rt_bitmap->file_header->data_offset + bitmap_stream->rle_written;
+
+    if (write_at(bitmap_stream, position, data, size) < 0)
+        return -1;
+
+    bitmap_stream->rle_written += size;
+    bitmap_stream->rle_next    ++;
+
+    return 0;
+}
+
+static sint_t put_rle_line(bitmap_stream_t* bitmap_stream, uint32_t file_line, const uint8_t* line)
+{
+    uint32_t size = encode_bitmap_rle(line, 0, bitmap_stream->compression, bitmap_stream->width, 1,
+                                      bitmap_stream->rle_line, bitmap_stream->rle_size);
+
+    if (! size)
+        return -1;
+
+    // Single line ends bitmap, so every line but last gets end of line instead
+    if (file_line + 1 < bitmap_stream->height)
+        bitmap_stream->rle_line[size - 1] = 0x00;
+
+    if (file_line != bitmap_stream->rle_next)
+    {
+        // Waiting lines are kept by bitmap_stream, so they are made by its allocator
+        mem_allocator_t* previous = set_mem_allocator(get_mem_block_allocator(bitmap_stream));
+        uint8_t*         copy     = (uint8_t*) mem_alloc(size);
+
+        set_mem_allocator(previous);
+
+        if (! copy)
+            return -1;
+
+        memcpy(copy, bitmap_stream->rle_line, size);
+
+        bitmap_stream->rle_waiting[file_line] = copy;
+        bitmap_stream->rle_sizes[file_line]   = size;
+
+        return 0;
+    }
+
+    if (write_rle(bitmap_stream, bitmap_stream->rle_line, size) < 0)
+        return -1;
+
+    // Lines waiting for this one follow it
+    while ((bitmap_stream->rle_next < bitmap_stream->height) && (bitmap_stream->rle_waiting[bitmap_stream->rle_next]))
+    {
+        uint32_t next = bitmap_stream->rle_next;
+
+        if (write_rle(bitmap_stream, bitmap_stream->rle_waiting[next], bitmap_stream->rle_sizes[next]) < 0)
+            return -1;
+
+        mem_free(bitmap_stream->rle_waiting[next]);
+        bitmap_stream->rle_waiting[next] = NULL;
+    }
+
+    return 0;
+}
+
+bitmap_stream_t* new_bitmap_stream(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, bool_e pixels)
+{
+    rt_bitmap_data_t rt_bitmap_data;
+
+    if ((! stream) || (! rt_bitmap) || (calc_rt_bitmap_data(rt_bitmap, 0, &rt_bitmap_data) < 0)
+    ||  (! rt_bitmap_data.width) || (! rt_bitmap_data.height))
+        return NULL;
+
+    bitmap_info_header_t* info_header = (BITMAP_CORE != rt_bitmap->info_type) ? (bitmap_info_header_t*) rt_bitmap->info_header : NULL;
+    uint32_t              compression = (info_header) ? info_header->compression : BI_RGB;
+
+    if ((compression != BI_RGB) && (compression != BI_BITFIELDS)
+    &&  ((compression != BI_RLE8) || (rt_bitmap_data.bit_count != 8))
+    &&  ((compression != BI_RLE4) || (rt_bitmap_data.bit_count != 4)))
+        return NULL;
+
+    // RLE lines are stored from bottom to top only
+    if ((is_rle(compression)) && ((sint32_t) info_header->data_height < 0))
+        return NULL;
+
+    bitmap_stream_t* bitmap_stream = (bitmap_stream_t*) mem_calloc(1, sizeof(bitmap_stream_t));
+
+    if (! bitmap_stream)
+        return NULL;
+
+    bitmap_stream->state       = BITMAP_STREAM_LINES;
+    bitmap_stream->stream      = stream;
+    bitmap_stream->offset      = offset;
+    bitmap_stream->rt_bitmap   = rt_bitmap;
+    bitmap_stream->compression = compression;
+    bitmap_stream->bit_count   = rt_bitmap_data.bit_count;
+    bitmap_stream->width       = rt_bitmap_data.width;
+    bitmap_stream->height      = rt_bitmap_data.height;
+    bitmap_stream->top_down    = ((info_header) && ((sint32_t) info_header->data_height < 0)) ? TRUE : FALSE;
+    bitmap_stream->line_size   = (pixels) ? (rt_bitmap_data.width * sizeof(uint32_t)) : ((rt_bitmap_data.width * rt_bitmap_data.bit_count + 7) / 8);
+    bitmap_stream->data_line   = rt_bitmap->data_line;
+    bitmap_stream->position    = BITMAP_STREAM_UNKNOWN;
+
+    // Padding of line stays zero
+    bitmap_stream->line      = (uint8_t*) mem_calloc(1, rt_bitmap->data_line);
+    bitmap_stream->lines_put = (uint8_t*) mem_calloc(rt_bitmap_data.height, sizeof(uint8_t));
+    bitmap_stream->band      = (uint8_t*) mem_alloc(BITMAP_STREAM_BAND_SIZE);
+
+    if ((! bitmap_stream->line) || (! bitmap_stream->lines_put) || (! bitmap_stream->band))
+    {
+        del_bitmap_stream(bitmap_stream);
+        return NULL;
+    }
+
+    if (pixels)
+    {
+        bitmap_stream->pixel_pack = new_pixel_pack(rt_bitmap, rt_bitmap_data.bit_count, rt_bitmap_data.width);
+
+        if (! bitmap_stream->pixel_pack)
+        {
+            del_bitmap_stream(bitmap_stream);
+            return NULL;
+        }
+    }
+
+    if (is_rle(compression))
+    {
+        bitmap_stream->rle_size    = calc_bitmap_rle_size(rt_bitmap_data.width, 1);
+        bitmap_stream->rle_line    = (uint8_t*)  mem_alloc(bitmap_stream->rle_size);
+        bitmap_stream->rle_waiting = (uint8_t**) mem_calloc(rt_bitmap_data.height, sizeof(uint8_t*));
+        bitmap_stream->rle_sizes   = (uint32_t*) mem_calloc(rt_bitmap_data.height, sizeof(uint32_t));
+
+        if ((! bitmap_stream->rle_line) || (! bitmap_stream->rle_waiting) || (! bitmap_stream->rle_sizes))
+        {
+            del_bitmap_stream(bitmap_stream);
+            return NULL;
+        }
+
+        return bitmap_stream;
+    }
+
+    // Size of uncompressed file is known, so headers go first and file gets its space
+    uint32_t size = calc_rt_bitmap_full_size(rt_bitmap);
+
+    if (put_rt_bitmap(stream, offset, rt_bitmap) < 0)
+    {
+        del_bitmap_stream(bitmap_stream);
+        return NULL;
+    }
+
+    if (size)
+        file_reserve(stream, offset, size);
+
+    return bitmap_stream;
+}
+
+sint_t put_bitmap_stream(bitmap_stream_t* bitmap_stream, uint32_t line, const void_t* data)
+{
+    STATS_SCOPE(STATS_PUT_BITMAP_STREAM);
+
+    if ((! bitmap_stream) || (! data) || (bitmap_stream->state != BITMAP_STREAM_LINES)
+    ||  (line >= bitmap_stream->height) || (bitmap_stream->lines_put[line]))
+        return -1;
+
+    // Lines are stored from bottom to top
+    uint32_t file_line = (bitmap_stream->top_down) ? line : (bitmap_stream->height - line - 1);
+    uint32_t position  = bitmap_stream->offset + bitmap_stream->rt_bitmap->file_header->data_offset + file_line * bitmap_stream->data_line;
+    uint32_t used      = (bitmap_stream->width * bitmap_stream->bit_count + 7) / 8;
+    uint8_t* place     = NULL;
+    sint_t   result    = 0;
+
+    // Uncompressed line is packed right into its place in band
+    if (! is_rle(bitmap_stream->compression))
+    {
+        result = place_in_band(bitmap_stream, position, bitmap_stream->data_line, &place);
+
+        if (place)
+            memset(place + used, 0, bitmap_stream->data_line - used);
+    }
+
+    if (! place)
+        place = bitmap_stream->line;
+
+    if (result == 0)
+    {
+        if (bitmap_stream->pixel_pack)
+            pack_pixel_line(bitmap_stream->pixel_pack, (const uint32_t*) data, place);
+        else
+            memcpy(place, data, used);
+
+        if (is_rle(bitmap_stream->compression))
+            result = put_rle_line(bitmap_stream, file_line, place);
+        else if (place == bitmap_stream->line)
+            result = write_stream(bitmap_stream, position, place, bitmap_stream->data_line);
+    }
+
+    if (result < 0)
+    {
+        bitmap_stream->state = BITMAP_STREAM_ERROR;
+        return -1;
+    }
+
+    bitmap_stream->lines_put[line] = 1;
+    bitmap_stream->lines_num      ++;
+
+    return 0;
+}
+
+sint_t run_bitmap_stream(bitmap_stream_t* bitmap_stream, bitmap_stream_callback_t callback, void_t* context)
+{
+    STATS_SCOPE(STATS_RUN_BITMAP_STREAM);
+
+    if ((! bitmap_stream) || (! callback) || (bitmap_stream->state != BITMAP_STREAM_LINES))
+        return -1;
+
+    uint8_t* data = (uint8_t*) mem_alloc(bitmap_stream->line_size);
+
+    if (! data)
+        return -1;
+
+    uint32_t i, height = bitmap_stream->height;
+
+    begin_cancel_units(height);
+
+    for (i = 0; i < height; i ++)
+    {
+        if (! check_cancel_units(i))
+            break;
+
+        // File order, so compressed lines are written at once (lines put before are skipped)
+        uint32_t line = (bitmap_stream->top_down) ? i : (height - i - 1);
+
+        if (bitmap_stream->lines_put[line])
+            continue;
+
+        if ((callback(context, line, data) != 0) || (put_bitmap_stream(bitmap_stream, line, data) < 0))
+            break;
+    }
+
+    mem_free(data);
+
+    if (i < height)
+        return -1;
+
+    end_cancel_units();
+
+    return 0;
+}
+
+sint_t end_bitmap_stream(bitmap_stream_t* bitmap_stream)
+{
+    if ((! bitmap_stream) || (bitmap_stream->state != BITMAP_STREAM_LINES) || (bitmap_stream->lines_num < bitmap_stream->height))
+        return -1;
+
+    if (flush_band(bitmap_stream) < 0)
+    {
+        bitmap_stream->state = BITMAP_STREAM_ERROR;
+        return -1;
+    }
+
+    // Headers and profile follow compressed data
+    if ((is_rle(bitmap_stream->compression))
+    &&  ((set_rt_bitmap_data_size(bitmap_stream->rt_bitmap, bitmap_stream->rle_written) < 0)
+    ||   (put_rt_bitmap(bitmap_stream->stream, bitmap_stream->offset, bitmap_stream->rt_bitmap) < 0)))
+    {
+        bitmap_stream->state = BITMAP_STREAM_ERROR;
+        return -1;
+    }
+
+    bitmap_stream->state = BITMAP_STREAM_DONE;
+
+    return 0;
+}
+
+void_t del_bitmap_stream(bitmap_stream_t* bitmap_stream)
+{
+    uint32_t i;
+
+    if (bitmap_stream->rle_waiting)
+    {
+        for (i = 0; i < bitmap_stream->height; i ++)
+        {
+            if (bitmap_stream->rle_waiting[i])
+                mem_free(bitmap_stream->rle_waiting[i]);
+        }
+
+        mem_free(bitmap_stream->rle_waiting);
+    }
+    if (bitmap_stream->rle_sizes)
+        mem_free(bitmap_stream->rle_sizes);
+    if (bitmap_stream->rle_line)
+        mem_free(bitmap_stream->rle_line);
+    if (bitmap_stream->pixel_pack)
+        del_pixel_pack(bitmap_stream->pixel_pack);
+    if (bitmap_stream->lines_put)
+        mem_free(bitmap_stream->lines_put);
+    if (bitmap_stream->line)
+        mem_free(bitmap_stream->line);
+    if (bitmap_stream->band)
+        mem_free(bitmap_stream->band);
+    mem_free(bitmap_stream);
+}
@@ -0,0 +1,75 @@
+#ifndef __BMP_STRM_H__
+#define __BMP_STRM_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "rt_btmap.h"
+#include "pixconv.h"
+
+// Streaming writer of bitmap files
+//
+// Lines are put one by one in any order (counted from top of image) or pulled
+// from callback in file order by run_bitmap_stream(), so whole image is never
+// held in memory. Every line of uncompressed bitmap is written directly to
+// its place in file (space of file is reserved first), headers and profile
+// are put at start. Lines following each other in file are collected in band
+// of fixed size and written together.
+//
+// Lines are lines of bitmap, or 32-bit BGRA pixels packed on the fly (see
+// new_pixel_pack), so indexed bitmap gets nearest colors of its color table.
+//
+// RLE lines (BI_RLE8 and BI_RLE4) are encoded as they come. Compressed lines
+// have no fixed place: line coming in file order (bottom to top) is written at
+// once, others are kept compressed until lines below them are written.
+// Headers get size of compressed data by end_bitmap_stream(). Top-down RLE
+// bitmap (negative height) is not valid BMP, so no stream is made for it.
+//
+// Each line must be put once, end_bitmap_stream() fails if some is missing.
+// Nonzero result of callback stops run with error, cancelled token (see
+// cancel.h) stops it before next line.
+
+typedef sint_t (*bitmap_stream_callback_t)(void_t* context, uint32_t line, void_t* data);
+
+typedef enum _bitmap_stream_state_e {
+    BITMAP_STREAM_LINES,
+    BITMAP_STREAM_DONE,
+    BITMAP_STREAM_ERROR
+} bitmap_stream_state_e;
+
+typedef struct _bitmap_stream_t {
+    bitmap_stream_state_e state;
+    FILE*                 stream;
+    uint32_t              offset;       // Of file header
+    rt_bitmap_t*          rt_bitmap;    // Owned by caller
+    uint32_t              compression;
+    uint32_t              bit_count;
+    uint32_t              width;
+    uint32_t              height;
+    bool_e                top_down;
+    uint32_t              line_size;    // Of put lines
+    uint32_t              data_line;    // Of uncompressed lines in file
+    uint32_t              position;     // Next byte of file written without seek
+    uint8_t*              band;         // Lines following each other in file
+    uint32_t              band_position;
+    uint32_t              band_used;
+    pixel_pack_t*         pixel_pack;   // Lines are BGRA pixels
+    uint8_t*              line;         // Packed line
+    uint8_t*              lines_put;    // Flag of every line
+    uint32_t              lines_num;
+    uint8_t*              rle_line;     // Encoded line
+    uint32_t              rle_size;
+    uint8_t**             rle_waiting;  // Encoded lines by file line, until lines below are written
+    uint32_t*             rle_sizes;
+    uint32_t              rle_next;     // File line written next
+    uint32_t              rle_written;  // Bytes of compressed data
+} bitmap_stream_t;
+
+bitmap_stream_t* new_bitmap_stream(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, bool_e pixels);
+sint_t           put_bitmap_stream(bitmap_stream_t* bitmap_stream, uint32_t line, const void_t* data);
+sint_t           run_bitmap_stream(bitmap_stream_t* bitmap_stream, bitmap_stream_callback_t callback, void_t* context);
+sint_t           end_bitmap_stream(bitmap_stream_t* bitmap_stream);
+void_t           del_bitmap_stream(bitmap_stream_t* bitmap_stream);
+
+#endif // __BMP_STRM_H__
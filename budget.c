@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "stats.h"
+#include "budget.h"
+
+static const char_t* budget_status_str [BUDGET_STATUS_NUM] = {
+    "ok",
+    "bytes read limit",
+    "reads limit",
+    "allocation limit",
+    "entries limit",
+    "nesting limit",
+    "deadline"
+};
+
+static THREAD_LOCAL parse_budget_t* thread_budget = NULL;
+
+static inline bool_e exceed_budget(parse_budget_t* budget, budget_status_e status)
+{
+    budget->status = status;
+    return FALSE;
+}
+
+static inline bool_e check_deadline(parse_budget_t* budget, uint64_t counter)
+{
+    if ((budget->deadline_ns) && (! (counter % BUDGET_DEADLINE_PERIOD)) && (get_time_ns() > budget->deadline_ns))
+        return exceed_budget(budget, BUDGET_DEADLINE);
+
+    return TRUE;
+}
+
+void_t init_parse_budget(parse_budget_t* budget, uint64_t timeout_ns)
+{
+    memset(budget, 0, sizeof(parse_budget_t));
+
+    if (timeout_ns)
+        budget->deadline_ns = get_time_ns() + timeout_ns;
+}
+
+parse_budget_t* get_parse_budget(void_t)
+{
+    return thread_budget;
+}
+
+parse_budget_t* set_parse_budget(parse_budget_t* budget)
+{
+    parse_budget_t* previous = thread_budget;
+
+    thread_budget = budget;
+
+    return previous;
+}
+
+budget_status_e get_budget_status(void_t)
+{
+    return (thread_budget) ? thread_budget->status : BUDGET_OK;
+}
+
+const char_t* convert_budget_status_to_text(budget_status_e status)
+{
+    return (status < BUDGET_STATUS_NUM) ? budget_status_str[status] : NULL;
+}
+
+bool_e use_budget_read(size_t bytes)
+{
+    parse_budget_t* budget = thread_budget;
+
+    if (! budget)
+        return TRUE;
+
+    if (budget->status != BUDGET_OK)
+        return FALSE;
+
+    budget->reads      ++;
+    budget->bytes_read += bytes;
+
+    if ((budget->max_reads) && (budget->reads > budget->max_reads))
+        return exceed_budget(budget, BUDGET_READS);
+
+    if ((budget->max_bytes_read) && (budget->bytes_read > budget->max_bytes_read))
+        return exceed_budget(budget, BUDGET_BYTES_READ);
+
+    return check_deadline(budget, budget->reads);
+}
+
+bool_e use_budget_alloc(size_t bytes)
+{
+    parse_budget_t* budget = thread_budget;
+
+    if (! budget)
+        return TRUE;
+
+    if (budget->status != BUDGET_OK)
+        return FALSE;
+
+    budget->allocs    ++;
+    budget->allocated += bytes;
+
+    if ((budget->max_allocated) && (budget->allocated > budget->max_allocated))
+        return exceed_budget(budget, BUDGET_ALLOCATED);
+
+    return check_deadline(budget, budget->allocs);
+}
+
+bool_e use_budget_entries(uint32_t entries_num)
+{
+    parse_budget_t* budget = thread_budget;
+
+    if (! budget)
+        return TRUE;
+
+    if (budget->status != BUDGET_OK)
+        return FALSE;
+
+    if ((budget->max_entries) && (entries_num > budget->max_entries))
+        return exceed_budget(budget, BUDGET_ENTRIES);
+
+    return TRUE;
+}
+
+bool_e enter_budget_nesting(void_t)
+{
+    parse_budget_t* budget = thread_budget;
+
+    if (! budget)
+        return TRUE;
+
+    // Level is taken even on failure (every enter is paired with leave)
+    budget->nesting ++;
+
+    if (budget->status != BUDGET_OK)
+        return FALSE;
+
+    if ((budget->max_nesting) && (budget->nesting > budget->max_nesting))
+        return exceed_budget(budget, BUDGET_NESTING);
+
+    return TRUE;
+}
+
+void_t leave_budget_nesting(void_t)
+{
+    parse_budget_t* budget = thread_budget;
+
+    if ((budget) && (budget->nesting))
+        budget->nesting --;
+}
@@ -0,0 +1,61 @@
+#ifndef __BUDGET_H__
+#define __BUDGET_H__
+
+#include <stddef.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Parse budget for hostile or corrupt inputs
+//
+// Budget is set for calling thread (as allocator is) and applies to every
+// parser until it is removed. Zero limit means no limit. First exceeded limit
+// is kept in status and after that every read and allocation fails, so parser
+// returns error as soon as possible. Caller checks status to tell exhausted
+// budget from corrupt data.
+
+typedef enum _budget_status_e {
+    BUDGET_OK,
+    BUDGET_BYTES_READ,
+    BUDGET_READS,
+    BUDGET_ALLOCATED,
+    BUDGET_ENTRIES,
+    BUDGET_NESTING,
+    BUDGET_DEADLINE,
+    BUDGET_STATUS_NUM
+} budget_status_e;
+
+typedef struct _parse_budget_t {
+    // Limits
+    uint64_t        max_bytes_read;
+    uint64_t        max_reads;
+    uint64_t        max_allocated;  // Sum of requested allocation sizes
+    uint32_t        max_entries;    // Entries of single table (resources, names, bundles, fonts, colors)
+    uint32_t        max_nesting;    // Depth of nested structures
+    uint64_t        deadline_ns;    // Absolute time (see get_time_ns)
+    // Usage
+    uint64_t        bytes_read;
+    uint64_t        reads;
+    uint64_t        allocs;
+    uint64_t        allocated;
+    uint32_t        nesting;
+    budget_status_e status;
+} parse_budget_t;
+
+#define BUDGET_DEADLINE_PERIOD 0x10 // Clock is checked on every 16th read or allocation
+
+void_t          init_parse_budget(parse_budget_t* budget, uint64_t timeout_ns); // No limits, zero timeout means no deadline
+parse_budget_t* get_parse_budget(void_t);
+parse_budget_t* set_parse_budget(parse_budget_t* budget); // Returns previous budget, NULL removes budget
+budget_status_e get_budget_status(void_t);
+const char_t*   convert_budget_status_to_text(budget_status_e status);
+
+// Library hooks (FALSE if budget of calling thread is exceeded)
+
+bool_e use_budget_read(size_t bytes);
+bool_e use_budget_alloc(size_t bytes);
+bool_e use_budget_entries(uint32_t entries_num);
+bool_e enter_budget_nesting(void_t);
+void_t leave_budget_nesting(void_t);
+
+#endif // __BUDGET_H__
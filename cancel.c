@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "stats.h"
+#include "cancel.h"
+
+static const char_t* cancel_status_str [CANCEL_STATUS_NUM] = {
+    "none",
+    "requested",
+    "deadline"
+};
+
+static THREAD_LOCAL cancel_token_t* thread_token = NULL;
+
+void_t init_cancel_token(cancel_token_t* token, uint64_t timeout_ns)
+{
+    memset(token, 0, sizeof(cancel_token_t));
+
+    if (timeout_ns)
+        token->deadline_ns = get_time_ns() + timeout_ns;
+}
+
+void_t cancel_token(cancel_token_t* token)
+{
+    ATOMIC_STORE(&token->requested, 1);
+}
+
+cancel_token_t* get_cancel_token(void_t)
+{
+    return thread_token;
+}
+
+cancel_token_t* set_cancel_token(cancel_token_t* token)
+{
+    cancel_token_t* previous = thread_token;
+
+    thread_token = token;
+
+    return previous;
+}
+
+cancel_status_e get_cancel_status(void_t)
+{
+    return (thread_token) ? thread_token->status : CANCEL_NONE;
+}
+
+// Workers of operation poll token of its calling thread, which sets status
+bool_e poll_cancel_token(cancel_token_t* token)
+{
+    if (! token)
+        return TRUE;
+
+    if ((token->status != CANCEL_NONE) || (ATOMIC_LOAD(&token->requested))
+    ||  ((token->deadline_ns) && (get_time_ns() > token->deadline_ns)))
+        return FALSE;
+
+    return TRUE;
+}
+
+const char_t* convert_cancel_status_to_text(cancel_status_e status)
+{
+    return (status < CANCEL_STATUS_NUM) ? cancel_status_str[status] : NULL;
+}
+
+void_t begin_cancel_units(uint32_t units_total)
+{
+    cancel_token_t* token = thread_token;
+
+    if (! token)
+        return;
+
+    token->units_done  = 0;
+    token->units_total = units_total;
+}
+
+bool_e check_cancel_units(uint32_t units_done)
+{
+    cancel_token_t* token = thread_token;
+
+    if (! token)
+        return TRUE;
+
+    token->units_done = units_done;
+
+    // Stopped token stays stopped until it is initialized again
+    if (token->status != CANCEL_NONE)
+        return FALSE;
+
+    if (ATOMIC_LOAD(&token->requested))
+        token->status = CANCEL_REQUESTED;
+    else if ((token->deadline_ns) && (get_time_ns() > token->deadline_ns))
+        token->status = CANCEL_DEADLINE;
+
+    return (token->status == CANCEL_NONE) ? TRUE : FALSE;
+}
+
+void_t end_cancel_units(void_t)
+{
+    cancel_token_t* token = thread_token;
+
+    if (token)
+        token->units_done = token->units_total;
+}
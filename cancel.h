@@ -0,0 +1,44 @@
+#ifndef __CANCEL_H__
+#define __CANCEL_H__
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Cooperative cancellation of long decode operations
+//
+// Token is set for calling thread (as parse budget is) and can be cancelled
+// from any thread. Decoders check it once per unit of work (bitmap row, font
+// glyph, streamed resource) and stop with error when it is cancelled or its
+// deadline has passed. Units completed before stop are kept in caller-owned
+// buffer and counted in token, so caller can use or discard partial result.
+
+typedef enum _cancel_status_e {
+    CANCEL_NONE,
+    CANCEL_REQUESTED,
+    CANCEL_DEADLINE,
+    CANCEL_STATUS_NUM
+} cancel_status_e;
+
+typedef struct _cancel_token_t {
+    uint32_t        requested;      // Set by cancel_token() from any thread
+    uint64_t        deadline_ns;    // Absolute time (see get_time_ns), zero means no deadline
+    cancel_status_e status;         // Reason of stop
+    uint32_t        units_done;     // Progress of last operation (rows, glyphs or resources)
+    uint32_t        units_total;
+} cancel_token_t;
+
+void_t          init_cancel_token(cancel_token_t* token, uint64_t timeout_ns); // Zero timeout means no deadline
+void_t          cancel_token(cancel_token_t* token);                           // Thread safe
+cancel_token_t* get_cancel_token(void_t);
+cancel_token_t* set_cancel_token(cancel_token_t* token);                       // Returns previous token, NULL removes token
+cancel_status_e get_cancel_status(void_t);
+bool_e          poll_cancel_token(cancel_token_t* token);                      // Thread safe, FALSE if cancelled or past deadline (status is not set)
+const char_t*   convert_cancel_status_to_text(cancel_status_e status);
+
+// Library hooks (FALSE if operation of calling thread should stop)
+
+void_t begin_cancel_units(uint32_t units_total);
+bool_e check_cancel_units(uint32_t units_done);
+void_t end_cancel_units(void_t);
+
+#endif // __CANCEL_H__
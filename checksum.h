@@ -1,11 +1,20 @@
-#ifndef __CHECKSUM_H__
-#define __CHECKSUM_H__
-
-#include <stdio.h>
-
-#include "inttypes.h"
-#include "platform.h"
-
-uint16_t validate_mz_checksum(FILE* stream, uint32_t size);
-
-#endif // __CHECKSUM_H__
+#ifndef __CHECKSUM_H__
+#define __CHECKSUM_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+uint16_t validate_mz_checksum(FILE* stream, uint32_t size);
+
+// Running checksums of PNG and zlib streams (start with zero for CRC-32 and
+// one for Adler-32, result of part is passed to next one)
+//
+// CRC-32 is folded eight bytes at once through tables, Adler-32 is summed by
+// kernels best for CPU (see cpufeat.h).
+
+uint32_t calc_crc32(uint32_t crc, const void_t* data, size_t size);
+uint32_t calc_adler32(uint32_t adler, const void_t* data, size_t size);
+
+#endif // __CHECKSUM_H__
@@ -1,217 +1,449 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#include "inttypes.h"
-#include "platform.h"
-
-#include "colortbl.h"
-
-const rgb_triple_t color_table_1_bit [2] = {
-    { 0x00, 0x00, 0x00 }, { 0xFF, 0xFF, 0xFF }
-};
-
-const rgb_triple_t color_table_4_bit [16] = {
-    { 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x80 },
-    { 0x00, 0x80, 0x00 }, { 0x00, 0x80, 0x80 },
-    { 0x80, 0x00, 0x00 }, { 0x80, 0x00, 0x80 },
-    { 0x80, 0x80, 0x00 }, { 0x80, 0x80, 0x80 },
-    { 0xC0, 0xC0, 0xC0 }, { 0x00, 0x00, 0xFF },
-    { 0x00, 0xFF, 0x00 }, { 0x00, 0xFF, 0xFF },
-    { 0xFF, 0x00, 0x00 }, { 0xFF, 0x00, 0xFF },
-    { 0xFF, 0xFF, 0x00 }, { 0xFF, 0xFF, 0xFF }
-};
-
-const rgb_triple_t color_table_8_bit [256] = {
-    { 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x80 }, // 0x00
-    { 0x00, 0x80, 0x00 }, { 0x00, 0x80, 0x80 },
-    { 0x80, 0x00, 0x00 }, { 0x80, 0x00, 0x80 },
-    { 0x80, 0x80, 0x00 }, { 0xC0, 0xC0, 0xC0 },
-    { 0xC0, 0xDC, 0xC0 }, { 0xF0, 0xCA, 0xA6 },
-    { 0x00, 0x20, 0x40 }, { 0x00, 0x20, 0x60 },
-    { 0x00, 0x20, 0x80 }, { 0x00, 0x20, 0xA0 },
-    { 0x00, 0x20, 0xC0 }, { 0x00, 0x20, 0xE0 },
-    { 0x00, 0x40, 0x00 }, { 0x00, 0x40, 0x20 }, // 0x10
-    { 0x00, 0x40, 0x40 }, { 0x00, 0x40, 0x60 },
-    { 0x00, 0x40, 0x80 }, { 0x00, 0x40, 0xA0 },
-    { 0x00, 0x40, 0xC0 }, { 0x00, 0x40, 0xE0 },
-    { 0x00, 0x60, 0x00 }, { 0x00, 0x60, 0x20 },
-    { 0x00, 0x60, 0x40 }, { 0x00, 0x60, 0x60 },
-    { 0x00, 0x60, 0x80 }, { 0x00, 0x60, 0xA0 },
-    { 0x00, 0x60, 0xC0 }, { 0x00, 0x60, 0xE0 },
-    { 0x00, 0x80, 0x00 }, { 0x00, 0x80, 0x20 }, // 0x20
-    { 0x00, 0x80, 0x40 }, { 0x00, 0x80, 0x60 },
-    { 0x00, 0x80, 0x80 }, { 0x00, 0x80, 0xA0 },
-    { 0x00, 0x80, 0xC0 }, { 0x00, 0x80, 0xE0 },
-    { 0x00, 0xA0, 0x00 }, { 0x00, 0xA0, 0x20 },
-    { 0x00, 0xA0, 0x40 }, { 0x00, 0xA0, 0x60 },
-    { 0x00, 0xA0, 0x80 }, { 0x00, 0xA0, 0xA0 },
-    { 0x00, 0xA0, 0xC0 }, { 0x00, 0xA0, 0xE0 },
-    { 0x00, 0xC0, 0x00 }, { 0x00, 0xC0, 0x20 }, // 0x30
-    { 0x00, 0xC0, 0x40 }, { 0x00, 0xC0, 0x60 },
-    { 0x00, 0xC0, 0x80 }, { 0x00, 0xC0, 0xA0 },
-    { 0x00, 0xC0, 0xC0 }, { 0x00, 0xC0, 0xE0 },
-    { 0x00, 0xE0, 0x00 }, { 0x00, 0xE0, 0x20 },
-    { 0x00, 0xE0, 0x40 }, { 0x00, 0xE0, 0x60 },
-    { 0x00, 0xE0, 0x80 }, { 0x00, 0xE0, 0xA0 },
-    { 0x00, 0xE0, 0xC0 }, { 0x00, 0xE0, 0xE0 },
-    { 0x40, 0x00, 0x00 }, { 0x40, 0x00, 0x20 }, // 0x40
-    { 0x40, 0x00, 0x40 }, { 0x40, 0x00, 0x60 },
-    { 0x40, 0x00, 0x80 }, { 0x40, 0x00, 0xA0 },
-    { 0x40, 0x00, 0xC0 }, { 0x40, 0x00, 0xE0 },
-    { 0x40, 0x20, 0x00 }, { 0x40, 0x20, 0x20 },
-    { 0x40, 0x20, 0x40 }, { 0x40, 0x20, 0x60 },
-    { 0x40, 0x20, 0x80 }, { 0x40, 0x20, 0xA0 },
-    { 0x40, 0x20, 0xC0 }, { 0x40, 0x20, 0xE0 },
-    { 0x40, 0x40, 0x00 }, { 0x40, 0x40, 0x20 }, // 0x50
-    { 0x40, 0x40, 0x40 }, { 0x40, 0x40, 0x60 },
-    { 0x40, 0x40, 0x80 }, { 0x40, 0x40, 0xA0 },
-    { 0x40, 0x40, 0xC0 }, { 0x40, 0x40, 0xE0 },
-    { 0x40, 0x60, 0x00 }, { 0x40, 0x60, 0x20 },
-    { 0x40, 0x60, 0x40 }, { 0x40, 0x60, 0x60 },
-    { 0x40, 0x60, 0x80 }, { 0x40, 0x60, 0xA0 },
-    { 0x40, 0x60, 0xC0 }, { 0x40, 0x60, 0xE0 },
-    { 0x40, 0x80, 0x00 }, { 0x40, 0x80, 0x20 }, // 0x60
-    { 0x40, 0x80, 0x40 }, { 0x40, 0x80, 0x60 },
-    { 0x40, 0x80, 0x80 }, { 0x40, 0x80, 0xA0 },
-    { 0x40, 0x80, 0xC0 }, { 0x40, 0x80, 0xE0 },
-    { 0x40, 0xA0, 0x00 }, { 0x40, 0xA0, 0x20 },
-    { 0x40, 0xA0, 0x40 }, { 0x40, 0xA0, 0x60 },
-    { 0x40, 0xA0, 0x80 }, { 0x40, 0xA0, 0xA0 },
-    { 0x40, 0xA0, 0xC0 }, { 0x40, 0xA0, 0xE0 },
-    { 0x40, 0xC0, 0x00 }, { 0x40, 0xC0, 0x20 }, // 0x70
-    { 0x40, 0xC0, 0x40 }, { 0x40, 0xC0, 0x60 },
-    { 0x40, 0xC0, 0x80 }, { 0x40, 0xC0, 0xA0 },
-    { 0x40, 0xC0, 0xC0 }, { 0x40, 0xC0, 0xE0 },
-    { 0x40, 0xE0, 0x00 }, { 0x40, 0xE0, 0x20 },
-    { 0x40, 0xE0, 0x40 }, { 0x40, 0xE0, 0x60 },
-    { 0x40, 0xE0, 0x80 }, { 0x40, 0xE0, 0xA0 },
-    { 0x40, 0xE0, 0xC0 }, { 0x40, 0xE0, 0xE0 },
-    { 0x80, 0x00, 0x00 }, { 0x80, 0x00, 0x20 }, // 0x80
-    { 0x80, 0x00, 0x40 }, { 0x80, 0x00, 0x60 },
-    { 0x80, 0x00, 0x80 }, { 0x80, 0x00, 0xA0 },
-    { 0x80, 0x00, 0xC0 }, { 0x80, 0x00, 0xE0 },
-    { 0x80, 0x20, 0x00 }, { 0x80, 0x20, 0x20 },
-    { 0x80, 0x20, 0x40 }, { 0x80, 0x20, 0x60 },
-    { 0x80, 0x20, 0x80 }, { 0x80, 0x20, 0xA0 },
-    { 0x80, 0x20, 0xC0 }, { 0x80, 0x20, 0xE0 },
-    { 0x80, 0x40, 0x00 }, { 0x80, 0x40, 0x20 }, // 0x90
-    { 0x80, 0x40, 0x40 }, { 0x80, 0x40, 0x60 },
-    { 0x80, 0x40, 0x80 }, { 0x80, 0x40, 0xA0 },
-    { 0x80, 0x40, 0xC0 }, { 0x80, 0x40, 0xE0 },
-    { 0x80, 0x60, 0x00 }, { 0x80, 0x60, 0x20 },
-    { 0x80, 0x60, 0x40 }, { 0x80, 0x60, 0x60 },
-    { 0x80, 0x60, 0x80 }, { 0x80, 0x60, 0xA0 },
-    { 0x80, 0x60, 0xC0 }, { 0x80, 0x60, 0xE0 },
-    { 0x80, 0x80, 0x00 }, { 0x80, 0x80, 0x20 }, // 0xA0
-    { 0x80, 0x80, 0x40 }, { 0x80, 0x80, 0x60 },
-    { 0x80, 0x80, 0x80 }, { 0x80, 0x80, 0xA0 },
-    { 0x80, 0x80, 0xC0 }, { 0x80, 0x80, 0xE0 },
-    { 0x80, 0xA0, 0x00 }, { 0x80, 0xA0, 0x20 },
-    { 0x80, 0xA0, 0x40 }, { 0x80, 0xA0, 0x60 },
-    { 0x80, 0xA0, 0x80 }, { 0x80, 0xA0, 0xA0 },
-    { 0x80, 0xA0, 0xC0 }, { 0x80, 0xA0, 0xE0 },
-    { 0x80, 0xC0, 0x00 }, { 0x80, 0xC0, 0x20 }, // 0xB0
-    { 0x80, 0xC0, 0x40 }, { 0x80, 0xC0, 0x60 },
-    { 0x80, 0xC0, 0x80 }, { 0x80, 0xC0, 0xA0 },
-    { 0x80, 0xC0, 0xC0 }, { 0x80, 0xC0, 0xE0 },
-    { 0x80, 0xE0, 0x00 }, { 0x80, 0xE0, 0x20 },
-    { 0x80, 0xE0, 0x40 }, { 0x80, 0xE0, 0x60 },
-    { 0x80, 0xE0, 0x80 }, { 0x80, 0xE0, 0xA0 },
-    { 0x80, 0xE0, 0xC0 }, { 0x80, 0xE0, 0xE0 },
-    { 0xC0, 0x00, 0x00 }, { 0xC0, 0x00, 0x20 }, // 0xC0
-    { 0xC0, 0x00, 0x40 }, { 0xC0, 0x00, 0x60 },
-    { 0xC0, 0x00, 0x80 }, { 0xC0, 0x00, 0xA0 },
-    { 0xC0, 0x00, 0xC0 }, { 0xC0, 0x00, 0xE0 },
-    { 0xC0, 0x20, 0x00 }, { 0xC0, 0x20, 0x20 },
-    { 0xC0, 0x20, 0x40 }, { 0xC0, 0x20, 0x60 },
-    { 0xC0, 0x20, 0x80 }, { 0xC0, 0x20, 0xA0 },
-    { 0xC0, 0x20, 0xC0 }, { 0xC0, 0x20, 0xE0 },
-    { 0xC0, 0x40, 0x00 }, { 0xC0, 0x40, 0x20 }, // 0xD0
-    { 0xC0, 0x40, 0x40 }, { 0xC0, 0x40, 0x60 },
-    { 0xC0, 0x40, 0x80 }, { 0xC0, 0x40, 0xA0 },
-    { 0xC0, 0x40, 0xC0 }, { 0xC0, 0x40, 0xE0 },
-    { 0xC0, 0x60, 0x00 }, { 0xC0, 0x60, 0x20 },
-    { 0xC0, 0x60, 0x40 }, { 0xC0, 0x60, 0x60 },
-    { 0xC0, 0x60, 0x80 }, { 0xC0, 0x60, 0xA0 },
-    { 0xC0, 0x60, 0xC0 }, { 0xC0, 0x60, 0xE0 },
-    { 0xC0, 0x80, 0x00 }, { 0xC0, 0x80, 0x20 }, // 0xE0
-    { 0xC0, 0x80, 0x40 }, { 0xC0, 0x80, 0x60 },
-    { 0xC0, 0x80, 0x80 }, { 0xC0, 0x80, 0xA0 },
-    { 0xC0, 0x80, 0xC0 }, { 0xC0, 0x80, 0xE0 },
-    { 0xC0, 0xA0, 0x00 }, { 0xC0, 0xA0, 0x20 },
-    { 0xC0, 0xA0, 0x40 }, { 0xC0, 0xA0, 0x60 },
-    { 0xC0, 0xA0, 0x80 }, { 0xC0, 0xA0, 0xA0 },
-    { 0xC0, 0xA0, 0xC0 }, { 0xC0, 0xA0, 0xE0 },
-    { 0xC0, 0xC0, 0x00 }, { 0xC0, 0xC0, 0x20 }, // 0xF0
-    { 0xC0, 0xC0, 0x40 }, { 0xC0, 0xC0, 0x60 },
-    { 0xC0, 0xC0, 0x80 }, { 0xC0, 0xC0, 0xA0 },
-    { 0xF0, 0xFB, 0xFF }, { 0xA4, 0xA0, 0xA0 },
-    { 0x80, 0x80, 0x80 }, { 0x00, 0x00, 0xFF },
-    { 0x00, 0xFF, 0x00 }, { 0x00, 0xFF, 0xFF },
-    { 0xFF, 0x00, 0x00 }, { 0xFF, 0x00, 0xFF },
-    { 0xFF, 0xFF, 0x00 }, { 0xFF, 0xFF, 0xFF }
-};
-
-uint32_t get_colors_num(uint32_t bit_count)
-{
-    switch (bit_count)
-    {
-        case  1: return COLORS_IN_1_BIT_TABLE;
-        case  4: return COLORS_IN_4_BIT_TABLE;
-        case  8: return COLORS_IN_8_BIT_TABLE;
-        default: break;
-    }
-    return 0;
-}
-
-rgb_triple_t* get_color_table_triple(uint32_t bit_count)
-{
-    uint32_t      colors_num  = get_colors_num(bit_count);
-    rgb_triple_t* color_table = (rgb_triple_t*) malloc(sizeof(rgb_triple_t) * colors_num);
-
-    if (! color_table)
-        return NULL;
-
-    switch (bit_count)
-    {
-        case  1: memcpy(color_table, color_table_1_bit, sizeof(color_table_1_bit)); break;
-        case  4: memcpy(color_table, color_table_4_bit, sizeof(color_table_4_bit)); break;
-        case  8: memcpy(color_table, color_table_8_bit, sizeof(color_table_8_bit)); break;
-        default:
-            free(color_table);
-            return NULL;
-    }
-
-    return color_table;
-}
-
-rgb_quad_t* get_color_table_quad(uint32_t bit_count)
-{
-          uint32_t   i, colors_num  = get_colors_num(bit_count);
-          rgb_quad_t*   color_table = (rgb_quad_t*) malloc(sizeof(rgb_quad_t) * colors_num);
-    const rgb_triple_t* base_table  = NULL;
-
-    if (! color_table)
-        return NULL;
-
-    switch (bit_count)
-    {
-        case  1: base_table = color_table_1_bit; break;
-        case  4: base_table = color_table_4_bit; break;
-        case  8: base_table = color_table_8_bit; break;
-        default:
-            free(color_table);
-            return NULL;
-    }
-
-    for (i = 0; i < colors_num; i ++)
-    {
-        color_table[i].blue     = base_table[i].blue;
-        color_table[i].green    = base_table[i].green;
-        color_table[i].red      = base_table[i].red;
-        color_table[i].reserved = 0;
-    }
-
-    return color_table;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+
+#include "colortbl.h"
+
+const rgb_triple_t color_table_1_bit [2] = {
+    { 0x00, 0x00, 0x00 }, { 0xFF, 0xFF, 0xFF }
+};
+
+const rgb_triple_t color_table_4_bit [16] = {
+    { 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x80 },
+    { 0x00, 0x80, 0x00 }, { 0x00, 0x80, 0x80 },
+    { 0x80, 0x00, 0x00 }, { 0x80, 0x00, 0x80 },
+    { 0x80, 0x80, 0x00 }, { 0x80, 0x80, 0x80 },
+    { 0xC0, 0xC0, 0xC0 }, { 0x00, 0x00, 0xFF },
+    { 0x00, 0xFF, 0x00 }, { 0x00, 0xFF, 0xFF },
+    { 0xFF, 0x00, 0x00 }, { 0xFF, 0x00, 0xFF },
+    { 0xFF, 0xFF, 0x00 }, { 0xFF, 0xFF, 0xFF }
+};
+
+const rgb_triple_t color_table_8_bit [256] = {
+    { 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x80 }, // 0x00
+    { 0x00, 0x80, 0x00 }, { 0x00, 0x80, 0x80 },
+    { 0x80, 0x00, 0x00 }, { 0x80, 0x00, 0x80 },
+    { 0x80, 0x80, 0x00 }, { 0xC0, 0xC0, 0xC0 },
+    { 0xC0, 0xDC, 0xC0 }, { 0xF0, 0xCA, 0xA6 },
+    { 0x00, 0x20, 0x40 }, { 0x00, 0x20, 0x60 },
+    { 0x00, 0x20, 0x80 }, { 0x00, 0x20, 0xA0 },
+    { 0x00, 0x20, 0xC0 }, { 0x00, 0x20, 0xE0 },
+    { 0x00, 0x40, 0x00 }, { 0x00, 0x40, 0x20 }, // 0x10
+    { 0x00, 0x40, 0x40 }, { 0x00, 0x40, 0x60 },
+    { 0x00, 0x40, 0x80 }, { 0x00, 0x40, 0xA0 },
+    { 0x00, 0x40, 0xC0 }, { 0x00, 0x40, 0xE0 },
+    { 0x00, 0x60, 0x00 }, { 0x00, 0x60, 0x20 },
+    { 0x00, 0x60, 0x40 }, { 0x00, 0x60, 0x60 },
+    { 0x00, 0x60, 0x80 }, { 0x00, 0x60, 0xA0 },
+    { 0x00, 0x60, 0xC0 }, { 0x00, 0x60, 0xE0 },
+    { 0x00, 0x80, 0x00 }, { 0x00, 0x80, 0x20 }, // 0x20
+    { 0x00, 0x80, 0x40 }, { 0x00, 0x80, 0x60 },
+    { 0x00, 0x80, 0x80 }, { 0x00, 0x80, 0xA0 },
+    { 0x00, 0x80, 0xC0 }, { 0x00, 0x80, 0xE0 },
+    { 0x00, 0xA0, 0x00 }, { 0x00, 0xA0, 0x20 },
+    { 0x00, 0xA0, 0x40 }, { 0x00, 0xA0, 0x60 },
+    { 0x00, 0xA0, 0x80 }, { 0x00, 0xA0, 0xA0 },
+    { 0x00, 0xA0, 0xC0 }, { 0x00, 0xA0, 0xE0 },
+    { 0x00, 0xC0, 0x00 }, { 0x00, 0xC0, 0x20 }, // 0x30
+    { 0x00, 0xC0, 0x40 }, { 0x00, 0xC0, 0x60 },
+    { 0x00, 0xC0, 0x80 }, { 0x00, 0xC0, 0xA0 },
+    { 0x00, 0xC0, 0xC0 }, { 0x00, 0xC0, 0xE0 },
+    { 0x00, 0xE0, 0x00 }, { 0x00, 0xE0, 0x20 },
+    { 0x00, 0xE0, 0x40 }, { 0x00, 0xE0, 0x60 },
+    { 0x00, 0xE0, 0x80 }, { 0x00, 0xE0, 0xA0 },
+    { 0x00, 0xE0, 0xC0 }, { 0x00, 0xE0, 0xE0 },
+    { 0x40, 0x00, 0x00 }, { 0x40, 0x00, 0x20 }, // 0x40
+    { 0x40, 0x00, 0x40 }, { 0x40, 0x00, 0x60 },
+    { 0x40, 0x00, 0x80 }, { 0x40, 0x00, 0xA0 },
+    { 0x40, 0x00, 0xC0 }, { 0x40, 0x00, 0xE0 },
+    { 0x40, 0x20, 0x00 }, { 0x40, 0x20, 0x20 },
+    { 0x40, 0x20, 0x40 }, { 0x40, 0x20, 0x60 },
+    { 0x40, 0x20, 0x80 }, { 0x40, 0x20, 0xA0 },
+    { 0x40, 0x20, 0xC0 }, { 0x40, 0x20, 0xE0 },
+    { 0x40, 0x40, 0x00 }, { 0x40, 0x40, 0x20 }, // 0x50
+    { 0x40, 0x40, 0x40 }, { 0x40, 0x40, 0x60 },
+    { 0x40, 0x40, 0x80 }, { 0x40, 0x40, 0xA0 },
+    { 0x40, 0x40, 0xC0 }, { 0x40, 0x40, 0xE0 },
+    { 0x40, 0x60, 0x00 }, { 0x40, 0x60, 0x20 },
+    { 0x40, 0x60, 0x40 }, { 0x40, 0x60, 0x60 },
+    { 0x40, 0x60, 0x80 }, { 0x40, 0x60, 0xA0 },
+    { 0x40, 0x60, 0xC0 }, { 0x40, 0x60, 0xE0 },
+    { 0x40, 0x80, 0x00 }, { 0x40, 0x80, 0x20 }, // 0x60
+    { 0x40, 0x80, 0x40 }, { 0x40, 0x80, 0x60 },
+    { 0x40, 0x80, 0x80 }, { 0x40, 0x80, 0xA0 },
+    { 0x40, 0x80, 0xC0 }, { 0x40, 0x80, 0xE0 },
+    { 0x40, 0xA0, 0x00 }, { 0x40, 0xA0, 0x20 },
+    { 0x40, 0xA0, 0x40 }, { 0x40, 0xA0, 0x60 },
+    { 0x40, 0xA0, 0x80 }, { 0x40, 0xA0, 0xA0 },
+    { 0x40, 0xA0, 0xC0 }, { 0x40, 0xA0, 0xE0 },
+    { 0x40, 0xC0, 0x00 }, { 0x40, 0xC0, 0x20 }, // 0x70
+    { 0x40, 0xC0, 0x40 }, { 0x40, 0xC0, 0x60 },
+    { 0x40, 0xC0, 0x80 }, { 0x40, 0xC0, 0xA0 },
+    { 0x40, 0xC0, 0xC0 }, { 0x40, 0xC0, 0xE0 },
+    { 0x40, 0xE0, 0x00 }, { 0x40, 0xE0, 0x20 },
+    { 0x40, 0xE0, 0x40 }, { 0x40, 0xE0, 0x60 },
+    { 0x40, 0xE0, 0x80 }, { 0x40, 0xE0, 0xA0 },
+    { 0x40, 0xE0, 0xC0 }, { 0x40, 0xE0, 0xE0 },
+    { 0x80, 0x00, 0x00 }, { 0x80, 0x00, 0x20 }, // 0x80
+    { 0x80, 0x00, 0x40 }, { 0x80, 0x00, 0x60 },
+    { 0x80, 0x00, 0x80 }, { 0x80, 0x00, 0xA0 },
+    { 0x80, 0x00, 0xC0 }, { 0x80, 0x00, 0xE0 },
+    { 0x80, 0x20, 0x00 }, { 0x80, 0x20, 0x20 },
+    { 0x80, 0x20, 0x40 }, { 0x80, 0x20, 0x60 },
+    { 0x80, 0x20, 0x80 }, { 0x80, 0x20, 0xA0 },
+    { 0x80, 0x20, 0xC0 }, { 0x80, 0x20, 0xE0 },
+    { 0x80, 0x40, 0x00 }, { 0x80, 0x40, 0x20 }, // 0x90
+    { 0x80, 0x40, 0x40 }, { 0x80, 0x40, 0x60 },
+    { 0x80, 0x40, 0x80 }, { 0x80, 0x40, 0xA0 },
+    { 0x80, 0x40, 0xC0 }, { 0x80, 0x40, 0xE0 },
+    { 0x80, 0x60, 0x00 }, { 0x80, 0x60, 0x20 },
+    { 0x80, 0x60, 0x40 }, { 0x80, 0x60, 0x60 },
+    { 0x80, 0x60, 0x80 }, { 0x80, 0x60, 0xA0 },
+    { 0x80, 0x60, 0xC0 }, { 0x80, 0x60, 0xE0 },
+    { 0x80, 0x80, 0x00 }, { 0x80, 0x80, 0x20 }, // 0xA0
+    { 0x80, 0x80, 0x40 }, { 0x80, 0x80, 0x60 },
+    { 0x80, 0x80, 0x80 }, { 0x80, 0x80, 0xA0 },
+    { 0x80, 0x80, 0xC0 }, { 0x80, 0x80, 0xE0 },
+    { 0x80, 0xA0, 0x00 }, { 0x80, 0xA0, 0x20 },
+    { 0x80, 0xA0, 0x40 }, { 0x80, 0xA0, 0x60 },
+    { 0x80, 0xA0, 0x80 }, { 0x80, 0xA0, 0xA0 },
+    { 0x80, 0xA0, 0xC0 }, { 0x80, 0xA0, 0xE0 },
+    { 0x80, 0xC0, 0x00 }, { 0x80, 0xC0, 0x20 }, // 0xB0
+    { 0x80, 0xC0, 0x40 }, { 0x80, 0xC0, 0x60 },
+    { 0x80, 0xC0, 0x80 }, { 0x80, 0xC0, 0xA0 },
+    { 0x80, 0xC0, 0xC0 }, { 0x80, 0xC0, 0xE0 },
+    { 0x80, 0xE0, 0x00 }, { 0x80, 0xE0, 0x20 },
+    { 0x80, 0xE0, 0x40 }, { 0x80, 0xE0, 0x60 },
+    { 0x80, 0xE0, 0x80 }, { 0x80, 0xE0, 0xA0 },
+    { 0x80, 0xE0, 0xC0 }, { 0x80, 0xE0, 0xE0 },
+    { 0xC0, 0x00, 0x00 }, { 0xC0, 0x00, 0x20 }, // 0xC0
+    { 0xC0, 0x00, 0x40 }, { 0xC0, 0x00, 0x60 },
+    { 0xC0, 0x00, 0x80 }, { 0xC0, 0x00, 0xA0 },
+    { 0xC0, 0x00, 0xC0 }, { 0xC0, 0x00, 0xE0 },
+    { 0xC0, 0x20, 0x00 }, { 0xC0, 0x20, 0x20 },
+    { 0xC0, 0x20, 0x40 }, { 0xC0, 0x20, 0x60 },
+    { 0xC0, 0x20, 0x80 }, { 0xC0, 0x20, 0xA0 },
+    { 0xC0, 0x20, 0xC0 }, { 0xC0, 0x20, 0xE0 },
+    { 0xC0, 0x40, 0x00 }, { 0xC0, 0x40, 0x20 }, // 0xD0
+    { 0xC0, 0x40, 0x40 }, { 0xC0, 0x40, 0x60 },
+    { 0xC0, 0x40, 0x80 }, { 0xC0, 0x40, 0xA0 },
+    { 0xC0, 0x40, 0xC0 }, { 0xC0, 0x40, 0xE0 },
+    { 0xC0, 0x60, 0x00 }, { 0xC0, 0x60, 0x20 },
+    { 0xC0, 0x60, 0x40 }, { 0xC0, 0x60, 0x60 },
+    { 0xC0, 0x60, 0x80 }, { 0xC0, 0x60, 0xA0 },
+    { 0xC0, 0x60, 0xC0 }, { 0xC0, 0x60, 0xE0 },
+    { 0xC0, 0x80, 0x00 }, { 0xC0, 0x80, 0x20 }, // 0xE0
+    { 0xC0, 0x80, 0x40 }, { 0xC0, 0x80, 0x60 },
+    { 0xC0, 0x80, 0x80 }, { 0xC0, 0x80, 0xA0 },
+    { 0xC0, 0x80, 0xC0 }, { 0xC0, 0x80, 0xE0 },
+    { 0xC0, 0xA0, 0x00 }, { 0xC0, 0xA0, 0x20 },
+    { 0xC0, 0xA0, 0x40 }, { 0xC0, 0xA0, 0x60 },
+    { 0xC0, 0xA0, 0x80 }, { 0xC0, 0xA0, 0xA0 },
+    { 0xC0, 0xA0, 0xC0 }, { 0xC0, 0xA0, 0xE0 },
+    { 0xC0, 0xC0, 0x00 }, { 0xC0, 0xC0, 0x20 }, // 0xF0
+    { 0xC0, 0xC0, 0x40 }, { 0xC0, 0xC0, 0x60 },
+    { 0xC0, 0xC0, 0x80 }, { 0xC0, 0xC0, 0xA0 },
+    { 0xF0, 0xFB, 0xFF }, { 0xA4, 0xA0, 0xA0 },
+    { 0x80, 0x80, 0x80 }, { 0x00, 0x00, 0xFF },
+    { 0x00, 0xFF, 0x00 }, { 0x00, 0xFF, 0xFF },
+    { 0xFF, 0x00, 0x00 }, { 0xFF, 0x00, 0xFF },
+    { 0xFF, 0xFF, 0x00 }, { 0xFF, 0xFF, 0xFF }
+};
+
+const rgb_quad_t color_quads_1_bit [2] = {
+    { 0x00, 0x00, 0x00, 0x00 }, { 0xFF, 0xFF, 0xFF, 0x00 }
+};
+
+const rgb_quad_t color_quads_4_bit [16] = {
+    { 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x80, 0x00 },
+    { 0x00, 0x80, 0x00, 0x00 }, { 0x00, 0x80, 0x80, 0x00 },
+    { 0x80, 0x00, 0x00, 0x00 }, { 0x80, 0x00, 0x80, 0x00 },
+    { 0x80, 0x80, 0x00, 0x00 }, { 0x80, 0x80, 0x80, 0x00 },
+    { 0xC0, 0xC0, 0xC0, 0x00 }, { 0x00, 0x00, 0xFF, 0x00 },
+    { 0x00, 0xFF, 0x00, 0x00 }, { 0x00, 0xFF, 0xFF, 0x00 },
+    { 0xFF, 0x00, 0x00, 0x00 }, { 0xFF, 0x00, 0xFF, 0x00 },
+    { 0xFF, 0xFF, 0x00, 0x00 }, { 0xFF, 0xFF, 0xFF, 0x00 }
+};
+
+const rgb_quad_t color_quads_8_bit [256] = {
+    { 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x80, 0x00 }, // 0x00
+    { 0x00, 0x80, 0x00, 0x00 }, { 0x00, 0x80, 0x80, 0x00 },
+    { 0x80, 0x00, 0x00, 0x00 }, { 0x80, 0x00, 0x80, 0x00 },
+    { 0x80, 0x80, 0x00, 0x00 }, { 0xC0, 0xC0, 0xC0, 0x00 },
+    { 0xC0, 0xDC, 0xC0, 0x00 }, { 0xF0, 0xCA, 0xA6, 0x00 },
+    { 0x00, 0x20, 0x40, 0x00 }, { 0x00, 0x20, 0x60, 0x00 },
+    { 0x00, 0x20, 0x80, 0x00 }, { 0x00, 0x20, 0xA0, 0x00 },
+    { 0x00, 0x20, 0xC0, 0x00 }, { 0x00, 0x20, 0xE0, 0x00 },
+    { 0x00, 0x40, 0x00, 0x00 }, { 0x00, 0x40, 0x20, 0x00 }, // 0x10
+    { 0x00, 0x40, 0x40, 0x00 }, { 0x00, 0x40, 0x60, 0x00 },
+    { 0x00, 0x40, 0x80, 0x00 }, { 0x00, 0x40, 0xA0, 0x00 },
+    { 0x00, 0x40, 0xC0, 0x00 }, { 0x00, 0x40, 0xE0, 0x00 },
+    { 0x00, 0x60, 0x00, 0x00 }, { 0x00, 0x60, 0x20, 0x00 },
+    { 0x00, 0x60, 0x40, 0x00 }, { 0x00, 0x60, 0x60, 0x00 },
+    { 0x00, 0x60, 0x80, 0x00 }, { 0x00, 0x60, 0xA0, 0x00 },
+    { 0x00, 0x60, 0xC0, 0x00 }, { 0x00, 0x60, 0xE0, 0x00 },
+    { 0x00, 0x80, 0x00, 0x00 }, { 0x00, 0x80, 0x20, 0x00 }, // 0x20
+    { 0x00, 0x80, 0x40, 0x00 }, { 0x00, 0x80, 0x60, 0x00 },
+    { 0x00, 0x80, 0x80, 0x00 }, { 0x00, 0x80, 0xA0, 0x00 },
+    { 0x00, 0x80, 0xC0, 0x00 }, { 0x00, 0x80, 0xE0, 0x00 },
+    { 0x00, 0xA0, 0x00, 0x00 }, { 0x00, 0xA0, 0x20, 0x00 },
+    { 0x00, 0xA0, 0x40, 0x00 }, { 0x00, 0xA0, 0x60, 0x00 },
+    { 0x00, 0xA0, 0x80, 0x00 }, { 0x00, 0xA0, 0xA0, 0x00 },
+    { 0x00, 0xA0, 0xC0, 0x00 }, { 0x00, 0xA0, 0xE0, 0x00 },
+    { 0x00, 0xC0, 0x00, 0x00 }, { 0x00, 0xC0, 0x20, 0x00 }, // 0x30
+    { 0x00, 0xC0, 0x40, 0x00 }, { 0x00, 0xC0, 0x60, 0x00 },
+    { 0x00, 0xC0, 0x80, 0x00 }, { 0x00, 0xC0, 0xA0, 0x00 },
+    { 0x00, 0xC0, 0xC0, 0x00 }, { 0x00, 0xC0, 0xE0, 0x00 },
+    { 0x00, 0xE0, 0x00, 0x00 }, { 0x00, 0xE0, 0x20, 0x00 },
+    { 0x00, 0xE0, 0x40, 0x00 }, { 0x00, 0xE0, 0x60, 0x00 },
+    { 0x00, 0xE0, 0x80, 0x00 }, { 0x00, 0xE0, 0xA0, 0x00 },
+    { 0x00, 0xE0, 0xC0, 0x00 }, { 0x00, 0xE0, 0xE0, 0x00 },
+    { 0x40, 0x00, 0x00, 0x00 }, { 0x40, 0x00, 0x20, 0x00 }, // 0x40
+    { 0x40, 0x00, 0x40, 0x00 }, { 0x40, 0x00, 0x60, 0x00 },
+    { 0x40, 0x00, 0x80, 0x00 }, { 0x40, 0x00, 0xA0, 0x00 },
+    { 0x40, 0x00, 0xC0, 0x00 }, { 0x40, 0x00, 0xE0, 0x00 },
+    { 0x40, 0x20, 0x00, 0x00 }, { 0x40, 0x20, 0x20, 0x00 },
+    { 0x40, 0x20, 0x40, 0x00 }, { 0x40, 0x20, 0x60, 0x00 },
+    { 0x40, 0x20, 0x80, 0x00 }, { 0x40, 0x20, 0xA0, 0x00 },
+    { 0x40, 0x20, 0xC0, 0x00 }, { 0x40, 0x20, 0xE0, 0x00 },
+    { 0x40, 0x40, 0x00, 0x00 }, { 0x40, 0x40, 0x20, 0x00 }, // 0x50
+    { 0x40, 0x40, 0x40, 0x00 }, { 0x40, 0x40, 0x60, 0x00 },
+    { 0x40, 0x40, 0x80, 0x00 }, { 0x40, 0x40, 0xA0, 0x00 },
+    { 0x40, 0x40, 0xC0, 0x00 }, { 0x40, 0x40, 0xE0, 0x00 },
+    { 0x40, 0x60, 0x00, 0x00 }, { 0x40, 0x60, 0x20, 0x00 },
+    { 0x40, 0x60, 0x40, 0x00 }, { 0x40, 0x60, 0x60, 0x00 },
+    { 0x40, 0x60, 0x80, 0x00 }, { 0x40, 0x60, 0xA0, 0x00 },
+    { 0x40, 0x60, 0xC0, 0x00 }, { 0x40, 0x60, 0xE0, 0x00 },
+    { 0x40, 0x80, 0x00, 0x00 }, { 0x40, 0x80, 0x20, 0x00 }, // 0x60
+    { 0x40, 0x80, 0x40, 0x00 }, { 0x40, 0x80, 0x60, 0x00 },
+    { 0x40, 0x80, 0x80, 0x00 }, { 0x40, 0x80, 0xA0, 0x00 },
+    { 0x40, 0x80, 0xC0, 0x00 }, { 0x40, 0x80, 0xE0, 0x00 },
+    { 0x40, 0xA0, 0x00, 0x00 }, { 0x40, 0xA0, 0x20, 0x00 },
+    { 0x40, 0xA0, 0x40, 0x00 }, { 0x40, 0xA0, 0x60, 0x00 },
+    { 0x40, 0xA0, 0x80, 0x00 }, { 0x40, 0xA0, 0xA0, 0x00 },
+    { 0x40, 0xA0, 0xC0, 0x00 }, { 0x40, 0xA0, 0xE0, 0x00 },
+    { 0x40, 0xC0, 0x00, 0x00 }, { 0x40, 0xC0, 0x20, 0x00 }, // 0x70
+    { 0x40, 0xC0, 0x40, 0x00 }, { 0x40, 0xC0, 0x60, 0x00 },
+    { 0x40, 0xC0, 0x80, 0x00 }, { 0x40, 0xC0, 0xA0, 0x00 },
+    { 0x40, 0xC0, 0xC0, 0x00 }, { 0x40, 0xC0, 0xE0, 0x00 },
+    { 0x40, 0xE0, 0x00, 0x00 }, { 0x40, 0xE0, 0x20, 0x00 },
+    { 0x40, 0xE0, 0x40, 0x00 }, { 0x40, 0xE0, 0x60, 0x00 },
+    { 0x40, 0xE0, 0x80, 0x00 }, { 0x40, 0xE0, 0xA0, 0x00 },
+    { 0x40, 0xE0, 0xC0, 0x00 }, { 0x40, 0xE0, 0xE0, 0x00 },
+    { 0x80, 0x00, 0x00, 0x00 }, { 0x80, 0x00, 0x20, 0x00 }, // 0x80
+    { 0x80, 0x00, 0x40, 0x00 }, { 0x80, 0x00, 0x60, 0x00 },
+    { 0x80, 0x00, 0x80, 0x00 }, { 0x80, 0x00, 0xA0, 0x00 },
+    { 0x80, 0x00, 0xC0, 0x00 }, { 0x80, 0x00, 0xE0, 0x00 },
+    { 0x80, 0x20, 0x00, 0x00 }, { 0x80, 0x20, 0x20, 0x00 },
+    { 0x80, 0x20, 0x40, 0x00 }, { 0x80, 0x20, 0x60, 0x00 },
+    { 0x80, 0x20, 0x80, 0x00 }, { 0x80, 0x20, 0xA0, 0x00 },
+    { 0x80, 0x20, 0xC0, 0x00 }, { 0x80, 0x20, 0xE0, 0x00 },
+    { 0x80, 0x40, 0x00, 0x00 }, { 0x80, 0x40, 0x20, 0x00 }, // 0x90
+    { 0x80, 0x40, 0x40, 0x00 }, { 0x80, 0x40, 0x60, 0x00 },
+    { 0x80, 0x40, 0x80, 0x00 }, { 0x80, 0x40, 0xA0, 0x00 },
+    { 0x80, 0x40, 0xC0, 0x00 }, { 0x80, 0x40, 0xE0, 0x00 },
+    { 0x80, 0x60, 0x00, 0x00 }, { 0x80, 0x60, 0x20, 0x00 },
+    { 0x80, 0x60, 0x40, 0x00 }, { 0x80, 0x60, 0x60, 0x00 },
+    { 0x80, 0x60, 0x80, 0x00 }, { 0x80, 0x60, 0xA0, 0x00 },
+    { 0x80, 0x60, 0xC0, 0x00 }, { 0x80, 0x60, 0xE0, 0x00 },
+    { 0x80, 0x80, 0x00, 0x00 }, { 0x80, 0x80, 0x20, 0x00 }, // 0xA0
+    { 0x80, 0x80, 0x40, 0x00 }, { 0x80, 0x80, 0x60, 0x00 },
+    { 0x80, 0x80, 0x80, 0x00 }, { 0x80, 0x80, 0xA0, 0x00 },
+    { 0x80, 0x80, 0xC0, 0x00 }, { 0x80, 0x80, 0xE0, 0x00 },
+    { 0x80, 0xA0, 0x00, 0x00 }, { 0x80, 0xA0, 0x20, 0x00 },
+    { 0x80, 0xA0, 0x40, 0x00 }, { 0x80, 0xA0, 0x60, 0x00 },
+    { 0x80, 0xA0, 0x80, 0x00 }, { 0x80, 0xA0, 0xA0, 0x00 },
+    { 0x80, 0xA0, 0xC0, 0x00 }, { 0x80, 0xA0, 0xE0, 0x00 },
+    { 0x80, 0xC0, 0x00, 0x00 }, { 0x80, 0xC0, 0x20, 0x00 }, // 0xB0
+    { 0x80, 0xC0, 0x40, 0x00 }, { 0x80, 0xC0, 0x60, 0x00 },
+    { 0x80, 0xC0, 0x80, 0x00 }, { 0x80, 0xC0, 0xA0, 0x00 },
+    { 0x80, 0xC0, 0xC0, 0x00 }, { 0x80, 0xC0, 0xE0, 0x00 },
+    { 0x80, 0xE0, 0x00, 0x00 }, { 0x80, 0xE0, 0x20, 0x00 },
+    { 0x80, 0xE0, 0x40, 0x00 }, { 0x80, 0xE0, 0x60, 0x00 },
+    { 0x80, 0xE0, 0x80, 0x00 }, { 0x80, 0xE0, 0xA0, 0x00 },
+    { 0x80, 0xE0, 0xC0, 0x00 }, { 0x80, 0xE0, 0xE0, 0x00 },
+    { 0xC0, 0x00, 0x00, 0x00 }, { 0xC0, 0x00, 0x20, 0x00 }, // 0xC0
+    { 0xC0, 0x00, 0x40, 0x00 }, { 0xC0, 0x00, 0x60, 0x00 },
+    { 0xC0, 0x00, 0x80, 0x00 }, { 0xC0, 0x00, 0xA0, 0x00 },
+    { 0xC0, 0x00, 0xC0, 0x00 }, { 0xC0, 0x00, 0xE0, 0x00 },
+    { 0xC0, 0x20, 0x00, 0x00 }, { 0xC0, 0x20, 0x20, 0x00 },
+    { 0xC0, 0x20, 0x40, 0x00 }, { 0xC0, 0x20, 0x60, 0x00 },
+    { 0xC0, 0x20, 0x80, 0x00 }, { 0xC0, 0x20, 0xA0, 0x00 },
+    { 0xC0, 0x20, 0xC0, 0x00 }, { 0xC0, 0x20, 0xE0, 0x00 },
+    { 0xC0, 0x40, 0x00, 0x00 }, { 0xC0, 0x40, 0x20, 0x00 }, // 0xD0
+    { 0xC0, 0x40, 0x40, 0x00 }, { 0xC0, 0x40, 0x60, 0x00 },
+    { 0xC0, 0x40, 0x80, 0x00 }, { 0xC0, 0x40, 0xA0, 0x00 },
+    { 0xC0, 0x40, 0xC0, 0x00 }, { 0xC0, 0x40, 0xE0, 0x00 },
+    { 0xC0, 0x60, 0x00, 0x00 }, { 0xC0, 0x60, 0x20, 0x00 },
+    { 0xC0, 0x60, 0x40, 0x00 }, { 0xC0, 0x60, 0x60, 0x00 },
+    { 0xC0, 0x60, 0x80, 0x00 }, { 0xC0, 0x60, 0xA0, 0x00 },
+    { 0xC0, 0x60, 0xC0, 0x00 }, { 0xC0, 0x60, 0xE0, 0x00 },
+    { 0xC0, 0x80, 0x00, 0x00 }, { 0xC0, 0x80, 0x20, 0x00 }, // 0xE0
+    { 0xC0, 0x80, 0x40, 0x00 }, { 0xC0, 0x80, 0x60, 0x00 },
+    { 0xC0, 0x80, 0x80, 0x00 }, { 0xC0, 0x80, 0xA0, 0x00 },
+    { 0xC0, 0x80, 0xC0, 0x00 }, { 0xC0, 0x80, 0xE0, 0x00 },
+    { 0xC0, 0xA0, 0x00, 0x00 }, { 0xC0, 0xA0, 0x20, 0x00 },
+    { 0xC0, 0xA0, 0x40, 0x00 }, { 0xC0, 0xA0, 0x60, 0x00 },
+    { 0xC0, 0xA0, 0x80, 0x00 }, { 0xC0, 0xA0, 0xA0, 0x00 },
+    { 0xC0, 0xA0, 0xC0, 0x00 }, { 0xC0, 0xA0, 0xE0, 0x00 },
+    { 0xC0, 0xC0, 0x00, 0x00 }, { 0xC0, 0xC0, 0x20, 0x00 }, // 0xF0
+    { 0xC0, 0xC0, 0x40, 0x00 }, { 0xC0, 0xC0, 0x60, 0x00 },
+    { 0xC0, 0xC0, 0x80, 0x00 }, { 0xC0, 0xC0, 0xA0, 0x00 },
+    { 0xF0, 0xFB, 0xFF, 0x00 }, { 0xA4, 0xA0, 0xA0, 0x00 },
+    { 0x80, 0x80, 0x80, 0x00 }, { 0x00, 0x00, 0xFF, 0x00 },
+    { 0x00, 0xFF, 0x00, 0x00 }, { 0x00, 0xFF, 0xFF, 0x00 },
+    { 0xFF, 0x00, 0x00, 0x00 }, { 0xFF, 0x00, 0xFF, 0x00 },
+    { 0xFF, 0xFF, 0x00, 0x00 }, { 0xFF, 0xFF, 0xFF, 0x00 }
+};
+
+uint32_t get_colors_num(uint32_t bit_count)
+{
+    switch (bit_count)
+    {
+        case  1: return COLORS_IN_1_BIT_TABLE;
+        case  4: return COLORS_IN_4_BIT_TABLE;
+        case  8: return COLORS_IN_8_BIT_TABLE;
+        default: break;
+    }
+    return 0;
+}
+
+const rgb_quad_t* get_color_table_default(uint32_t bit_count)
+{
+    switch (bit_count)
+    {
+        case  1: return color_quads_1_bit;
+        case  4: return color_quads_4_bit;
+        case  8: return color_quads_8_bit;
+        default: break;
+    }
+    return NULL;
+}
+
+rgb_triple_t* get_color_table_triple(uint32_t bit_count)
+{
+    uint32_t      colors_num  = get_colors_num(bit_count);
+    rgb_triple_t* color_table = (rgb_triple_t*) mem_alloc(sizeof(rgb_triple_t) * colors_num);
+
+    if (! color_table)
+        return NULL;
+
+    switch (bit_count)
+    {
+        case  1: memcpy(color_table, color_table_1_bit, sizeof(color_table_1_bit)); break;
+        case  4: memcpy(color_table, color_table_4_bit, sizeof(color_table_4_bit)); break;
+        case  8: memcpy(color_table, color_table_8_bit, sizeof(color_table_8_bit)); break;
+        default:
+            mem_free(color_table);
+            return NULL;
+    }
+
+    return color_table;
+}
+
+rgb_quad_t* get_color_table_quad(uint32_t bit_count)
+{
+          uint32_t    colors_num  = get_colors_num(bit_count);
+    const rgb_quad_t* base_table  = get_color_table_default(bit_count);
+          rgb_quad_t* color_table = (base_table) ? (rgb_quad_t*) mem_alloc(sizeof(rgb_quad_t) * colors_num) : NULL;
+
+    if (! color_table)
+        return NULL;
+
+    memcpy(color_table, base_table, sizeof(rgb_quad_t) * colors_num);
+
+    return color_table;
+}
+
+// Default palettes are never freed (they have no references)
+static color_palette_t color_palette_1_bit = { color_quads_1_bit, COLORS_IN_1_BIT_TABLE, 0, FALSE, { { 0 } } };
+static color_palette_t color_palette_4_bit = { color_quads_4_bit, COLORS_IN_4_BIT_TABLE, 0, FALSE, { { 0 } } };
+static color_palette_t color_palette_8_bit = { color_quads_8_bit, COLORS_IN_8_BIT_TABLE, 0, FALSE, { { 0 } } };
+
+color_palette_t* get_color_palette_default(uint32_t bit_count)
+{
+    switch (bit_count)
+    {
+        case  1: return &color_palette_1_bit;
+        case  4: return &color_palette_4_bit;
+        case  8: return &color_palette_8_bit;
+        default: break;
+    }
+    return NULL;
+}
+
+color_palette_t* new_color_palette(rgb_quad_t* colors, uint32_t colors_num, uint32_t bit_count)
+{
+    if ((! colors) || (! colors_num))
+        return NULL;
+
+    // Most tables of files are default ones
+    const rgb_quad_t* base_table = get_color_table_default(bit_count);
+
+    if ((base_table) && (colors_num == get_colors_num(bit_count)) && (memcmp(colors, base_table, sizeof(rgb_quad_t) * colors_num) == 0))
+    {
+        mem_free(colors);
+        return get_color_palette_default(bit_count);
+    }
+
+    color_palette_t* palette = (color_palette_t*) mem_alloc(sizeof(color_palette_t));
+
+    if (! palette)
+    {
+        mem_free(colors);
+        return NULL;
+    }
+
+    palette->colors       = colors;
+    palette->colors_num   = colors_num;
+    palette->refs         = 1;
+    palette->pixels_ready = FALSE;
+
+    return palette;
+}
+
+color_palette_t* retain_color_palette(color_palette_t* palette)
+{
+    if (ATOMIC_LOAD(&palette->refs))
+        ATOMIC_ADD(&palette->refs, 1);
+
+    return palette;
+}
+
+void_t release_color_palette(color_palette_t* palette)
+{
+    if ((! ATOMIC_LOAD(&palette->refs)) || (ATOMIC_SUB(&palette->refs, 1)))
+        return;
+
+    mem_free((void_t*) palette->colors);
+    mem_free(palette);
+}
+
+const uint32_t* get_color_palette_pixels(color_palette_t* palette, bool_e rgba)
+{
+    const uint32_t* pixels = palette->pixels[(rgba) ? 1 : 0];
+
+    if (ATOMIC_LOAD(&palette->pixels_ready))
+        return pixels;
+
+    // Threads building pixels at once store same values
+    uint32_t i, colors_num = (palette->colors_num < COLORS_IN_8_BIT_TABLE) ? palette->colors_num : COLORS_IN_8_BIT_TABLE;
+
+    for (i = 0; i < COLORS_IN_8_BIT_TABLE; i ++)
+    {
+        uint32_t red   = (i < colors_num) ? palette->colors[i].red   : 0;
+        uint32_t green = (i < colors_num) ? palette->colors[i].green : 0;
+        uint32_t blue  = (i < colors_num) ? palette->colors[i].blue  : 0;
+
+        ATOMIC_STORE(&palette->pixels[0][i], 0xFF000000 | (red << 16) | (green << 8) | blue);
+        ATOMIC_STORE(&palette->pixels[1][i], 0xFF000000 | (blue << 16) | (green << 8) | red);
+    }
+
+    ATOMIC_STORE(&palette->pixels_ready, TRUE);
+
+    return pixels;
+}
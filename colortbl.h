@@ -1,36 +1,65 @@
-#ifndef __COLORTBL_H__
-#define __COLORTBL_H__
-
-#include <stdio.h>
-
-#include "inttypes.h"
-#include "platform.h"
-
-#pragma pack(1)
-typedef struct _rgb_triple_t {
-    uint8_t blue;
-    uint8_t green;
-    uint8_t red;
-} rgb_triple_t PACKED_STRUCT;
-
-typedef struct _rgb_quad_t {
-    uint8_t blue;
-    uint8_t green;
-    uint8_t red;
-    uint8_t reserved;
-} rgb_quad_t PACKED_STRUCT;
-#pragma pack()
-
-#define COLORS_IN_1_BIT_TABLE 2
-#define COLORS_IN_4_BIT_TABLE 16
-#define COLORS_IN_8_BIT_TABLE 256
-
-extern const rgb_triple_t color_table_1_bit [COLORS_IN_1_BIT_TABLE];
-extern const rgb_triple_t color_table_4_bit [COLORS_IN_4_BIT_TABLE];
-extern const rgb_triple_t color_table_8_bit [COLORS_IN_8_BIT_TABLE];
-
-uint32_t      get_colors_num         (uint32_t bit_count);
-rgb_triple_t* get_color_table_triple (uint32_t bit_count);
-rgb_quad_t*   get_color_table_quad   (uint32_t bit_count);
-
-#endif // __COLORTBL_H__
+#ifndef __COLORTBL_H__
+#define __COLORTBL_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#pragma pack(1)
+typedef struct _rgb_triple_t {
+    uint8_t blue;
+    uint8_t green;
+    uint8_t red;
+} rgb_triple_t PACKED_STRUCT;
+
+typedef struct _rgb_quad_t {
+    uint8_t blue;
+    uint8_t green;
+    uint8_t red;
+    uint8_t reserved;
+} rgb_quad_t PACKED_STRUCT;
+#pragma pack()
+
+#define COLORS_IN_1_BIT_TABLE 2
+#define COLORS_IN_4_BIT_TABLE 16
+#define COLORS_IN_8_BIT_TABLE 256
+
+extern const rgb_triple_t color_table_1_bit [COLORS_IN_1_BIT_TABLE];
+extern const rgb_triple_t color_table_4_bit [COLORS_IN_4_BIT_TABLE];
+extern const rgb_triple_t color_table_8_bit [COLORS_IN_8_BIT_TABLE];
+
+// Same colors as quads (reserved is zero), tables of default palettes
+extern const rgb_quad_t color_quads_1_bit [COLORS_IN_1_BIT_TABLE];
+extern const rgb_quad_t color_quads_4_bit [COLORS_IN_4_BIT_TABLE];
+extern const rgb_quad_t color_quads_8_bit [COLORS_IN_8_BIT_TABLE];
+
+uint32_t          get_colors_num          (uint32_t bit_count);
+const rgb_quad_t* get_color_table_default (uint32_t bit_count); // Shared read-only table, NULL without table
+rgb_triple_t*     get_color_table_triple  (uint32_t bit_count); // Copy of default table
+rgb_quad_t*       get_color_table_quad    (uint32_t bit_count); // Copy of default table
+
+// Shared palettes
+//
+// Default palettes of bit counts are static, table of file becomes palette
+// of its own (reference counted) unless it has colors of default one. Pixels
+// of palette (opaque BGRA and RGBA, indexes missing in table are black) are
+// built on first use by any thread, so expansion of indexes is single lookup
+// into them. Last release frees palette through allocator which created it
+// (see memalloc.h), whoever holds last reference and whichever one is current.
+
+typedef struct _color_palette_t {
+    const rgb_quad_t* colors;
+    uint32_t          colors_num;
+    uint32_t          refs;         // Zero for default palettes
+    bool_e            pixels_ready;
+    uint32_t          pixels [2][COLORS_IN_8_BIT_TABLE];
+} color_palette_t;
+
+color_palette_t* get_color_palette_default(uint32_t bit_count); // NULL without table
+color_palette_t* new_color_palette(rgb_quad_t* colors, uint32_t colors_num, uint32_t bit_count); // Takes colors over (freed on error too)
+color_palette_t* retain_color_palette(color_palette_t* palette);
+void_t           release_color_palette(color_palette_t* palette);
+const uint32_t*  get_color_palette_pixels(color_palette_t* palette, bool_e rgba);
+
+#endif // __COLORTBL_H__
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "cpufeat.h"
+#include "kernels.h"
+
+static const char_t* cpu_level_str [CPU_LEVEL_NUM] = {
+    "scalar",
+    "sse2",
+    "avx2",
+    "avx512"
+};
+
+static const cpu_kernels_t cpu_kernels_table [CPU_LEVEL_NUM] = {
+    { CPU_LEVEL_SCALAR, sum_words_scalar, expand_1_bit_scalar, expand_4_bit_scalar, expand_8_bit_scalar,
+                        convert_24_to_32_scalar, swap_red_blue_scalar, convert_32_to_24_scalar, convert_32_to_gray_scalar,
+                        expand_16_bit_scalar,    expand_32_bit_scalar,
+                        resample_32_scalar,      resample_8_scalar,    resample_lines_scalar,
+                        adler_32_scalar,         filter_png_line_scalar, premultiply_mask_scalar },
+#ifdef KERNELS_X86
+    // SSE2 has no byte shuffles, 24-bit lines stay scalar
+    { CPU_LEVEL_SSE2,   sum_words_sse2,   expand_1_bit_sse2,   expand_4_bit_scalar, expand_8_bit_scalar,
+                        convert_24_to_32_scalar, swap_red_blue_sse2,   convert_32_to_24_scalar, convert_32_to_gray_sse2,
+                        expand_16_bit_sse2,      expand_32_bit_sse2,
+                        resample_32_sse2,        resample_8_sse2,      resample_lines_sse2,
+                        adler_32_sse2,           filter_png_line_sse2,   premultiply_mask_sse2 },
+    { CPU_LEVEL_AVX2,   sum_words_avx2,   expand_1_bit_avx2,   expand_4_bit_avx2,   expand_8_bit_avx2,
+                        convert_24_to_32_avx2,   swap_red_blue_avx2,   convert_32_to_24_avx2,   convert_32_to_gray_avx2,
+                        expand_16_bit_avx2,      expand_32_bit_avx2,
+                        resample_32_avx2,        resample_8_avx2,      resample_lines_avx2,
+                        adler_32_avx2,           filter_png_line_avx2,   premultiply_mask_avx2 },
+    // 24-bit lines do not fit into 512-bit lanes better than into two 128-bit ones
+    { CPU_LEVEL_AVX512, sum_words_avx512, expand_1_bit_avx512, expand_4_bit_avx512, expand_8_bit_avx512,
+                        convert_24_to_32_avx2,   swap_red_blue_avx512, convert_32_to_24_avx2,   convert_32_to_gray_avx2,
+                        expand_16_bit_avx2,      expand_32_bit_avx2,
+                        resample_32_avx2,        resample_8_avx2,      resample_lines_avx2,
+                        adler_32_avx2,           filter_png_line_avx2,   premultiply_mask_avx2 }
+#endif
+};
+
+// Levels are published atomically (CPU_LEVEL_NUM until first use), detection
+// is idempotent, so concurrent first calls find same level
+static uint32_t cpu_level_supported = CPU_LEVEL_NUM;
+static uint32_t cpu_level_selected  = CPU_LEVEL_NUM;
+
+static cpu_level_e detect_cpu_level(void_t)
+{
+#ifdef KERNELS_X86
+    // Checks of AVX levels include OS support of register state (XGETBV)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return CPU_LEVEL_AVX512;
+
+    if (__builtin_cpu_supports("avx2"))
+        return CPU_LEVEL_AVX2;
+
+    if (__builtin_cpu_supports("sse2"))
+        return CPU_LEVEL_SSE2;
+#endif
+
+    return CPU_LEVEL_SCALAR;
+}
+
+static cpu_level_e get_cpu_level_env(cpu_level_e level)
+{
+    const char_t* value = getenv(CPU_LEVEL_ENV);
+    uint32_t      i;
+
+    if (! value)
+        return level;
+
+    for (i = 0; i < CPU_LEVEL_NUM; i ++)
+    {
+        if (! strcmp(value, cpu_level_str[i]))
+            return ((cpu_level_e) i < level) ? (cpu_level_e) i : level;
+    }
+
+    return level;
+}
+
+cpu_level_e get_cpu_level_supported(void_t)
+{
+    uint32_t level = ATOMIC_LOAD(&cpu_level_supported);
+
+    if (level == CPU_LEVEL_NUM)
+    {
+        level = detect_cpu_level();
+        ATOMIC_STORE(&cpu_level_supported, level);
+    }
+
+    return (cpu_level_e) level;
+}
+
+cpu_level_e get_cpu_level(void_t)
+{
+    return get_cpu_kernels()->level;
+}
+
+cpu_level_e set_cpu_level(cpu_level_e level)
+{
+    cpu_level_e supported = get_cpu_level_supported();
+
+    if (level > supported)
+        level = supported;
+
+    ATOMIC_STORE(&cpu_level_selected, level);
+
+    return level;
+}
+
+const cpu_kernels_t* get_cpu_kernels(void_t)
+{
+    uint32_t level = ATOMIC_LOAD(&cpu_level_selected);
+
+    if (level == CPU_LEVEL_NUM)
+    {
+        uint32_t expected = CPU_LEVEL_NUM;
+
+        // Level set meanwhile by set_cpu_level() is kept
+        level = get_cpu_level_env(get_cpu_level_supported());
+
+        if (! ATOMIC_EXCHANGE(&cpu_level_selected, &expected, level))
+            level = expected;
+    }
+
+    return &cpu_kernels_table[level];
+}
+
+const cpu_kernels_t* get_cpu_kernels_level(cpu_level_e level)
+{
+    return (level <= get_cpu_level_supported()) ? &cpu_kernels_table[level] : NULL;
+}
+
+const char_t* convert_cpu_level_to_text(cpu_level_e level)
+{
+    return (level < CPU_LEVEL_NUM) ? cpu_level_str[level] : NULL;
+}
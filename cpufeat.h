@@ -0,0 +1,108 @@
+#ifndef __CPUFEAT_H__
+#define __CPUFEAT_H__
+
+#include <stddef.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+// CPU feature dispatch
+//
+// Every kernel has scalar reference implementation and optional vectorized
+// ones. Table of best kernels for host CPU is selected once (on first use).
+// Level can be lowered by environment variable RESOURCE_CPU_LEVEL
+// (scalar, sse2, avx2, avx512) or by set_cpu_level(), never raised above
+// level supported by CPU and OS. Selection is published atomically, so any
+// thread can call set_cpu_level() while others decode: running operations
+// (and converters, resamplers) keep table they took, all levels give same
+// results.
+
+#define CPU_LEVEL_ENV "RESOURCE_CPU_LEVEL"
+
+typedef enum _cpu_level_e {
+    CPU_LEVEL_SCALAR,
+    CPU_LEVEL_SSE2,
+    CPU_LEVEL_AVX2,
+    CPU_LEVEL_AVX512, // AVX-512 F and BW
+    CPU_LEVEL_NUM
+} cpu_level_e;
+
+// Channels of 16-bit or 32-bit pixels with color masks, prepared once per
+// image (see pixconv.h). Channel is taken by shift and limit, then scaled to
+// 8 bits by multiply and shift (low bits repeat high ones). Channels are in
+// order of 32-bit BGRA pixel: blue, green, red, alpha.
+typedef struct _bitfields_t {
+    uint32_t shift       [4];
+    uint32_t limit       [4];   // Up to 0xFF, zero for missing channel
+    uint32_t scale       [4];
+    uint32_t scale_shift [4];
+    uint32_t alpha;             // 0xFF000000 if there is no alpha channel
+} bitfields_t;
+
+// Taps of resampling filter (see resample.h), prepared once per dimension.
+// Every target pixel has same number of taps starting at its first source
+// pixel, weights are fixed point (RESAMPLE_WEIGHT_BITS) and sum to one.
+#define RESAMPLE_WEIGHT_BITS 14
+
+typedef struct _resample_taps_t {
+    uint32_t  taps;
+    uint32_t* first;    // Per target pixel
+    sint16_t* weights;  // Taps per target pixel
+} resample_taps_t;
+
+// PNG filter types (none, sub, up, average, Paeth)
+#define PNG_FILTER_NUM 5
+
+typedef struct _cpu_kernels_t {
+    cpu_level_e level;
+
+    // Sum of little-endian 16-bit words (size is even)
+    uint16_t (*sum_words)(const uint8_t* data, size_t size);
+
+    // Expansion of indexed pixels (most significant bits first) to 32-bit
+    // palette entries. Palette must have entries for every index of bit count.
+    void_t (*expand_1_bit)(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+    void_t (*expand_4_bit)(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+    void_t (*expand_8_bit)(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+
+    // Pixel conversions of 32-bit BGRA (rgb_quad_t) lines. Source and
+    // destination of swap can be same line.
+    void_t (*convert_24_to_32)(const uint8_t* src, uint32_t* dst, uint32_t width);      // BGR to BGRA (opaque)
+    void_t (*swap_red_blue)(const uint32_t* src, uint32_t* dst, uint32_t width);        // BGRA to RGBA
+    void_t (*convert_32_to_24)(const uint32_t* src, uint8_t* dst, uint32_t width);      // BGRA to RGB
+    void_t (*convert_32_to_gray)(const uint32_t* src, uint8_t* dst, uint32_t width);    // BGRA to luma (see kernels.h)
+
+    // Expansion of little-endian 16-bit or 32-bit pixels with color masks to BGRA
+    void_t (*expand_16_bit)(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+    void_t (*expand_32_bit)(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+
+    // Resampling of line of 32-bit pixels (channels alike) or 8-bit ones to
+    // width pixels, then of bytes (size) of taps lines into single line.
+    // Results are rounded and saturated to bytes.
+    void_t (*resample_32)(const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps);
+    void_t (*resample_8)(const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps);
+    void_t (*resample_lines)(const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size);
+
+    // Adler-32 of bytes (running value of zlib stream)
+    uint32_t (*adler_32)(uint32_t adler, const uint8_t* data, size_t size);
+
+    // PNG filters sub, up, average and Paeth of line against prior one (zero
+    // line above first one), bpp is bytes per pixel (at least one). Filtered
+    // lines go to four buffers of size, costs of all filters (none first) are
+    // sums of filtered bytes taken as signed.
+    void_t (*filter_png_line)(const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs);
+
+    // Icon compositing of 32-bit pixels in place: alpha is cleared under set
+    // bits of AND mask (most significant bit first, NULL keeps alpha), then
+    // color channels are multiplied by alpha (rounded).
+    void_t (*premultiply_mask)(uint32_t* pixels, const uint8_t* mask, uint32_t width);
+} cpu_kernels_t;
+
+cpu_level_e          get_cpu_level_supported(void_t);
+cpu_level_e          get_cpu_level(void_t);
+cpu_level_e          set_cpu_level(cpu_level_e level); // Returns selected level
+const cpu_kernels_t* get_cpu_kernels(void_t);
+const cpu_kernels_t* get_cpu_kernels_level(cpu_level_e level); // NULL if level is not supported
+const char_t*        convert_cpu_level_to_text(cpu_level_e level);
+
+#endif // __CPUFEAT_H__
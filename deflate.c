@@ -0,0 +1,879 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "stats.h"
+#include "checksum.h"
+
+#include "deflate.h"
+
+#define DEFLATE_MATCH_MIN       3
+#define DEFLATE_MATCH_MAX       258
+#define DEFLATE_LOOKAHEAD       (DEFLATE_MATCH_MAX + 1) // Bytes after position kept for matching (next position is tried too)
+#define DEFLATE_TOO_FAR         0x1000                  // Shortest matches farther are not worth their distance
+#define DEFLATE_FAST_INSERT_MAX 16                      // Longer matches of fast level are not hashed inside
+#define DEFLATE_NONE            0xFFFFFFFF
+#define DEFLATE_END_OF_BLOCK    256
+#define DEFLATE_LITERALS        286
+#define DEFLATE_LITERAL_CODES   288                     // Fixed code has two more (unused) literals
+#define DEFLATE_DISTANCES       30
+#define DEFLATE_CODE_LENGTHS    19
+#define DEFLATE_BITS_MAX        15
+#define DEFLATE_CODE_BITS_MAX   7
+#define DEFLATE_STORED_MAX      0xFFFF
+
+static const char_t* deflate_level_str [DEFLATE_LEVEL_NUM] = {
+    "store",
+    "fast",
+    "default"
+};
+
+static const uint32_t deflate_chains [DEFLATE_LEVEL_NUM] = { 0, 4,  64  };
+static const uint32_t deflate_nices  [DEFLATE_LEVEL_NUM] = { 0, 32, 128 };
+
+// Order of code lengths of code length alphabet in header of dynamic block
+static const uint8_t code_length_order [DEFLATE_CODE_LENGTHS] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// Codes of lengths and distances
+//
+// Lengths 3..258 and distances 1..32768 have codes of 0..28 (after end of
+// block) and 0..29, every code above first four (eight for lengths) covers
+// twice as many values as two codes below it.
+
+static inline uint32_t get_highest_bit(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+
+    _BitScanReverse(&index, value);
+
+    return (uint32_t) index;
+#else
+    return 31 - (uint32_t) __builtin_clz(value);
+#endif
+}
+
+static inline uint32_t get_length_code(uint32_t length)
+{
+    uint32_t value = length - DEFLATE_MATCH_MIN;
+
+    if (length == DEFLATE_MATCH_MAX)
+        return 28;
+
+    if (value < 8)
+        return value;
+
+    uint32_t bits = get_highest_bit(value);
+
+    return 4 * (bits - 1) + ((value >> (bits - 2)) & 3);
+}
+
+static inline uint32_t get_length_extra(uint32_t code)
+{
+    return ((code < 8) || (code == 28)) ? 0 : code / 4 - 1;
+}
+
+static inline uint32_t get_length_base(uint32_t code)
+{
+    return (code < 8) ? code : (code == 28) ? DEFLATE_MATCH_MAX - DEFLATE_MATCH_MIN : (4 + (code & 3)) << (code / 4 - 1);
+}
+
+static inline uint32_t get_distance_code(uint32_t distance)
+{
+    uint32_t value = distance - 1;
+
+    if (value < 4)
+        return value;
+
+    uint32_t bits = get_highest_bit(value);
+
+    return 2 * bits + ((value >> (bits - 1)) & 1);
+}
+
+static inline uint32_t get_distance_extra(uint32_t code)
+{
+    return (code < 4) ? 0 : code / 2 - 1;
+}
+
+static inline uint32_t get_distance_base(uint32_t code)
+{
+    return (code < 4) ? code : (2 + (code & 1)) << (code / 2 - 1);
+}
+
+// Huffman codes
+
+static sint_t compare_keys(const void_t* first, const void_t* second)
+{
+    uint64_t a = *(const uint64_t*) first;
+    uint64_t b = *(const uint64_t*) second;
+
+    return (a < b) ? -1 : (a > b) ? 1 : 0;
+}
+
+// Code lengths of counts (zero for unused symbols) limited to bits_max. Tree
+// is merged from leaves sorted by count and queue of inner nodes (which come
+// in order of their counts), counts are halved until tree fits.
+static void_t build_lengths(const uint32_t* counts, uint32_t num, uint32_t bits_max, uint8_t* lengths)
+{
+    uint64_t keys    [DEFLATE_LITERALS];
+    uint32_t scaled  [DEFLATE_LITERALS];
+    uint32_t weights [DEFLATE_LITERALS * 2];
+    uint32_t parents [DEFLATE_LITERALS * 2];
+    uint32_t depths  [DEFLATE_LITERALS * 2];
+    uint32_t i, used = 0;
+
+    memset(lengths, 0, num);
+
+    for (i = 0; i < num; i ++)
+    {
+        scaled[i] = counts[i];
+
+        if (counts[i])
+            used ++;
+    }
+
+    // Single code has one bit
+    if (used < 2)
+    {
+        for (i = 0; i < num; i ++)
+        {
+            if (counts[i])
+                lengths[i] = 1;
+        }
+
+        return;
+    }
+
+    for (;;)
+    {
+        uint32_t leaf = 0, inner = used, next = used, depth_max = 0;
+
+        for (i = 0, used = 0; i < num; i ++)
+        {
+            if (scaled[i])
+                keys[used ++] = ((uint64_t) scaled[i] << 16) | i;
+        }
+
+        qsort(keys, used, sizeof(uint64_t), compare_keys);
+
+        for (i = 0; i < used; i ++)
+            weights[i] = (uint32_t) (keys[i] >> 16);
+
+        for ( ; next < used * 2 - 1; next ++)
+        {
+            uint32_t pair [2];
+
+            for (i = 0; i < 2; i ++)
+            {
+                if ((leaf < used) && ((inner == next) || (weights[leaf] <= weights[inner])))
+                    pair[i] = leaf ++;
+                else
+                    pair[i] = inner ++;
+            }
+
+            weights[next]    = weights[pair[0]] + weights[pair[1]];
+            parents[pair[0]] = next;
+            parents[pair[1]] = next;
+        }
+
+        // Parents come after children
+        depths[next - 1] = 0;
+
+        for (i = next - 1; i --; )
+        {
+            depths[i] = depths[parents[i]] + 1;
+
+            if ((i < used) && (depths[i] > depth_max))
+                depth_max = depths[i];
+        }
+
+        if (depth_max <= bits_max)
+        {
+            for (i = 0; i < used; i ++)
+                lengths[keys[i] & 0xFFFF] = (uint8_t) depths[i];
+
+            return;
+        }
+
+        for (i = 0; i < num; i ++)
+        {
+            if (scaled[i])
+                scaled[i] = (scaled[i] >> 1) | 1;
+        }
+    }
+}
+
+// Canonical codes with bits reversed (output is written from lowest bit)
+static void_t build_codes(const uint8_t* lengths, uint32_t num, uint16_t* codes)
+{
+    uint32_t counts [DEFLATE_BITS_MAX + 1] = { 0 };
+    uint32_t next   [DEFLATE_BITS_MAX + 1];
+    uint32_t i, bits, code = 0;
+
+    for (i = 0; i < num; i ++)
+        counts[lengths[i]] ++;
+
+    counts[0] = 0;
+
+    for (bits = 1; bits <= DEFLATE_BITS_MAX; bits ++)
+    {
+        code       = (code + counts[bits - 1]) << 1;
+        next[bits] = code;
+    }
+
+    for (i = 0; i < num; i ++)
+    {
+        uint32_t reversed = 0;
+
+        if (! lengths[i])
+            continue;
+
+        for (code = next[lengths[i]] ++, bits = 0; bits < lengths[i]; bits ++, code >>= 1)
+            reversed = (reversed << 1) | (code & 1);
+
+        codes[i] = (uint16_t) reversed;
+    }
+}
+
+static void_t fill_fixed_lengths(uint8_t* literal_lengths, uint8_t* distance_lengths)
+{
+    uint32_t i;
+
+    for (i = 0; i < DEFLATE_LITERAL_CODES; i ++)
+        literal_lengths[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+
+    for (i = 0; i < DEFLATE_DISTANCES; i ++)
+        distance_lengths[i] = 5;
+}
+
+// Output
+
+static void_t emit_output(deflate_t* deflate)
+{
+    if ((deflate->output_used) && (deflate->state == DEFLATE_DATA))
+    {
+        if (deflate->callback(deflate->context, deflate->output, deflate->output_used) != 0)
+            deflate->state = DEFLATE_ERROR;
+    }
+
+    deflate->output_used = 0;
+}
+
+static inline void_t put_bits(deflate_t* deflate, uint32_t value, uint32_t count)
+{
+    deflate->bits     |= (uint64_t) value << deflate->bits_num;
+    deflate->bits_num += count;
+
+    if (deflate->bits_num >= 32)
+    {
+        uint8_t* output = deflate->output + deflate->output_used;
+
+        output[0] = (uint8_t) deflate->bits;
+        output[1] = (uint8_t) (deflate->bits >> 8);
+        output[2] = (uint8_t) (deflate->bits >> 16);
+        output[3] = (uint8_t) (deflate->bits >> 24);
+
+        deflate->bits         >>= 32;
+        deflate->bits_num      -= 32;
+        deflate->output_used   += 4;
+
+        if (deflate->output_used >= DEFLATE_OUTPUT_SIZE)
+            emit_output(deflate);
+    }
+}
+
+// Bits are padded to byte and written out
+static void_t align_bits(deflate_t* deflate)
+{
+    for ( ; deflate->bits_num; deflate->bits >>= 8, deflate->bits_num = (deflate->bits_num > 8) ? deflate->bits_num - 8 : 0)
+    {
+        deflate->output[deflate->output_used ++] = (uint8_t) deflate->bits;
+
+        if (deflate->output_used >= DEFLATE_OUTPUT_SIZE)
+            emit_output(deflate);
+    }
+
+    deflate->bits = 0;
+}
+
+static void_t put_bytes(deflate_t* deflate, const uint8_t* data, uint32_t size)
+{
+    while (size)
+    {
+        uint32_t part = DEFLATE_OUTPUT_SIZE - deflate->output_used;
+
+        part = (size < part) ? size : part;
+
+        memcpy(deflate->output + deflate->output_used, data, part);
+
+        deflate->output_used += part;
+        data                 += part;
+        size                 -= part;
+
+        if (deflate->output_used >= DEFLATE_OUTPUT_SIZE)
+            emit_output(deflate);
+    }
+}
+
+// Blocks
+
+static uint64_t calc_symbols_cost(deflate_t* deflate, const uint8_t* literal_lengths, const uint8_t* distance_lengths)
+{
+    uint64_t cost = 0;
+    uint32_t i;
+
+    for (i = 0; i < DEFLATE_LITERALS; i ++)
+        cost += (uint64_t) deflate->literal_counts[i] * (literal_lengths[i] + ((i > DEFLATE_END_OF_BLOCK) ? get_length_extra(i - DEFLATE_END_OF_BLOCK - 1) : 0));
+
+    for (i = 0; i < DEFLATE_DISTANCES; i ++)
+        cost += (uint64_t) deflate->distance_counts[i] * (distance_lengths[i] + get_distance_extra(i));
+
+    return cost;
+}
+
+static void_t put_symbols(deflate_t* deflate, const uint8_t* literal_lengths, const uint8_t* distance_lengths)
+{
+    uint16_t literal_codes  [DEFLATE_LITERAL_CODES];
+    uint16_t distance_codes [DEFLATE_DISTANCES];
+    uint32_t i;
+
+    build_codes(literal_lengths,  DEFLATE_LITERAL_CODES, literal_codes);
+    build_codes(distance_lengths, DEFLATE_DISTANCES, distance_codes);
+
+    for (i = 0; i < deflate->symbols_num; i ++)
+    {
+        uint32_t length   = deflate->lengths[i];
+        uint32_t distance = deflate->distances[i];
+
+        if (! distance)
+        {
+            put_bits(deflate, literal_codes[length], literal_lengths[length]);
+            continue;
+        }
+
+        uint32_t code = get_length_code(length);
+
+        put_bits(deflate, literal_codes[DEFLATE_END_OF_BLOCK + 1 + code], literal_lengths[DEFLATE_END_OF_BLOCK + 1 + code]);
+        put_bits(deflate, length - DEFLATE_MATCH_MIN - get_length_base(code), get_length_extra(code));
+
+        code = get_distance_code(distance);
+
+        put_bits(deflate, distance_codes[code], distance_lengths[code]);
+        put_bits(deflate, distance - 1 - get_distance_base(code), get_distance_extra(code));
+    }
+
+    put_bits(deflate, literal_codes[DEFLATE_END_OF_BLOCK], literal_lengths[DEFLATE_END_OF_BLOCK]);
+}
+
+static void_t put_stored(deflate_t* deflate, bool_e final)
+{
+    const uint8_t* data = deflate->window + deflate->block_start;
+    uint32_t       size = deflate->position - deflate->block_start;
+
+    // Empty last block is stored too
+    do
+    {
+        uint32_t part = (size < DEFLATE_STORED_MAX) ? size : DEFLATE_STORED_MAX;
+
+        put_bits(deflate, ((final) && (part == size)) ? 1 : 0, 3);
+        align_bits(deflate);
+        put_bits(deflate, part, 16);
+        put_bits(deflate, part ^ 0xFFFF, 16);
+        put_bytes(deflate, data, part);
+
+        data += part;
+        size -= part;
+    }
+    while (size);
+}
+
+// Code lengths of both alphabets run-length encoded (16 repeats previous
+// length, 17 and 18 repeat zero), codes of them go to header
+typedef struct _deflate_header_t {
+    uint32_t literals_num;
+    uint32_t distances_num;
+    uint32_t code_lengths_num;
+    uint8_t  symbols [DEFLATE_LITERALS + DEFLATE_DISTANCES];
+    uint8_t  extras  [DEFLATE_LITERALS + DEFLATE_DISTANCES];
+    uint32_t symbols_num;
+    uint32_t counts  [DEFLATE_CODE_LENGTHS];
+    uint8_t  lengths [DEFLATE_CODE_LENGTHS];
+} deflate_header_t;
+
+static uint64_t calc_header(deflate_header_t* header, const uint8_t* literal_lengths, const uint8_t* distance_lengths)
+{
+    uint8_t  sequence [DEFLATE_LITERALS + DEFLATE_DISTANCES];
+    uint32_t i, run, num;
+    uint64_t cost;
+
+    for (header->literals_num  = DEFLATE_LITERALS;  (header->literals_num  > 257) && (! literal_lengths[header->literals_num - 1]);   header->literals_num --);
+    for (header->distances_num = DEFLATE_DISTANCES; (header->distances_num > 1)   && (! distance_lengths[header->distances_num - 1]); header->distances_num --);
+
+    num = header->literals_num + header->distances_num;
+
+    memcpy(sequence, literal_lengths, header->literals_num);
+    memcpy(sequence + header->literals_num, distance_lengths, header->distances_num);
+    memset(header->counts, 0, sizeof(header->counts));
+
+    header->symbols_num = 0;
+
+    for (i = 0; i < num; i += run)
+    {
+        uint8_t symbol = sequence[i];
+
+        for (run = 1; (i + run < num) && (sequence[i + run] == symbol); run ++);
+
+        if ((! symbol) && (run >= 3))
+        {
+            run = (run < 138) ? run : 138;
+
+            header->symbols[header->symbols_num] = (run < 11) ? 17 : 18;
+            header->extras[header->symbols_num]  = (uint8_t) ((run < 11) ? run - 3 : run - 11);
+        }
+        else if ((symbol) && (i) && (sequence[i - 1] == symbol) && (run >= 3))
+        {
+            run = (run < 6) ? run : 6;
+
+            header->symbols[header->symbols_num] = 16;
+            header->extras[header->symbols_num]  = (uint8_t) (run - 3);
+        }
+        else
+        {
+            run = 1;
+
+            header->symbols[header->symbols_num] = symbol;
+            header->extras[header->symbols_num]  = 0;
+        }
+
+        header->counts[header->symbols[header->symbols_num ++]] ++;
+    }
+
+    build_lengths(header->counts, DEFLATE_CODE_LENGTHS, DEFLATE_CODE_BITS_MAX, header->lengths);
+
+    for (header->code_lengths_num = DEFLATE_CODE_LENGTHS; (header->code_lengths_num > 4) && (! header->lengths[code_length_order[header->code_lengths_num - 1]]); header->code_lengths_num --);
+
+    cost = 5 + 5 + 4 + 3 * header->code_lengths_num;
+
+    for (i = 0; i < DEFLATE_CODE_LENGTHS; i ++)
+        cost += (uint64_t) header->counts[i] * (header->lengths[i] + ((i == 16) ? 2 : (i == 17) ? 3 : (i == 18) ? 7 : 0));
+
+    return cost;
+}
+
+static void_t put_header(deflate_t* deflate, const deflate_header_t* header)
+{
+    uint16_t codes [DEFLATE_CODE_LENGTHS];
+    uint32_t i;
+
+    build_codes(header->lengths, DEFLATE_CODE_LENGTHS, codes);
+
+    put_bits(deflate, header->literals_num - 257, 5);
+    put_bits(deflate, header->distances_num - 1, 5);
+    put_bits(deflate, header->code_lengths_num - 4, 4);
+
+    for (i = 0; i < header->code_lengths_num; i ++)
+        put_bits(deflate, header->lengths[code_length_order[i]], 3);
+
+    for (i = 0; i < header->symbols_num; i ++)
+    {
+        uint32_t symbol = header->symbols[i];
+
+        put_bits(deflate, codes[symbol], header->lengths[symbol]);
+
+        if (symbol >= 16)
+            put_bits(deflate, header->extras[i], (symbol == 16) ? 2 : (symbol == 17) ? 3 : 7);
+    }
+}
+
+// Smallest of stored, fixed and dynamic block (stored one is possible while
+// its bytes are in window)
+static void_t put_block(deflate_t* deflate, bool_e final)
+{
+    uint32_t bytes = deflate->position - deflate->block_start;
+
+    if ((! bytes) && (! final))
+        return;
+
+    if (deflate->level == DEFLATE_STORE)
+    {
+        put_stored(deflate, final);
+    }
+    else
+    {
+        uint8_t          fixed_literals  [DEFLATE_LITERAL_CODES];
+        uint8_t          fixed_distances [DEFLATE_DISTANCES];
+        uint8_t          literal_lengths  [DEFLATE_LITERAL_CODES] = { 0 };
+        uint8_t          distance_lengths [DEFLATE_DISTANCES];
+        deflate_header_t header;
+
+        deflate->literal_counts[DEFLATE_END_OF_BLOCK] = 1;
+
+        fill_fixed_lengths(fixed_literals, fixed_distances);
+        build_lengths(deflate->literal_counts,  DEFLATE_LITERALS,  DEFLATE_BITS_MAX, literal_lengths);
+        build_lengths(deflate->distance_counts, DEFLATE_DISTANCES, DEFLATE_BITS_MAX, distance_lengths);
+
+        // Block without matches still describes one distance code
+        uint32_t i;
+        for (i = 0; (i < DEFLATE_DISTANCES) && (! distance_lengths[i]); i ++);
+
+        if (i == DEFLATE_DISTANCES)
+            distance_lengths[0] = 1;
+
+        uint64_t stored_cost  = 3 + 7 + (uint64_t) 40 * (bytes / DEFLATE_STORED_MAX + 1) + (uint64_t) bytes * 8;
+        uint64_t fixed_cost   = 3 + calc_symbols_cost(deflate, fixed_literals, fixed_distances);
+        uint64_t dynamic_cost = 3 + calc_header(&header, literal_lengths, distance_lengths) + calc_symbols_cost(deflate, literal_lengths, distance_lengths);
+
+        if ((stored_cost <= fixed_cost) && (stored_cost <= dynamic_cost))
+        {
+            put_stored(deflate, final);
+        }
+        else if (fixed_cost <= dynamic_cost)
+        {
+            put_bits(deflate, (final) ? 3 : 2, 3);
+            put_symbols(deflate, fixed_literals, fixed_distances);
+        }
+        else
+        {
+            put_bits(deflate, (final) ? 5 : 4, 3);
+            put_header(deflate, &header);
+            put_symbols(deflate, literal_lengths, distance_lengths);
+        }
+    }
+
+    memset(deflate->literal_counts,  0, sizeof(deflate->literal_counts));
+    memset(deflate->distance_counts, 0, sizeof(deflate->distance_counts));
+
+    deflate->symbols_num = 0;
+    deflate->block_start = deflate->position;
+}
+
+// Matching
+
+static inline uint32_t get_hash(const uint8_t* data)
+{
+    uint32_t value = (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16);
+
+    return (value * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+// Positions before end (which have three bytes in window) are chained
+static void_t insert_hashes(deflate_t* deflate, uint32_t end)
+{
+    for ( ; (deflate->inserted < end) && (deflate->inserted + DEFLATE_MATCH_MIN <= deflate->used); deflate->inserted ++)
+    {
+        uint32_t hash = get_hash(deflate->window + deflate->inserted);
+
+        deflate->prev[deflate->inserted & (DEFLATE_WINDOW_SIZE - 1)] = deflate->head[hash];
+        deflate->head[hash]                                          = deflate->inserted;
+    }
+}
+
+static inline uint32_t get_match_length(const uint8_t* match, const uint8_t* current, uint32_t limit)
+{
+    uint32_t length = 0;
+
+    // Words first, then bytes of first different one
+    for ( ; length + 8 <= limit; length += 8)
+    {
+        uint64_t a, b;
+
+        memcpy(&a, match + length, sizeof(a));
+        memcpy(&b, current + length, sizeof(b));
+
+        if (a != b)
+            break;
+    }
+
+    for ( ; (length < limit) && (match[length] == current[length]); length ++);
+
+    return length;
+}
+
+// Longest match of position among chained ones (zero if none)
+static uint32_t find_match(deflate_t* deflate, uint32_t position, uint32_t* distance)
+{
+    uint32_t limit = deflate->used - position;
+
+    if (limit < DEFLATE_MATCH_MIN)
+        return 0;
+
+    limit = (limit < DEFLATE_MATCH_MAX) ? limit : DEFLATE_MATCH_MAX;
+
+    insert_hashes(deflate, position + 1);
+
+    const uint8_t* current   = deflate->window + position;
+    uint32_t       candidate = deflate->prev[position & (DEFLATE_WINDOW_SIZE - 1)];
+    uint32_t       chain     = deflate->chain;
+    uint32_t       best      = DEFLATE_MATCH_MIN - 1;
+
+    while ((candidate < position) && (position - candidate <= DEFLATE_WINDOW_SIZE) && (chain --))
+    {
+        const uint8_t* match = deflate->window + candidate;
+
+        if ((match[best] == current[best]) && (match[0] == current[0]) && (match[1] == current[1]))
+        {
+            uint32_t length = get_match_length(match, current, limit);
+
+            if (length > best)
+            {
+                best      = length;
+                *distance = position - candidate;
+
+                if ((length >= deflate->nice) || (length == limit))
+                    break;
+            }
+        }
+
+        // Slot of older position can hold newer one
+        uint32_t next = deflate->prev[candidate & (DEFLATE_WINDOW_SIZE - 1)];
+
+        if (next >= candidate)
+            break;
+
+        candidate = next;
+    }
+
+    if ((best < DEFLATE_MATCH_MIN) || ((best == DEFLATE_MATCH_MIN) && (*distance > DEFLATE_TOO_FAR)))
+        return 0;
+
+    return best;
+}
+
+static inline void_t add_literal(deflate_t* deflate, uint8_t literal)
+{
+    deflate->lengths[deflate->symbols_num]     = literal;
+    deflate->distances[deflate->symbols_num ++] = 0;
+    deflate->literal_counts[literal] ++;
+}
+
+static inline void_t add_match(deflate_t* deflate, uint32_t length, uint32_t distance)
+{
+    deflate->lengths[deflate->symbols_num]     = (uint16_t) length;
+    deflate->distances[deflate->symbols_num ++] = (uint16_t) distance;
+    deflate->literal_counts[DEFLATE_END_OF_BLOCK + 1 + get_length_code(length)] ++;
+    deflate->distance_counts[get_distance_code(distance)] ++;
+}
+
+// Bytes are encoded while enough of them follow (all of them at end)
+static void_t encode_window(deflate_t* deflate, bool_e final)
+{
+    uint32_t limit = (final) ? deflate->used : (deflate->used > DEFLATE_LOOKAHEAD) ? deflate->used - DEFLATE_LOOKAHEAD : 0;
+
+    if (deflate->level == DEFLATE_STORE)
+    {
+        deflate->position = (deflate->position > limit) ? deflate->position : limit;
+        return;
+    }
+
+    while ((deflate->position < limit) && (deflate->state == DEFLATE_DATA))
+    {
+        uint32_t position = deflate->position;
+        uint32_t distance = 0;
+
+        // Room for literal and match
+        if (deflate->symbols_num + 2 > DEFLATE_SYMBOLS_MAX)
+            put_block(deflate, FALSE);
+
+        uint32_t length = find_match(deflate, position, &distance);
+
+        // Lazy matching: longer match of next position wins over this one
+        if ((length) && (deflate->level == DEFLATE_DEFAULT) && (length < deflate->nice))
+        {
+            uint32_t next_distance = 0;
+            uint32_t next_length   = find_match(deflate, position + 1, &next_distance);
+
+            if (next_length > length)
+            {
+                add_literal(deflate, deflate->window[position ++]);
+
+                length   = next_length;
+                distance = next_distance;
+            }
+        }
+
+        if (length)
+        {
+            add_match(deflate, length, distance);
+
+            if ((deflate->level == DEFLATE_FAST) && (length > DEFLATE_FAST_INSERT_MAX))
+                deflate->inserted = position + length;
+
+            deflate->position = position + length;
+        }
+        else
+        {
+            add_literal(deflate, deflate->window[position]);
+
+            deflate->position = position + 1;
+        }
+    }
+}
+
+// Upper half of window becomes lower one, block is finished first (its bytes
+// leave window)
+static void_t slide_window(deflate_t* deflate)
+{
+    uint32_t i;
+
+    put_block(deflate, FALSE);
+
+    memmove(deflate->window, deflate->window + DEFLATE_WINDOW_SIZE, DEFLATE_WINDOW_SIZE);
+
+    deflate->used        -= DEFLATE_WINDOW_SIZE;
+    deflate->position    -= DEFLATE_WINDOW_SIZE;
+    deflate->block_start -= DEFLATE_WINDOW_SIZE;
+    deflate->inserted     = (deflate->inserted > DEFLATE_WINDOW_SIZE) ? deflate->inserted - DEFLATE_WINDOW_SIZE : 0;
+
+    // Stored level has no chains
+    if (! deflate->head)
+        return;
+
+    for (i = 0; i < (1 << DEFLATE_HASH_BITS); i ++)
+        deflate->head[i] = ((deflate->head[i] != DEFLATE_NONE) && (deflate->head[i] >= DEFLATE_WINDOW_SIZE)) ? deflate->head[i] - DEFLATE_WINDOW_SIZE : DEFLATE_NONE;
+
+    for (i = 0; i < DEFLATE_WINDOW_SIZE; i ++)
+        deflate->prev[i] = ((deflate->prev[i] != DEFLATE_NONE) && (deflate->prev[i] >= DEFLATE_WINDOW_SIZE)) ? deflate->prev[i] - DEFLATE_WINDOW_SIZE : DEFLATE_NONE;
+}
+
+// Deflater
+
+deflate_t* new_deflate(deflate_level_e level, deflate_callback_t callback, void_t* context)
+{
+    if ((level >= DEFLATE_LEVEL_NUM) || (! callback))
+        return NULL;
+
+    deflate_t* deflate = (deflate_t*) mem_calloc(1, sizeof(deflate_t));
+
+    if (! deflate)
+        return NULL;
+
+    deflate->state     = DEFLATE_DATA;
+    deflate->level     = level;
+    deflate->chain     = deflate_chains[level];
+    deflate->nice      = deflate_nices[level];
+    deflate->adler     = 1;
+    deflate->callback  = callback;
+    deflate->context   = context;
+    deflate->window    = (uint8_t*) mem_alloc(DEFLATE_WINDOW_SIZE * 2);
+    deflate->output    = (uint8_t*) mem_alloc(DEFLATE_OUTPUT_SIZE + 4);
+
+    if (level != DEFLATE_STORE)
+    {
+        deflate->head      = (uint32_t*) mem_alloc(sizeof(uint32_t) * (1 << DEFLATE_HASH_BITS));
+        deflate->prev      = (uint32_t*) mem_alloc(sizeof(uint32_t) * DEFLATE_WINDOW_SIZE);
+        deflate->lengths   = (uint16_t*) mem_alloc(sizeof(uint16_t) * DEFLATE_SYMBOLS_MAX);
+        deflate->distances = (uint16_t*) mem_alloc(sizeof(uint16_t) * DEFLATE_SYMBOLS_MAX);
+
+        if ((! deflate->head) || (! deflate->prev) || (! deflate->lengths) || (! deflate->distances))
+        {
+            del_deflate(deflate);
+            return NULL;
+        }
+
+        memset(deflate->head, 0xFF, sizeof(uint32_t) * (1 << DEFLATE_HASH_BITS));
+        memset(deflate->prev, 0xFF, sizeof(uint32_t) * DEFLATE_WINDOW_SIZE);
+    }
+
+    if ((! deflate->window) || (! deflate->output))
+    {
+        del_deflate(deflate);
+        return NULL;
+    }
+
+    // Header of zlib stream: deflate with 32K window, level hint, check bits
+    deflate->output[0]   = 0x78;
+    deflate->output[1]   = (level == DEFLATE_DEFAULT) ? 0x9C : 0x01;
+    deflate->output_used = 2;
+
+    return deflate;
+}
+
+sint_t put_deflate(deflate_t* deflate, const void_t* data, uint32_t size)
+{
+    STATS_SCOPE(STATS_PUT_DEFLATE);
+
+    if ((! deflate) || ((! data) && (size)) || (deflate->state != DEFLATE_DATA))
+        return -1;
+
+    const uint8_t* bytes = (const uint8_t*) data;
+
+    deflate->adler = calc_adler32(deflate->adler, data, size);
+
+    while ((size) && (deflate->state == DEFLATE_DATA))
+    {
+        if (deflate->used == DEFLATE_WINDOW_SIZE * 2)
+            slide_window(deflate);
+
+        uint32_t part = DEFLATE_WINDOW_SIZE * 2 - deflate->used;
+
+        part = (size < part) ? size : part;
+
+        memcpy(deflate->window + deflate->used, bytes, part);
+
+        deflate->used += part;
+        bytes         += part;
+        size          -= part;
+
+        encode_window(deflate, FALSE);
+    }
+
+    return (deflate->state == DEFLATE_DATA) ? 0 : -1;
+}
+
+sint_t end_deflate(deflate_t* deflate)
+{
+    if ((! deflate) || (deflate->state != DEFLATE_DATA))
+        return -1;
+
+    encode_window(deflate, TRUE);
+    put_block(deflate, TRUE);
+    align_bits(deflate);
+
+    uint8_t adler [4] = {
+        (uint8_t) (deflate->adler >> 24),
+        (uint8_t) (deflate->adler >> 16),
+        (uint8_t) (deflate->adler >> 8),
+        (uint8_t) deflate->adler
+    };
+
+    put_bytes(deflate, adler, sizeof(adler));
+    emit_output(deflate);
+
+    if (deflate->state != DEFLATE_DATA)
+        return -1;
+
+    deflate->state = DEFLATE_DONE;
+
+    return 0;
+}
+
+void_t del_deflate(deflate_t* deflate)
+{
+    if (! deflate)
+        return;
+
+    if (deflate->window)
+        mem_free(deflate->window);
+    if (deflate->output)
+        mem_free(deflate->output);
+    if (deflate->head)
+        mem_free(deflate->head);
+    if (deflate->prev)
+        mem_free(deflate->prev);
+    if (deflate->lengths)
+        mem_free(deflate->lengths);
+    if (deflate->distances)
+        mem_free(deflate->distances);
+
+    mem_free(deflate);
+}
+
+const char_t* convert_deflate_level_to_text(deflate_level_e level)
+{
+    return (level < DEFLATE_LEVEL_NUM) ? deflate_level_str[level] : NULL;
+}
@@ -0,0 +1,76 @@
+#ifndef __DEFLATE_H__
+#define __DEFLATE_H__
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Deflate compression into zlib stream (RFC 1950, RFC 1951)
+//
+// Data is put in parts of any size and comes out through callback in parts of
+// up to DEFLATE_OUTPUT_SIZE bytes, stream is finished by end_deflate() (last
+// block and Adler-32 of data). Input is kept in window of twice the distance
+// limit, matches are found through hash chains of three bytes.
+//
+// Every block is written as the smallest of stored, fixed Huffman and dynamic
+// Huffman ones (code lengths are limited by rescaling counts). Levels:
+//   DEFLATE_STORE   : stored blocks only (no matching)
+//   DEFLATE_FAST    : few candidates per position, no lazy matching, long
+//                     matches are not hashed inside (throughput over ratio)
+//   DEFLATE_DEFAULT : longer chains and lazy matching of next position
+//
+// Nonzero result of callback stops deflater with error.
+
+#define DEFLATE_WINDOW_SIZE 0x8000
+#define DEFLATE_OUTPUT_SIZE 0x8000
+#define DEFLATE_HASH_BITS   15
+#define DEFLATE_SYMBOLS_MAX 0x4000  // Matches and literals of block
+
+typedef enum _deflate_level_e {
+    DEFLATE_STORE,
+    DEFLATE_FAST,
+    DEFLATE_DEFAULT,
+    DEFLATE_LEVEL_NUM
+} deflate_level_e;
+
+typedef enum _deflate_state_e {
+    DEFLATE_DATA,
+    DEFLATE_DONE,
+    DEFLATE_ERROR
+} deflate_state_e;
+
+typedef sint_t (*deflate_callback_t)(void_t* context, const void_t* data, uint32_t size);
+
+typedef struct _deflate_t {
+    deflate_state_e    state;
+    deflate_level_e    level;
+    uint32_t           chain;           // Candidates tried per position
+    uint32_t           nice;            // Length of match ending search
+    uint8_t*           window;          // Twice window size (and padding for word compares)
+    uint32_t           used;            // Bytes in window
+    uint32_t           position;        // Next byte to encode
+    uint32_t           inserted;        // Next position to hash
+    uint32_t           block_start;     // First byte of current block
+    uint32_t*          head;            // Last position of every hash
+    uint32_t*          prev;            // Previous position of same hash (by position modulo window size)
+    uint16_t*          lengths;         // Literal, or length of match (with distance)
+    uint16_t*          distances;       // Zero for literal
+    uint32_t           symbols_num;
+    uint32_t           literal_counts [286];
+    uint32_t           distance_counts [30];
+    uint32_t           adler;
+    uint64_t           bits;            // Output bits not written yet
+    uint32_t           bits_num;
+    uint8_t*           output;
+    uint32_t           output_used;
+    deflate_callback_t callback;
+    void_t*            context;
+} deflate_t;
+
+deflate_t*    new_deflate(deflate_level_e level, deflate_callback_t callback, void_t* context);
+sint_t        put_deflate(deflate_t* deflate, const void_t* data, uint32_t size);
+sint_t        end_deflate(deflate_t* deflate);
+void_t        del_deflate(deflate_t* deflate);
+
+const char_t* convert_deflate_level_to_text(deflate_level_e level);
+
+#endif // __DEFLATE_H__
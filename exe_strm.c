@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "stats.h"
+#include "budget.h"
+#include "cancel.h"
+
+#include "exe_head.h"
+#include "exe_strm.h"
+
+#define EXE_STREAM_MZ_REGION     (SEGMENTED_HEADER_OFFSET + sizeof(uint32_t))
+#define EXE_STREAM_MAX_TABLE     0x10000
+#define EXE_STREAM_BUFFER_SIZE   0x0100
+
+static inline uint16_t get_word(const uint8_t* data)
+{
+    return (uint16_t) (data[0] | (data[1] << 8));
+}
+
+static inline uint32_t get_min(uint32_t a, uint32_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static sint_t reserve_buffer(exe_stream_t* exe_stream, uint32_t size)
+{
+    if (size <= exe_stream->buffer_size)
+        return 0;
+
+    uint32_t new_size = (exe_stream->buffer_size) ? exe_stream->buffer_size : EXE_STREAM_BUFFER_SIZE;
+
+    while (new_size < size)
+        new_size *= 2;
+
+    // Buffer is kept by exe_stream, so it is made by allocator of exe_stream
+    mem_allocator_t* previous   = set_mem_allocator(get_mem_block_allocator(exe_stream));
+    void_t*          new_buffer = mem_realloc(exe_stream->buffer, new_size);
+
+    set_mem_allocator(previous);
+
+    if (! new_buffer)
+        return -1;
+
+    exe_stream->buffer      = (uint8_t*) new_buffer;
+    exe_stream->buffer_size = new_size;
+
+    return 0;
+}
+
+// Next region can start inside of buffered one (then its bytes are kept)
+static sint_t start_region(exe_stream_t* exe_stream, uint32_t offset, uint32_t size)
+{
+    if (offset >= exe_stream->position)
+    {
+        exe_stream->buffer_used = 0;
+    }
+    else if (offset >= exe_stream->buffer_offset)
+    {
+        uint32_t kept = exe_stream->position - offset;
+
+        memmove(exe_stream->buffer, exe_stream->buffer + (offset - exe_stream->buffer_offset), kept);
+        exe_stream->buffer_used = kept;
+    }
+    else
+    {
+        return -1;
+    }
+
+    exe_stream->buffer_offset = offset;
+    exe_stream->region_size   = size;
+
+    return reserve_buffer(exe_stream, size);
+}
+
+static uint32_t collect_region(exe_stream_t* exe_stream, const uint8_t* data, uint32_t size)
+{
+    uint32_t done = 0;
+
+    // Skip bytes before region
+    if (exe_stream->position < exe_stream->buffer_offset)
+    {
+        done                  = get_min(exe_stream->buffer_offset - exe_stream->position, size);
+        exe_stream->position += done;
+    }
+
+    if ((exe_stream->position >= exe_stream->buffer_offset) && (exe_stream->buffer_used < exe_stream->region_size))
+    {
+        uint32_t part = get_min(exe_stream->region_size - exe_stream->buffer_used, size - done);
+
+        memcpy(exe_stream->buffer + exe_stream->buffer_used, data + done, part);
+
+        exe_stream->buffer_used += part;
+        exe_stream->position    += part;
+        done                    += part;
+    }
+
+    return done;
+}
+
+static sint_t parse_mz_header(exe_stream_t* exe_stream)
+{
+    memcpy(&exe_stream->mz_header, exe_stream->buffer, sizeof(mz_header_t));
+    memcpy(&exe_stream->segmented_offset, exe_stream->buffer + SEGMENTED_HEADER_OFFSET, sizeof(uint32_t));
+
+    if ((exe_stream->mz_header.syncword != MZ_HEADER_SYNC)
+    ||  (exe_stream->mz_header.reloc_table_offset != RELOCATION_TABLE_OFFSET)
+    ||  (! exe_stream->segmented_offset))
+        return -1;
+
+    exe_stream->state = EXE_STREAM_NE_HEADER;
+
+    return start_region(exe_stream, exe_stream->segmented_offset, NE_HEADER_SIZE);
+}
+
+static sint_t parse_ne_header(exe_stream_t* exe_stream)
+{
+    memcpy(&exe_stream->ne_header, exe_stream->buffer, sizeof(ne_header_t));
+
+    if (exe_stream->ne_header.syncword != NE_HEADER_SYNC)
+        return -1;
+
+    // Module without resources
+    if (exe_stream->ne_header.resource_table_offset == exe_stream->ne_header.resident_table_offset)
+    {
+        exe_stream->state = EXE_STREAM_DONE;
+        return 0;
+    }
+
+    exe_stream->state = EXE_STREAM_RESOURCE_TABLE;
+
+    return start_region(exe_stream, exe_stream->segmented_offset + exe_stream->ne_header.resource_table_offset, sizeof(uint16_t));
+}
+
+// Size of whole table (zero if more bytes are required, then region is extended)
+static uint32_t scan_resource_table(exe_stream_t* exe_stream)
+{
+    const uint8_t* table = exe_stream->buffer;
+    uint32_t       size  = exe_stream->buffer_used;
+    uint32_t       pos   = sizeof(uint16_t);
+
+    for ( ; ; )
+    {
+        if (pos + sizeof(uint16_t) > size)
+        {
+            exe_stream->region_size = pos + sizeof(uint16_t);
+            return 0;
+        }
+
+        if (! get_word(table + pos))
+            return pos + sizeof(uint16_t);
+
+        if (pos + RESOURCE_TYPE_SIZE > size)
+        {
+            exe_stream->region_size = pos + RESOURCE_TYPE_SIZE;
+            return 0;
+        }
+
+        pos += RESOURCE_TYPE_SIZE + RESOURCE_INFO_SIZE * get_word(table + pos + 2);
+    }
+}
+
+static sint_t compare_resource_offsets(const void_t* a, const void_t* b)
+{
+    const resource_entry_t* x = *((const resource_entry_t**) a);
+    const resource_entry_t* y = *((const resource_entry_t**) b);
+
+    if (x->content_offset != y->content_offset)
+        return (x->content_offset < y->content_offset) ? -1 : 1;
+
+    // Keep table order for shared data
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+static sint_t parse_resource_table(exe_stream_t* exe_stream)
+{
+    const uint8_t* table = exe_stream->buffer;
+    uint16_t       alignment_shift = get_word(table);
+    uint32_t       i, info_num     = 0;
+    uint32_t       pos;
+
+    // Multiplier must fit (shifts of real modules are small)
+    if (alignment_shift >= 31)
+        return -1;
+
+    uint32_t multiplier = 1 << alignment_shift;
+
+    // Count entries first (table is complete)
+    for (pos = sizeof(uint16_t); get_word(table + pos); pos += RESOURCE_TYPE_SIZE + RESOURCE_INFO_SIZE * get_word(table + pos + 2))
+        info_num += get_word(table + pos + 2);
+
+    if (! use_budget_entries(info_num))
+        return -1;
+
+    exe_stream->resource_table.resource_data_alignment_shift = alignment_shift;
+    exe_stream->resource_table.info_entries_num              = info_num;
+
+    if (! info_num)
+    {
+        exe_stream->state = EXE_STREAM_DONE;
+        return 0;
+    }
+
+    resource_entry_t*  info_entries = (resource_entry_t*) mem_alloc(sizeof(resource_entry_t) * info_num);
+    resource_entry_t** order        = (resource_entry_t**) mem_alloc(sizeof(resource_entry_t*) * info_num);
+
+    if ((! info_entries) || (! order))
+    {
+        if (info_entries) mem_free(info_entries);
+        if (order)        mem_free(order);
+        return -1;
+    }
+
+    exe_stream->resource_table.info_entries = info_entries;
+    exe_stream->resource_order              = order;
+
+    resource_type_t resource_type;
+    resource_info_t resource_info;
+
+    for (info_num = 0, pos = sizeof(uint16_t); get_word(table + pos); )
+    {
+        memcpy(&resource_type, table + pos, sizeof(resource_type_t));
+        pos += RESOURCE_TYPE_SIZE;
+
+        for (i = 0; i < resource_type.num_of_resources; i ++)
+        {
+            memcpy(&resource_info, table + pos, sizeof(resource_info_t));
+            pos += RESOURCE_INFO_SIZE;
+
+            info_entries[info_num].type_id        = resource_type.type_id;
+            info_entries[info_num].resource_id    = resource_info.resource_id;
+            info_entries[info_num].flags          = resource_info.flags;
+            // Resource must end below 4 GB (offsets of entries are 32-bit)
+            uint64_t content_offset = (uint64_t) multiplier * resource_info.content_offset;
+            uint64_t content_size   = (uint64_t) multiplier * resource_info.content_size;
+
+            if (content_offset + content_size > 0xFFFFFFFF)
+                return -1;
+
+            info_entries[info_num].content_offset = (uint32_t) content_offset;
+            info_entries[info_num].content_size   = (uint32_t) content_size;
+
+            order[info_num] = info_entries + info_num;
+            info_num ++;
+        }
+    }
+
+    qsort(order, info_num, sizeof(resource_entry_t*), compare_resource_offsets);
+
+    // Buffer becomes window of resources
+    exe_stream->state       = EXE_STREAM_RESOURCES;
+    exe_stream->buffer_used = 0;
+
+    begin_cancel_units(info_num);
+
+    return 0;
+}
+
+static sint_t send_resource(exe_stream_t* exe_stream, const resource_entry_t* entry, const uint8_t* data)
+{
+    // Cancelled stream can not be resumed
+    if (! check_cancel_units(exe_stream->resources_next))
+    {
+        exe_stream->state = EXE_STREAM_ERROR;
+        return -1;
+    }
+
+    exe_stream->resources_next ++;
+    exe_stream->resources_sent ++;
+
+    if (exe_stream->callback(exe_stream->context, entry, data) != 0)
+        exe_stream->state = EXE_STREAM_DONE;
+
+    return (exe_stream->state == EXE_STREAM_DONE) ? -1 : 0;
+}
+
+static uint32_t put_resources(exe_stream_t* exe_stream, const uint8_t* data, uint32_t size)
+{
+    uint32_t done = 0;
+
+    while (exe_stream->resources_next < exe_stream->resource_table.info_entries_num)
+    {
+        resource_entry_t* entry = exe_stream->resource_order[exe_stream->resources_next];
+        uint64_t          end   = (uint64_t) entry->content_offset + entry->content_size;
+
+        if (! exe_stream->buffer_used)
+        {
+            // Data already passed by
+            if (entry->content_offset < exe_stream->position)
+            {
+                exe_stream->resources_next   ++;
+                exe_stream->resources_missed ++;
+                continue;
+            }
+
+            // Skip bytes before resource
+            uint32_t skip = get_min(entry->content_offset - exe_stream->position, size - done);
+
+            exe_stream->position += skip;
+            done                 += skip;
+
+            if (exe_stream->position < entry->content_offset)
+                return done;
+
+            // Whole resource is in chunk (position stays, next resource can overlap)
+            if (end - exe_stream->position <= (uint64_t) (size - done))
+            {
+                if (send_resource(exe_stream, entry, data + done) < 0)
+                    return size;
+
+                continue;
+            }
+
+            exe_stream->buffer_offset = exe_stream->position;
+        }
+
+        // Collect resource in window
+        if (end > exe_stream->position)
+        {
+            uint32_t part = (uint32_t) ((end - exe_stream->position < (uint64_t) (size - done)) ? (end - exe_stream->position) : (size - done));
+
+            if (reserve_buffer(exe_stream, exe_stream->buffer_used + part) < 0)
+            {
+                exe_stream->state = EXE_STREAM_ERROR;
+                return size;
+            }
+
+            memcpy(exe_stream->buffer + exe_stream->buffer_used, data + done, part);
+
+            exe_stream->buffer_used += part;
+            exe_stream->position    += part;
+            done                    += part;
+
+            if (exe_stream->position < end)
+                return done;
+        }
+
+        if (send_resource(exe_stream, entry, exe_stream->buffer + (entry->content_offset - exe_stream->buffer_offset)) < 0)
+            return size;
+
+        // Keep window only from next resource
+        uint32_t next_offset = exe_stream->position;
+
+        if (exe_stream->resources_next < exe_stream->resource_table.info_entries_num)
+            next_offset = exe_stream->resource_order[exe_stream->resources_next]->content_offset;
+
+        if (next_offset >= exe_stream->position)
+        {
+            exe_stream->buffer_used = 0;
+        }
+        else if (next_offset > exe_stream->buffer_offset)
+        {
+            exe_stream->buffer_used = exe_stream->position - next_offset;
+
+            memmove(exe_stream->buffer, exe_stream->buffer + (next_offset - exe_stream->buffer_offset), exe_stream->buffer_used);
+            exe_stream->buffer_offset = next_offset;
+        }
+    }
+
+    exe_stream->state = EXE_STREAM_DONE;
+
+    end_cancel_units();
+
+    return size;
+}
+
+exe_stream_t* new_exe_stream(exe_stream_callback_t callback, void_t* context)
+{
+    if (! callback)
+        return NULL;
+
+    exe_stream_t* exe_stream = (exe_stream_t*) mem_calloc(1, sizeof(exe_stream_t));
+
+    if (! exe_stream)
+        return NULL;
+
+    exe_stream->state    = EXE_STREAM_MZ_HEADER;
+    exe_stream->callback = callback;
+    exe_stream->context  = context;
+
+    if (start_region(exe_stream, 0, EXE_STREAM_MZ_REGION) < 0)
+    {
+        mem_free(exe_stream);
+        return NULL;
+    }
+
+    return exe_stream;
+}
+
+sint_t put_exe_stream(exe_stream_t* exe_stream, const void_t* data, uint32_t size)
+{
+    STATS_SCOPE(STATS_PUT_EXE_STREAM);
+
+    if ((! exe_stream) || ((! data) && (size)))
+        return -1;
+
+#ifdef USE_STATS
+    add_stats_read(size);
+#endif
+
+    if (! use_budget_read(size))
+    {
+        exe_stream->state = EXE_STREAM_ERROR;
+        return -1;
+    }
+
+    const uint8_t* chunk = (const uint8_t*) data;
+
+    while (exe_stream->state < EXE_STREAM_DONE)
+    {
+        uint32_t done;
+        sint_t   result = 0;
+
+        if (exe_stream->state == EXE_STREAM_RESOURCES)
+        {
+            if (! size)
+                break;
+
+            done = put_resources(exe_stream, chunk, size);
+        }
+        else
+        {
+            // Region can be complete without new bytes (it started inside of previous one)
+            done = collect_region(exe_stream, chunk, size);
+
+            if (exe_stream->buffer_used < exe_stream->region_size)
+                break;
+
+            switch (exe_stream->state)
+            {
+                case EXE_STREAM_MZ_HEADER:
+                    result = parse_mz_header(exe_stream);
+                    break;
+
+                case EXE_STREAM_NE_HEADER:
+                    result = parse_ne_header(exe_stream);
+                    break;
+
+                case EXE_STREAM_RESOURCE_TABLE:
+                    if (scan_resource_table(exe_stream))
+                        result = parse_resource_table(exe_stream);
+                    else if ((exe_stream->region_size > EXE_STREAM_MAX_TABLE) || (reserve_buffer(exe_stream, exe_stream->region_size) < 0))
+                        result = -1;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        if (result < 0)
+            exe_stream->state = EXE_STREAM_ERROR;
+
+        chunk += done;
+        size  -= done;
+    }
+
+    return (exe_stream->state == EXE_STREAM_ERROR) ? -1 : 0;
+}
+
+sint_t end_exe_stream(exe_stream_t* exe_stream)
+{
+    if ((! exe_stream) || (exe_stream->state != EXE_STREAM_DONE))
+        return -1;
+
+    return (exe_stream->resources_missed) ? -1 : 0;
+}
+
+void_t del_exe_stream(exe_stream_t* exe_stream)
+{
+    if (exe_stream->resource_table.info_entries)
+        mem_free(exe_stream->resource_table.info_entries);
+    if (exe_stream->resource_order)
+        mem_free(exe_stream->resource_order);
+    if (exe_stream->buffer)
+        mem_free(exe_stream->buffer);
+    mem_free(exe_stream);
+}
@@ -0,0 +1,57 @@
+#ifndef __EXE_STRM_H__
+#define __EXE_STRM_H__
+
+#include "inttypes.h"
+#include "platform.h"
+#include "exe_head.h"
+
+// Forward-only parser of NE modules (pipes, decompressors)
+//
+// Input is pushed in chunks of any size. MZ header, NE header and resource
+// table are parsed in file order, only these regions are buffered. Resources
+// are passed to callback in ascending offset order as soon as their last byte
+// arrives: directly from pushed chunk if it holds whole resource, otherwise
+// from window buffer (which also keeps overlapping resources).
+//
+// Resources placed before end of resource table can not be reached and are
+// counted as missed. Table with resource ending beyond 4 GB is error.
+// Nonzero result of callback stops parsing, cancelled token (see cancel.h)
+// stops it with error before next resource.
+
+typedef sint_t (*exe_stream_callback_t)(void_t* context, const resource_entry_t* entry, const uint8_t* data);
+
+typedef enum _exe_stream_state_e {
+    EXE_STREAM_MZ_HEADER,
+    EXE_STREAM_NE_HEADER,
+    EXE_STREAM_RESOURCE_TABLE,
+    EXE_STREAM_RESOURCES,
+    EXE_STREAM_DONE,
+    EXE_STREAM_ERROR
+} exe_stream_state_e;
+
+typedef struct _exe_stream_t {
+    exe_stream_state_e    state;
+    exe_stream_callback_t callback;
+    void_t*               context;
+    uint32_t              position;         // Offset of next input byte
+    mz_header_t           mz_header;        // Valid after EXE_STREAM_MZ_HEADER
+    uint32_t              segmented_offset;
+    ne_header_t           ne_header;        // Valid after EXE_STREAM_NE_HEADER
+    resource_table_info_t resource_table;   // Valid after EXE_STREAM_RESOURCE_TABLE
+    resource_entry_t**    resource_order;   // Entries by ascending offset
+    uint32_t              resources_next;
+    uint32_t              resources_sent;
+    uint32_t              resources_missed;
+    uint8_t*              buffer;           // Header region or resource window
+    uint32_t              buffer_offset;    // Offset of first buffered byte
+    uint32_t              buffer_used;
+    uint32_t              buffer_size;
+    uint32_t              region_size;      // Header bytes required in buffer
+} exe_stream_t;
+
+exe_stream_t* new_exe_stream(exe_stream_callback_t callback, void_t* context);
+sint_t        put_exe_stream(exe_stream_t* exe_stream, const void_t* data, uint32_t size);
+sint_t        end_exe_stream(exe_stream_t* exe_stream); // Zero if every reachable resource was passed
+void_t        del_exe_stream(exe_stream_t* exe_stream);
+
+#endif // __EXE_STRM_H__
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include "inttypes.h"
+#include "platform.h"
+#include "stats.h"
+#include "trace.h"
+
+#include "fileio.h"
+
+size_t file_read_at(FILE* stream, uint32_t offset, void_t* buffer, size_t size)
+{
+    size_t done = 0;
+
+    if (! use_budget_read(size))
+        return 0;
+
+    TRACE_EVENT(TRACE_READ, TRACE_BEGIN, 0, (uint32_t) size);
+
+#ifdef _WIN32
+    HANDLE handle = (HANDLE) _get_osfhandle(_fileno(stream));
+
+    while (done < size)
+    {
+        OVERLAPPED overlapped;
+        DWORD      part = 0;
+        DWORD      want = ((size - done) < 0x40000000) ? (DWORD) (size - done) : 0x40000000;
+
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = (DWORD) (offset + done);
+
+        if ((! ReadFile(handle, (uint8_t*) buffer + done, want, &part, &overlapped)) || (! part))
+            break;
+
+        done += part;
+    }
+#else
+    while (done < size)
+    {
+        ssize_t part = pread(fileno(stream), (uint8_t*) buffer + done, size - done, (off_t) offset + (off_t) done);
+
+        if (part <= 0)
+            break;
+
+        done += (size_t) part;
+    }
+#endif
+
+#ifdef USE_STATS
+    add_stats_read(done);
+#endif
+
+    TRACE_EVENT(TRACE_READ, TRACE_END, 0, (uint32_t) done);
+    return done;
+}
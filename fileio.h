@@ -0,0 +1,138 @@
+#ifndef __FILEIO_H__
+#define __FILEIO_H__
+
+#include <stdio.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/uio.h>
+#endif
+
+#include "inttypes.h"
+#include "platform.h"
+#include "stats.h"
+#include "trace.h"
+#include "budget.h"
+
+// Stream access used by all parsers (single place to count and limit I/O)
+
+static inline sint_t file_seek(FILE* stream, long offset, sint_t origin)
+{
+    if (get_budget_status() != BUDGET_OK)
+        return -1;
+
+#ifdef USE_STATS
+    add_stats_seek();
+#endif
+    return fseek(stream, offset, origin);
+}
+
+static inline size_t file_read(void_t* buffer, size_t size, size_t count, FILE* stream)
+{
+    if (! use_budget_read(size * count))
+        return 0;
+
+    TRACE_EVENT(TRACE_READ, TRACE_BEGIN, 0, (uint32_t) (size * count));
+
+    size_t done = fread(buffer, size, count, stream);
+#ifdef USE_STATS
+    add_stats_read(size * done);
+#endif
+
+    TRACE_EVENT(TRACE_READ, TRACE_END, 0, (uint32_t) (size * done));
+    return done;
+}
+
+static inline size_t file_write(const void_t* buffer, size_t size, size_t count, FILE* stream)
+{
+    size_t done = fwrite(buffer, size, count, stream);
+#ifdef USE_STATS
+    add_stats_write(size * done);
+#endif
+    return done;
+}
+
+// Read at absolute offset (pread where available)
+//
+// Position of stream is not used, so several threads can read same stream at
+// once (buffered writes must be flushed first). Position is left undefined
+// on Windows. Budget of calling thread is charged as by file_read.
+
+size_t file_read_at(FILE* stream, uint32_t offset, void_t* buffer, size_t size);
+
+// Gathered write of parts at absolute offset (pwritev where available)
+//
+// Buffer of stream is flushed first, stream is left positioned after written
+// bytes on every platform (as by file_write). Up to FILE_VECTORS_MAX parts go
+// to single system call. Vectors are consumed (advanced past written bytes).
+
+#ifdef _WIN32
+typedef struct _file_vector_t {
+    void_t* iov_base;
+    size_t  iov_len;
+} file_vector_t;
+#else
+typedef struct iovec file_vector_t;
+#endif
+
+#define FILE_VECTORS_MAX 0x400
+
+static inline size_t file_write_vector(FILE* stream, uint32_t offset, file_vector_t* vectors, uint32_t count)
+{
+    size_t   done = 0;
+    uint32_t i    = 0;
+
+#ifdef _WIN32
+    if (fseek(stream, offset, SEEK_SET) != 0)
+        return 0;
+
+    for ( ; i < count; i ++)
+        done += fwrite(vectors[i].iov_base, 1, vectors[i].iov_len, stream);
+#else
+    if (fflush(stream) != 0)
+        return 0;
+
+    while (i < count)
+    {
+        sint_t  num  = (sint_t) (((count - i) < FILE_VECTORS_MAX) ? (count - i) : FILE_VECTORS_MAX);
+        ssize_t part = pwritev(fileno(stream), vectors + i, num, (off_t) offset + (off_t) done);
+
+        if (part <= 0)
+            break;
+
+        done += (size_t) part;
+
+        // Partially written part continues in next call
+        for ( ; (i < count) && ((size_t) part >= vectors[i].iov_len); i ++)
+            part -= (ssize_t) vectors[i].iov_len;
+
+        if (part)
+        {
+            vectors[i].iov_base  = (uint8_t*) vectors[i].iov_base + part;
+            vectors[i].iov_len  -= (size_t) part;
+        }
+    }
+
+    // Descriptor writes do not move stream
+    if (fseek(stream, (long) offset + (long) done, SEEK_SET) != 0)
+        done = 0;
+#endif
+
+#ifdef USE_STATS
+    add_stats_write(done);
+#endif
+    return done;
+}
+
+// Preallocation of file space (hint, failure is not error)
+static inline sint_t file_reserve(FILE* stream, uint32_t offset, uint32_t size)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    return (posix_fallocate(fileno(stream), (off_t) offset, (off_t) size) == 0) ? 0 : -1;
+#endif
+}
+
+#endif // __FILEIO_H__
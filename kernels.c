@@ -0,0 +1,1377 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "kernels.h"
+
+#ifdef KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// Scalar (reference)
+
+uint16_t sum_words_scalar(const uint8_t* data, size_t size)
+{
+    uint16_t sum = 0x0000;
+    size_t   i;
+
+    for (i = 0; i + 1 < size; i += 2)
+        sum += (uint16_t) (data[i] | (data[i + 1] << 8));
+
+    return sum;
+}
+
+void_t expand_1_bit_scalar(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+        dst[x] = palette[(src[x >> 3] >> (7 - (x & 7))) & 0x01];
+}
+
+void_t expand_4_bit_scalar(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+        dst[x] = palette[(src[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F];
+}
+
+void_t expand_8_bit_scalar(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+        dst[x] = palette[src[x]];
+}
+
+void_t convert_24_to_32_scalar(const uint8_t* src, uint32_t* dst, uint32_t width)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++, src += 3)
+        dst[x] = 0xFF000000 | ((uint32_t) src[2] << 16) | ((uint32_t) src[1] << 8) | src[0];
+}
+
+void_t swap_red_blue_scalar(const uint32_t* src, uint32_t* dst, uint32_t width)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+        dst[x] = (src[x] & 0xFF00FF00) | ((src[x] >> 16) & 0x000000FF) | ((src[x] & 0x000000FF) << 16);
+}
+
+void_t convert_32_to_24_scalar(const uint32_t* src, uint8_t* dst, uint32_t width)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++, dst += 3)
+    {
+        dst[0] = (uint8_t) (src[x] >> 16);
+        dst[1] = (uint8_t) (src[x] >> 8);
+        dst[2] = (uint8_t) (src[x]);
+    }
+}
+
+void_t convert_32_to_gray_scalar(const uint32_t* src, uint8_t* dst, uint32_t width)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+    {
+        uint32_t luma = GRAY_WEIGHT_RED   * ((src[x] >> 16) & 0xFF)
+                      + GRAY_WEIGHT_GREEN * ((src[x] >> 8)  & 0xFF)
+                      + GRAY_WEIGHT_BLUE  * ((src[x])       & 0xFF);
+
+        dst[x] = (uint8_t) ((luma + 64) >> 7);
+    }
+}
+
+static inline uint32_t expand_bitfields(uint32_t pixel, const bitfields_t* bitfields)
+{
+    uint32_t i, result = bitfields->alpha;
+
+    for (i = 0; i < 4; i ++)
+        result |= ((((pixel >> bitfields->shift[i]) & bitfields->limit[i]) * bitfields->scale[i]) >> bitfields->scale_shift[i]) << (i * 8);
+
+    return result;
+}
+
+void_t expand_16_bit_scalar(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++, src += 2)
+        dst[x] = expand_bitfields(src[0] | ((uint32_t) src[1] << 8), bitfields);
+}
+
+void_t expand_32_bit_scalar(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++, src += 4)
+        dst[x] = expand_bitfields(src[0] | ((uint32_t) src[1] << 8) | ((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24), bitfields);
+}
+
+// Weighted sum in fixed point, rounded and saturated
+static inline uint8_t round_weighted(sint32_t sum)
+{
+    sum = (sum + (1 << (RESAMPLE_WEIGHT_BITS - 1))) >> RESAMPLE_WEIGHT_BITS;
+
+    return (uint8_t) ((sum < 0) ? 0 : ((sum > 0xFF) ? 0xFF : sum));
+}
+
+void_t resample_32_scalar(const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps)
+{
+    uint32_t x, i;
+
+    for (x = 0; x < width; x ++)
+    {
+        const uint32_t* pixels  = src + taps->first[x];
+        const sint16_t* weights = taps->weights + (size_t) taps->taps * x;
+        sint32_t        sum [4] = { 0, 0, 0, 0 };
+
+        for (i = 0; i < taps->taps; i ++)
+        {
+            sum[0] += weights[i] * (sint32_t) ((pixels[i])       & 0xFF);
+            sum[1] += weights[i] * (sint32_t) ((pixels[i] >> 8)  & 0xFF);
+            sum[2] += weights[i] * (sint32_t) ((pixels[i] >> 16) & 0xFF);
+            sum[3] += weights[i] * (sint32_t) ((pixels[i] >> 24) & 0xFF);
+        }
+
+        dst[x] = round_weighted(sum[0]) | ((uint32_t) round_weighted(sum[1]) << 8)
+             | ((uint32_t) round_weighted(sum[2]) << 16) | ((uint32_t) round_weighted(sum[3]) << 24);
+    }
+}
+
+void_t resample_8_scalar(const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps)
+{
+    uint32_t x, i;
+
+    for (x = 0; x < width; x ++)
+    {
+        const uint8_t*  pixels  = src + taps->first[x];
+        const sint16_t* weights = taps->weights + (size_t) taps->taps * x;
+        sint32_t        sum     = 0;
+
+        for (i = 0; i < taps->taps; i ++)
+            sum += weights[i] * (sint32_t) pixels[i];
+
+        dst[x] = round_weighted(sum);
+    }
+}
+
+void_t resample_lines_scalar(const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size)
+{
+    uint32_t x, i;
+
+    for (x = 0; x < size; x ++)
+    {
+        sint32_t sum = 0;
+
+        for (i = 0; i < taps; i ++)
+            sum += weights[i] * (sint32_t) lines[i][x];
+
+        dst[x] = round_weighted(sum);
+    }
+}
+
+// Largest number of bytes summed before sums of Adler-32 are reduced (zlib NMAX)
+#define ADLER_BLOCK 5552
+#define ADLER_BASE  65521
+
+uint32_t adler_32_scalar(uint32_t adler, const uint8_t* data, size_t size)
+{
+    uint32_t s1 = adler & 0xFFFF;
+    uint32_t s2 = adler >> 16;
+
+    while (size)
+    {
+        size_t block = (size < ADLER_BLOCK) ? size : ADLER_BLOCK;
+
+        for (size -= block; block; block --)
+        {
+            s1 += *data ++;
+            s2 += s1;
+        }
+
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+
+    return (s2 << 16) | s1;
+}
+
+// Predictor of Paeth filter (neighbour nearest to a + b - c, ties in order a, b, c)
+static inline uint8_t predict_paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    sint32_t pa = abs((sint32_t) b - c);
+    sint32_t pb = abs((sint32_t) a - c);
+    sint32_t pc = abs((sint32_t) a + b - 2 * c);
+
+    return ((pa <= pb) && (pa <= pc)) ? a : (pb <= pc) ? b : c;
+}
+
+// Byte taken as signed, its magnitude
+static inline uint32_t get_filter_cost(uint8_t value)
+{
+    return (value < 0x80) ? value : 0x100 - value;
+}
+
+// Bytes from x (left neighbours of first pixel are zero)
+static inline void_t filter_png_tail(const uint8_t* line, const uint8_t* prior, uint32_t x, uint32_t size, uint32_t bpp,
+                                     uint8_t* const* filtered, uint32_t* costs)
+{
+    for ( ; x < size; x ++)
+    {
+        uint8_t a = (x >= bpp) ? line[x - bpp]  : 0;
+        uint8_t b = prior[x];
+        uint8_t c = (x >= bpp) ? prior[x - bpp] : 0;
+
+        filtered[0][x] = (uint8_t) (line[x] - a);
+        filtered[1][x] = (uint8_t) (line[x] - b);
+        filtered[2][x] = (uint8_t) (line[x] - ((a + b) >> 1));
+        filtered[3][x] = (uint8_t) (line[x] - predict_paeth(a, b, c));
+
+        costs[0] += get_filter_cost(line[x]);
+        costs[1] += get_filter_cost(filtered[0][x]);
+        costs[2] += get_filter_cost(filtered[1][x]);
+        costs[3] += get_filter_cost(filtered[2][x]);
+        costs[4] += get_filter_cost(filtered[3][x]);
+    }
+}
+
+void_t filter_png_line_scalar(const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs)
+{
+    memset(costs, 0, sizeof(uint32_t) * PNG_FILTER_NUM);
+
+    filter_png_tail(line, prior, 0, size, bpp, filtered, costs);
+}
+
+// Product of channel and alpha divided by 255, rounded
+static inline uint32_t premultiply_channel(uint32_t channel, uint32_t alpha)
+{
+    uint32_t product = channel * alpha + 0x80;
+
+    return (product + (product >> 8)) >> 8;
+}
+
+void_t premultiply_mask_scalar(uint32_t* pixels, const uint8_t* mask, uint32_t width)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+    {
+        uint32_t alpha = ((mask) && ((mask[x >> 3] << (x & 7)) & 0x80)) ? 0 : (pixels[x] >> 24);
+
+        pixels[x] = (alpha << 24) | (premultiply_channel((pixels[x] >> 16) & 0xFF, alpha) << 16)
+                  | (premultiply_channel((pixels[x] >> 8) & 0xFF, alpha) << 8) | premultiply_channel(pixels[x] & 0xFF, alpha);
+    }
+}
+
+#ifdef KERNELS_X86
+
+// SSE2 (no gathers or byte shuffles, indexed lookups stay scalar)
+
+__attribute__((target("sse2")))
+uint16_t sum_words_sse2(const uint8_t* data, size_t size)
+{
+    // Lanes wrap around at 16 bits as well as checksum does
+    __m128i  sum = _mm_setzero_si128();
+    uint16_t lanes [8];
+    size_t   i;
+
+    for (i = 0; i + 16 <= size; i += 16)
+        sum = _mm_add_epi16(sum, _mm_loadu_si128((const __m128i*) (data + i)));
+
+    _mm_storeu_si128((__m128i*) lanes, sum);
+
+    return (uint16_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]
+                     + sum_words_scalar(data + i, size - i));
+}
+
+__attribute__((target("sse2")))
+void_t expand_1_bit_sse2(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    const __m128i bits_high = _mm_setr_epi32(0x80, 0x40, 0x20, 0x10);
+    const __m128i bits_low  = _mm_setr_epi32(0x08, 0x04, 0x02, 0x01);
+    const __m128i color_0   = _mm_set1_epi32((sint_t) palette[0]);
+    const __m128i color_1   = _mm_set1_epi32((sint_t) palette[1]);
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m128i byte = _mm_set1_epi32(src[x >> 3]);
+        __m128i high = _mm_cmpeq_epi32(_mm_and_si128(byte, bits_high), bits_high);
+        __m128i low  = _mm_cmpeq_epi32(_mm_and_si128(byte, bits_low),  bits_low);
+
+        _mm_storeu_si128((__m128i*) (dst + x),     _mm_or_si128(_mm_and_si128(high, color_1), _mm_andnot_si128(high, color_0)));
+        _mm_storeu_si128((__m128i*) (dst + x + 4), _mm_or_si128(_mm_and_si128(low,  color_1), _mm_andnot_si128(low,  color_0)));
+    }
+
+    expand_1_bit_scalar(src + (x >> 3), dst + x, width - x, palette);
+}
+
+__attribute__((target("sse2")))
+void_t swap_red_blue_sse2(const uint32_t* src, uint32_t* dst, uint32_t width)
+{
+    const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+    uint32_t      x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*) (src + x));
+        __m128i red_blue = _mm_and_si128(pixels, mask);
+
+        red_blue = _mm_or_si128(_mm_slli_epi32(red_blue, 16), _mm_srli_epi32(red_blue, 16));
+
+        _mm_storeu_si128((__m128i*) (dst + x), _mm_or_si128(_mm_andnot_si128(mask, pixels), red_blue));
+    }
+
+    swap_red_blue_scalar(src + x, dst + x, width - x);
+}
+
+__attribute__((target("sse2")))
+void_t convert_32_to_gray_sse2(const uint32_t* src, uint8_t* dst, uint32_t width)
+{
+    const __m128i weights = _mm_setr_epi16(GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                           GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0);
+    const __m128i round   = _mm_set1_epi32(64);
+    const __m128i zero    = _mm_setzero_si128();
+    uint32_t      x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*) (src + x));
+
+        // Pairs of products per pixel, second one is added from upper half of qword
+        __m128i low  = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+        __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+
+        low  = _mm_add_epi32(low,  _mm_srli_epi64(low,  32));
+        high = _mm_add_epi32(high, _mm_srli_epi64(high, 32));
+
+        __m128i luma = _mm_unpacklo_epi64(_mm_shuffle_epi32(low,  _MM_SHUFFLE(2, 0, 2, 0)),
+                                          _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 0, 2, 0)));
+
+        luma = _mm_srli_epi32(_mm_add_epi32(luma, round), 7);
+        luma = _mm_packus_epi16(_mm_packs_epi32(luma, zero), zero);
+
+        uint32_t packed = (uint32_t) _mm_cvtsi128_si32(luma);
+        memcpy(dst + x, &packed, sizeof(uint32_t));
+    }
+
+    convert_32_to_gray_scalar(src + x, dst + x, width - x);
+}
+
+// Channels of 16-bit pixels stay in 16-bit lanes (scaled channel fits into them)
+__attribute__((target("sse2")))
+void_t expand_16_bit_sse2(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields)
+{
+    const __m128i alpha = _mm_set1_epi16((sint16_t) (bitfields->alpha >> 16));
+    __m128i       shift [4], limit [4], scale [4], scale_shift [4];
+    uint32_t      i, x;
+
+    for (i = 0; i < 4; i ++)
+    {
+        shift[i]       = _mm_cvtsi32_si128((sint_t) bitfields->shift[i]);
+        limit[i]       = _mm_set1_epi16((sint16_t) bitfields->limit[i]);
+        scale[i]       = _mm_set1_epi16((sint16_t) bitfields->scale[i]);
+        scale_shift[i] = _mm_cvtsi32_si128((sint_t) bitfields->scale_shift[i]);
+    }
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*) (src + x * 2));
+        __m128i channel [4];
+
+        for (i = 0; i < 4; i ++)
+            channel[i] = _mm_srl_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srl_epi16(pixels, shift[i]), limit[i]), scale[i]), scale_shift[i]);
+
+        __m128i blue_green = _mm_or_si128(channel[0], _mm_slli_epi16(channel[1], 8));
+        __m128i red_alpha  = _mm_or_si128(_mm_or_si128(channel[2], _mm_slli_epi16(channel[3], 8)), alpha);
+
+        _mm_storeu_si128((__m128i*) (dst + x),     _mm_unpacklo_epi16(blue_green, red_alpha));
+        _mm_storeu_si128((__m128i*) (dst + x + 4), _mm_unpackhi_epi16(blue_green, red_alpha));
+    }
+
+    expand_16_bit_scalar(src + x * 2, dst + x, width - x, bitfields);
+}
+
+// Limited channel has zero upper half of 32-bit lane, so 16-bit multiply is exact
+__attribute__((target("sse2")))
+void_t expand_32_bit_sse2(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields)
+{
+    const __m128i alpha = _mm_set1_epi32((sint_t) bitfields->alpha);
+    __m128i       shift [4], limit [4], scale [4], scale_shift [4];
+    uint32_t      i, x;
+
+    for (i = 0; i < 4; i ++)
+    {
+        shift[i]       = _mm_cvtsi32_si128((sint_t) bitfields->shift[i]);
+        limit[i]       = _mm_set1_epi32((sint_t) bitfields->limit[i]);
+        scale[i]       = _mm_set1_epi32((sint_t) bitfields->scale[i]);
+        scale_shift[i] = _mm_cvtsi32_si128((sint_t) bitfields->scale_shift[i]);
+    }
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*) (src + x * 4));
+        __m128i result = alpha;
+
+        for (i = 0; i < 4; i ++)
+        {
+            __m128i channel = _mm_srl_epi32(_mm_mullo_epi16(_mm_and_si128(_mm_srl_epi32(pixels, shift[i]), limit[i]), scale[i]), scale_shift[i]);
+
+            result = _mm_or_si128(result, _mm_sll_epi32(channel, _mm_cvtsi32_si128((sint_t) (i * 8))));
+        }
+
+        _mm_storeu_si128((__m128i*) (dst + x), result);
+    }
+
+    expand_32_bit_scalar(src + x * 4, dst + x, width - x, bitfields);
+}
+
+// Pair of weights in every 32-bit lane (for multiply-add of interleaved pairs)
+static inline uint32_t pair_weights(sint16_t first, sint16_t second)
+{
+    return (uint32_t) (uint16_t) first | ((uint32_t) (uint16_t) second << 16);
+}
+
+// Channels of two pixels interleaved in 16-bit lanes (b0 b1 g0 g1 r0 r1 a0 a1)
+__attribute__((target("sse2")))
+static inline __m128i interleave_pixels_sse2(__m128i pixels)
+{
+    return _mm_unpacklo_epi16(pixels, _mm_unpackhi_epi64(pixels, pixels));
+}
+
+__attribute__((target("sse2")))
+static inline uint32_t round_pixel_sse2(__m128i sum)
+{
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (RESAMPLE_WEIGHT_BITS - 1))), RESAMPLE_WEIGHT_BITS);
+    sum = _mm_packus_epi16(_mm_packs_epi32(sum, sum), sum);
+
+    return (uint32_t) _mm_cvtsi128_si32(sum);
+}
+
+// Partial sum of four channels over taps from i (two at a time, then last one)
+__attribute__((target("sse2")))
+static inline __m128i resample_pixel_sse2(const uint32_t* pixels, const sint16_t* weights, uint32_t i, uint32_t taps, __m128i sum)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for ( ; i + 2 <= taps; i += 2)
+    {
+        __m128i pair = interleave_pixels_sse2(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (pixels + i)), zero));
+
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, _mm_set1_epi32((sint_t) pair_weights(weights[i], weights[i + 1]))));
+    }
+
+    if (i < taps)
+    {
+        __m128i pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((sint_t) pixels[i]), zero), zero);
+
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(pixel, _mm_set1_epi32((sint_t) pair_weights(weights[i], 0))));
+    }
+
+    return sum;
+}
+
+__attribute__((target("sse2")))
+void_t resample_32_sse2(const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t      x, i;
+
+    for (x = 0; x < width; x ++)
+    {
+        const uint32_t* pixels  = src + taps->first[x];
+        const sint16_t* weights = taps->weights + (size_t) taps->taps * x;
+        __m128i         sum     = zero;
+
+        // Four pixels at once, two of them in each half
+        for (i = 0; i + 4 <= taps->taps; i += 4)
+        {
+            __m128i quad = _mm_loadu_si128((const __m128i*) (pixels + i));
+            __m128i low  = interleave_pixels_sse2(_mm_unpacklo_epi8(quad, zero));
+            __m128i high = interleave_pixels_sse2(_mm_unpackhi_epi8(quad, zero));
+
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(low,  _mm_set1_epi32((sint_t) pair_weights(weights[i],     weights[i + 1]))));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(high, _mm_set1_epi32((sint_t) pair_weights(weights[i + 2], weights[i + 3]))));
+        }
+
+        dst[x] = round_pixel_sse2(resample_pixel_sse2(pixels, weights, i, taps->taps, sum));
+    }
+}
+
+__attribute__((target("sse2")))
+static inline sint32_t sum_lanes_sse2(__m128i sum)
+{
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(sum);
+}
+
+// Sum of taps from i (eight at a time, then four, then one by one) added to
+// lanes of partial sums
+__attribute__((target("sse2")))
+static inline sint32_t sum_taps_8_sse2(const uint8_t* pixels, const sint16_t* weights, uint32_t i, uint32_t taps, __m128i lanes)
+{
+    const __m128i zero = _mm_setzero_si128();
+    sint32_t      sum;
+
+    for ( ; i + 8 <= taps; i += 8)
+    {
+        __m128i octet = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (pixels + i)), zero);
+
+        lanes = _mm_add_epi32(lanes, _mm_madd_epi16(octet, _mm_loadu_si128((const __m128i*) (weights + i))));
+    }
+
+    if (i + 4 <= taps)
+    {
+        uint32_t quad;
+
+        memcpy(&quad, pixels + i, sizeof(quad));
+
+        __m128i quartet = _mm_unpacklo_epi8(_mm_cvtsi32_si128((sint_t) quad), zero);
+
+        lanes  = _mm_add_epi32(lanes, _mm_madd_epi16(quartet, _mm_loadl_epi64((const __m128i*) (weights + i))));
+        i     += 4;
+    }
+
+    for (sum = sum_lanes_sse2(lanes); i < taps; i ++)
+        sum += weights[i] * (sint32_t) pixels[i];
+
+    return sum;
+}
+
+__attribute__((target("sse2")))
+void_t resample_8_sse2(const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t      x;
+
+    for (x = 0; x < width; x ++)
+    {
+        const uint8_t*  pixels  = src + taps->first[x];
+        const sint16_t* weights = taps->weights + (size_t) taps->taps * x;
+
+        dst[x] = round_weighted(sum_taps_8_sse2(pixels, weights, 0, taps->taps, zero));
+    }
+}
+
+// Bytes of lines from x (lines can not be advanced without copy of pointers)
+static inline void_t resample_lines_tail(const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t x, uint32_t size)
+{
+    uint32_t i;
+
+    for ( ; x < size; x ++)
+    {
+        sint32_t sum = 0;
+
+        for (i = 0; i < taps; i ++)
+            sum += weights[i] * (sint32_t) lines[i][x];
+
+        dst[x] = round_weighted(sum);
+    }
+}
+
+// Sixteen bytes of two lines at once, products of pairs are summed in four
+// groups of 32-bit lanes
+__attribute__((target("sse2")))
+void_t resample_lines_sse2(const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (RESAMPLE_WEIGHT_BITS - 1));
+    uint32_t      x, i;
+
+    for (x = 0; x + 16 <= size; x += 16)
+    {
+        __m128i sum [4] = { round, round, round, round };
+
+        for (i = 0; i < taps; i += 2)
+        {
+            __m128i first  = _mm_loadu_si128((const __m128i*) (lines[i] + x));
+            __m128i second = (i + 1 < taps) ? _mm_loadu_si128((const __m128i*) (lines[i + 1] + x)) : zero;
+            __m128i pair   = _mm_set1_epi32((sint_t) pair_weights(weights[i], (i + 1 < taps) ? weights[i + 1] : 0));
+            __m128i low_a  = _mm_unpacklo_epi8(first, zero);
+            __m128i low_b  = _mm_unpacklo_epi8(second, zero);
+            __m128i high_a = _mm_unpackhi_epi8(first, zero);
+            __m128i high_b = _mm_unpackhi_epi8(second, zero);
+
+            sum[0] = _mm_add_epi32(sum[0], _mm_madd_epi16(_mm_unpacklo_epi16(low_a,  low_b),  pair));
+            sum[1] = _mm_add_epi32(sum[1], _mm_madd_epi16(_mm_unpackhi_epi16(low_a,  low_b),  pair));
+            sum[2] = _mm_add_epi32(sum[2], _mm_madd_epi16(_mm_unpacklo_epi16(high_a, high_b), pair));
+            sum[3] = _mm_add_epi32(sum[3], _mm_madd_epi16(_mm_unpackhi_epi16(high_a, high_b), pair));
+        }
+
+        for (i = 0; i < 4; i ++)
+            sum[i] = _mm_srai_epi32(sum[i], RESAMPLE_WEIGHT_BITS);
+
+        _mm_storeu_si128((__m128i*) (dst + x), _mm_packus_epi16(_mm_packs_epi32(sum[0], sum[1]), _mm_packs_epi32(sum[2], sum[3])));
+    }
+
+    resample_lines_tail(lines, weights, taps, dst, x, size);
+}
+
+// Adler-32 of sixteen bytes at once: s1 of every step is kept in lanes and
+// added to s2 sixteen times after block, bytes are weighted by distance
+// from end of step
+__attribute__((target("sse2")))
+uint32_t adler_32_sse2(uint32_t adler, const uint8_t* data, size_t size)
+{
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i weights_0 = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i weights_1 = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    uint32_t      s1        = adler & 0xFFFF;
+    uint32_t      s2        = adler >> 16;
+
+    while (size >= 16)
+    {
+        size_t  block  = ((size < ADLER_BLOCK) ? size : ADLER_BLOCK) & ~(size_t) 15;
+        __m128i sums_1 = zero;
+        __m128i sums_2 = zero;
+        __m128i prior  = zero;   // Sum of s1 lanes before every step
+        size_t  i;
+
+        for (i = 0; i < block; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128((const __m128i*) (data + i));
+
+            prior  = _mm_add_epi32(prior, sums_1);
+            sums_1 = _mm_add_epi32(sums_1, _mm_sad_epu8(bytes, zero));
+            sums_2 = _mm_add_epi32(sums_2, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weights_0));
+            sums_2 = _mm_add_epi32(sums_2, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weights_1));
+        }
+
+        uint64_t sum_2 = (uint64_t) s2 + (uint64_t) s1 * block + ((uint64_t) (uint32_t) sum_lanes_sse2(prior) << 4) + (uint32_t) sum_lanes_sse2(sums_2);
+
+        s1    = (uint32_t) ((s1 + (uint32_t) sum_lanes_sse2(sums_1)) % ADLER_BASE);
+        s2    = (uint32_t) (sum_2 % ADLER_BASE);
+        data += block;
+        size -= block;
+    }
+
+    return adler_32_scalar((s2 << 16) | s1, data, size);
+}
+
+// Magnitudes of signed bytes summed in two 64-bit lanes
+__attribute__((target("sse2")))
+static inline __m128i add_filter_costs_sse2(__m128i costs, __m128i bytes)
+{
+    __m128i magnitudes = _mm_min_epu8(bytes, _mm_sub_epi8(_mm_setzero_si128(), bytes));
+
+    return _mm_add_epi64(costs, _mm_sad_epu8(magnitudes, _mm_setzero_si128()));
+}
+
+// Paeth predictor of eight pixels in 16-bit lanes
+__attribute__((target("sse2")))
+static inline __m128i predict_paeth_sse2(__m128i a, __m128i b, __m128i c)
+{
+    __m128i db = _mm_sub_epi16(b, c);
+    __m128i da = _mm_sub_epi16(a, c);
+    __m128i pa = _mm_max_epi16(db, _mm_sub_epi16(_mm_setzero_si128(), db));
+    __m128i pb = _mm_max_epi16(da, _mm_sub_epi16(_mm_setzero_si128(), da));
+    __m128i pc = _mm_add_epi16(da, db);
+
+    pc = _mm_max_epi16(pc, _mm_sub_epi16(_mm_setzero_si128(), pc));
+
+    __m128i not_a = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+    __m128i not_b = _mm_cmpgt_epi16(pb, pc);
+    __m128i b_c   = _mm_or_si128(_mm_andnot_si128(not_b, b), _mm_and_si128(not_b, c));
+
+    return _mm_or_si128(_mm_andnot_si128(not_a, a), _mm_and_si128(not_a, b_c));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i filter_paeth_sse2(__m128i raw, __m128i a, __m128i b, __m128i c)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i low  = predict_paeth_sse2(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+    __m128i high = predict_paeth_sse2(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+
+    return _mm_sub_epi8(raw, _mm_packus_epi16(low, high));
+}
+
+// First pixel has no left neighbours, rest of line is filtered sixteen bytes
+// at once with neighbours loaded at offset of pixel
+__attribute__((target("sse2")))
+void_t filter_png_line_sse2(const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs)
+{
+    const __m128i one  = _mm_set1_epi8(1);
+    __m128i       sums [PNG_FILTER_NUM];
+    uint32_t      x, i;
+
+    memset(costs, 0, sizeof(uint32_t) * PNG_FILTER_NUM);
+
+    filter_png_tail(line, prior, 0, (bpp < size) ? bpp : size, bpp, filtered, costs);
+
+    for (i = 0; i < PNG_FILTER_NUM; i ++)
+        sums[i] = _mm_setzero_si128();
+
+    for (x = bpp; x + 16 <= size; x += 16)
+    {
+        __m128i raw = _mm_loadu_si128((const __m128i*) (line + x));
+        __m128i a   = _mm_loadu_si128((const __m128i*) (line + x - bpp));
+        __m128i b   = _mm_loadu_si128((const __m128i*) (prior + x));
+        __m128i c   = _mm_loadu_si128((const __m128i*) (prior + x - bpp));
+
+        // Rounded average corrected to floor
+        __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        __m128i results [PNG_FILTER_NUM - 1] = {
+            _mm_sub_epi8(raw, a),
+            _mm_sub_epi8(raw, b),
+            _mm_sub_epi8(raw, average),
+            filter_paeth_sse2(raw, a, b, c)
+        };
+
+        sums[0] = add_filter_costs_sse2(sums[0], raw);
+
+        for (i = 0; i < PNG_FILTER_NUM - 1; i ++)
+        {
+            _mm_storeu_si128((__m128i*) (filtered[i] + x), results[i]);
+            sums[i + 1] = add_filter_costs_sse2(sums[i + 1], results[i]);
+        }
+    }
+
+    for (i = 0; i < PNG_FILTER_NUM; i ++)
+        costs[i] += (uint32_t) sum_lanes_sse2(sums[i]);
+
+    if (x < size)
+        filter_png_tail(line, prior, x, size, bpp, filtered, costs);
+}
+
+// Channels of two pixels in 16-bit lanes times their alpha (alpha lanes stay)
+__attribute__((target("sse2")))
+static inline __m128i premultiply_half_sse2(__m128i half)
+{
+    const __m128i round = _mm_set1_epi16(0x80);
+    const __m128i alpha = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+    __m128i product = _mm_add_epi16(_mm_mullo_epi16(half, _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, 0xFF), 0xFF)), round);
+
+    product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+
+    return _mm_or_si128(_mm_andnot_si128(alpha, product), _mm_and_si128(alpha, half));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i premultiply_sse2(__m128i pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    return _mm_packus_epi16(premultiply_half_sse2(_mm_unpacklo_epi8(pixels, zero)), premultiply_half_sse2(_mm_unpackhi_epi8(pixels, zero)));
+}
+
+// Eight pixels per byte of mask, alpha is cleared under set bits
+__attribute__((target("sse2")))
+void_t premultiply_mask_sse2(uint32_t* pixels, const uint8_t* mask, uint32_t width)
+{
+    const __m128i bits_high = _mm_setr_epi32(0x80, 0x40, 0x20, 0x10);
+    const __m128i bits_low  = _mm_setr_epi32(0x08, 0x04, 0x02, 0x01);
+    const __m128i color     = _mm_set1_epi32(0x00FFFFFF);
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m128i high = _mm_loadu_si128((const __m128i*) (pixels + x));
+        __m128i low  = _mm_loadu_si128((const __m128i*) (pixels + x + 4));
+
+        if (mask)
+        {
+            __m128i byte = _mm_set1_epi32(mask[x >> 3]);
+
+            high = _mm_and_si128(high, _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(byte, bits_high), _mm_setzero_si128()), color));
+            low  = _mm_and_si128(low,  _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(byte, bits_low),  _mm_setzero_si128()), color));
+        }
+
+        _mm_storeu_si128((__m128i*) (pixels + x),     premultiply_sse2(high));
+        _mm_storeu_si128((__m128i*) (pixels + x + 4), premultiply_sse2(low));
+    }
+
+    premultiply_mask_scalar(pixels + x, (mask) ? mask + (x >> 3) : NULL, width - x);
+}
+
+// AVX2
+
+__attribute__((target("avx2")))
+uint16_t sum_words_avx2(const uint8_t* data, size_t size)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t  i;
+
+    for (i = 0; i + 32 <= size; i += 32)
+        sum = _mm256_add_epi16(sum, _mm256_loadu_si256((const __m256i*) (data + i)));
+
+    __m128i  half = _mm_add_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    uint16_t lanes [8];
+
+    _mm_storeu_si128((__m128i*) lanes, half);
+
+    return (uint16_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]
+                     + sum_words_scalar(data + i, size - i));
+}
+
+__attribute__((target("avx2")))
+void_t expand_1_bit_avx2(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    const __m256i bits    = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m256i color_0 = _mm256_set1_epi32((sint_t) palette[0]);
+    const __m256i color_1 = _mm256_set1_epi32((sint_t) palette[1]);
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256i byte = _mm256_set1_epi32(src[x >> 3]);
+        __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(byte, bits), bits);
+
+        _mm256_storeu_si256((__m256i*) (dst + x), _mm256_blendv_epi8(color_0, color_1, mask));
+    }
+
+    expand_1_bit_scalar(src + (x >> 3), dst + x, width - x, palette);
+}
+
+__attribute__((target("avx2")))
+void_t expand_4_bit_avx2(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    const __m256i shifts = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+    const __m256i nibble = _mm256_set1_epi32(0x0F);
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        uint32_t packed;
+        memcpy(&packed, src + (x >> 1), sizeof(uint32_t));
+
+        // Every byte twice, then high nibble of first copy and low nibble of second one
+        __m128i bytes = _mm_cvtsi32_si128((sint_t) packed);
+        bytes = _mm_unpacklo_epi8(bytes, bytes);
+
+        __m256i index = _mm256_and_si256(_mm256_srlv_epi32(_mm256_cvtepu8_epi32(bytes), shifts), nibble);
+
+        _mm256_storeu_si256((__m256i*) (dst + x), _mm256_i32gather_epi32((const int*) palette, index, 4));
+    }
+
+    expand_4_bit_scalar(src + (x >> 1), dst + x, width - x, palette);
+}
+
+__attribute__((target("avx2")))
+void_t expand_8_bit_avx2(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    uint32_t x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (src + x)));
+
+        _mm256_storeu_si256((__m256i*) (dst + x), _mm256_i32gather_epi32((const int*) palette, index, 4));
+    }
+
+    expand_8_bit_scalar(src + x, dst + x, width - x, palette);
+}
+
+__attribute__((target("avx2")))
+void_t convert_24_to_32_avx2(const uint8_t* src, uint32_t* dst, uint32_t width)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha   = _mm256_set1_epi32((sint_t) 0xFF000000);
+    uint32_t      x;
+
+    // Every lane loads 16 bytes for 4 pixels (12 bytes), so 2 pixels are kept for tail
+    for (x = 0; x + 10 <= width; x += 8)
+    {
+        const uint8_t* line   = src + x * 3;
+        __m256i        pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) line)),
+                                                        _mm_loadu_si128((const __m128i*) (line + 12)), 1);
+
+        _mm256_storeu_si256((__m256i*) (dst + x), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha));
+    }
+
+    convert_24_to_32_scalar(src + x * 3, dst + x, width - x);
+}
+
+__attribute__((target("avx2")))
+void_t swap_red_blue_avx2(const uint32_t* src, uint32_t* dst, uint32_t width)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+        _mm256_storeu_si256((__m256i*) (dst + x), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) (src + x)), shuffle));
+
+    swap_red_blue_scalar(src + x, dst + x, width - x);
+}
+
+__attribute__((target("avx2")))
+void_t convert_32_to_24_avx2(const uint32_t* src, uint8_t* dst, uint32_t width)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                             2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    uint32_t      x;
+
+    // Every lane stores 16 bytes for 4 pixels (12 bytes), so 2 pixels are kept for tail
+    for (x = 0; x + 10 <= width; x += 8)
+    {
+        __m256i  pixels = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) (src + x)), shuffle);
+        uint8_t* line   = dst + x * 3;
+
+        _mm_storeu_si128((__m128i*) line,        _mm256_castsi256_si128(pixels));
+        _mm_storeu_si128((__m128i*) (line + 12), _mm256_extracti128_si256(pixels, 1));
+    }
+
+    convert_32_to_24_scalar(src + x, dst + x * 3, width - x);
+}
+
+__attribute__((target("avx2")))
+void_t convert_32_to_gray_avx2(const uint32_t* src, uint8_t* dst, uint32_t width)
+{
+    const __m256i weights = _mm256_setr_epi8(GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0,
+                                             GRAY_WEIGHT_BLUE, GRAY_WEIGHT_GREEN, GRAY_WEIGHT_RED, 0);
+    const __m256i ones    = _mm256_set1_epi16(1);
+    const __m256i round   = _mm256_set1_epi32(64);
+    const __m256i shuffle = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i gather  = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*) (src + x));
+        __m256i luma   = _mm256_madd_epi16(_mm256_maddubs_epi16(pixels, weights), ones);
+
+        luma = _mm256_srli_epi32(_mm256_add_epi32(luma, round), 7);
+        luma = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(luma, shuffle), gather);
+
+        _mm_storel_epi64((__m128i*) (dst + x), _mm256_castsi256_si128(luma));
+    }
+
+    convert_32_to_gray_scalar(src + x, dst + x, width - x);
+}
+
+__attribute__((target("avx2")))
+void_t expand_16_bit_avx2(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields)
+{
+    const __m256i alpha = _mm256_set1_epi16((sint16_t) (bitfields->alpha >> 16));
+    __m256i       limit [4], scale [4];
+    __m128i       shift [4], scale_shift [4];
+    uint32_t      i, x;
+
+    for (i = 0; i < 4; i ++)
+    {
+        shift[i]       = _mm_cvtsi32_si128((sint_t) bitfields->shift[i]);
+        limit[i]       = _mm256_set1_epi16((sint16_t) bitfields->limit[i]);
+        scale[i]       = _mm256_set1_epi16((sint16_t) bitfields->scale[i]);
+        scale_shift[i] = _mm_cvtsi32_si128((sint_t) bitfields->scale_shift[i]);
+    }
+
+    for (x = 0; x + 16 <= width; x += 16)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*) (src + x * 2));
+        __m256i channel [4];
+
+        for (i = 0; i < 4; i ++)
+            channel[i] = _mm256_srl_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srl_epi16(pixels, shift[i]), limit[i]), scale[i]), scale_shift[i]);
+
+        __m256i blue_green = _mm256_or_si256(channel[0], _mm256_slli_epi16(channel[1], 8));
+        __m256i red_alpha  = _mm256_or_si256(_mm256_or_si256(channel[2], _mm256_slli_epi16(channel[3], 8)), alpha);
+
+        // Unpacking works inside 128-bit lanes
+        __m256i low  = _mm256_unpacklo_epi16(blue_green, red_alpha);
+        __m256i high = _mm256_unpackhi_epi16(blue_green, red_alpha);
+
+        _mm256_storeu_si256((__m256i*) (dst + x),     _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256((__m256i*) (dst + x + 8), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+
+    expand_16_bit_scalar(src + x * 2, dst + x, width - x, bitfields);
+}
+
+__attribute__((target("avx2")))
+void_t expand_32_bit_avx2(const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields)
+{
+    const __m256i alpha = _mm256_set1_epi32((sint_t) bitfields->alpha);
+    __m256i       limit [4], scale [4];
+    __m128i       shift [4], scale_shift [4];
+    uint32_t      i, x;
+
+    for (i = 0; i < 4; i ++)
+    {
+        shift[i]       = _mm_cvtsi32_si128((sint_t) bitfields->shift[i]);
+        limit[i]       = _mm256_set1_epi32((sint_t) bitfields->limit[i]);
+        scale[i]       = _mm256_set1_epi32((sint_t) bitfields->scale[i]);
+        scale_shift[i] = _mm_cvtsi32_si128((sint_t) bitfields->scale_shift[i]);
+    }
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*) (src + x * 4));
+        __m256i result = alpha;
+
+        for (i = 0; i < 4; i ++)
+        {
+            __m256i channel = _mm256_srl_epi32(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srl_epi32(pixels, shift[i]), limit[i]), scale[i]), scale_shift[i]);
+
+            result = _mm256_or_si256(result, _mm256_sll_epi32(channel, _mm_cvtsi32_si128((sint_t) (i * 8))));
+        }
+
+        _mm256_storeu_si256((__m256i*) (dst + x), result);
+    }
+
+    expand_32_bit_scalar(src + x * 4, dst + x, width - x, bitfields);
+}
+
+__attribute__((target("avx2")))
+void_t resample_32_avx2(const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps)
+{
+    const __m256i spread = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+    uint32_t      x, i;
+
+    for (x = 0; x < width; x ++)
+    {
+        const uint32_t* pixels  = src + taps->first[x];
+        const sint16_t* weights = taps->weights + (size_t) taps->taps * x;
+        __m256i         sum     = _mm256_setzero_si256();
+
+        // Four pixels at once, pair of them in each 128-bit lane
+        for (i = 0; i + 4 <= taps->taps; i += 4)
+        {
+            __m256i quad  = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (pixels + i)));
+            __m256i pairs = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*) (weights + i))), spread);
+
+            quad = _mm256_unpacklo_epi16(quad, _mm256_unpackhi_epi64(quad, quad));
+            sum  = _mm256_add_epi32(sum, _mm256_madd_epi16(quad, pairs));
+        }
+
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+
+        dst[x] = round_pixel_sse2(resample_pixel_sse2(pixels, weights, i, taps->taps, half));
+    }
+}
+
+__attribute__((target("avx2")))
+void_t resample_8_avx2(const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps)
+{
+    uint32_t x, i;
+
+    for (x = 0; x < width; x ++)
+    {
+        const uint8_t*  pixels  = src + taps->first[x];
+        const sint16_t* weights = taps->weights + (size_t) taps->taps * x;
+        __m256i         wide    = _mm256_setzero_si256();
+
+        for (i = 0; i + 16 <= taps->taps; i += 16)
+        {
+            __m256i pixels_16 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (pixels + i)));
+
+            wide = _mm256_add_epi32(wide, _mm256_madd_epi16(pixels_16, _mm256_loadu_si256((const __m256i*) (weights + i))));
+        }
+
+        __m128i lanes = _mm_add_epi32(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+
+        dst[x] = round_weighted(sum_taps_8_sse2(pixels, weights, i, taps->taps, lanes));
+    }
+}
+
+// Same as SSE2 with 32 bytes, unpacks and packs stay inside 128-bit lanes, so
+// bytes come out in order
+__attribute__((target("avx2")))
+void_t resample_lines_avx2(const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi32(1 << (RESAMPLE_WEIGHT_BITS - 1));
+    uint32_t      x, i;
+
+    for (x = 0; x + 32 <= size; x += 32)
+    {
+        __m256i sum [4] = { round, round, round, round };
+
+        for (i = 0; i < taps; i += 2)
+        {
+            __m256i first  = _mm256_loadu_si256((const __m256i*) (lines[i] + x));
+            __m256i second = (i + 1 < taps) ? _mm256_loadu_si256((const __m256i*) (lines[i + 1] + x)) : zero;
+            __m256i pair   = _mm256_set1_epi32((sint_t) pair_weights(weights[i], (i + 1 < taps) ? weights[i + 1] : 0));
+            __m256i low_a  = _mm256_unpacklo_epi8(first, zero);
+            __m256i low_b  = _mm256_unpacklo_epi8(second, zero);
+            __m256i high_a = _mm256_unpackhi_epi8(first, zero);
+            __m256i high_b = _mm256_unpackhi_epi8(second, zero);
+
+            sum[0] = _mm256_add_epi32(sum[0], _mm256_madd_epi16(_mm256_unpacklo_epi16(low_a,  low_b),  pair));
+            sum[1] = _mm256_add_epi32(sum[1], _mm256_madd_epi16(_mm256_unpackhi_epi16(low_a,  low_b),  pair));
+            sum[2] = _mm256_add_epi32(sum[2], _mm256_madd_epi16(_mm256_unpacklo_epi16(high_a, high_b), pair));
+            sum[3] = _mm256_add_epi32(sum[3], _mm256_madd_epi16(_mm256_unpackhi_epi16(high_a, high_b), pair));
+        }
+
+        for (i = 0; i < 4; i ++)
+            sum[i] = _mm256_srai_epi32(sum[i], RESAMPLE_WEIGHT_BITS);
+
+        _mm256_storeu_si256((__m256i*) (dst + x), _mm256_packus_epi16(_mm256_packs_epi32(sum[0], sum[1]), _mm256_packs_epi32(sum[2], sum[3])));
+    }
+
+    resample_lines_tail(lines, weights, taps, dst, x, size);
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t sum_lanes_avx2(__m256i sum)
+{
+    return (uint32_t) sum_lanes_sse2(_mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+}
+
+// Same as SSE2 with 32 bytes (weights from 32 down to 1)
+__attribute__((target("avx2")))
+uint32_t adler_32_avx2(uint32_t adler, const uint8_t* data, size_t size)
+{
+    const __m256i zero      = _mm256_setzero_si256();
+    const __m256i weights_0 = _mm256_setr_epi16(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m256i weights_1 = _mm256_setr_epi16(16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1);
+    uint32_t      s1        = adler & 0xFFFF;
+    uint32_t      s2        = adler >> 16;
+
+    while (size >= 32)
+    {
+        size_t  block  = ((size < ADLER_BLOCK) ? size : ADLER_BLOCK) & ~(size_t) 31;
+        __m256i sums_1 = zero;
+        __m256i sums_2 = zero;
+        __m256i prior  = zero;
+        size_t  i;
+
+        for (i = 0; i < block; i += 32)
+        {
+            __m256i bytes = _mm256_loadu_si256((const __m256i*) (data + i));
+
+            prior  = _mm256_add_epi32(prior, sums_1);
+            sums_1 = _mm256_add_epi32(sums_1, _mm256_sad_epu8(bytes, zero));
+            sums_2 = _mm256_add_epi32(sums_2, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)), weights_0));
+            sums_2 = _mm256_add_epi32(sums_2, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)), weights_1));
+        }
+
+        uint64_t sum_2 = (uint64_t) s2 + (uint64_t) s1 * block + ((uint64_t) sum_lanes_avx2(prior) << 5) + sum_lanes_avx2(sums_2);
+
+        s1    = (uint32_t) ((s1 + sum_lanes_avx2(sums_1)) % ADLER_BASE);
+        s2    = (uint32_t) (sum_2 % ADLER_BASE);
+        data += block;
+        size -= block;
+    }
+
+    return adler_32_sse2((s2 << 16) | s1, data, size);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i add_filter_costs_avx2(__m256i costs, __m256i bytes)
+{
+    __m256i magnitudes = _mm256_min_epu8(bytes, _mm256_sub_epi8(_mm256_setzero_si256(), bytes));
+
+    return _mm256_add_epi64(costs, _mm256_sad_epu8(magnitudes, _mm256_setzero_si256()));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i predict_paeth_avx2(__m256i a, __m256i b, __m256i c)
+{
+    __m256i pa = _mm256_abs_epi16(_mm256_sub_epi16(b, c));
+    __m256i pb = _mm256_abs_epi16(_mm256_sub_epi16(a, c));
+    __m256i pc = _mm256_abs_epi16(_mm256_sub_epi16(_mm256_add_epi16(a, b), _mm256_add_epi16(c, c)));
+
+    __m256i not_a = _mm256_or_si256(_mm256_cmpgt_epi16(pa, pb), _mm256_cmpgt_epi16(pa, pc));
+    __m256i not_b = _mm256_cmpgt_epi16(pb, pc);
+
+    return _mm256_blendv_epi8(a, _mm256_blendv_epi8(b, c, not_b), not_a);
+}
+
+// Unpacks and packs stay inside 128-bit lanes, so bytes come out in order
+__attribute__((target("avx2")))
+static inline __m256i filter_paeth_avx2(__m256i raw, __m256i a, __m256i b, __m256i c)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256i low  = predict_paeth_avx2(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero), _mm256_unpacklo_epi8(c, zero));
+    __m256i high = predict_paeth_avx2(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero), _mm256_unpackhi_epi8(c, zero));
+
+    return _mm256_sub_epi8(raw, _mm256_packus_epi16(low, high));
+}
+
+__attribute__((target("avx2")))
+void_t filter_png_line_avx2(const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs)
+{
+    const __m256i one  = _mm256_set1_epi8(1);
+    __m256i       sums [PNG_FILTER_NUM];
+    uint32_t      x, i;
+
+    memset(costs, 0, sizeof(uint32_t) * PNG_FILTER_NUM);
+
+    filter_png_tail(line, prior, 0, (bpp < size) ? bpp : size, bpp, filtered, costs);
+
+    for (i = 0; i < PNG_FILTER_NUM; i ++)
+        sums[i] = _mm256_setzero_si256();
+
+    for (x = bpp; x + 32 <= size; x += 32)
+    {
+        __m256i raw = _mm256_loadu_si256((const __m256i*) (line + x));
+        __m256i a   = _mm256_loadu_si256((const __m256i*) (line + x - bpp));
+        __m256i b   = _mm256_loadu_si256((const __m256i*) (prior + x));
+        __m256i c   = _mm256_loadu_si256((const __m256i*) (prior + x - bpp));
+
+        __m256i average = _mm256_sub_epi8(_mm256_avg_epu8(a, b), _mm256_and_si256(_mm256_xor_si256(a, b), one));
+        __m256i results [PNG_FILTER_NUM - 1] = {
+            _mm256_sub_epi8(raw, a),
+            _mm256_sub_epi8(raw, b),
+            _mm256_sub_epi8(raw, average),
+            filter_paeth_avx2(raw, a, b, c)
+        };
+
+        sums[0] = add_filter_costs_avx2(sums[0], raw);
+
+        for (i = 0; i < PNG_FILTER_NUM - 1; i ++)
+        {
+            _mm256_storeu_si256((__m256i*) (filtered[i] + x), results[i]);
+            sums[i + 1] = add_filter_costs_avx2(sums[i + 1], results[i]);
+        }
+    }
+
+    for (i = 0; i < PNG_FILTER_NUM; i ++)
+        costs[i] += sum_lanes_avx2(sums[i]);
+
+    if (x < size)
+        filter_png_tail(line, prior, x, size, bpp, filtered, costs);
+}
+
+// Channels of four pixels in 16-bit lanes times their alpha (alpha lanes stay)
+__attribute__((target("avx2")))
+static inline __m256i premultiply_half_avx2(__m256i half)
+{
+    const __m256i round = _mm256_set1_epi16(0x80);
+    const __m256i alpha = _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+
+    __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(half, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(half, 0xFF), 0xFF)), round);
+
+    product = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+
+    return _mm256_blendv_epi8(product, half, alpha);
+}
+
+__attribute__((target("avx2")))
+void_t premultiply_mask_avx2(uint32_t* pixels, const uint8_t* mask, uint32_t width)
+{
+    const __m256i bits  = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m256i color = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i zero  = _mm256_setzero_si256();
+    uint32_t      x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256i line = _mm256_loadu_si256((const __m256i*) (pixels + x));
+
+        if (mask)
+            line = _mm256_and_si256(line, _mm256_or_si256(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask[x >> 3]), bits), zero), color));
+
+        // Unpacking and packing stay inside 128-bit lanes, so pixels keep their order
+        line = _mm256_packus_epi16(premultiply_half_avx2(_mm256_unpacklo_epi8(line, zero)), premultiply_half_avx2(_mm256_unpackhi_epi8(line, zero)));
+
+        _mm256_storeu_si256((__m256i*) (pixels + x), line);
+    }
+
+    premultiply_mask_scalar(pixels + x, (mask) ? mask + (x >> 3) : NULL, width - x);
+}
+
+// AVX-512
+
+__attribute__((target("avx512f,avx512bw")))
+uint16_t sum_words_avx512(const uint8_t* data, size_t size)
+{
+    __m512i sum = _mm512_setzero_si512();
+    size_t  i;
+
+    for (i = 0; i + 64 <= size; i += 64)
+        sum = _mm512_add_epi16(sum, _mm512_loadu_si512((const void_t*) (data + i)));
+
+    __m256i  quarter = _mm256_add_epi16(_mm512_castsi512_si256(sum), _mm512_extracti64x4_epi64(sum, 1));
+    __m128i  half    = _mm_add_epi16(_mm256_castsi256_si128(quarter), _mm256_extracti128_si256(quarter, 1));
+    uint16_t lanes [8];
+
+    _mm_storeu_si128((__m128i*) lanes, half);
+
+    return (uint16_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]
+                     + sum_words_scalar(data + i, size - i));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void_t expand_1_bit_avx512(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    const __m512i bits    = _mm512_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                              0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m512i color_0 = _mm512_set1_epi32((sint_t) palette[0]);
+    const __m512i color_1 = _mm512_set1_epi32((sint_t) palette[1]);
+    uint32_t      x;
+
+    for (x = 0; x + 16 <= width; x += 16)
+    {
+        // First byte in low half, second byte in high half
+        __m512i   bytes = _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_set1_epi32(src[x >> 3])),
+                                             _mm256_set1_epi32(src[(x >> 3) + 1]), 1);
+        __mmask16 mask  = _mm512_test_epi32_mask(bytes, bits);
+
+        _mm512_storeu_si512((void_t*) (dst + x), _mm512_mask_blend_epi32(mask, color_0, color_1));
+    }
+
+    expand_1_bit_scalar(src + (x >> 3), dst + x, width - x, palette);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void_t expand_4_bit_avx512(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    const __m512i shifts = _mm512_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0);
+    const __m512i nibble = _mm512_set1_epi32(0x0F);
+    uint32_t      x;
+
+    for (x = 0; x + 16 <= width; x += 16)
+    {
+        __m128i bytes = _mm_loadl_epi64((const __m128i*) (src + (x >> 1)));
+        bytes = _mm_unpacklo_epi8(bytes, bytes);
+
+        __m512i index = _mm512_and_si512(_mm512_srlv_epi32(_mm512_cvtepu8_epi32(bytes), shifts), nibble);
+
+        _mm512_storeu_si512((void_t*) (dst + x), _mm512_i32gather_epi32(index, (const void_t*) palette, 4));
+    }
+
+    expand_4_bit_scalar(src + (x >> 1), dst + x, width - x, palette);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void_t expand_8_bit_avx512(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette)
+{
+    uint32_t x;
+
+    for (x = 0; x + 16 <= width; x += 16)
+    {
+        __m512i index = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*) (src + x)));
+
+        _mm512_storeu_si512((void_t*) (dst + x), _mm512_i32gather_epi32(index, (const void_t*) palette, 4));
+    }
+
+    expand_8_bit_scalar(src + x, dst + x, width - x, palette);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void_t swap_red_blue_avx512(const uint32_t* src, uint32_t* dst, uint32_t width)
+{
+    const __m512i shuffle = _mm512_broadcast_i32x4(_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    uint32_t      x;
+
+    for (x = 0; x + 16 <= width; x += 16)
+        _mm512_storeu_si512((void_t*) (dst + x), _mm512_shuffle_epi8(_mm512_loadu_si512((const void_t*) (src + x)), shuffle));
+
+    swap_red_blue_scalar(src + x, dst + x, width - x);
+}
+
+#endif // KERNELS_X86
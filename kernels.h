@@ -0,0 +1,81 @@
+#ifndef __KERNELS_H__
+#define __KERNELS_H__
+
+#include <stddef.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "cpufeat.h"
+
+// Kernel implementations for every CPU level (use dispatch table of cpufeat.h)
+//
+// Vectorized kernels are compiled with target attributes, so single build
+// contains all of them. KERNELS_X86 is defined if they are available.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define KERNELS_X86
+#endif
+
+// Luma weights in 1/128 (fit into signed bytes for multiply-add)
+#define GRAY_WEIGHT_RED   38
+#define GRAY_WEIGHT_GREEN 75
+#define GRAY_WEIGHT_BLUE  15
+
+uint16_t sum_words_scalar    (const uint8_t* data, size_t size);
+void_t   expand_1_bit_scalar (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   expand_4_bit_scalar (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   expand_8_bit_scalar (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   convert_24_to_32_scalar   (const uint8_t* src, uint32_t* dst, uint32_t width);
+void_t   swap_red_blue_scalar      (const uint32_t* src, uint32_t* dst, uint32_t width);
+void_t   convert_32_to_24_scalar   (const uint32_t* src, uint8_t* dst, uint32_t width);
+void_t   convert_32_to_gray_scalar (const uint32_t* src, uint8_t* dst, uint32_t width);
+void_t   expand_16_bit_scalar      (const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+void_t   expand_32_bit_scalar      (const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+void_t   resample_32_scalar        (const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps);
+void_t   resample_8_scalar         (const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps);
+void_t   resample_lines_scalar     (const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size);
+uint32_t adler_32_scalar           (uint32_t adler, const uint8_t* data, size_t size);
+void_t   filter_png_line_scalar    (const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs);
+void_t   premultiply_mask_scalar   (uint32_t* pixels, const uint8_t* mask, uint32_t width);
+
+#ifdef KERNELS_X86
+
+uint16_t sum_words_sse2      (const uint8_t* data, size_t size);
+void_t   expand_1_bit_sse2   (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   swap_red_blue_sse2        (const uint32_t* src, uint32_t* dst, uint32_t width);
+void_t   convert_32_to_gray_sse2   (const uint32_t* src, uint8_t* dst, uint32_t width);
+void_t   expand_16_bit_sse2        (const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+void_t   expand_32_bit_sse2        (const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+void_t   resample_32_sse2          (const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps);
+void_t   resample_8_sse2           (const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps);
+void_t   resample_lines_sse2       (const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size);
+uint32_t adler_32_sse2             (uint32_t adler, const uint8_t* data, size_t size);
+void_t   filter_png_line_sse2      (const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs);
+void_t   premultiply_mask_sse2     (uint32_t* pixels, const uint8_t* mask, uint32_t width);
+
+uint16_t sum_words_avx2      (const uint8_t* data, size_t size);
+void_t   expand_1_bit_avx2   (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   expand_4_bit_avx2   (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   expand_8_bit_avx2   (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   convert_24_to_32_avx2     (const uint8_t* src, uint32_t* dst, uint32_t width);
+void_t   swap_red_blue_avx2        (const uint32_t* src, uint32_t* dst, uint32_t width);
+void_t   convert_32_to_24_avx2     (const uint32_t* src, uint8_t* dst, uint32_t width);
+void_t   convert_32_to_gray_avx2   (const uint32_t* src, uint8_t* dst, uint32_t width);
+void_t   expand_16_bit_avx2        (const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+void_t   expand_32_bit_avx2        (const uint8_t* src, uint32_t* dst, uint32_t width, const bitfields_t* bitfields);
+void_t   resample_32_avx2          (const uint32_t* src, uint32_t* dst, uint32_t width, const resample_taps_t* taps);
+void_t   resample_8_avx2           (const uint8_t* src, uint8_t* dst, uint32_t width, const resample_taps_t* taps);
+void_t   resample_lines_avx2       (const uint8_t* const* lines, const sint16_t* weights, uint32_t taps, uint8_t* dst, uint32_t size);
+uint32_t adler_32_avx2             (uint32_t adler, const uint8_t* data, size_t size);
+void_t   filter_png_line_avx2      (const uint8_t* line, const uint8_t* prior, uint32_t size, uint32_t bpp, uint8_t* const* filtered, uint32_t* costs);
+void_t   premultiply_mask_avx2     (uint32_t* pixels, const uint8_t* mask, uint32_t width);
+
+uint16_t sum_words_avx512    (const uint8_t* data, size_t size);
+void_t   expand_1_bit_avx512 (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   expand_4_bit_avx512 (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   expand_8_bit_avx512 (const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette);
+void_t   swap_red_blue_avx512      (const uint32_t* src, uint32_t* dst, uint32_t width);
+
+#endif // KERNELS_X86
+
+#endif // __KERNELS_H__
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "stats.h"
+#include "budget.h"
+
+#include "memalloc.h"
+
+struct _mem_chunk_t {
+    mem_chunk_t* next;
+    size_t       size;
+    size_t       used;
+    uint8_t*     data;
+};
+
+#define MEM_ALIGN(size) (((size) + (MEM_ARENA_ALIGNMENT - 1)) & ~((size_t) MEM_ARENA_ALIGNMENT - 1))
+
+// Every block is preceded by allocator which made it (padded to keep data aligned)
+#define MEM_OWNER_HEADER_SIZE MEM_ALIGN(sizeof(mem_allocator_t*))
+
+// Every arena block is preceded by its size (padded to keep data aligned)
+#define MEM_BLOCK_HEADER_SIZE MEM_ALIGN(sizeof(size_t))
+#define MEM_CHUNK_HEADER_SIZE MEM_ALIGN(sizeof(mem_chunk_t))
+
+static void_t* heap_alloc(void_t* context, size_t size)
+{
+    return malloc(size);
+}
+
+static void_t* heap_realloc(void_t* context, void_t* block, size_t size)
+{
+    return realloc(block, size);
+}
+
+static void_t heap_free(void_t* context, void_t* block)
+{
+    free(block);
+}
+
+static mem_allocator_t heap_allocator = {
+    heap_alloc,
+    heap_realloc,
+    heap_free,
+    NULL
+};
+
+static THREAD_LOCAL mem_allocator_t* current_allocator = NULL;
+
+mem_allocator_t* get_mem_allocator(void_t)
+{
+    return (current_allocator) ? current_allocator : &heap_allocator;
+}
+
+mem_allocator_t* set_mem_allocator(mem_allocator_t* allocator)
+{
+    mem_allocator_t* previous = current_allocator;
+
+    current_allocator = (allocator == &heap_allocator) ? NULL : allocator;
+
+    return previous;
+}
+
+static inline mem_allocator_t** get_block_owner(const void_t* block)
+{
+    return (mem_allocator_t**) (((uint8_t*) block) - MEM_OWNER_HEADER_SIZE);
+}
+
+mem_allocator_t* get_mem_block_allocator(const void_t* block)
+{
+    return (block) ? *get_block_owner(block) : get_mem_allocator();
+}
+
+void_t* mem_alloc(size_t size)
+{
+    mem_allocator_t* allocator = get_mem_allocator();
+
+    if (size > ((size_t) -1) - MEM_OWNER_HEADER_SIZE)
+        return NULL;
+
+    if (! use_budget_alloc(size))
+        return NULL;
+
+#ifdef USE_STATS
+    add_stats_alloc(size);
+#endif
+
+    uint8_t* block = (uint8_t*) allocator->alloc(allocator->context, MEM_OWNER_HEADER_SIZE + size);
+
+    if (! block)
+        return NULL;
+
+    *((mem_allocator_t**) block) = allocator;
+
+    return block + MEM_OWNER_HEADER_SIZE;
+}
+
+void_t* mem_calloc(size_t count, size_t size)
+{
+    if ((size) && (count > ((size_t) -1) / size))
+        return NULL;
+
+    void_t* block = mem_alloc(count * size);
+
+    if (block)
+        memset(block, 0, count * size);
+
+    return block;
+}
+
+void_t* mem_realloc(void_t* block, size_t size)
+{
+    if (! block)
+        return mem_alloc(size);
+
+    // Block stays with allocator which made it, whichever one is current
+    mem_allocator_t* allocator = *get_block_owner(block);
+
+    if (size > ((size_t) -1) - MEM_OWNER_HEADER_SIZE)
+        return NULL;
+
+    if (! use_budget_alloc(size))
+        return NULL;
+
+#ifdef USE_STATS
+    add_stats_alloc(size);
+#endif
+
+    uint8_t* new_block = (uint8_t*) allocator->realloc(allocator->context, get_block_owner(block), MEM_OWNER_HEADER_SIZE + size);
+
+    return (new_block) ? new_block + MEM_OWNER_HEADER_SIZE : NULL;
+}
+
+void_t mem_free(void_t* block)
+{
+    if (! block)
+        return;
+
+    mem_allocator_t* allocator = *get_block_owner(block);
+
+#ifdef USE_STATS
+    add_stats_free();
+#endif
+
+    allocator->free(allocator->context, get_block_owner(block));
+}
+
+static mem_chunk_t* new_mem_chunk(size_t size)
+{
+    // Chunks always come from heap (arena can be current allocator here)
+    mem_chunk_t* chunk = (mem_chunk_t*) malloc(MEM_CHUNK_HEADER_SIZE + size);
+
+    if (! chunk)
+        return NULL;
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->data = ((uint8_t*) chunk) + MEM_CHUNK_HEADER_SIZE;
+
+    return chunk;
+}
+
+static void_t del_mem_chunks(mem_chunk_t* chunk)
+{
+    while (chunk)
+    {
+        mem_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+static inline size_t get_block_size(void_t* block)
+{
+    return *((size_t*) (((uint8_t*) block) - MEM_BLOCK_HEADER_SIZE));
+}
+
+static inline bool_e is_last_block(mem_arena_t* arena, void_t* block)
+{
+    mem_chunk_t* chunk = arena->current;
+
+    if ((! chunk) || ((uint8_t*) block < chunk->data) || ((uint8_t*) block >= chunk->data + chunk->used))
+        return FALSE;
+
+    return (((uint8_t*) block) + MEM_ALIGN(get_block_size(block)) == chunk->data + chunk->used) ? TRUE : FALSE;
+}
+
+static void_t* arena_alloc(void_t* context, size_t size)
+{
+    mem_arena_t* arena = (mem_arena_t*) context;
+    mem_chunk_t* chunk = arena->current;
+
+    if (size > ((size_t) -1) - 2 * MEM_BLOCK_HEADER_SIZE)
+        return NULL;
+
+    size_t total = MEM_BLOCK_HEADER_SIZE + MEM_ALIGN(size);
+
+    if (total > arena->chunk_size)
+    {
+        // Dedicated chunk (released by reset)
+        chunk = new_mem_chunk(total);
+
+        if (! chunk)
+            return NULL;
+
+        chunk->next      = arena->oversized;
+        arena->oversized = chunk;
+
+        arena->bytes_reserved += total;
+    }
+    else
+    {
+        // Find chunk with enough space (chunks after current are empty)
+        while ((chunk) && (chunk->used + total > chunk->size))
+            chunk = chunk->next;
+
+        if (! chunk)
+        {
+            chunk = new_mem_chunk(arena->chunk_size);
+
+            if (! chunk)
+                return NULL;
+
+            if (arena->current)
+            {
+                mem_chunk_t* tail = arena->current;
+
+                while (tail->next)
+                    tail = tail->next;
+
+                tail->next = chunk;
+            }
+            else
+                arena->chunks = chunk;
+
+            arena->bytes_reserved += arena->chunk_size;
+        }
+
+        arena->current = chunk;
+    }
+
+    uint8_t* block = chunk->data + chunk->used + MEM_BLOCK_HEADER_SIZE;
+
+    *((size_t*) (block - MEM_BLOCK_HEADER_SIZE)) = size;
+
+    chunk->used       += total;
+    arena->bytes_used += total;
+
+    return block;
+}
+
+static void_t arena_free(void_t* context, void_t* block)
+{
+    mem_arena_t* arena = (mem_arena_t*) context;
+
+    // Only the last block can be given back, others live until reset
+    if (is_last_block(arena, block))
+    {
+        size_t total = MEM_BLOCK_HEADER_SIZE + MEM_ALIGN(get_block_size(block));
+
+        arena->current->used -= total;
+        arena->bytes_used    -= total;
+    }
+}
+
+static void_t* arena_realloc(void_t* context, void_t* block, size_t size)
+{
+    mem_arena_t* arena = (mem_arena_t*) context;
+
+    if (! block)
+        return arena_alloc(context, size);
+
+    size_t old_size = get_block_size(block);
+
+    // Grow or shrink last block in place
+    if ((is_last_block(arena, block)) && (size <= arena->chunk_size))
+    {
+        mem_chunk_t* chunk = arena->current;
+        size_t       start = ((uint8_t*) block) - chunk->data;
+
+        if (start + MEM_ALIGN(size) <= chunk->size)
+        {
+            arena->bytes_used -= chunk->used;
+            chunk->used        = start + MEM_ALIGN(size);
+            arena->bytes_used += chunk->used;
+
+            *((size_t*) (((uint8_t*) block) - MEM_BLOCK_HEADER_SIZE)) = size;
+            return block;
+        }
+    }
+
+    void_t* new_block = arena_alloc(context, size);
+
+    if (! new_block)
+        return NULL;
+
+    memcpy(new_block, block, (old_size < size) ? old_size : size);
+
+    return new_block;
+}
+
+mem_arena_t* new_mem_arena(size_t chunk_size)
+{
+    mem_arena_t* arena = (mem_arena_t*) malloc(sizeof(mem_arena_t));
+
+    if (! arena)
+        return NULL;
+
+    arena->allocator.alloc   = arena_alloc;
+    arena->allocator.realloc = arena_realloc;
+    arena->allocator.free    = arena_free;
+    arena->allocator.context = arena;
+
+    arena->chunks         = NULL;
+    arena->current        = NULL;
+    arena->oversized      = NULL;
+    arena->chunk_size     = MEM_ALIGN((chunk_size) ? chunk_size : MEM_ARENA_CHUNK_SIZE);
+    arena->bytes_used     = 0;
+    arena->bytes_reserved = 0;
+
+    return arena;
+}
+
+mem_allocator_t* get_mem_arena_allocator(mem_arena_t* arena)
+{
+    return &arena->allocator;
+}
+
+void_t reset_mem_arena(mem_arena_t* arena)
+{
+    mem_chunk_t* chunk;
+
+    del_mem_chunks(arena->oversized);
+    arena->oversized      = NULL;
+    arena->bytes_reserved = 0;
+
+    for (chunk = arena->chunks; chunk; chunk = chunk->next)
+    {
+        chunk->used            = 0;
+        arena->bytes_reserved += chunk->size;
+    }
+
+    arena->current    = arena->chunks;
+    arena->bytes_used = 0;
+}
+
+void_t del_mem_arena(mem_arena_t* arena)
+{
+    if (current_allocator == &arena->allocator)
+        current_allocator = NULL;
+
+    del_mem_chunks(arena->oversized);
+    del_mem_chunks(arena->chunks);
+    free(arena);
+}
@@ -0,0 +1,70 @@
+#ifndef __MEMALLOC_H__
+#define __MEMALLOC_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Allocator hooks
+//
+// All parsers allocate through mem_alloc/mem_realloc/mem_free, which forward
+// to the allocator that is current for the calling thread (heap by default).
+// Every block records allocator which made it, mem_realloc/mem_free go through
+// that one, so objects can be deleted (del_* functions) under any allocator.
+// Allocator must outlive its blocks (arena reset releases them all at once).
+
+typedef void_t* (*mem_alloc_func_t)   (void_t* context, size_t size);
+typedef void_t* (*mem_realloc_func_t) (void_t* context, void_t* block, size_t size);
+typedef void_t  (*mem_free_func_t)    (void_t* context, void_t* block);
+
+typedef struct _mem_allocator_t {
+    mem_alloc_func_t   alloc;
+    mem_realloc_func_t realloc;
+    mem_free_func_t    free;
+    void_t*            context;
+} mem_allocator_t;
+
+mem_allocator_t* get_mem_allocator(void_t);
+mem_allocator_t* set_mem_allocator(mem_allocator_t* allocator); // Returns previous allocator, NULL selects heap
+mem_allocator_t* get_mem_block_allocator(const void_t* block);   // Allocator which made block, current one for NULL
+
+void_t* mem_alloc   (size_t size);
+void_t* mem_calloc  (size_t count, size_t size);
+void_t* mem_realloc (void_t* block, size_t size);
+void_t  mem_free    (void_t* block);
+
+// Bump arena
+//
+// Blocks are carved sequentially from chunks of chunk_size bytes (bigger
+// requests get a dedicated chunk). Freeing a block is a no-op unless it is
+// the last one allocated, so a whole exe_info + resource table + font graph
+// is released at once by reset_mem_arena. Chunks are kept for reuse.
+//
+// Usage:
+//   mem_allocator_t* prev = set_mem_allocator(get_mem_arena_allocator(arena));
+//   ... get_exe_info(), get_resource_table_info(), get_rt_font() ...
+//   set_mem_allocator(prev);
+//   reset_mem_arena(arena);
+
+#define MEM_ARENA_CHUNK_SIZE 0x10000
+#define MEM_ARENA_ALIGNMENT  0x10
+
+typedef struct _mem_chunk_t mem_chunk_t;
+
+typedef struct _mem_arena_t {
+    mem_allocator_t allocator;
+    mem_chunk_t*    chunks;
+    mem_chunk_t*    current;
+    mem_chunk_t*    oversized;
+    size_t          chunk_size;
+    size_t          bytes_used;
+    size_t          bytes_reserved;
+} mem_arena_t;
+
+mem_arena_t*     new_mem_arena(size_t chunk_size); // Zero selects MEM_ARENA_CHUNK_SIZE
+mem_allocator_t* get_mem_arena_allocator(mem_arena_t* arena);
+void_t           reset_mem_arena(mem_arena_t* arena);
+void_t           del_mem_arena(mem_arena_t* arena);
+
+#endif // __MEMALLOC_H__
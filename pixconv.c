@@ -0,0 +1,625 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "stats.h"
+#include "cancel.h"
+#include "cpufeat.h"
+
+#include "rt_btmap.h"
+#include "pixconv.h"
+
+static const char_t* pixel_format_str [PIXEL_FORMAT_NUM] = {
+    "rgba32",
+    "bgra32",
+    "rgb24",
+    "gray8"
+};
+
+static const uint32_t pixel_format_bit_count [PIXEL_FORMAT_NUM] = {
+    32,
+    32,
+    24,
+    8
+};
+
+// Multiply and shift repeating channel of 0..7 bits up to 8 bits
+static const uint32_t bitfields_scale [8][2] = {
+    {   0, 0 },
+    { 255, 0 },
+    {  85, 0 },
+    {  73, 1 },
+    {  17, 0 },
+    {  33, 2 },
+    {  65, 4 },
+    { 129, 6 }
+};
+
+static const bitmap_masks_t default_masks_16 = { 0x7C00,     0x03E0,     0x001F,     0 };
+static const bitmap_masks_t default_masks_32 = { 0x00FF0000, 0x0000FF00, 0x000000FF, 0 };
+
+// Palette of bitmap (default one without table)
+static color_palette_t* get_palette(rt_bitmap_t* rt_bitmap, uint32_t bit_count)
+{
+    return ((rt_bitmap) && (rt_bitmap->color_palette)) ? rt_bitmap->color_palette : get_color_palette_default(bit_count);
+}
+
+// Colors of palette as BGRA, returns their number
+static uint32_t fill_palette_colors(uint32_t* palette, rt_bitmap_t* rt_bitmap, uint32_t bit_count)
+{
+    color_palette_t* color_palette = get_palette(rt_bitmap, bit_count);
+    uint32_t         colors_num    = get_colors_num(bit_count);
+
+    if (colors_num > color_palette->colors_num)
+        colors_num = color_palette->colors_num;
+
+    memcpy(palette, get_color_palette_pixels(color_palette, FALSE), sizeof(uint32_t) * COLORS_IN_8_BIT_TABLE);
+
+    return colors_num;
+}
+
+// Indexed pixels get final channel order right from palette
+static void_t fill_palette(pixel_conv_t* pixel_conv, rt_bitmap_t* rt_bitmap)
+{
+    pixel_conv->color_palette = retain_color_palette(get_palette(rt_bitmap, pixel_conv->bit_count));
+    pixel_conv->palette       = get_color_palette_pixels(pixel_conv->color_palette, (pixel_conv->format == PIXEL_RGBA32) ? TRUE : FALSE);
+}
+
+static void_t expand_32_bit_line(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t alpha)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++, src += 4)
+    {
+        uint32_t pixel;
+        memcpy(&pixel, src, sizeof(uint32_t));
+
+        dst[x] = pixel | alpha;
+    }
+}
+
+static sint_t fill_bitfields(pixel_conv_t* pixel_conv, rt_bitmap_t* rt_bitmap)
+{
+    bitmap_masks_t bitmap_masks = (pixel_conv->bit_count == 16) ? default_masks_16 : default_masks_32;
+
+    if ((rt_bitmap) && (calc_rt_bitmap_masks(rt_bitmap, &bitmap_masks) < 0))
+        return -1;
+
+    if (calc_pixel_bitfields(&bitmap_masks, pixel_conv->bit_count, &pixel_conv->bitfields) < 0)
+        return -1;
+
+    // Most 32-bit pixels are copied (with alpha or opaque)
+    pixel_conv->bgra = ((pixel_conv->bit_count == 32) && (bitmap_masks.red == 0x00FF0000) && (bitmap_masks.green == 0x0000FF00)
+                    &&  (bitmap_masks.blue == 0x000000FF) && ((! bitmap_masks.alpha) || (bitmap_masks.alpha == 0xFF000000))) ? TRUE : FALSE;
+
+    return 0;
+}
+
+static void_t pack_bitfields_line(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t bit_count, uint32_t lookup [4][0x100])
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x ++)
+    {
+        uint32_t pixel = lookup[0][src[x] & 0xFF] | lookup[1][(src[x] >> 8) & 0xFF]
+                       | lookup[2][(src[x] >> 16) & 0xFF] | lookup[3][src[x] >> 24];
+
+        // Little-endian pixels
+        *dst ++ = (uint8_t) pixel;
+        *dst ++ = (uint8_t) (pixel >> 8);
+
+        if (bit_count == 32)
+        {
+            *dst ++ = (uint8_t) (pixel >> 16);
+            *dst ++ = (uint8_t) (pixel >> 24);
+        }
+    }
+}
+
+static sint_t fill_pack_lookup(pixel_pack_t* pixel_pack, rt_bitmap_t* rt_bitmap)
+{
+    bitmap_masks_t bitmap_masks = (pixel_pack->bit_count == 16) ? default_masks_16 : default_masks_32;
+    bitfields_t    bitfields;
+
+    // Same masks as decoding accepts
+    if (((rt_bitmap) && (calc_rt_bitmap_masks(rt_bitmap, &bitmap_masks) < 0))
+    ||  (calc_pixel_bitfields(&bitmap_masks, pixel_pack->bit_count, &bitfields) < 0))
+        return -1;
+
+    // Every channel value is looked up already in place of its mask
+    uint32_t masks [4] = { bitmap_masks.blue, bitmap_masks.green, bitmap_masks.red, bitmap_masks.alpha };
+    uint32_t i, value;
+
+    for (i = 0; i < 4; i ++)
+    {
+        uint32_t low = 0, max = 0;
+
+        if (masks[i])
+        {
+            while (! ((masks[i] >> low) & 1))
+                low ++;
+
+            max = masks[i] >> low;
+        }
+
+        // Narrow channel keeps high bits, wide one is scaled
+        for (value = 0; value < 0x100; value ++)
+            pixel_pack->lookup[i][value] = ((max < 0xFF) ? ((value * (max + 1)) >> 8) : (uint32_t) (((uint64_t) value * max) / 0xFF)) << low;
+    }
+
+    return 0;
+}
+
+// Nearest color of table (alpha is ignored), found colors are cached
+static uint8_t find_color(pixel_pack_t* pixel_pack, uint32_t color)
+{
+    color &= 0x00FFFFFF;
+
+    uint32_t slot = (color * 0x9E3779B1) >> (32 - PIXEL_PACK_CACHE_BITS);
+
+    if (pixel_pack->cache_key[slot] == (color | PIXEL_PACK_CACHED))
+        return pixel_pack->cache_index[slot];
+
+    uint32_t i, best = 0, best_distance = 0xFFFFFFFF;
+
+    for (i = 0; (i < pixel_pack->colors_num) && (best_distance); i ++)
+    {
+        sint32_t blue     = (sint32_t) (color & 0xFF)         - (sint32_t) (pixel_pack->palette[i] & 0xFF);
+        sint32_t green    = (sint32_t) ((color >> 8) & 0xFF)  - (sint32_t) ((pixel_pack->palette[i] >> 8) & 0xFF);
+        sint32_t red      = (sint32_t) ((color >> 16) & 0xFF) - (sint32_t) ((pixel_pack->palette[i] >> 16) & 0xFF);
+        uint32_t distance = (uint32_t) (red * red + green * green + blue * blue);
+
+        if (distance < best_distance)
+        {
+            best          = i;
+            best_distance = distance;
+        }
+    }
+
+    pixel_pack->cache_key[slot]   = color | PIXEL_PACK_CACHED;
+    pixel_pack->cache_index[slot] = (uint8_t) best;
+
+    return (uint8_t) best;
+}
+
+pixel_conv_t* new_pixel_conv(rt_bitmap_t* rt_bitmap, uint32_t bit_count, uint32_t width, pixel_format_e format)
+{
+    if ((format >= PIXEL_FORMAT_NUM) || (! width))
+        return NULL;
+
+    switch (bit_count)
+    {
+        case  1:
+        case  4:
+        case  8:
+        case 16:
+        case 24:
+        case 32:
+            break;
+
+        default:
+            return NULL;
+    }
+
+    // Only RLE lines are decoded by load_rt_bitmap_data()
+    if ((rt_bitmap) && (BITMAP_CORE != rt_bitmap->info_type))
+    {
+        uint32_t compression = ((bitmap_info_header_t*) rt_bitmap->info_header)->compression;
+
+        if ((compression != BI_RGB) && (compression != BI_RLE8) && (compression != BI_RLE4) && (compression != BI_BITFIELDS))
+            return NULL;
+    }
+
+    pixel_conv_t* pixel_conv = (pixel_conv_t*) mem_alloc(sizeof(pixel_conv_t));
+
+    if (! pixel_conv)
+        return NULL;
+
+    pixel_conv->format    = format;
+    pixel_conv->bit_count = bit_count;
+    pixel_conv->width     = width;
+    pixel_conv->kernels   = get_cpu_kernels();
+    pixel_conv->bgra          = FALSE;
+    pixel_conv->line          = NULL;
+    pixel_conv->color_palette = NULL;
+    pixel_conv->palette       = NULL;
+
+    if (((bit_count == 16) || (bit_count == 32)) && (fill_bitfields(pixel_conv, rt_bitmap) < 0))
+    {
+        mem_free(pixel_conv);
+        return NULL;
+    }
+
+    if (get_pixel_format_bit_count(format) != 32)
+    {
+        pixel_conv->line = (uint32_t*) mem_alloc(sizeof(uint32_t) * width);
+
+        if (! pixel_conv->line)
+        {
+            mem_free(pixel_conv);
+            return NULL;
+        }
+    }
+
+    if (get_colors_num(bit_count))
+        fill_palette(pixel_conv, rt_bitmap);
+
+    return pixel_conv;
+}
+
+sint_t convert_pixel_line(pixel_conv_t* pixel_conv, const void_t* src, void_t* dst)
+{
+    if ((! pixel_conv) || (! src) || (! dst))
+        return -1;
+
+    const cpu_kernels_t* kernels = pixel_conv->kernels;
+    uint32_t             width   = pixel_conv->width;
+    bool_e               swap    = (pixel_conv->format == PIXEL_RGBA32) ? TRUE : FALSE;
+
+    // 32-bit formats are built in place of output
+    uint32_t* line = (pixel_conv->line) ? pixel_conv->line : (uint32_t*) dst;
+
+    switch (pixel_conv->bit_count)
+    {
+        case  1: kernels->expand_1_bit((const uint8_t*) src, line, width, pixel_conv->palette); swap = FALSE; break;
+        case  4: kernels->expand_4_bit((const uint8_t*) src, line, width, pixel_conv->palette); swap = FALSE; break;
+        case  8: kernels->expand_8_bit((const uint8_t*) src, line, width, pixel_conv->palette); swap = FALSE; break;
+        case 16: kernels->expand_16_bit((const uint8_t*) src, line, width, &pixel_conv->bitfields); break;
+        case 24: kernels->convert_24_to_32((const uint8_t*) src, line, width);                  break;
+        case 32:
+            if (pixel_conv->bgra)
+                expand_32_bit_line((const uint8_t*) src, line, width, pixel_conv->bitfields.alpha);
+            else
+                kernels->expand_32_bit((const uint8_t*) src, line, width, &pixel_conv->bitfields);
+            break;
+        default: return -1;
+    }
+
+    switch (pixel_conv->format)
+    {
+        case PIXEL_RGBA32:
+            if (swap)
+                kernels->swap_red_blue(line, line, width);
+            break;
+
+        case PIXEL_RGB24:
+            kernels->convert_32_to_24(line, (uint8_t*) dst, width);
+            break;
+
+        case PIXEL_GRAY8:
+            kernels->convert_32_to_gray(line, (uint8_t*) dst, width);
+            break;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+void_t del_pixel_conv(pixel_conv_t* pixel_conv)
+{
+    if (pixel_conv->color_palette)
+        release_color_palette(pixel_conv->color_palette);
+    if (pixel_conv->line)
+        mem_free(pixel_conv->line);
+    mem_free(pixel_conv);
+}
+
+pixel_pack_t* new_pixel_pack(rt_bitmap_t* rt_bitmap, uint32_t bit_count, uint32_t width)
+{
+    if (! width)
+        return NULL;
+
+    switch (bit_count)
+    {
+        case  1:
+        case  4:
+        case  8:
+        case 16:
+        case 24:
+        case 32:
+            break;
+
+        default:
+            return NULL;
+    }
+
+    pixel_pack_t* pixel_pack = (pixel_pack_t*) mem_calloc(1, sizeof(pixel_pack_t));
+
+    if (! pixel_pack)
+        return NULL;
+
+    pixel_pack->bit_count = bit_count;
+    pixel_pack->width     = width;
+
+    if (((bit_count == 16) || (bit_count == 32)) && (fill_pack_lookup(pixel_pack, rt_bitmap) < 0))
+    {
+        mem_free(pixel_pack);
+        return NULL;
+    }
+
+    if (get_colors_num(bit_count))
+        pixel_pack->colors_num = fill_palette_colors(pixel_pack->palette, rt_bitmap, bit_count);
+
+    return pixel_pack;
+}
+
+sint_t pack_pixel_line(pixel_pack_t* pixel_pack, const uint32_t* src, void_t* dst)
+{
+    if ((! pixel_pack) || (! src) || (! dst))
+        return -1;
+
+    uint32_t bit_count = pixel_pack->bit_count;
+    uint32_t width     = pixel_pack->width;
+    uint8_t* line      = (uint8_t*) dst;
+    uint32_t x;
+
+    switch (bit_count)
+    {
+        case  1:
+        case  4:
+            memset(line, 0, (width * bit_count + 7) / 8);
+
+            // First pixel in high bits
+            for (x = 0; x < width; x ++)
+                line[(x * bit_count) / 8] |= (uint8_t) (find_color(pixel_pack, src[x]) << (8 - bit_count - (x * bit_count) % 8));
+            break;
+
+        case  8:
+            for (x = 0; x < width; x ++)
+                line[x] = find_color(pixel_pack, src[x]);
+            break;
+
+        case 24:
+            for (x = 0; x < width; x ++)
+            {
+                *line ++ = (uint8_t) src[x];
+                *line ++ = (uint8_t) (src[x] >> 8);
+                *line ++ = (uint8_t) (src[x] >> 16);
+            }
+            break;
+
+        default:
+            pack_bitfields_line(src, line, width, bit_count, pixel_pack->lookup);
+            break;
+    }
+
+    return 0;
+}
+
+void_t del_pixel_pack(pixel_pack_t* pixel_pack)
+{
+    mem_free(pixel_pack);
+}
+
+uint32_t get_pixel_format_bit_count(pixel_format_e format)
+{
+    return (format < PIXEL_FORMAT_NUM) ? pixel_format_bit_count[format] : 0;
+}
+
+const char_t* convert_pixel_format_to_text(pixel_format_e format)
+{
+    return (format < PIXEL_FORMAT_NUM) ? pixel_format_str[format] : NULL;
+}
+
+sint_t calc_pixel_bitfields(const bitmap_masks_t* bitmap_masks, uint32_t bit_count, bitfields_t* bitfields)
+{
+    if ((! bitmap_masks) || (! bitfields) || ((bit_count != 16) && (bit_count != 32)))
+        return -1;
+
+    // Order of BGRA pixel
+    uint32_t masks [4] = { bitmap_masks->blue, bitmap_masks->green, bitmap_masks->red, bitmap_masks->alpha };
+    uint32_t i;
+
+    for (i = 0; i < 4; i ++)
+    {
+        uint32_t mask = masks[i];
+        uint32_t low  = 0;
+        uint32_t bits = 0;
+
+        if ((bit_count == 16) && (mask > 0xFFFF))
+            return -1;
+
+        if (mask)
+        {
+            while (! (mask & 1))
+            {
+                mask >>= 1;
+                low  ++;
+            }
+
+            while (mask & 1)
+            {
+                mask >>= 1;
+                bits ++;
+            }
+
+            // Holes in mask
+            if (mask)
+                return -1;
+        }
+
+        // Wide channel keeps its high 8 bits
+        if (bits >= 8)
+        {
+            bitfields->shift[i]       = low + bits - 8;
+            bitfields->limit[i]       = 0xFF;
+            bitfields->scale[i]       = 1;
+            bitfields->scale_shift[i] = 0;
+        }
+        else
+        {
+            bitfields->shift[i]       = low;
+            bitfields->limit[i]       = (1u << bits) - 1;
+            bitfields->scale[i]       = bitfields_scale[bits][0];
+            bitfields->scale_shift[i] = bitfields_scale[bits][1];
+        }
+    }
+
+    bitfields->alpha = (bitmap_masks->alpha) ? 0 : 0xFF000000;
+
+    return 0;
+}
+
+sint_t calc_rt_bitmap_pixels(rt_bitmap_data_t* rt_bitmap_data, pixel_format_e format, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_pixels)
+{
+    if ((! rt_bitmap_data) || (! rt_bitmap_pixels) || (format >= PIXEL_FORMAT_NUM))
+        return -1;
+
+    uint32_t bit_count = get_pixel_format_bit_count(format);
+
+    // Stride of 32-bit pixels stays multiple of pixel size
+    if (bit_count == 32)
+        alignment = calc_aligned_line_size(((alignment) ? alignment : sizeof(uint32_t)), sizeof(uint32_t));
+
+    rt_bitmap_pixels->bit_count = bit_count;
+    rt_bitmap_pixels->width     = rt_bitmap_data->width;
+    rt_bitmap_pixels->height    = rt_bitmap_data->height;
+    rt_bitmap_pixels->line_size = calc_aligned_line_size(rt_bitmap_data->width * (bit_count / 8), alignment);
+    rt_bitmap_pixels->size      = rt_bitmap_pixels->line_size * rt_bitmap_pixels->height;
+    rt_bitmap_pixels->data      = NULL;
+
+    return 0;
+}
+
+sint_t convert_rt_bitmap_data(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, pixel_format_e format, rt_bitmap_data_t* rt_bitmap_pixels)
+{
+    STATS_SCOPE(STATS_CONVERT_RT_BITMAP_DATA);
+
+    if ((! rt_bitmap_data) || (! rt_bitmap_data->data) || (! rt_bitmap_pixels) || (! rt_bitmap_pixels->data))
+        return -1;
+
+    uint32_t bit_count = get_pixel_format_bit_count(format);
+
+    if ((rt_bitmap_pixels->bit_count != bit_count) || (rt_bitmap_pixels->width != rt_bitmap_data->width)
+    ||  (rt_bitmap_pixels->height != rt_bitmap_data->height) || (! rt_bitmap_pixels->line_size)
+    ||  (rt_bitmap_pixels->line_size < rt_bitmap_data->width * (bit_count / 8))
+    ||  (rt_bitmap_pixels->size / rt_bitmap_pixels->line_size < rt_bitmap_pixels->height))
+        return -1;
+
+    if ((bit_count == 32) && (rt_bitmap_pixels->line_size % sizeof(uint32_t)))
+        return -1;
+
+    // Source buffer must hold all its lines too
+    if ((! rt_bitmap_data->line_size) || (rt_bitmap_data->line_size < (rt_bitmap_data->width * rt_bitmap_data->bit_count + 7) / 8)
+    ||  (rt_bitmap_data->size / rt_bitmap_data->line_size < rt_bitmap_data->height))
+        return -1;
+
+    if (! rt_bitmap_data->height)
+        return 0;
+
+    pixel_conv_t* pixel_conv = new_pixel_conv(rt_bitmap, rt_bitmap_data->bit_count, rt_bitmap_data->width, format);
+
+    if (! pixel_conv)
+        return -1;
+
+    const uint8_t* src = (const uint8_t*) rt_bitmap_data->data;
+          uint8_t* dst = (uint8_t*) rt_bitmap_pixels->data;
+
+    begin_cancel_units(rt_bitmap_data->height);
+
+    uint32_t i;
+    for (i = 0; i < rt_bitmap_data->height; i ++)
+    {
+        if (! check_cancel_units(i))
+        {
+            del_pixel_conv(pixel_conv);
+            return -1;
+        }
+
+        convert_pixel_line(pixel_conv, src, dst);
+
+        src += rt_bitmap_data->line_size;
+        dst += rt_bitmap_pixels->line_size;
+    }
+
+    end_cancel_units();
+
+    del_pixel_conv(pixel_conv);
+
+    return 0;
+}
+
+rt_bitmap_data_t* get_rt_bitmap_pixels(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, pixel_format_e format)
+{
+    STATS_SCOPE(STATS_GET_RT_BITMAP_PIXELS);
+
+    rt_bitmap_data_t* rt_bitmap_pixels = (rt_bitmap_data_t*) mem_alloc(sizeof(rt_bitmap_data_t));
+
+    if (! rt_bitmap_pixels)
+        return NULL;
+
+    if (calc_rt_bitmap_pixels(rt_bitmap_data, format, 0, rt_bitmap_pixels) < 0)
+    {
+        mem_free(rt_bitmap_pixels);
+        return NULL;
+    }
+
+    rt_bitmap_pixels->data = mem_alloc(rt_bitmap_pixels->size);
+
+    if (! rt_bitmap_pixels->data)
+    {
+        mem_free(rt_bitmap_pixels);
+        return NULL;
+    }
+
+    if (convert_rt_bitmap_data(rt_bitmap, rt_bitmap_data, format, rt_bitmap_pixels) < 0)
+    {
+        del_rt_bitmap_data(rt_bitmap_pixels);
+        return NULL;
+    }
+
+    return rt_bitmap_pixels;
+}
+
+sint_t convert_rt_bitmap_pixels(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_pixels, rt_bitmap_data_t* rt_bitmap_data)
+{
+    STATS_SCOPE(STATS_CONVERT_RT_BITMAP_PIXELS);
+
+    if ((! rt_bitmap_pixels) || (! rt_bitmap_pixels->data) || (! rt_bitmap_data) || (! rt_bitmap_data->data))
+        return -1;
+
+    uint32_t bit_count = rt_bitmap_data->bit_count;
+
+    if ((rt_bitmap_pixels->bit_count != 32) || (rt_bitmap_pixels->width != rt_bitmap_data->width)
+    ||  (rt_bitmap_pixels->height != rt_bitmap_data->height) || (rt_bitmap_pixels->line_size % sizeof(uint32_t))
+    ||  (rt_bitmap_pixels->line_size < rt_bitmap_pixels->width * sizeof(uint32_t))
+    ||  (! rt_bitmap_data->line_size) || (rt_bitmap_data->line_size < (rt_bitmap_data->width * bit_count + 7) / 8)
+    ||  (rt_bitmap_data->size / rt_bitmap_data->line_size < rt_bitmap_data->height))
+        return -1;
+
+    pixel_pack_t* pixel_pack = new_pixel_pack(rt_bitmap, bit_count, rt_bitmap_data->width);
+
+    if (! pixel_pack)
+        return -1;
+
+    const uint8_t* src = (const uint8_t*) rt_bitmap_pixels->data;
+          uint8_t* dst = (uint8_t*) rt_bitmap_data->data;
+    uint32_t       i;
+
+    begin_cancel_units(rt_bitmap_data->height);
+
+    for (i = 0; i < rt_bitmap_data->height; i ++)
+    {
+        if (! check_cancel_units(i))
+        {
+            del_pixel_pack(pixel_pack);
+            return -1;
+        }
+
+        pack_pixel_line(pixel_pack, (const uint32_t*) src, dst);
+
+        src += rt_bitmap_pixels->line_size;
+        dst += rt_bitmap_data->line_size;
+    }
+
+    del_pixel_pack(pixel_pack);
+
+    end_cancel_units();
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef __PIXCONV_H__
+#define __PIXCONV_H__
+
+#include "inttypes.h"
+#include "platform.h"
+#include "cpufeat.h"
+#include "colortbl.h"
+#include "rt_btmap.h"
+
+// Conversion of bitmap lines to common pixel formats
+//
+// Converter is prepared once for source (bit count, width, color table) and
+// target format, then converts line by line, so it can follow decoding of
+// every line. Indexed pixels are expanded through palette already prepared
+// in target channel order, other ones pass through 32-bit BGRA line. Output
+// is opaque unless color masks have alpha channel (high byte of 32-bit BI_RGB
+// pixels is unused). Kernels are best for CPU (see cpufeat.h).
+//
+// Supported sources are uncompressed (or RLE decoded) 1, 4, 8, 16, 24 and
+// 32 bits, 16-bit and 32-bit pixels with color masks of bitmap (BI_BITFIELDS).
+// Bitmap without color table uses default one of bit count, bitmap without
+// masks default ones. Converter retains palette of bitmap, so it survives
+// del_rt_bitmap() and set_rt_bitmap_palette(). If converter drops last
+// reference, del_pixel_conv() frees palette (through allocator of bitmap).
+
+typedef enum _pixel_format_e {
+    PIXEL_RGBA32,
+    PIXEL_BGRA32,
+    PIXEL_RGB24,
+    PIXEL_GRAY8,
+    PIXEL_FORMAT_NUM
+} pixel_format_e;
+
+typedef struct _pixel_conv_t {
+    pixel_format_e       format;
+    uint32_t             bit_count;     // Of source line
+    uint32_t             width;
+    const cpu_kernels_t* kernels;
+    color_palette_t*     color_palette; // Retained while converter lives
+    const uint32_t*      palette;       // Pixels of palette in target channel order
+    bitfields_t          bitfields;
+    bool_e               bgra;          // 32-bit pixels are BGRA already (only alpha is added)
+    uint32_t*            line;          // BGRA line for RGB24 and GRAY8 formats
+} pixel_conv_t;
+
+pixel_conv_t* new_pixel_conv(rt_bitmap_t* rt_bitmap, uint32_t bit_count, uint32_t width, pixel_format_e format); // Bitmap can be NULL
+sint_t        convert_pixel_line(pixel_conv_t* pixel_conv, const void_t* src, void_t* dst);
+void_t        del_pixel_conv(pixel_conv_t* pixel_conv);
+
+uint32_t      get_pixel_format_bit_count(pixel_format_e format);
+const char_t* convert_pixel_format_to_text(pixel_format_e format);
+
+// Shifts and scales of channels, masks must be contiguous and fit into pixel
+sint_t        calc_pixel_bitfields(const bitmap_masks_t* bitmap_masks, uint32_t bit_count, bitfields_t* bitfields);
+
+// Conversion of whole bitmap data
+//
+// Same rules for caller-owned buffer as for expansion (see rt_btmap.h).
+// Cancel token (see cancel.h) is checked on every line. Result is freed by
+// del_rt_bitmap_data().
+
+sint_t            calc_rt_bitmap_pixels(rt_bitmap_data_t* rt_bitmap_data, pixel_format_e format, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_pixels);
+sint_t            convert_rt_bitmap_data(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, pixel_format_e format, rt_bitmap_data_t* rt_bitmap_pixels);
+rt_bitmap_data_t* get_rt_bitmap_pixels(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, pixel_format_e format);
+
+// Packing of 32-bit BGRA lines into lines of bitmap
+//
+// 16-bit and 32-bit pixels are packed with color masks of bitmap (see
+// calc_rt_bitmap_masks), channels wider than mask keep high bits. 24-bit
+// pixels drop alpha. Indexed pixels get nearest color of color table, colors
+// found are cached, so pixels drawn with colors of table cost a lookup.
+
+#define PIXEL_PACK_CACHE_BITS 12
+#define PIXEL_PACK_CACHED     0x01000000
+
+typedef struct _pixel_pack_t {
+    uint32_t bit_count;         // Of target line
+    uint32_t width;
+    uint32_t lookup [4][0x100]; // Channels in place of masks
+    uint32_t palette [COLORS_IN_8_BIT_TABLE];
+    uint32_t colors_num;
+    uint32_t cache_key [1 << PIXEL_PACK_CACHE_BITS];
+    uint8_t  cache_index [1 << PIXEL_PACK_CACHE_BITS];
+} pixel_pack_t;
+
+pixel_pack_t* new_pixel_pack(rt_bitmap_t* rt_bitmap, uint32_t bit_count, uint32_t width); // Bitmap can be NULL
+sint_t        pack_pixel_line(pixel_pack_t* pixel_pack, const uint32_t* src, void_t* dst);
+void_t        del_pixel_pack(pixel_pack_t* pixel_pack);
+
+// Data is prepared by calc_rt_bitmap_data() and put by put_rt_bitmap_data()
+sint_t            convert_rt_bitmap_pixels(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_pixels, rt_bitmap_data_t* rt_bitmap_data);
+
+#endif // __PIXCONV_H__
@@ -1,10 +1,69 @@
-#ifndef __PLATFORM_H__
-#define __PLATFORM_H__
-
-#ifdef USE_PACKED_ATTRIBUTE
-    #define PACKED_STRUCT __attribute__((__packed__))
-#else
-    #define PACKED_STRUCT
-#endif
-
-#endif // __PLATFORM_H__
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+#ifdef USE_PACKED_ATTRIBUTE
+    #define PACKED_STRUCT __attribute__((__packed__))
+#else
+    #define PACKED_STRUCT
+#endif
+
+#ifdef _MSC_VER
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
+// Atomic operations on 32-bit values and pointers
+//
+// Loads acquire, stores release, additions return new value (both). Enough
+// for counters, flags and publishing of data built by one thread. Exchange
+// of pointer can fail spuriously (it is retried in loop), of value cannot.
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+
+    // Interlocked operations are full barriers
+    #define ATOMIC_LOAD(ptr)         _InterlockedOr((volatile long*) (ptr), 0)
+    #define ATOMIC_STORE(ptr, value) _InterlockedExchange((volatile long*) (ptr), (long) (value))
+    #define ATOMIC_ADD(ptr, value)   (_InterlockedExchangeAdd((volatile long*) (ptr), (long) (value)) + (long) (value))
+    #define ATOMIC_SUB(ptr, value)   (_InterlockedExchangeAdd((volatile long*) (ptr), 0 - (long) (value)) - (long) (value))
+    #define ATOMIC_LOAD_PTR(ptr)     _InterlockedCompareExchangePointer((void* volatile*) (ptr), NULL, NULL)
+
+    // Expected value is updated if exchange fails
+    static __inline int atomic_exchange(volatile long* ptr, long* expected, long desired)
+    {
+        long seen = _InterlockedCompareExchange(ptr, desired, *expected);
+
+        if (seen == *expected)
+            return 1;
+
+        *expected = seen;
+        return 0;
+    }
+
+    static __inline int atomic_exchange_ptr(void* volatile* ptr, void** expected, void* desired)
+    {
+        void* seen = _InterlockedCompareExchangePointer(ptr, desired, *expected);
+
+        if (seen == *expected)
+            return 1;
+
+        *expected = seen;
+        return 0;
+    }
+
+    #define ATOMIC_EXCHANGE(ptr, expected, desired)     atomic_exchange((volatile long*) (ptr), (long*) (expected), (long) (desired))
+    #define ATOMIC_EXCHANGE_PTR(ptr, expected, desired) atomic_exchange_ptr((void* volatile*) (ptr), (void**) (expected), (void*) (desired))
+#else
+    #define ATOMIC_LOAD(ptr)         __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define ATOMIC_STORE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+    #define ATOMIC_ADD(ptr, value)   __atomic_add_fetch(ptr, value, __ATOMIC_ACQ_REL)
+    #define ATOMIC_SUB(ptr, value)   __atomic_sub_fetch(ptr, value, __ATOMIC_ACQ_REL)
+    #define ATOMIC_LOAD_PTR(ptr)     __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+
+    // Expected value is updated if exchange fails
+    #define ATOMIC_EXCHANGE(ptr, expected, desired)     __atomic_compare_exchange_n(ptr, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+    #define ATOMIC_EXCHANGE_PTR(ptr, expected, desired) __atomic_compare_exchange_n(ptr, expected, desired, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+#endif
+
+#endif // __PLATFORM_H__
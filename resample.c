@@ -0,0 +1,495 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "stats.h"
+#include "budget.h"
+#include "cancel.h"
+#include "cpufeat.h"
+
+#include "rt_btmap.h"
+#include "pixconv.h"
+#include "resample.h"
+
+#define RESAMPLE_PART_SIZE 0x40000            // Bytes of source lines decoded at once
+#define RESAMPLE_PI        3.14159265358979323846
+
+static const char_t* resample_filter_str [RESAMPLE_FILTER_NUM] = {
+    "nearest",
+    "box",
+    "bilinear",
+    "lanczos"
+};
+
+// Taps
+
+static double get_filter_support(resample_filter_e filter)
+{
+    switch (filter)
+    {
+        case RESAMPLE_BILINEAR: return 1.0;
+        case RESAMPLE_LANCZOS:  return 3.0;
+        default:                return 0.5;
+    }
+}
+
+static inline double get_sinc(double x)
+{
+    return (x == 0.0) ? 1.0 : sin(RESAMPLE_PI * x) / (RESAMPLE_PI * x);
+}
+
+static double get_filter_weight(resample_filter_e filter, double x)
+{
+    x = fabs(x);
+
+    if (filter == RESAMPLE_LANCZOS)
+        return (x < 3.0) ? get_sinc(x) * get_sinc(x / 3.0) : 0.0;
+
+    return (x < 1.0) ? 1.0 - x : 0.0;
+}
+
+// Source pixels under target pixel x (first included, last excluded) and their
+// weights (weights can be NULL)
+static void_t calc_window(resample_filter_e filter, uint32_t src_size, uint32_t size, uint32_t x,
+                          uint32_t* p_first, uint32_t* p_last, double* weights)
+{
+    double   scale  = (double) src_size / size;
+    double   widen  = (scale > 1.0) ? scale : 1.0;
+    double   center = (x + 0.5) * scale;
+    sint32_t first, last, i;
+
+    if (filter == RESAMPLE_NEAREST)
+    {
+        first = (sint32_t) center;
+        first = (first < (sint32_t) src_size) ? first : (sint32_t) src_size - 1;
+        last  = first + 1;
+    }
+    else if (filter == RESAMPLE_BOX)
+    {
+        first = (sint32_t) floor(x * scale);
+        last  = (sint32_t) ceil((x + 1) * scale);
+    }
+    else
+    {
+        double support = get_filter_support(filter) * widen;
+
+        first = (sint32_t) floor(center - support + 0.5);
+        last  = (sint32_t) floor(center + support + 0.5);
+    }
+
+    first = (first > 0) ? first : 0;
+    last  = (last < (sint32_t) src_size) ? last : (sint32_t) src_size;
+    last  = (last > first) ? last : first + 1;
+
+    *p_first = (uint32_t) first;
+    *p_last  = (uint32_t) last;
+
+    if (! weights)
+        return;
+
+    for (i = first; i < last; i ++)
+    {
+        double low  = x * scale;
+        double high = (x + 1) * scale;
+
+        if (filter == RESAMPLE_NEAREST)
+            weights[i - first] = 1.0;
+        else if (filter == RESAMPLE_BOX)
+            weights[i - first] = ((i + 1 < high) ? i + 1 : high) - ((i > low) ? i : low); // Covered part of pixel
+        else
+            weights[i - first] = get_filter_weight(filter, (i + 0.5 - center) / widen);
+    }
+}
+
+// Every window has taps of widest one (moved inside image near its end),
+// fixed point weights are rounded from running sum, so they sum to one
+static sint_t calc_taps(resample_filter_e filter, uint32_t src_size, uint32_t size, resample_taps_t* taps)
+{
+    uint32_t x, i, first, last, max = 1;
+
+    for (x = 0; x < size; x ++)
+    {
+        calc_window(filter, src_size, size, x, &first, &last, NULL);
+
+        max = (last - first > max) ? last - first : max;
+    }
+
+    double* weights = (double*) mem_alloc(sizeof(double) * max);
+
+    taps->taps    = max;
+    taps->first   = (uint32_t*) mem_alloc(sizeof(uint32_t) * size);
+    taps->weights = (sint16_t*) mem_calloc((size_t) size * max, sizeof(sint16_t));
+
+    if ((! weights) || (! taps->first) || (! taps->weights))
+    {
+        if (weights)
+            mem_free(weights);
+        return -1;
+    }
+
+    for (x = 0; x < size; x ++)
+    {
+        calc_window(filter, src_size, size, x, &first, &last, weights);
+
+        double   total = 0.0, sum = 0.0;
+        sint32_t fixed = 0;
+
+        for (i = 0; i < last - first; i ++)
+            total += weights[i];
+
+        // Window without weight (Lanczos between lobes) takes nearest pixel
+        if (total <= 0.0)
+        {
+            uint32_t nearest = (uint32_t) ((x + 0.5) * src_size / size);
+
+            nearest = (nearest > first) ? nearest - first : 0;
+            nearest = (nearest < last - first) ? nearest : last - first - 1;
+
+            for (i = 0; i < last - first; i ++)
+                weights[i] = (i == nearest) ? 1.0 : 0.0;
+
+            total = 1.0;
+        }
+
+        taps->first[x] = (first + max <= src_size) ? first : src_size - max;
+
+        sint16_t* fixed_weights = taps->weights + (size_t) max * x + (first - taps->first[x]);
+
+        for (i = 0; i < last - first; i ++)
+        {
+            sint32_t previous = fixed;
+
+            sum   += weights[i] / total;
+            fixed  = (sint32_t) floor(sum * (1 << RESAMPLE_WEIGHT_BITS) + 0.5);
+
+            fixed_weights[i] = (sint16_t) (fixed - previous);
+        }
+    }
+
+    mem_free(weights);
+
+    return 0;
+}
+
+static void_t free_taps(resample_taps_t* taps)
+{
+    if (taps->first)
+        mem_free(taps->first);
+    if (taps->weights)
+        mem_free(taps->weights);
+}
+
+// Resampler
+
+resampler_t* new_resampler(pixel_format_e format, uint32_t src_width, uint32_t src_height, uint32_t width, uint32_t height,
+                           resample_filter_e filter, resampler_callback_t callback, void_t* context)
+{
+    if ((format == PIXEL_RGB24) || (format >= PIXEL_FORMAT_NUM) || (filter >= RESAMPLE_FILTER_NUM) || (! callback)
+    ||  (! src_width) || (! src_height) || (! width) || (! height))
+        return NULL;
+
+    resampler_t* resampler = (resampler_t*) mem_calloc(1, sizeof(resampler_t));
+
+    if (! resampler)
+        return NULL;
+
+    resampler->format     = format;
+    resampler->filter     = filter;
+    resampler->src_width  = src_width;
+    resampler->src_height = src_height;
+    resampler->width      = width;
+    resampler->height     = height;
+    resampler->line_size  = width * (get_pixel_format_bit_count(format) / 8);
+    resampler->kernels    = get_cpu_kernels();
+    resampler->callback   = callback;
+    resampler->context    = context;
+
+    if ((calc_taps(filter, src_width,  width,  &resampler->columns) < 0)
+    ||  (calc_taps(filter, src_height, height, &resampler->rows) < 0))
+    {
+        del_resampler(resampler);
+        return NULL;
+    }
+
+    resampler->ring  = (uint8_t*) mem_alloc((size_t) resampler->line_size * resampler->rows.taps);
+    resampler->lines = (const uint8_t**) mem_alloc(sizeof(uint8_t*) * resampler->rows.taps);
+    resampler->line  = (uint8_t*) mem_alloc(resampler->line_size);
+
+    if ((! resampler->ring) || (! resampler->lines) || (! resampler->line))
+    {
+        del_resampler(resampler);
+        return NULL;
+    }
+
+    return resampler;
+}
+
+// Target lines whose source lines are all in ring
+static sint_t put_target_lines(resampler_t* resampler)
+{
+    const resample_taps_t* rows = &resampler->rows;
+
+    while ((resampler->dst_line < resampler->height) && (rows->first[resampler->dst_line] + rows->taps <= resampler->src_line))
+    {
+        uint32_t       first = rows->first[resampler->dst_line];
+        const uint8_t* data;
+        uint32_t       i;
+
+        for (i = 0; i < rows->taps; i ++)
+            resampler->lines[i] = resampler->ring + (size_t) resampler->line_size * ((first + i) % rows->taps);
+
+        if (rows->taps == 1)
+        {
+            data = resampler->lines[0];
+        }
+        else
+        {
+            resampler->kernels->resample_lines(resampler->lines, rows->weights + (size_t) rows->taps * resampler->dst_line, rows->taps,
+                                               resampler->line, resampler->line_size);
+            data = resampler->line;
+        }
+
+        if (resampler->callback(resampler->context, resampler->dst_line, data) != 0)
+        {
+            // Later lines are refused
+            resampler->src_line = resampler->src_height;
+            return -1;
+        }
+
+        resampler->dst_line ++;
+    }
+
+    return 0;
+}
+
+sint_t put_resampler_line(resampler_t* resampler, const void_t* src)
+{
+    STATS_SCOPE(STATS_PUT_RESAMPLER_LINE);
+
+    if ((! resampler) || (! src) || (resampler->src_line >= resampler->src_height))
+        return -1;
+
+    uint32_t line = resampler->src_line ++;
+
+    // Windows only move down, so line above window of next target line is not used
+    if ((resampler->dst_line >= resampler->height) || (line < resampler->rows.first[resampler->dst_line]))
+        return 0;
+
+    const resample_taps_t* columns = &resampler->columns;
+    uint8_t*               ring    = resampler->ring + (size_t) resampler->line_size * (line % resampler->rows.taps);
+    uint32_t               x;
+
+    // Single tap has whole weight
+    if (resampler->format == PIXEL_GRAY8)
+    {
+        if (columns->taps == 1)
+        {
+            for (x = 0; x < resampler->width; x ++)
+                ring[x] = ((const uint8_t*) src)[columns->first[x]];
+        }
+        else
+        {
+            resampler->kernels->resample_8((const uint8_t*) src, ring, resampler->width, columns);
+        }
+    }
+    else
+    {
+        if (columns->taps == 1)
+        {
+            for (x = 0; x < resampler->width; x ++)
+                ((uint32_t*) ring)[x] = ((const uint32_t*) src)[columns->first[x]];
+        }
+        else
+        {
+            resampler->kernels->resample_32((const uint32_t*) src, (uint32_t*) ring, resampler->width, columns);
+        }
+    }
+
+    return put_target_lines(resampler);
+}
+
+void_t del_resampler(resampler_t* resampler)
+{
+    if (! resampler)
+        return;
+
+    free_taps(&resampler->columns);
+    free_taps(&resampler->rows);
+
+    if (resampler->ring)
+        mem_free(resampler->ring);
+    if (resampler->lines)
+        mem_free((void_t*) resampler->lines);
+    if (resampler->line)
+        mem_free(resampler->line);
+
+    mem_free(resampler);
+}
+
+const char_t* convert_resample_filter_to_text(resample_filter_e filter)
+{
+    return (filter < RESAMPLE_FILTER_NUM) ? resample_filter_str[filter] : NULL;
+}
+
+// Whole image
+
+static sint_t put_resampled_line(void_t* context, uint32_t line, const void_t* data)
+{
+    rt_bitmap_data_t* rt_bitmap_resampled = (rt_bitmap_data_t*) context;
+
+    memcpy((uint8_t*) rt_bitmap_resampled->data + (size_t) rt_bitmap_resampled->line_size * line, data,
+           (size_t) rt_bitmap_resampled->width * (rt_bitmap_resampled->bit_count / 8));
+
+    return 0;
+}
+
+static sint_t check_resampled(pixel_format_e format, rt_bitmap_data_t* rt_bitmap_resampled)
+{
+    uint32_t bit_count = get_pixel_format_bit_count(format);
+
+    if ((! rt_bitmap_resampled) || (! rt_bitmap_resampled->data) || (format == PIXEL_RGB24) || (! bit_count)
+    ||  (rt_bitmap_resampled->bit_count != bit_count) || (! rt_bitmap_resampled->width) || (! rt_bitmap_resampled->height)
+    ||  (rt_bitmap_resampled->line_size < rt_bitmap_resampled->width * (bit_count / 8))
+    ||  (rt_bitmap_resampled->size / rt_bitmap_resampled->line_size < rt_bitmap_resampled->height))
+        return -1;
+
+    return 0;
+}
+
+sint_t calc_rt_bitmap_resampled(pixel_format_e format, uint32_t width, uint32_t height, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_resampled)
+{
+    uint32_t bit_count = get_pixel_format_bit_count(format);
+
+    if ((! rt_bitmap_resampled) || (format == PIXEL_RGB24) || (! bit_count) || (! width) || (! height))
+        return -1;
+
+    rt_bitmap_resampled->bit_count = bit_count;
+    rt_bitmap_resampled->width     = width;
+    rt_bitmap_resampled->height    = height;
+    rt_bitmap_resampled->line_size = calc_aligned_line_size(width * (bit_count / 8), alignment);
+    rt_bitmap_resampled->size      = rt_bitmap_resampled->line_size * height;
+    rt_bitmap_resampled->data      = NULL;
+
+    return 0;
+}
+
+sint_t resample_rt_bitmap_pixels(rt_bitmap_data_t* rt_bitmap_pixels, resample_filter_e filter, rt_bitmap_data_t* rt_bitmap_resampled)
+{
+    STATS_SCOPE(STATS_RESAMPLE_RT_BITMAP_PIXELS);
+
+    if ((! rt_bitmap_pixels) || (! rt_bitmap_pixels->data) || (! rt_bitmap_pixels->line_size)
+    ||  (rt_bitmap_pixels->size / rt_bitmap_pixels->line_size < rt_bitmap_pixels->height))
+        return -1;
+
+    // Channels of 32-bit pixels are filtered alike, so order does not matter
+    pixel_format_e format = (rt_bitmap_pixels->bit_count == 8) ? PIXEL_GRAY8 : PIXEL_BGRA32;
+
+    if (((rt_bitmap_pixels->bit_count != 8) && (rt_bitmap_pixels->bit_count != 32))
+    ||  (rt_bitmap_pixels->line_size < rt_bitmap_pixels->width * (rt_bitmap_pixels->bit_count / 8))
+    ||  ((rt_bitmap_pixels->bit_count == 32) && (rt_bitmap_pixels->line_size % sizeof(uint32_t)))
+    ||  (check_resampled(format, rt_bitmap_resampled) < 0))
+        return -1;
+
+    resampler_t* resampler = new_resampler(format, rt_bitmap_pixels->width, rt_bitmap_pixels->height,
+                                           rt_bitmap_resampled->width, rt_bitmap_resampled->height, filter,
+                                           put_resampled_line, rt_bitmap_resampled);
+
+    if (! resampler)
+        return -1;
+
+    begin_cancel_units(rt_bitmap_pixels->height);
+
+    uint32_t i;
+    for (i = 0; i < rt_bitmap_pixels->height; i ++)
+    {
+        if ((! check_cancel_units(i))
+        ||  (put_resampler_line(resampler, (const uint8_t*) rt_bitmap_pixels->data + (size_t) rt_bitmap_pixels->line_size * i) < 0))
+            break;
+    }
+
+    sint_t result = ((i < rt_bitmap_pixels->height) || (resampler->dst_line < resampler->height)) ? -1 : 0;
+
+    del_resampler(resampler);
+
+    if (result == 0)
+        end_cancel_units();
+
+    return result;
+}
+
+sint_t load_rt_bitmap_resampled(FILE* stream, rt_bitmap_t* rt_bitmap, pixel_format_e format, resample_filter_e filter, rt_bitmap_data_t* rt_bitmap_resampled)
+{
+    STATS_SCOPE(STATS_LOAD_RT_BITMAP_RESAMPLED);
+
+    rt_bitmap_data_t lines;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &lines) < 0) || (! lines.height)
+    ||  (check_resampled(format, rt_bitmap_resampled) < 0))
+        return -1;
+
+    uint32_t height    = lines.height;
+    uint32_t part_max  = (lines.line_size < RESAMPLE_PART_SIZE) ? (RESAMPLE_PART_SIZE / lines.line_size) : 1;
+    uint32_t bit_count = get_pixel_format_bit_count(format);
+
+    part_max = (part_max < height) ? part_max : height;
+
+    begin_cancel_units(height);
+
+    if ((! check_cancel_units(0)) || (! use_budget_read(rt_bitmap->data_size)) || (index_rt_bitmap_rle(stream, rt_bitmap) < 0))
+        return -1;
+
+    lines.size = lines.line_size * part_max;
+    lines.data = mem_alloc(lines.size);
+
+    uint32_t*     pixels     = (uint32_t*) mem_alloc(sizeof(uint32_t) * lines.width);
+    pixel_conv_t* pixel_conv = new_pixel_conv(rt_bitmap, lines.bit_count, lines.width, format);
+    resampler_t*  resampler  = new_resampler(format, lines.width, height, rt_bitmap_resampled->width, rt_bitmap_resampled->height,
+                                             filter, put_resampled_line, rt_bitmap_resampled);
+
+    uint32_t i = 0, j;
+
+    if ((lines.data) && (pixels) && (pixel_conv) && (resampler) && (bit_count))
+    {
+        // Source lines are decoded in parts and converted one by one
+        for ( ; i < height; i += lines.height)
+        {
+            lines.height = ((height - i) < part_max) ? (height - i) : part_max;
+
+            if ((! check_cancel_units(i))
+            ||  (load_rt_bitmap_lines(stream, rt_bitmap, i, &lines) < 0))
+                break;
+
+            for (j = 0; j < lines.height; j ++)
+            {
+                convert_pixel_line(pixel_conv, (const uint8_t*) lines.data + (size_t) lines.line_size * j, pixels);
+
+                if (put_resampler_line(resampler, pixels) < 0)
+                    break;
+            }
+
+            if (j < lines.height)
+                break;
+        }
+    }
+
+    sint_t result = ((i < height) || (! resampler) || (resampler->dst_line < resampler->height)) ? -1 : 0;
+
+    if (lines.data)
+        mem_free(lines.data);
+    if (pixels)
+        mem_free(pixels);
+    if (pixel_conv)
+        del_pixel_conv(pixel_conv);
+    if (resampler)
+        del_resampler(resampler);
+
+    if (result == 0)
+        end_cancel_units();
+
+    return result;
+}
@@ -0,0 +1,80 @@
+#ifndef __RESAMPLE_H__
+#define __RESAMPLE_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "cpufeat.h"
+#include "rt_btmap.h"
+#include "pixconv.h"
+
+// Resampling of pixel lines (thumbnails)
+//
+// Resampler is prepared once for source and target dimensions, then takes
+// source lines top to bottom and gives every target line to callback as soon
+// as all source lines under it have come. Filter is separable: source line is
+// resampled horizontally into ring of as many lines as vertical filter has
+// taps, so memory used depends on target width only (source lines no target
+// line uses are skipped). Taps of both directions are computed once in fixed
+// point (see resample_taps_t), kernels are best for CPU (see cpufeat.h).
+//
+// Nearest takes source pixel under center of target pixel, box averages
+// source area covered by target pixel, bilinear and Lanczos (three lobes)
+// are widened by scale when downscaling. Lines are 32-bit pixels (RGBA32 or
+// BGRA32, channels are filtered alike and alpha is not premultiplied) or
+// GRAY8 ones.
+//
+// Nonzero result of callback stops resampler with error.
+
+typedef enum _resample_filter_e {
+    RESAMPLE_NEAREST,
+    RESAMPLE_BOX,
+    RESAMPLE_BILINEAR,
+    RESAMPLE_LANCZOS,
+    RESAMPLE_FILTER_NUM
+} resample_filter_e;
+
+typedef sint_t (*resampler_callback_t)(void_t* context, uint32_t line, const void_t* data);
+
+typedef struct _resampler_t {
+    pixel_format_e       format;
+    resample_filter_e    filter;
+    uint32_t             src_width;
+    uint32_t             src_height;
+    uint32_t             width;
+    uint32_t             height;
+    uint32_t             line_size;     // Bytes of target line
+    const cpu_kernels_t* kernels;
+    resample_taps_t      columns;       // Horizontal taps (per target column)
+    resample_taps_t      rows;          // Vertical taps (per target line)
+    uint8_t*             ring;          // Lines resampled horizontally (line of source at index modulo taps)
+    const uint8_t**      lines;         // Ring lines of target line
+    uint8_t*             line;          // Target line
+    uint32_t             src_line;      // Next source line
+    uint32_t             dst_line;      // Next target line
+    resampler_callback_t callback;
+    void_t*              context;
+} resampler_t;
+
+resampler_t*  new_resampler(pixel_format_e format, uint32_t src_width, uint32_t src_height, uint32_t width, uint32_t height,
+                            resample_filter_e filter, resampler_callback_t callback, void_t* context);
+sint_t        put_resampler_line(resampler_t* resampler, const void_t* src);
+void_t        del_resampler(resampler_t* resampler);
+
+const char_t* convert_resample_filter_to_text(resample_filter_e filter);
+
+// Resampling of whole image into caller-owned buffer
+//
+// calc_rt_bitmap_resampled() fills dimensions and stride of target.
+// resample_rt_bitmap_pixels() resamples converted pixels (32-bit or GRAY8,
+// see pixconv.h). load_rt_bitmap_resampled() decodes lines of bitmap in
+// parts (see load_rt_bitmap_lines), converts them to format and resamples
+// them, so neither source data nor its pixels are held whole. Cancel token
+// (see cancel.h) is checked on every source line.
+
+sint_t calc_rt_bitmap_resampled(pixel_format_e format, uint32_t width, uint32_t height, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_resampled);
+sint_t resample_rt_bitmap_pixels(rt_bitmap_data_t* rt_bitmap_pixels, resample_filter_e filter, rt_bitmap_data_t* rt_bitmap_resampled);
+sint_t load_rt_bitmap_resampled(FILE* stream, rt_bitmap_t* rt_bitmap, pixel_format_e format, resample_filter_e filter, rt_bitmap_data_t* rt_bitmap_resampled);
+
+#endif // __RESAMPLE_H__
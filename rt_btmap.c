@@ -1,581 +1,2001 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#include "inttypes.h"
-#include "platform.h"
-
-#include "rt_btmap.h"
-
-static void_t read_color_table_core(FILE* stream, rgb_quad_t** p_color_table, uint32_t* p_color_nums, uint16_t bit_count)
-{
-    uint32_t i, color_nums  = get_colors_num(bit_count);
-    rgb_quad_t* color_table = (color_nums) ? (rgb_quad_t*) malloc(sizeof(rgb_quad_t) * color_nums) : NULL;
-
-    if (! color_table)
-        return;
-
-    for (i = 0; i < color_nums; i ++)
-    {
-        rgb_triple_t rgb_triple = { 0, 0, 0 };
-
-        if (fread(&rgb_triple, 1, sizeof(rgb_triple_t), stream) != sizeof(rgb_triple_t))
-        {
-            free(color_table);
-            return;
-        }
-
-        color_table[i].blue     = rgb_triple.blue;
-        color_table[i].green    = rgb_triple.green;
-        color_table[i].red      = rgb_triple.red;
-        color_table[i].reserved = 0;
-    }
-
-    *p_color_table = color_table;
-    *p_color_nums  = color_nums;
-}
-
-static void_t read_color_table_info(FILE* stream, rgb_quad_t** p_color_table, uint32_t* p_color_nums, bitmap_info_header_t* info_header)
-{
-    uint32_t i, color_nums  = (info_header->colors_num_table) ? info_header->colors_num_table : get_colors_num(info_header->bit_count);
-    rgb_quad_t* color_table = (color_nums) ? (rgb_quad_t*) malloc(sizeof(rgb_quad_t) * color_nums) : NULL;
-
-    if (! color_table)
-        return;
-
-    for (i = 0; i < color_nums; i ++)
-    {
-        if (fread(color_table + i, 1, sizeof(rgb_quad_t), stream) != sizeof(rgb_quad_t))
-        {
-            free(color_table);
-            return;
-        }
-    }
-
-    *p_color_table = color_table;
-    *p_color_nums  = color_nums;
-}
-
-static sint_t save_color_table_core(FILE* stream, rgb_quad_t* color_table, uint32_t color_nums)
-{
-    uint32_t i;
-
-    for (i = 0; i < color_nums; i ++)
-    {
-        rgb_triple_t rgb_triple = { color_table[i].blue, color_table[i].green, color_table[i].red };
-
-        if (fwrite(&rgb_triple, 1, sizeof(rgb_triple_t), stream) != sizeof(rgb_triple_t))
-            return -1;
-    }
-
-    return 0;
-}
-
-static sint_t save_color_table_info(FILE* stream, rgb_quad_t* color_table, uint32_t color_nums)
-{
-    uint32_t i;
-
-    for (i = 0; i < color_nums; i ++)
-    {
-        if (fwrite(color_table + i, 1, sizeof(rgb_quad_t), stream) != sizeof(rgb_quad_t))
-            return -1;
-    }
-
-    return 0;
-}
-
-static inline uint32_t data_line_size_core(bitmap_core_header_t* core_header)
-{
-    return calc_bitmap_line_size((uint32_t) core_header->data_width, (uint32_t) core_header->bit_count);
-}
-
-static inline uint32_t data_line_size_info(bitmap_info_header_t* info_header)
-{
-    return calc_bitmap_line_size(info_header->data_width, (uint32_t) info_header->bit_count);
-}
-
-static bitmap_core_header_t* generate_core_header(uint32_t compression,
-                                                  uint32_t bit_count,
-                                                  uint32_t data_width,
-                                                  uint32_t data_height)
-{
-    if (compression != BI_RGB)
-        return NULL;
-
-    switch (bit_count)
-    {
-        case  1:
-        case  4:
-        case  8:
-        case 24:
-            break;
-
-        default:
-            return NULL;
-    }
-
-    bitmap_core_header_t* core_header = (bitmap_core_header_t*) malloc(sizeof(bitmap_core_header_t));
-    if (! core_header)
-        return NULL;
-
-    core_header->info_size   = BITMAP_CORE_HEADER_SIZE;
-    core_header->data_width  = (uint16_t) data_width;
-    core_header->data_height = (uint16_t) data_height;
-    core_header->planes_num  = 1;
-    core_header->bit_count   = (uint16_t) bit_count;
-
-    return core_header;
-}
-
-static bitmap_info_header_t* generate_info_header(uint32_t compression,
-                                                  uint32_t bit_count,
-                                                  uint32_t data_width,
-                                                  uint32_t data_height)
-{
-//  uint32_t colors_num = 0;
-
-    switch (compression)
-    {
-        case BI_RGB:
-        case BI_RLE8:
-        case BI_RLE4:
-        case BI_BITFIELDS:
-        case BI_JPEG:
-        case BI_PNG:
-        case BI_CMYK:
-        case BI_CMYKRLE8:
-        case BI_CMYKRLE4:
-            break;
-
-        default:
-            return NULL;
-    }
-
-    switch (bit_count)
-    {
-        case  1:
-        case  4:
-        case  8:
-        case 24:
-//          colors_num = get_colors_num(bit_count);
-            break;
-
-        case  0:
-        case 16:
-        case 32:
-            if (BI_RGB == compression)
-                return NULL;
-            break;
-
-        default:
-            return NULL;
-    }
-
-    bitmap_info_header_t* info_header = (bitmap_info_header_t*) malloc(sizeof(bitmap_info_header_t));
-    if (! info_header)
-        return NULL;
-
-    info_header->info_size        = BITMAP_INFO_HEADER_SIZE;
-    info_header->data_width       = data_width;
-    info_header->data_height      = data_height;
-    info_header->planes_num       = 1;
-    info_header->bit_count        = (uint16_t) bit_count;
-    info_header->compression      = compression;
-    info_header->data_size        = data_height * calc_bitmap_line_size(data_width, bit_count);
-    info_header->ppm_vertical     = 0;
-    info_header->ppm_horizontal   = 0;
-    info_header->colors_num_table = 0; // colors_num
-    info_header->colors_num_data  = 0; // colors_num
-
-    return info_header;
-}
-
-uint32_t calc_bitmap_line_size(uint32_t data_width, uint32_t bit_count)
-{
-    uint32_t line_size = data_width * bit_count / 8;
-
-    // Line is aligned for 4 bytes
-    line_size +=  0x03;
-    line_size &= ~0x03;
-
-    return line_size;
-}
-
-rt_bitmap_t* get_rt_bitmap(FILE* stream, uint32_t offset)
-{
-    // Check for correct compilation
-    if (( sizeof(bitmap_file_header_t) != BITMAP_FILE_HEADER_SIZE )
-    ||  ( sizeof(bitmap_core_header_t) != BITMAP_CORE_HEADER_SIZE )
-    ||  ( sizeof(bitmap_info_header_t) != BITMAP_INFO_HEADER_SIZE )
-    ||  ( sizeof(bitmap_v4_header_t)   != BITMAP_V4_HEADER_SIZE   )
-    ||  ( sizeof(bitmap_v5_header_t)   != BITMAP_V5_HEADER_SIZE   ))
-        return NULL;
-
-    // Go to begining of resource data
-    if (fseek(stream, offset, SEEK_SET) != 0)
-        return NULL;
-
-    // Get file header
-    bitmap_file_header_t* file_header = (bitmap_file_header_t*) malloc(sizeof(bitmap_file_header_t));
-
-    if (! file_header)
-        return NULL;
-
-    if (fread(file_header, 1, sizeof(bitmap_file_header_t), stream) != sizeof(bitmap_file_header_t))
-    {
-        free(file_header);
-        return NULL;
-    }
-
-    if (file_header->syncword != BITMAP_FILE_HEADER_SYNC)
-    {
-        free(file_header);
-        return NULL;
-    }
-
-    // Get type of info header
-    uint32_t     info_size   = 0;
-    info_types_e info_type   = BITMAP_UNKNOWN;
-    void_t*      info_header = NULL;
-
-    if (fread(&info_size, 1, sizeof(uint32_t), stream) != sizeof(uint32_t))
-    {
-        free(file_header);
-        return NULL;
-    }
-
-    switch (info_size)
-    {
-        case BITMAP_CORE_HEADER_SIZE:
-            info_type   = BITMAP_CORE;
-            info_header = malloc(sizeof(bitmap_core_header_t));
-            break;
-
-        case BITMAP_INFO_HEADER_SIZE:
-            info_type   = BITMAP_INFO;
-            info_header = malloc(sizeof(bitmap_info_header_t));
-            break;
-
-        case BITMAP_V4_HEADER_SIZE:
-            info_type   = BITMAP_V4;
-            info_header = malloc(sizeof(bitmap_v4_header_t));
-            break;
-
-        case BITMAP_V5_HEADER_SIZE:
-            info_type   = BITMAP_V5;
-            info_header = malloc(sizeof(bitmap_v5_header_t));
-            break;
-
-        default:
-            info_type   = BITMAP_UNKNOWN;
-            info_header = NULL;
-            break;
-    }
-
-    if (! info_header)
-    {
-        free(file_header);
-        return NULL;
-    }
-
-    // Get info header
-    *((uint32_t*) info_header) = info_size;
-    info_size -= sizeof(uint32_t);
-
-    if (fread(info_header + sizeof(uint32_t), 1, info_size, stream) != info_size)
-    {
-        free(info_header);
-        free(file_header);
-        return NULL;
-    }
-
-    // Get color table
-    rgb_quad_t* color_table = NULL;
-    uint32_t    color_nums  = 0;
-
-    if (BITMAP_CORE == info_type)
-        read_color_table_core(stream, &color_table, &color_nums, ((bitmap_core_header_t*) info_header)->bit_count);
-    else
-        read_color_table_info(stream, &color_table, &color_nums, (bitmap_info_header_t*) info_header);
-
-    // Prepare rt_bitmap struct
-    rt_bitmap_t* rt_bitmap = (rt_bitmap_t*) malloc(sizeof(rt_bitmap_t));
-
-    if (! rt_bitmap)
-    {
-        if (color_table)
-            free(color_table);
-        free(info_header);
-        free(file_header);
-        return NULL;
-    }
-
-    rt_bitmap->file_header = file_header;
-    rt_bitmap->info_header = info_header;
-    rt_bitmap->info_type   = info_type;
-    rt_bitmap->color_table = color_table;
-    rt_bitmap->color_nums  = color_nums;
-    rt_bitmap->data_offset = offset + file_header->data_offset;
-    rt_bitmap->data_line   = (BITMAP_CORE == info_type)
-                           ? data_line_size_core((bitmap_core_header_t*) info_header)
-                           : data_line_size_info((bitmap_info_header_t*) info_header);
-    rt_bitmap->data_size   = (BITMAP_CORE == info_type)
-                           ? ((bitmap_core_header_t*) info_header)->data_height * rt_bitmap->data_line
-                           : ((bitmap_info_header_t*) info_header)->data_size;
-    return rt_bitmap;
-}
-
-rt_bitmap_t* gen_rt_bitmap(info_types_e info_type,
-                           uint32_t     compression,
-                           uint32_t     bit_count,
-                           uint32_t     data_width,
-                           uint32_t     data_height)
-{
-    // Check for correct compilation
-    if (( sizeof(bitmap_file_header_t) != BITMAP_FILE_HEADER_SIZE )
-    ||  ( sizeof(bitmap_core_header_t) != BITMAP_CORE_HEADER_SIZE )
-    ||  ( sizeof(bitmap_info_header_t) != BITMAP_INFO_HEADER_SIZE )
-    ||  ( sizeof(bitmap_v4_header_t)   != BITMAP_V4_HEADER_SIZE   )
-    ||  ( sizeof(bitmap_v5_header_t)   != BITMAP_V5_HEADER_SIZE   ))
-        return NULL;
-
-    // Generate file header
-    bitmap_file_header_t* file_header = (bitmap_file_header_t*) malloc(sizeof(bitmap_file_header_t));
-
-    if (! file_header)
-        return NULL;
-
-    file_header->syncword    = BITMAP_FILE_HEADER_SYNC;
-    file_header->file_size   = BITMAP_FILE_HEADER_SIZE;
-    file_header->reserved    = 0;
-    file_header->data_offset = BITMAP_FILE_HEADER_SIZE;
-
-    // Generate info header
-    void_t*  info_header = NULL;
-    uint32_t info_size   = 0;
-
-    switch (info_type)
-    {
-        case BITMAP_CORE:
-            info_header = generate_core_header(compression, bit_count, data_width, data_height);
-            info_size   = BITMAP_CORE_HEADER_SIZE;
-            break;
-
-        case BITMAP_INFO:
-            info_header = generate_info_header(compression, bit_count, data_width, data_height);
-            info_size   = BITMAP_INFO_HEADER_SIZE;
-            break;
-
-        case BITMAP_V4:
-        case BITMAP_V5:
-            //
-            // TODO
-            //
-
-//      case BITMAP_UNKNOWN:
-        default:
-            info_header = NULL;
-            info_size   = 0;
-            break;
-    }
-
-    if (! info_header)
-    {
-        free(file_header);
-        return NULL;
-    }
-
-    file_header->file_size   += info_size;
-    file_header->data_offset += info_size;
-
-    // Generate color table
-    uint32_t    color_nums  = get_colors_num(bit_count);
-    rgb_quad_t* color_table = (color_nums) ? get_color_table_quad(bit_count) : NULL;
-
-    if ((color_table) && (color_nums))
-    {
-        uint32_t table_size = ((BITMAP_CORE == info_type) ? sizeof(rgb_triple_t) : sizeof(rgb_quad_t)) * color_nums;
-
-        file_header->file_size   += table_size;
-        file_header->data_offset += table_size;
-    }
-
-    // Prepare rt_bitmap struct
-    rt_bitmap_t* rt_bitmap = (rt_bitmap_t*) malloc(sizeof(rt_bitmap_t));
-
-    if (! rt_bitmap)
-    {
-        if (color_table)
-            free(color_table);
-        free(info_header);
-        free(file_header);
-        return NULL;
-    }
-
-    rt_bitmap->file_header = file_header;
-    rt_bitmap->info_header = info_header;
-    rt_bitmap->info_type   = info_type;
-    rt_bitmap->color_table = color_table;
-    rt_bitmap->color_nums  = color_nums;
-    rt_bitmap->data_offset = file_header->data_offset;
-    rt_bitmap->data_line   = (BITMAP_CORE == info_type)
-                           ? data_line_size_core((bitmap_core_header_t*) info_header)
-                           : data_line_size_info((bitmap_info_header_t*) info_header);
-    rt_bitmap->data_size   = data_height * rt_bitmap->data_line;
-
-    // Do not forget about data
-    file_header->file_size += rt_bitmap->data_size;
-
-    return rt_bitmap;
-}
-
-sint_t put_rt_bitmap(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap)
-{
-    sint_t ret = -1;
-
-    if ((! stream) || (! rt_bitmap))
-        return -1;
-
-    // Go to resource placement
-    if (fseek(stream, offset, SEEK_SET) != 0)
-        return -1;
-
-    // Save file header
-    if (fwrite(rt_bitmap->file_header, 1, sizeof(bitmap_file_header_t), stream) != sizeof(bitmap_file_header_t))
-        return -1;
-
-    switch (rt_bitmap->info_type)
-    {
-        case BITMAP_CORE:
-            ret = (fwrite(rt_bitmap->info_header, 1, sizeof(bitmap_core_header_t), stream) != sizeof(bitmap_core_header_t)) ? -1 : 0;
-            break;
-
-        case BITMAP_INFO:
-            ret = (fwrite(rt_bitmap->info_header, 1, sizeof(bitmap_info_header_t), stream) != sizeof(bitmap_info_header_t)) ? -1 : 0;
-            break;
-
-        case BITMAP_V4:
-        case BITMAP_V5:
-            //
-            // TODO
-            //
-
-//      case BITMAP_UNKNOWN:
-        default:
-            break;
-    }
-
-    if (ret < 0)
-        return ret;
-
-    // Save color table
-    if ((rt_bitmap->color_table) && (rt_bitmap->color_nums))
-    {
-        if (BITMAP_CORE == rt_bitmap->info_type)
-            ret = save_color_table_core(stream, rt_bitmap->color_table, rt_bitmap->color_nums);
-        else
-            ret = save_color_table_info(stream, rt_bitmap->color_table, rt_bitmap->color_nums);
-    }
-
-    if (ret < 0)
-        return ret;
-
-    return 0;
-}
-
-void_t del_rt_bitmap(rt_bitmap_t* rt_bitmap)
-{
-    if (rt_bitmap->color_table)
-        free(rt_bitmap->color_table);
-    free(rt_bitmap->info_header);
-    free(rt_bitmap->file_header);
-    free(rt_bitmap);
-}
-
-rt_bitmap_data_t* get_rt_bitmap_data(FILE* stream, rt_bitmap_t* rt_bitmap)
-{
-    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap->data_size))
-        return NULL;
-
-    rt_bitmap_data_t* rt_bitmap_data = (rt_bitmap_data_t*) malloc(sizeof(rt_bitmap_data_t));
-
-    if (! rt_bitmap_data)
-        return NULL;
-
-    if (rt_bitmap->info_type == BITMAP_CORE)
-    {
-        bitmap_core_header_t* core_header = (bitmap_core_header_t*) rt_bitmap->info_header;
-
-        rt_bitmap_data->bit_count = core_header->bit_count;
-        rt_bitmap_data->width     = core_header->data_width;
-        rt_bitmap_data->height    = core_header->data_height;
-    }
-    else
-    {
-        bitmap_info_header_t* info_header = (bitmap_info_header_t*) rt_bitmap->info_header;
-
-        rt_bitmap_data->bit_count = info_header->bit_count;
-        rt_bitmap_data->width     = info_header->data_width;
-        rt_bitmap_data->height    = info_header->data_height;
-    }
-
-    rt_bitmap_data->line_size = rt_bitmap->data_line;
-    rt_bitmap_data->size      = rt_bitmap->data_size;
-    rt_bitmap_data->data      = malloc(rt_bitmap->data_size);
-
-    if (! rt_bitmap_data->data)
-    {
-        free(rt_bitmap_data);
-        return NULL;
-    }
-
-    if (fseek(stream, rt_bitmap->data_offset, SEEK_SET) != 0)
-    {
-        del_rt_bitmap_data(rt_bitmap_data);
-        return NULL;
-    }
-
-    uint8_t* line  = (uint8_t*) rt_bitmap_data->data;
-             line += rt_bitmap_data->size;
-             line -= rt_bitmap_data->line_size;
-
-    uint32_t i;
-    for (i = 0; i < rt_bitmap_data->height; i ++, line -= rt_bitmap_data->line_size)
-    {
-        if (fread(line, 1, rt_bitmap_data->line_size, stream) != (size_t) rt_bitmap_data->line_size)
-        {
-            del_rt_bitmap_data(rt_bitmap_data);
-            return NULL;
-        }
-    }
-
-    return rt_bitmap_data;
-}
-
-sint_t put_rt_bitmap_data(FILE* stream, uint32_t offset, rt_bitmap_data_t* rt_bitmap_data)
-{
-    if ((! stream) || (! rt_bitmap_data))
-        return -1;
-
-    if (fseek(stream, offset, SEEK_SET) != 0)
-        return -1;
-
-    uint8_t* line  = (uint8_t*) rt_bitmap_data->data;
-             line += rt_bitmap_data->size;
-             line -= rt_bitmap_data->line_size;
-
-    uint32_t i;
-    for (i = 0; i < rt_bitmap_data->height; i ++, line -= rt_bitmap_data->line_size)
-    {
-        if (fwrite(line, 1, rt_bitmap_data->line_size, stream) != (size_t) rt_bitmap_data->line_size)
-            return -1;
-    }
-
-    return 0;
-}
-
-void_t del_rt_bitmap_data(rt_bitmap_data_t* rt_bitmap_data)
-{
-    free(rt_bitmap_data->data);
-    free(rt_bitmap_data);
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "fileio.h"
+#include "stats.h"
+#include "budget.h"
+#include "cancel.h"
+#include "trace.h"
+#include "cpufeat.h"
+
+#include "resource.h"
+#include "rt_btmap.h"
+#include "bmp_rle.h"
+
+#define RT_BITMAP_BAND_SIZE 0x100000 // Bytes of lines read at once (without cancel token)
+#define RT_BITMAP_SKIP_SIZE 0x1000   // Gap between parts of lines in region read at once
+
+static void_t read_color_table_core(FILE* stream, color_palette_t** p_color_palette, uint16_t bit_count)
+{
+    uint32_t i, color_nums  = get_colors_num(bit_count);
+    rgb_quad_t* color_table = (color_nums) ? (rgb_quad_t*) mem_alloc(sizeof(rgb_quad_t) * color_nums) : NULL;
+
+    if (! color_table)
+        return;
+
+    for (i = 0; i < color_nums; i ++)
+    {
+        rgb_triple_t rgb_triple = { 0, 0, 0 };
+
+        if (file_read(&rgb_triple, 1, sizeof(rgb_triple_t), stream) != sizeof(rgb_triple_t))
+        {
+            mem_free(color_table);
+            return;
+        }
+
+        color_table[i].blue     = rgb_triple.blue;
+        color_table[i].green    = rgb_triple.green;
+        color_table[i].red      = rgb_triple.red;
+        color_table[i].reserved = 0;
+    }
+
+    *p_color_palette = new_color_palette(color_table, color_nums, bit_count);
+}
+
+static void_t read_color_table_info(FILE* stream, color_palette_t** p_color_palette, bitmap_info_header_t* info_header)
+{
+    uint32_t i, color_nums  = (info_header->colors_num_table) ? info_header->colors_num_table : get_colors_num(info_header->bit_count);
+    rgb_quad_t* color_table = ((color_nums) && (use_budget_entries(color_nums))) ? (rgb_quad_t*) mem_alloc(sizeof(rgb_quad_t) * color_nums) : NULL;
+
+    if (! color_table)
+        return;
+
+    for (i = 0; i < color_nums; i ++)
+    {
+        if (file_read(color_table + i, 1, sizeof(rgb_quad_t), stream) != sizeof(rgb_quad_t))
+        {
+            mem_free(color_table);
+            return;
+        }
+    }
+
+    *p_color_palette = new_color_palette(color_table, color_nums, info_header->bit_count);
+}
+
+static void_t read_color_masks(FILE* stream, bitmap_masks_t** p_color_masks)
+{
+    bitmap_masks_t* color_masks = (bitmap_masks_t*) mem_alloc(sizeof(bitmap_masks_t));
+
+    if (! color_masks)
+        return;
+
+    // Red, green and blue masks only
+    color_masks->alpha = 0;
+
+    if (file_read(color_masks, 1, BITMAP_INFO_MASKS_SIZE, stream) != BITMAP_INFO_MASKS_SIZE)
+    {
+        mem_free(color_masks);
+        return;
+    }
+
+    *p_color_masks = color_masks;
+}
+
+static void_t read_profile(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap)
+{
+    bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+
+    if ((v5_header->color_space != PROFILE_EMBEDDED) || (! v5_header->profile_size))
+        return;
+
+    void_t* profile = mem_alloc(v5_header->profile_size);
+
+    if (! profile)
+        return;
+
+    // Offset is from beginning of info header
+    if ((file_seek(stream, offset + BITMAP_FILE_HEADER_SIZE + v5_header->profile_offset, SEEK_SET) != 0)
+    ||  (file_read(profile, 1, v5_header->profile_size, stream) != (size_t) v5_header->profile_size))
+    {
+        mem_free(profile);
+        return;
+    }
+
+    rt_bitmap->profile = profile;
+}
+
+static uint32_t fill_color_table_core(uint8_t* buffer, const rgb_quad_t* color_table, uint32_t color_nums)
+{
+    uint32_t i;
+
+    for (i = 0; i < color_nums; i ++, buffer += sizeof(rgb_triple_t))
+    {
+        buffer[0] = color_table[i].blue;
+        buffer[1] = color_table[i].green;
+        buffer[2] = color_table[i].red;
+    }
+
+    return sizeof(rgb_triple_t) * color_nums;
+}
+
+static uint32_t fill_color_table_info(uint8_t* buffer, const rgb_quad_t* color_table, uint32_t color_nums)
+{
+    memcpy(buffer, color_table, sizeof(rgb_quad_t) * color_nums);
+
+    return sizeof(rgb_quad_t) * color_nums;
+}
+
+static inline uint32_t data_line_size_core(bitmap_core_header_t* core_header)
+{
+    return calc_bitmap_line_size((uint32_t) core_header->data_width, (uint32_t) core_header->bit_count);
+}
+
+static inline uint32_t data_line_size_info(bitmap_info_header_t* info_header)
+{
+    return calc_bitmap_line_size(info_header->data_width, (uint32_t) info_header->bit_count);
+}
+
+// Negative height means lines are stored from top to bottom
+static inline uint32_t data_height_info(bitmap_info_header_t* info_header)
+{
+    return ((sint32_t) info_header->data_height < 0) ? (0 - info_header->data_height) : info_header->data_height;
+}
+
+static inline bool_e is_top_down(rt_bitmap_t* rt_bitmap)
+{
+    if (BITMAP_CORE == rt_bitmap->info_type)
+        return FALSE;
+
+    return ((sint32_t) ((bitmap_info_header_t*) rt_bitmap->info_header)->data_height < 0) ? TRUE : FALSE;
+}
+
+static inline uint32_t get_compression(rt_bitmap_t* rt_bitmap)
+{
+    return (BITMAP_CORE == rt_bitmap->info_type) ? BI_RGB : ((bitmap_info_header_t*) rt_bitmap->info_header)->compression;
+}
+
+// Pixel array of embedded JPEG or PNG is image file of its own, it has no lines
+static inline bool_e is_payload(uint32_t compression)
+{
+    return ((compression == BI_JPEG) || (compression == BI_PNG)) ? TRUE : FALSE;
+}
+
+// File header, info header, color masks and color table
+static uint32_t calc_headers_size(rt_bitmap_t* rt_bitmap)
+{
+    uint32_t size = BITMAP_FILE_HEADER_SIZE + *((uint32_t*) rt_bitmap->info_header);
+
+    if ((BITMAP_INFO == rt_bitmap->info_type) && (rt_bitmap->color_masks))
+        size += BITMAP_INFO_MASKS_SIZE;
+
+    if ((rt_bitmap->color_table) && (rt_bitmap->color_nums))
+        size += ((BITMAP_CORE == rt_bitmap->info_type) ? sizeof(rgb_triple_t) : sizeof(rgb_quad_t)) * rt_bitmap->color_nums;
+
+    return size;
+}
+
+static uint32_t fill_headers(uint8_t* buffer, rt_bitmap_t* rt_bitmap)
+{
+    uint32_t size = 0;
+
+    memcpy(buffer, rt_bitmap->file_header, BITMAP_FILE_HEADER_SIZE);
+    size += BITMAP_FILE_HEADER_SIZE;
+
+    memcpy(buffer + size, rt_bitmap->info_header, *((uint32_t*) rt_bitmap->info_header));
+    size += *((uint32_t*) rt_bitmap->info_header);
+
+    if ((BITMAP_INFO == rt_bitmap->info_type) && (rt_bitmap->color_masks))
+    {
+        memcpy(buffer + size, rt_bitmap->color_masks, BITMAP_INFO_MASKS_SIZE);
+        size += BITMAP_INFO_MASKS_SIZE;
+    }
+
+    if ((rt_bitmap->color_table) && (rt_bitmap->color_nums))
+    {
+        if (BITMAP_CORE == rt_bitmap->info_type)
+            size += fill_color_table_core(buffer + size, rt_bitmap->color_table, rt_bitmap->color_nums);
+        else
+            size += fill_color_table_info(buffer + size, rt_bitmap->color_table, rt_bitmap->color_nums);
+    }
+
+    return size;
+}
+
+// Profile follows pixel data
+static void_t place_profile(rt_bitmap_t* rt_bitmap)
+{
+    if (BITMAP_V5 != rt_bitmap->info_type)
+        return;
+
+    bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+
+    v5_header->profile_offset = (v5_header->profile_size)
+                              ? (rt_bitmap->file_header->data_offset - BITMAP_FILE_HEADER_SIZE + rt_bitmap->data_size)
+                              : 0;
+}
+
+static void_t swap_lines(uint8_t* line_a, uint8_t* line_b, uint32_t size)
+{
+    uint8_t  temp [0x100];
+    uint32_t part;
+
+    for ( ; size; size -= part, line_a += part, line_b += part)
+    {
+        part = (size < sizeof(temp)) ? size : sizeof(temp);
+
+        memcpy(temp,   line_a, part);
+        memcpy(line_a, line_b, part);
+        memcpy(line_b, temp,   part);
+    }
+}
+
+static bitmap_core_header_t* generate_core_header(uint32_t compression,
+                                                  uint32_t bit_count,
+                                                  uint32_t data_width,
+                                                  uint32_t data_height)
+{
+    if (compression != BI_RGB)
+        return NULL;
+
+    switch (bit_count)
+    {
+        case  1:
+        case  4:
+        case  8:
+        case 24:
+            break;
+
+        default:
+            return NULL;
+    }
+
+    bitmap_core_header_t* core_header = (bitmap_core_header_t*) mem_alloc(sizeof(bitmap_core_header_t));
+    if (! core_header)
+        return NULL;
+
+    core_header->info_size   = BITMAP_CORE_HEADER_SIZE;
+    core_header->data_width  = (uint16_t) data_width;
+    core_header->data_height = (uint16_t) data_height;
+    core_header->planes_num  = 1;
+    core_header->bit_count   = (uint16_t) bit_count;
+
+    return core_header;
+}
+
+static bitmap_info_header_t* generate_info_header(uint32_t compression,
+                                                  uint32_t bit_count,
+                                                  uint32_t data_width,
+                                                  uint32_t data_height)
+{
+//  uint32_t colors_num = 0;
+
+    switch (compression)
+    {
+        case BI_RLE8:
+            if (bit_count != 8)
+                return NULL;
+            break;
+
+        case BI_RLE4:
+            if (bit_count != 4)
+                return NULL;
+            break;
+
+        case BI_BITFIELDS:
+            if ((bit_count != 16) && (bit_count != 32))
+                return NULL;
+            break;
+
+        case BI_RGB:
+        case BI_JPEG:
+        case BI_PNG:
+        case BI_CMYK:
+        case BI_CMYKRLE8:
+        case BI_CMYKRLE4:
+            break;
+
+        default:
+            return NULL;
+    }
+
+    switch (bit_count)
+    {
+        case  1:
+        case  4:
+        case  8:
+        case 24:
+//          colors_num = get_colors_num(bit_count);
+            break;
+
+        case  0:
+        case 16:
+        case 32:
+            if (BI_RGB == compression)
+                return NULL;
+            break;
+
+        default:
+            return NULL;
+    }
+
+    bitmap_info_header_t* info_header = (bitmap_info_header_t*) mem_alloc(sizeof(bitmap_info_header_t));
+    if (! info_header)
+        return NULL;
+
+    info_header->info_size        = BITMAP_INFO_HEADER_SIZE;
+    info_header->data_width       = data_width;
+    info_header->data_height      = data_height;
+    info_header->planes_num       = 1;
+    info_header->bit_count        = (uint16_t) bit_count;
+    info_header->compression      = compression;
+    info_header->data_size        = 0;
+    info_header->ppm_vertical     = 0;
+    info_header->ppm_horizontal   = 0;
+    info_header->colors_num_table = 0; // colors_num
+    info_header->colors_num_data  = 0; // colors_num
+
+    // Negative height (top to bottom lines) is allowed, size of embedded image is set by caller
+    info_header->data_size = (is_payload(compression)) ? 0 : data_height_info(info_header) * calc_bitmap_line_size(data_width, bit_count);
+
+    return info_header;
+}
+
+static bitmap_v4_header_t* generate_v4_header(info_types_e info_type,
+                                              uint32_t     compression,
+                                              uint32_t     bit_count,
+                                              uint32_t     data_width,
+                                              uint32_t     data_height)
+{
+    // Same checks and fields as info header
+    bitmap_info_header_t* info_header = generate_info_header(compression, bit_count, data_width, data_height);
+
+    if (! info_header)
+        return NULL;
+
+    uint32_t info_size = (BITMAP_V5 == info_type) ? BITMAP_V5_HEADER_SIZE : BITMAP_V4_HEADER_SIZE;
+
+    bitmap_v4_header_t* v4_header = (bitmap_v4_header_t*) mem_alloc(info_size);
+    if (! v4_header)
+    {
+        mem_free(info_header);
+        return NULL;
+    }
+
+    memset(v4_header, 0, info_size);
+    memcpy(v4_header, info_header, sizeof(bitmap_info_header_t));
+    mem_free(info_header);
+
+    v4_header->info_size   = info_size;
+    v4_header->color_space = LCS_sRGB;
+
+    if (BI_BITFIELDS == compression)
+    {
+        v4_header->mask_red   = (bit_count == 16) ? 0xF800 : 0x00FF0000;
+        v4_header->mask_green = (bit_count == 16) ? 0x07E0 : 0x0000FF00;
+        v4_header->mask_blue  = (bit_count == 16) ? 0x001F : 0x000000FF;
+        v4_header->mask_alpha = (bit_count == 16) ? 0x0000 : 0xFF000000;
+    }
+
+    if (BITMAP_V5 == info_type)
+        ((bitmap_v5_header_t*) v4_header)->intent = LCS_GM_IMAGES;
+
+    return v4_header;
+}
+
+uint32_t calc_bitmap_line_size(uint32_t data_width, uint32_t bit_count)
+{
+    // Partial byte of last pixels counts too
+    uint32_t line_size = (data_width * bit_count + 7) / 8;
+
+    // Line is aligned for 4 bytes
+    line_size +=  0x03;
+    line_size &= ~0x03;
+
+    return line_size;
+}
+
+uint32_t calc_aligned_line_size(uint32_t line_size, uint32_t alignment)
+{
+    // Zero or one alignment keeps natural line size
+    if (alignment > 1)
+        line_size = ((line_size + alignment - 1) / alignment) * alignment;
+
+    return line_size;
+}
+
+// Check for correct compilation
+static inline bool_e check_headers_size(void_t)
+{
+    return (( sizeof(bitmap_file_header_t) == BITMAP_FILE_HEADER_SIZE )
+        &&  ( sizeof(bitmap_core_header_t) == BITMAP_CORE_HEADER_SIZE )
+        &&  ( sizeof(bitmap_info_header_t) == BITMAP_INFO_HEADER_SIZE )
+        &&  ( sizeof(bitmap_v4_header_t)   == BITMAP_V4_HEADER_SIZE   )
+        &&  ( sizeof(bitmap_v5_header_t)   == BITMAP_V5_HEADER_SIZE   )) ? TRUE : FALSE;
+}
+
+// Info header, color masks and color table at current position of stream,
+// offset is place of file header (file header is freed on error)
+static rt_bitmap_t* read_rt_bitmap_info(FILE* stream, uint32_t offset, bitmap_file_header_t* file_header)
+{
+    // Get type of info header
+    uint32_t     info_size   = 0;
+    info_types_e info_type   = BITMAP_UNKNOWN;
+    void_t*      info_header = NULL;
+
+    if (file_read(&info_size, 1, sizeof(uint32_t), stream) != sizeof(uint32_t))
+    {
+        mem_free(file_header);
+        return NULL;
+    }
+
+    switch (info_size)
+    {
+        case BITMAP_CORE_HEADER_SIZE:
+            info_type   = BITMAP_CORE;
+            info_header = mem_alloc(sizeof(bitmap_core_header_t));
+            break;
+
+        case BITMAP_INFO_HEADER_SIZE:
+            info_type   = BITMAP_INFO;
+            info_header = mem_alloc(sizeof(bitmap_info_header_t));
+            break;
+
+        case BITMAP_V4_HEADER_SIZE:
+            info_type   = BITMAP_V4;
+            info_header = mem_alloc(sizeof(bitmap_v4_header_t));
+            break;
+
+        case BITMAP_V5_HEADER_SIZE:
+            info_type   = BITMAP_V5;
+            info_header = mem_alloc(sizeof(bitmap_v5_header_t));
+            break;
+
+        default:
+            info_type   = BITMAP_UNKNOWN;
+            info_header = NULL;
+            break;
+    }
+
+    if (! info_header)
+    {
+        mem_free(file_header);
+        return NULL;
+    }
+
+    // Get info header
+    *((uint32_t*) info_header) = info_size;
+    info_size -= sizeof(uint32_t);
+
+    if (file_read(info_header + sizeof(uint32_t), 1, info_size, stream) != info_size)
+    {
+        mem_free(info_header);
+        mem_free(file_header);
+        return NULL;
+    }
+
+    // Get color masks
+    bitmap_masks_t* color_masks = NULL;
+
+    if ((BITMAP_INFO == info_type) && (((bitmap_info_header_t*) info_header)->compression == BI_BITFIELDS))
+        read_color_masks(stream, &color_masks);
+
+    // Get color table
+    color_palette_t* color_palette = NULL;
+
+    if (BITMAP_CORE == info_type)
+        read_color_table_core(stream, &color_palette, ((bitmap_core_header_t*) info_header)->bit_count);
+    else
+        read_color_table_info(stream, &color_palette, (bitmap_info_header_t*) info_header);
+
+    // Prepare rt_bitmap struct
+    rt_bitmap_t* rt_bitmap = (rt_bitmap_t*) mem_alloc(sizeof(rt_bitmap_t));
+
+    if (! rt_bitmap)
+    {
+        if (color_palette)
+            release_color_palette(color_palette);
+        if (color_masks)
+            mem_free(color_masks);
+        mem_free(info_header);
+        mem_free(file_header);
+        return NULL;
+    }
+
+    rt_bitmap->file_header   = file_header;
+    rt_bitmap->info_header   = info_header;
+    rt_bitmap->info_type     = info_type;
+    rt_bitmap->color_masks   = color_masks;
+    rt_bitmap->color_palette = color_palette;
+    rt_bitmap->color_table   = (color_palette) ? color_palette->colors     : NULL;
+    rt_bitmap->color_nums    = (color_palette) ? color_palette->colors_num : 0;
+    rt_bitmap->profile       = NULL;
+    rt_bitmap->rle_index     = NULL;
+
+    // Pixel data of packed DIB follows color table
+    if (! file_header->data_offset)
+        file_header->data_offset = calc_headers_size(rt_bitmap);
+
+    rt_bitmap->data_offset = offset + file_header->data_offset;
+    rt_bitmap->data_line   = (BITMAP_CORE == info_type)
+                           ? data_line_size_core((bitmap_core_header_t*) info_header)
+                           : data_line_size_info((bitmap_info_header_t*) info_header);
+    rt_bitmap->data_size   = (BITMAP_CORE == info_type)
+                           ? ((bitmap_core_header_t*) info_header)->data_height * rt_bitmap->data_line
+                           : ((bitmap_info_header_t*) info_header)->data_size;
+
+    if (is_payload(get_compression(rt_bitmap)))
+        rt_bitmap->data_line = 0;
+
+    // Size of uncompressed data can be omitted
+    if ((! rt_bitmap->data_size) && (BITMAP_CORE != info_type) && (((bitmap_info_header_t*) info_header)->compression == BI_RGB))
+        rt_bitmap->data_size = data_height_info((bitmap_info_header_t*) info_header) * rt_bitmap->data_line;
+
+    if (! file_header->file_size)
+        file_header->file_size = file_header->data_offset + rt_bitmap->data_size;
+
+    // Get embedded profile (usually placed after pixel data)
+    if (BITMAP_V5 == info_type)
+        read_profile(stream, offset, rt_bitmap);
+
+    return rt_bitmap;
+}
+
+rt_bitmap_t* get_rt_bitmap(FILE* stream, uint32_t offset)
+{
+    STATS_SCOPE(STATS_GET_RT_BITMAP);
+
+    if (! check_headers_size())
+        return NULL;
+
+    // Go to begining of resource data
+    if (file_seek(stream, offset, SEEK_SET) != 0)
+        return NULL;
+
+    // Get file header
+    bitmap_file_header_t* file_header = (bitmap_file_header_t*) mem_alloc(sizeof(bitmap_file_header_t));
+
+    if (! file_header)
+        return NULL;
+
+    if (file_read(file_header, 1, sizeof(bitmap_file_header_t), stream) != sizeof(bitmap_file_header_t))
+    {
+        mem_free(file_header);
+        return NULL;
+    }
+
+    if (file_header->syncword != BITMAP_FILE_HEADER_SYNC)
+    {
+        mem_free(file_header);
+        return NULL;
+    }
+
+    return read_rt_bitmap_info(stream, offset, file_header);
+}
+
+rt_bitmap_t* get_rt_bitmap_dib(FILE* stream, uint32_t offset)
+{
+    STATS_SCOPE(STATS_GET_RT_BITMAP_DIB);
+
+    if (! check_headers_size())
+        return NULL;
+
+    if (file_seek(stream, offset, SEEK_SET) != 0)
+        return NULL;
+
+    // File header is made up, as if it preceded info header
+    bitmap_file_header_t* file_header = (bitmap_file_header_t*) mem_calloc(1, sizeof(bitmap_file_header_t));
+
+    if (! file_header)
+        return NULL;
+
+    file_header->syncword = BITMAP_FILE_HEADER_SYNC;
+
+    return read_rt_bitmap_info(stream, offset - BITMAP_FILE_HEADER_SIZE, file_header);
+}
+
+rt_bitmap_t* gen_rt_bitmap(info_types_e info_type,
+                           uint32_t     compression,
+                           uint32_t     bit_count,
+                           uint32_t     data_width,
+                           uint32_t     data_height)
+{
+    STATS_SCOPE(STATS_GEN_RT_BITMAP);
+
+    // Check for correct compilation
+    if (( sizeof(bitmap_file_header_t) != BITMAP_FILE_HEADER_SIZE )
+    ||  ( sizeof(bitmap_core_header_t) != BITMAP_CORE_HEADER_SIZE )
+    ||  ( sizeof(bitmap_info_header_t) != BITMAP_INFO_HEADER_SIZE )
+    ||  ( sizeof(bitmap_v4_header_t)   != BITMAP_V4_HEADER_SIZE   )
+    ||  ( sizeof(bitmap_v5_header_t)   != BITMAP_V5_HEADER_SIZE   ))
+        return NULL;
+
+    // Generate file header
+    bitmap_file_header_t* file_header = (bitmap_file_header_t*) mem_alloc(sizeof(bitmap_file_header_t));
+
+    if (! file_header)
+        return NULL;
+
+    file_header->syncword    = BITMAP_FILE_HEADER_SYNC;
+    file_header->file_size   = BITMAP_FILE_HEADER_SIZE;
+    file_header->reserved    = 0;
+    file_header->data_offset = BITMAP_FILE_HEADER_SIZE;
+
+    // Generate info header
+    void_t*  info_header = NULL;
+    uint32_t info_size   = 0;
+
+    switch (info_type)
+    {
+        case BITMAP_CORE:
+            info_header = generate_core_header(compression, bit_count, data_width, data_height);
+            info_size   = BITMAP_CORE_HEADER_SIZE;
+            break;
+
+        case BITMAP_INFO:
+            info_header = generate_info_header(compression, bit_count, data_width, data_height);
+            info_size   = BITMAP_INFO_HEADER_SIZE;
+            break;
+
+        case BITMAP_V4:
+        case BITMAP_V5:
+            info_header = generate_v4_header(info_type, compression, bit_count, data_width, data_height);
+            info_size   = (BITMAP_V5 == info_type) ? BITMAP_V5_HEADER_SIZE : BITMAP_V4_HEADER_SIZE;
+            break;
+
+//      case BITMAP_UNKNOWN:
+        default:
+            info_header = NULL;
+            info_size   = 0;
+            break;
+    }
+
+    if (! info_header)
+    {
+        mem_free(file_header);
+        return NULL;
+    }
+
+    file_header->file_size   += info_size;
+    file_header->data_offset += info_size;
+
+    // Generate color masks
+    bitmap_masks_t* color_masks = NULL;
+
+    if ((BITMAP_INFO == info_type) && (BI_BITFIELDS == compression))
+    {
+        color_masks = (bitmap_masks_t*) mem_alloc(sizeof(bitmap_masks_t));
+
+        if (! color_masks)
+        {
+            mem_free(info_header);
+            mem_free(file_header);
+            return NULL;
+        }
+
+        color_masks->red   = (bit_count == 16) ? 0xF800 : 0x00FF0000;
+        color_masks->green = (bit_count == 16) ? 0x07E0 : 0x0000FF00;
+        color_masks->blue  = (bit_count == 16) ? 0x001F : 0x000000FF;
+        color_masks->alpha = 0;
+
+        file_header->file_size   += BITMAP_INFO_MASKS_SIZE;
+        file_header->data_offset += BITMAP_INFO_MASKS_SIZE;
+    }
+
+    // Default color table is shared
+    color_palette_t* color_palette = get_color_palette_default(bit_count);
+
+    if (color_palette)
+    {
+        uint32_t table_size = ((BITMAP_CORE == info_type) ? sizeof(rgb_triple_t) : sizeof(rgb_quad_t)) * color_palette->colors_num;
+
+        file_header->file_size   += table_size;
+        file_header->data_offset += table_size;
+    }
+
+    // Prepare rt_bitmap struct
+    rt_bitmap_t* rt_bitmap = (rt_bitmap_t*) mem_alloc(sizeof(rt_bitmap_t));
+
+    if (! rt_bitmap)
+    {
+        if (color_masks)
+            mem_free(color_masks);
+        mem_free(info_header);
+        mem_free(file_header);
+        return NULL;
+    }
+
+    rt_bitmap->file_header   = file_header;
+    rt_bitmap->info_header   = info_header;
+    rt_bitmap->info_type     = info_type;
+    rt_bitmap->color_masks   = color_masks;
+    rt_bitmap->color_palette = color_palette;
+    rt_bitmap->color_table   = (color_palette) ? color_palette->colors     : NULL;
+    rt_bitmap->color_nums    = (color_palette) ? color_palette->colors_num : 0;
+    rt_bitmap->profile       = NULL;
+    rt_bitmap->rle_index     = NULL;
+    rt_bitmap->data_offset   = file_header->data_offset;
+    rt_bitmap->data_line     = (BITMAP_CORE == info_type)
+                             ? data_line_size_core((bitmap_core_header_t*) info_header)
+                             : data_line_size_info((bitmap_info_header_t*) info_header);
+    rt_bitmap->data_size     = (BITMAP_CORE == info_type)
+                             ? data_height * rt_bitmap->data_line
+                             : ((bitmap_info_header_t*) info_header)->data_size;
+
+    if (is_payload(get_compression(rt_bitmap)))
+        rt_bitmap->data_line = 0;
+
+    // Do not forget about data
+    file_header->file_size += rt_bitmap->data_size;
+
+    return rt_bitmap;
+}
+
+sint_t put_rt_bitmap(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap)
+{
+    STATS_SCOPE(STATS_PUT_RT_BITMAP);
+
+    if ((! stream) || (! rt_bitmap))
+        return -1;
+
+    // Headers and tables are assembled for single write
+    uint32_t size   = calc_headers_size(rt_bitmap);
+    uint8_t* buffer = (uint8_t*) mem_alloc(size);
+
+    if (! buffer)
+        return -1;
+
+    fill_headers(buffer, rt_bitmap);
+
+    // Go to resource placement
+    if ((file_seek(stream, offset, SEEK_SET) != 0) || (file_write(buffer, 1, size, stream) != (size_t) size))
+    {
+        mem_free(buffer);
+        return -1;
+    }
+
+    mem_free(buffer);
+
+    // Profile is placed apart from headers
+    if ((BITMAP_V5 == rt_bitmap->info_type) && (rt_bitmap->profile))
+    {
+        bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+
+        if ((file_seek(stream, offset + BITMAP_FILE_HEADER_SIZE + v5_header->profile_offset, SEEK_SET) != 0)
+        ||  (file_write(rt_bitmap->profile, 1, v5_header->profile_size, stream) != (size_t) v5_header->profile_size))
+            return -1;
+    }
+
+    return 0;
+}
+
+// Uncompressed data with layout of bitmap (its stride can be wider than line in file)
+static sint_t check_full_data(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data)
+{
+    uint32_t compression = get_compression(rt_bitmap);
+
+    if ((compression != BI_RGB) && (compression != BI_BITFIELDS))
+        return -1;
+
+    rt_bitmap_data_t layout;
+
+    if ((calc_rt_bitmap_data(rt_bitmap, 0, &layout) < 0) || (rt_bitmap_data->bit_count != layout.bit_count)
+    ||  (rt_bitmap_data->width != layout.width) || (rt_bitmap_data->height != layout.height)
+    ||  (rt_bitmap_data->line_size < rt_bitmap->data_line) || (rt_bitmap->data_size < layout.size)
+    ||  (rt_bitmap->file_header->data_offset < calc_headers_size(rt_bitmap)))
+        return -1;
+
+    return 0;
+}
+
+// Line of data which is stored at given place in file
+static inline const uint8_t* get_file_line(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, uint32_t line)
+{
+    if (! is_top_down(rt_bitmap))
+        line = rt_bitmap_data->height - line - 1;
+
+    return (const uint8_t*) rt_bitmap_data->data + (size_t) rt_bitmap_data->line_size * line;
+}
+
+uint32_t calc_rt_bitmap_full_size(rt_bitmap_t* rt_bitmap)
+{
+    if (! rt_bitmap)
+        return 0;
+
+    uint64_t size = (uint64_t) rt_bitmap->file_header->data_offset + rt_bitmap->data_size;
+
+    // Profile follows pixel data (as placed by set_rt_bitmap_profile)
+    if ((BITMAP_V5 == rt_bitmap->info_type) && (rt_bitmap->profile))
+    {
+        bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+
+        if ((uint64_t) BITMAP_FILE_HEADER_SIZE + v5_header->profile_offset < size)
+            return 0;
+
+        size = (uint64_t) BITMAP_FILE_HEADER_SIZE + v5_header->profile_offset + v5_header->profile_size;
+    }
+
+    return (size > 0x7FFFFFFF) ? 0 : (uint32_t) size;
+}
+
+sint_t fill_rt_bitmap_full(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, void_t* image, uint32_t image_size)
+{
+    if ((! rt_bitmap) || (! rt_bitmap_data) || (! rt_bitmap_data->data) || (! image))
+        return -1;
+
+    uint32_t size = calc_rt_bitmap_full_size(rt_bitmap);
+
+    if ((! size) || (image_size < size) || (check_full_data(rt_bitmap, rt_bitmap_data) < 0))
+        return -1;
+
+    uint8_t* buffer      = (uint8_t*) image;
+    uint32_t data_offset = rt_bitmap->file_header->data_offset;
+    uint32_t data_end    = data_offset + rt_bitmap->data_line * rt_bitmap_data->height;
+    uint32_t i, headers_size = fill_headers(buffer, rt_bitmap);
+
+    // Every byte is written once (target can be mapped file), gaps are zeroed
+    memset(buffer + headers_size, 0, data_offset - headers_size);
+
+    for (i = 0; i < rt_bitmap_data->height; i ++)
+        memcpy(buffer + data_offset + (size_t) rt_bitmap->data_line * i, get_file_line(rt_bitmap, rt_bitmap_data, i), rt_bitmap->data_line);
+
+    memset(buffer + data_end, 0, size - data_end);
+
+    if ((BITMAP_V5 == rt_bitmap->info_type) && (rt_bitmap->profile))
+    {
+        bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+
+        memcpy(buffer + BITMAP_FILE_HEADER_SIZE + v5_header->profile_offset, rt_bitmap->profile, v5_header->profile_size);
+    }
+
+    return 0;
+}
+
+sint_t put_rt_bitmap_full(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data)
+{
+    STATS_SCOPE(STATS_PUT_RT_BITMAP_FULL);
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap_data) || (! rt_bitmap_data->data))
+        return -1;
+
+    uint32_t size = calc_rt_bitmap_full_size(rt_bitmap);
+
+    if ((! size) || (check_full_data(rt_bitmap, rt_bitmap_data) < 0))
+        return -1;
+
+    // Headers (up to pixel data) and tail (rest of data and profile) are
+    // assembled, lines are written from caller buffer in file order
+    uint32_t data_offset = rt_bitmap->file_header->data_offset;
+    uint32_t data_end    = data_offset + rt_bitmap->data_line * rt_bitmap_data->height;
+    uint32_t height      = rt_bitmap_data->height;
+    bool_e   packed      = ((is_top_down(rt_bitmap)) && (rt_bitmap_data->line_size == rt_bitmap->data_line)) ? TRUE : FALSE;
+
+    uint8_t*       buffer  = (uint8_t*) mem_alloc(size - (data_end - data_offset));
+    file_vector_t* vectors = (file_vector_t*) mem_alloc(sizeof(file_vector_t) * (height + 2));
+
+    if ((! buffer) || (! vectors))
+    {
+        if (buffer)
+            mem_free(buffer);
+        if (vectors)
+            mem_free(vectors);
+        return -1;
+    }
+
+    uint8_t* tail = buffer + data_offset;
+    uint32_t i, count = 0;
+
+    memset(buffer, 0, size - (data_end - data_offset));
+    fill_headers(buffer, rt_bitmap);
+
+    if ((BITMAP_V5 == rt_bitmap->info_type) && (rt_bitmap->profile))
+    {
+        bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+
+        memcpy(tail + BITMAP_FILE_HEADER_SIZE + v5_header->profile_offset - data_end, rt_bitmap->profile, v5_header->profile_size);
+    }
+
+    vectors[count].iov_base  = buffer;
+    vectors[count ++].iov_len = data_offset;
+
+    if ((packed) && (height))
+    {
+        vectors[count].iov_base  = rt_bitmap_data->data;
+        vectors[count ++].iov_len = (size_t) rt_bitmap->data_line * height;
+    }
+    else
+    {
+        for (i = 0; i < height; i ++)
+        {
+            vectors[count].iov_base  = (void_t*) get_file_line(rt_bitmap, rt_bitmap_data, i);
+            vectors[count ++].iov_len = rt_bitmap->data_line;
+        }
+    }
+
+    if (size > data_end)
+    {
+        vectors[count].iov_base  = tail;
+        vectors[count ++].iov_len = size - data_end;
+    }
+
+    // Small bitmap is written by single call, large one gets its space first
+    if (count > FILE_VECTORS_MAX)
+        file_reserve(stream, offset, size);
+
+    sint_t ret = (file_write_vector(stream, offset, vectors, count) != (size_t) size) ? -1 : 0;
+
+    mem_free(vectors);
+    mem_free(buffer);
+
+    return ret;
+}
+
+void_t del_rt_bitmap(rt_bitmap_t* rt_bitmap)
+{
+    if (rt_bitmap->color_palette)
+        release_color_palette(rt_bitmap->color_palette);
+    if (rt_bitmap->color_masks)
+        mem_free(rt_bitmap->color_masks);
+    if (rt_bitmap->profile)
+        mem_free(rt_bitmap->profile);
+    if (rt_bitmap->rle_index)
+        del_bitmap_rle_index(rt_bitmap->rle_index);
+    mem_free(rt_bitmap->info_header);
+    mem_free(rt_bitmap->file_header);
+    mem_free(rt_bitmap);
+}
+
+sint_t calc_rt_bitmap_masks(rt_bitmap_t* rt_bitmap, bitmap_masks_t* bitmap_masks)
+{
+    if ((! rt_bitmap) || (! bitmap_masks))
+        return -1;
+
+    uint32_t bit_count = (BITMAP_CORE == rt_bitmap->info_type)
+                       ? ((bitmap_core_header_t*) rt_bitmap->info_header)->bit_count
+                       : ((bitmap_info_header_t*) rt_bitmap->info_header)->bit_count;
+
+    if ((bit_count != 16) && (bit_count != 32))
+        return -1;
+
+    switch (get_compression(rt_bitmap))
+    {
+        case BI_RGB:
+            bitmap_masks->red   = (bit_count == 16) ? 0x7C00 : 0x00FF0000;
+            bitmap_masks->green = (bit_count == 16) ? 0x03E0 : 0x0000FF00;
+            bitmap_masks->blue  = (bit_count == 16) ? 0x001F : 0x000000FF;
+            bitmap_masks->alpha = 0;
+            return 0;
+
+        case BI_BITFIELDS:
+            break;
+
+        default:
+            return -1;
+    }
+
+    if (BITMAP_INFO == rt_bitmap->info_type)
+    {
+        if (! rt_bitmap->color_masks)
+            return -1;
+
+        *bitmap_masks = *rt_bitmap->color_masks;
+        return 0;
+    }
+
+    // V5 header starts with V4 one
+    bitmap_v4_header_t* v4_header = (bitmap_v4_header_t*) rt_bitmap->info_header;
+
+    bitmap_masks->red   = v4_header->mask_red;
+    bitmap_masks->green = v4_header->mask_green;
+    bitmap_masks->blue  = v4_header->mask_blue;
+    bitmap_masks->alpha = v4_header->mask_alpha;
+
+    return 0;
+}
+
+sint_t set_rt_bitmap_masks(rt_bitmap_t* rt_bitmap, const bitmap_masks_t* bitmap_masks)
+{
+    if ((! rt_bitmap) || (! bitmap_masks) || (get_compression(rt_bitmap) != BI_BITFIELDS))
+        return -1;
+
+    switch (rt_bitmap->info_type)
+    {
+        case BITMAP_INFO:
+            if ((! rt_bitmap->color_masks) || (bitmap_masks->alpha))
+                return -1;
+
+            *rt_bitmap->color_masks = *bitmap_masks;
+            break;
+
+        case BITMAP_V4:
+        case BITMAP_V5:
+            ((bitmap_v4_header_t*) rt_bitmap->info_header)->mask_red   = bitmap_masks->red;
+            ((bitmap_v4_header_t*) rt_bitmap->info_header)->mask_green = bitmap_masks->green;
+            ((bitmap_v4_header_t*) rt_bitmap->info_header)->mask_blue  = bitmap_masks->blue;
+            ((bitmap_v4_header_t*) rt_bitmap->info_header)->mask_alpha = bitmap_masks->alpha;
+            break;
+
+        default:
+            return -1;
+    }
+
+    return 0;
+}
+
+sint_t set_rt_bitmap_palette(rt_bitmap_t* rt_bitmap, const rgb_quad_t* colors, uint32_t colors_num)
+{
+    // Table keeps its size, so headers and place of data stay same
+    if ((! rt_bitmap) || (! rt_bitmap->color_palette) || (! colors) || (colors_num != rt_bitmap->color_nums))
+        return -1;
+
+    // Palette is kept by rt_bitmap, so it is made by allocator of rt_bitmap
+    mem_allocator_t* previous    = set_mem_allocator(get_mem_block_allocator(rt_bitmap));
+    rgb_quad_t*      color_table = (rgb_quad_t*) mem_alloc(sizeof(rgb_quad_t) * colors_num);
+
+    if (! color_table)
+    {
+        set_mem_allocator(previous);
+        return -1;
+    }
+
+    memcpy(color_table, colors, sizeof(rgb_quad_t) * colors_num);
+
+    uint32_t         bit_count     = (BITMAP_CORE == rt_bitmap->info_type)
+                                   ? ((bitmap_core_header_t*) rt_bitmap->info_header)->bit_count
+                                   : ((bitmap_info_header_t*) rt_bitmap->info_header)->bit_count;
+    color_palette_t* color_palette = new_color_palette(color_table, colors_num, bit_count);
+
+    set_mem_allocator(previous);
+
+    if (! color_palette)
+        return -1;
+
+    release_color_palette(rt_bitmap->color_palette);
+
+    rt_bitmap->color_palette = color_palette;
+    rt_bitmap->color_table   = color_palette->colors;
+
+    return 0;
+}
+
+sint_t set_rt_bitmap_profile(rt_bitmap_t* rt_bitmap, const void_t* profile, uint32_t profile_size)
+{
+    if ((! rt_bitmap) || (BITMAP_V5 != rt_bitmap->info_type) || ((profile) && (! profile_size)))
+        return -1;
+
+    bitmap_v5_header_t* v5_header = (bitmap_v5_header_t*) rt_bitmap->info_header;
+    void_t*             copy      = NULL;
+
+    if (profile)
+    {
+        // Profile is kept by rt_bitmap, so it is made by allocator of rt_bitmap
+        mem_allocator_t* previous = set_mem_allocator(get_mem_block_allocator(rt_bitmap));
+
+        copy = mem_alloc(profile_size);
+        set_mem_allocator(previous);
+
+        if (! copy)
+            return -1;
+
+        memcpy(copy, profile, profile_size);
+    }
+    else
+    {
+        profile_size = 0;
+    }
+
+    if (rt_bitmap->profile)
+    {
+        rt_bitmap->file_header->file_size -= v5_header->profile_size;
+        mem_free(rt_bitmap->profile);
+    }
+
+    rt_bitmap->profile                 = copy;
+    rt_bitmap->file_header->file_size += profile_size;
+
+    v5_header->profile_size = profile_size;
+    v5_header->color_space  = (profile) ? PROFILE_EMBEDDED : LCS_sRGB;
+
+    place_profile(rt_bitmap);
+
+    return 0;
+}
+
+sint_t set_rt_bitmap_data_size(rt_bitmap_t* rt_bitmap, uint32_t data_size)
+{
+    if ((! rt_bitmap) || (BITMAP_CORE == rt_bitmap->info_type))
+        return -1;
+
+    uint32_t compression = get_compression(rt_bitmap);
+
+    if ((compression != BI_RLE8) && (compression != BI_RLE4) && (! is_payload(compression)))
+        return -1;
+
+    // Headers get real size of data
+    rt_bitmap->file_header->file_size -= rt_bitmap->data_size;
+    rt_bitmap->file_header->file_size += data_size;
+    rt_bitmap->data_size               = data_size;
+
+    ((bitmap_info_header_t*) rt_bitmap->info_header)->data_size = data_size;
+
+    // Index of previous data is not valid anymore
+    if (rt_bitmap->rle_index)
+    {
+        del_bitmap_rle_index(rt_bitmap->rle_index);
+        rt_bitmap->rle_index = NULL;
+    }
+
+    place_profile(rt_bitmap);
+
+    return 0;
+}
+
+sint_t calc_rt_bitmap_data(rt_bitmap_t* rt_bitmap, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_data)
+{
+    if ((! rt_bitmap) || (! rt_bitmap_data) || (! rt_bitmap->data_line))
+        return -1;
+
+    if (rt_bitmap->info_type == BITMAP_CORE)
+    {
+        bitmap_core_header_t* core_header = (bitmap_core_header_t*) rt_bitmap->info_header;
+
+        rt_bitmap_data->bit_count = core_header->bit_count;
+        rt_bitmap_data->width     = core_header->data_width;
+        rt_bitmap_data->height    = core_header->data_height;
+    }
+    else
+    {
+        bitmap_info_header_t* info_header = (bitmap_info_header_t*) rt_bitmap->info_header;
+
+        rt_bitmap_data->bit_count = info_header->bit_count;
+        rt_bitmap_data->width     = info_header->data_width;
+        rt_bitmap_data->height    = data_height_info(info_header);
+    }
+
+    rt_bitmap_data->line_size = calc_aligned_line_size(rt_bitmap->data_line, alignment);
+    rt_bitmap_data->size      = rt_bitmap_data->line_size * rt_bitmap_data->height;
+    rt_bitmap_data->data      = NULL;
+
+    return 0;
+}
+
+static sint_t load_rle_data(FILE* stream, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, uint32_t compression)
+{
+    if ((! rt_bitmap->data_size) || (rt_bitmap_data->bit_count != ((compression == BI_RLE8) ? 8 : 4)))
+        return -1;
+
+    begin_cancel_units(rt_bitmap_data->height);
+
+    if (! check_cancel_units(0))
+        return -1;
+
+    // Compressed data is read at once
+    uint8_t* data = (uint8_t*) mem_alloc(rt_bitmap->data_size);
+
+    if (! data)
+        return -1;
+
+    if (file_read(data, 1, rt_bitmap->data_size, stream) != (size_t) rt_bitmap->data_size)
+    {
+        mem_free(data);
+        return -1;
+    }
+
+    // Skipped pixels have first color
+    uint8_t* line   = (uint8_t*) rt_bitmap_data->data;
+    sint32_t stride = (sint32_t) rt_bitmap_data->line_size;
+
+    memset(line, 0, (size_t) rt_bitmap_data->line_size * rt_bitmap_data->height);
+
+    // Lines are stored from bottom to top
+    if ((! is_top_down(rt_bitmap)) && (rt_bitmap_data->height))
+    {
+        line  += (size_t) rt_bitmap_data->line_size * (rt_bitmap_data->height - 1);
+        stride = 0 - stride;
+    }
+
+    // Decoded line by line, so cancel token is checked on every line
+    bitmap_rle_line_t state  = { 0, 0, 0 };
+    sint_t            result = 0;
+
+    while ((result == 0) && (state.y < rt_bitmap_data->height))
+    {
+        if (! check_cancel_units(state.y))
+        {
+            result = -1;
+            break;
+        }
+
+        result = decode_bitmap_rle_step(data, rt_bitmap->data_size, compression, &state, rt_bitmap_data->width, state.y + 1, line, stride);
+    }
+
+    mem_free(data);
+
+    if (result < 0)
+        return -1;
+
+    end_cancel_units();
+
+    return 0;
+}
+
+// Lines read packed at start of band are spread to stride and flipped inside band
+static void_t place_band(uint8_t* band, uint32_t band_num, uint32_t data_line, uint32_t line_size, bool_e top_down)
+{
+    uint32_t j;
+
+    // Backwards, so packed lines are not overwritten
+    if (line_size != data_line)
+    {
+        for (j = band_num - 1; j > 0; j --)
+            memmove(band + (size_t) line_size * j, band + (size_t) data_line * j, data_line);
+    }
+
+    // Lines are stored from bottom to top
+    if (! top_down)
+    {
+        for (j = 0; j < band_num / 2; j ++)
+            swap_lines(band + (size_t) line_size * j, band + (size_t) line_size * (band_num - j - 1), data_line);
+    }
+}
+
+// Lines are read in bands (usually whole pixel array at once) directly into
+// place of band in buffer. Cancel token is checked on every line, so while
+// token is set every band is single line.
+static sint_t load_bands(FILE* stream, uint32_t data_line, bool_e top_down, rt_bitmap_data_t* rt_bitmap_data)
+{
+    uint32_t line_size = rt_bitmap_data->line_size;
+    uint32_t height    = rt_bitmap_data->height;
+    uint32_t band_max  = ((data_line < RT_BITMAP_BAND_SIZE) && (! get_cancel_token())) ? (RT_BITMAP_BAND_SIZE / data_line) : 1;
+
+    begin_cancel_units(height);
+
+    uint32_t i, band_num;
+    for (i = 0; i < height; i += band_num)
+    {
+        // Lines already read stay in buffer
+        if (! check_cancel_units(i))
+            return -1;
+
+        band_num = ((height - i) < band_max) ? (height - i) : band_max;
+
+        uint8_t* band  = (uint8_t*) rt_bitmap_data->data;
+                 band += (size_t) line_size * ((top_down) ? i : (height - i - band_num));
+
+        if (file_read(band, 1, (size_t) data_line * band_num, stream) != (size_t) data_line * band_num)
+            return -1;
+
+        place_band(band, band_num, data_line, line_size, top_down);
+    }
+
+    end_cancel_units();
+
+    return 0;
+}
+
+sint_t load_rt_bitmap_data(FILE* stream, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data)
+{
+    STATS_SCOPE(STATS_LOAD_RT_BITMAP_DATA);
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap->data_line) || (! rt_bitmap_data) || (! rt_bitmap_data->data))
+        return -1;
+
+    // Buffer is owned by caller, its stride can be wider than line in file
+    if ((! rt_bitmap_data->line_size) || (rt_bitmap_data->line_size < rt_bitmap->data_line)
+    ||  (rt_bitmap_data->size / rt_bitmap_data->line_size < rt_bitmap_data->height))
+        return -1;
+
+    TRACE_SCOPE(TRACE_DECODE, RT_BITMAP, rt_bitmap->data_offset);
+
+    if (file_seek(stream, rt_bitmap->data_offset, SEEK_SET) != 0)
+        return -1;
+
+    uint32_t compression = get_compression(rt_bitmap);
+
+    if ((compression == BI_RLE8) || (compression == BI_RLE4))
+        return load_rle_data(stream, rt_bitmap, rt_bitmap_data, compression);
+
+    return load_bands(stream, rt_bitmap->data_line, is_top_down(rt_bitmap), rt_bitmap_data);
+}
+
+rt_bitmap_data_t* get_rt_bitmap_data(FILE* stream, rt_bitmap_t* rt_bitmap)
+{
+    STATS_SCOPE(STATS_GET_RT_BITMAP_DATA);
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap->data_size))
+        return NULL;
+
+    rt_bitmap_data_t* rt_bitmap_data = (rt_bitmap_data_t*) mem_alloc(sizeof(rt_bitmap_data_t));
+
+    if (! rt_bitmap_data)
+        return NULL;
+
+    if (calc_rt_bitmap_data(rt_bitmap, 0, rt_bitmap_data) < 0)
+    {
+        mem_free(rt_bitmap_data);
+        return NULL;
+    }
+
+    rt_bitmap_data->data = mem_alloc(rt_bitmap_data->size);
+
+    if (! rt_bitmap_data->data)
+    {
+        mem_free(rt_bitmap_data);
+        return NULL;
+    }
+
+    if (load_rt_bitmap_data(stream, rt_bitmap, rt_bitmap_data) < 0)
+    {
+        del_rt_bitmap_data(rt_bitmap_data);
+        return NULL;
+    }
+
+    return rt_bitmap_data;
+}
+
+sint_t calc_rt_bitmap_region(rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_region)
+{
+    if (calc_rt_bitmap_data(rt_bitmap, alignment, rt_bitmap_region) < 0)
+        return -1;
+
+    // Region is not empty and lies inside of image
+    if ((! width) || (x >= rt_bitmap_region->width)  || (width  > rt_bitmap_region->width  - x)
+    ||  (! height) || (y >= rt_bitmap_region->height) || (height > rt_bitmap_region->height - y))
+        return -1;
+
+    rt_bitmap_region->width     = width;
+    rt_bitmap_region->height    = height;
+    rt_bitmap_region->line_size = calc_aligned_line_size(calc_bitmap_line_size(width, rt_bitmap_region->bit_count), alignment);
+    rt_bitmap_region->size      = rt_bitmap_region->line_size * height;
+
+    return 0;
+}
+
+// Lines of RLE data are indexed once, compressed data is scanned in bands
+static bitmap_rle_index_t* index_rle_data(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t compression, uint32_t height)
+{
+    if (rt_bitmap->rle_index)
+        return rt_bitmap->rle_index;
+
+    uint32_t            data_size = rt_bitmap->data_size;
+    uint32_t            band_size = (data_size < RT_BITMAP_BAND_SIZE) ? data_size : RT_BITMAP_BAND_SIZE;
+    uint8_t*            band      = (uint8_t*) mem_alloc(band_size);
+
+    // Index is kept by rt_bitmap, so it is made by allocator of rt_bitmap
+    mem_allocator_t*    previous  = set_mem_allocator(get_mem_block_allocator(rt_bitmap));
+    bitmap_rle_index_t* index     = new_bitmap_rle_index(compression, height);
+
+    set_mem_allocator(previous);
+
+    if ((! band) || (! index))
+    {
+        if (band)
+            mem_free(band);
+        if (index)
+            del_bitmap_rle_index(index);
+        return NULL;
+    }
+
+    while (! index->done)
+    {
+        // Absolute run can end beyond band, so scan continues from its state
+        uint32_t pos  = index->state.pos;
+        uint32_t size = (pos < data_size) ? (((data_size - pos) < band_size) ? (data_size - pos) : band_size) : 0;
+        bool_e   last = (pos + size >= data_size) ? TRUE : FALSE;
+
+        if ((! check_cancel_units(0))
+        ||  (file_seek(stream, rt_bitmap->data_offset + pos, SEEK_SET) != 0)
+        ||  (file_read(band, 1, size, stream) != (size_t) size)
+        ||  ((! scan_bitmap_rle_index(index, band, size, last)) && (! index->done)))
+        {
+            mem_free(band);
+            del_bitmap_rle_index(index);
+            return NULL;
+        }
+    }
+
+    mem_free(band);
+
+    rt_bitmap->rle_index = index;
+
+    return index;
+}
+
+static sint_t load_rle_region(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t first, rt_bitmap_data_t* rt_bitmap_region,
+                              uint32_t compression, uint32_t image_height)
+{
+    if ((! rt_bitmap->data_size) || (rt_bitmap_region->bit_count != ((compression == BI_RLE8) ? 8 : 4)))
+        return -1;
+
+    uint32_t line_size = rt_bitmap_region->line_size;
+    uint32_t height    = rt_bitmap_region->height;
+    bool_e   top_down  = is_top_down(rt_bitmap);
+
+    begin_cancel_units(height);
+
+    if (! check_cancel_units(0))
+        return -1;
+
+    bitmap_rle_index_t* index = index_rle_data(stream, rt_bitmap, compression, image_height);
+
+    if (! index)
+        return -1;
+
+    // Skipped pixels have first color
+    memset(rt_bitmap_region->data, 0, (size_t) line_size * height);
+
+    uint8_t* band      = NULL;
+    uint32_t band_size = 0;
+
+    // Compressed data of lines is read in bands (at least one line)
+    uint32_t i, band_num;
+    for (i = 0; i < height; i += band_num)
+    {
+        if (! check_cancel_units(i))
+            break;
+
+        const bitmap_rle_line_t* lines = index->lines + first + i;
+
+        for (band_num = 1; (i + band_num < height) && (lines[band_num + 1].pos - lines[0].pos <= RT_BITMAP_BAND_SIZE); band_num ++)
+            ;
+
+        uint32_t end  = (lines[band_num].pos < rt_bitmap->data_size) ? lines[band_num].pos : rt_bitmap->data_size;
+        uint32_t size = (end > lines[0].pos) ? (end - lines[0].pos) : 0;
+
+        if (! size)
+            continue;
+
+        if (size > band_size)
+        {
+            if (band)
+                mem_free(band);
+
+            band      = (uint8_t*) mem_alloc(size);
+            band_size = size;
+
+            if (! band)
+                break;
+        }
+
+        if ((file_seek(stream, rt_bitmap->data_offset + lines[0].pos, SEEK_SET) != 0)
+        ||  (file_read(band, 1, size, stream) != (size_t) size))
+            break;
+
+        // Lines are stored from bottom to top
+        uint8_t* line   = (uint8_t*) rt_bitmap_region->data + (size_t) line_size * ((top_down) ? i : (height - i - 1));
+        sint32_t stride = (top_down) ? (sint32_t) line_size : (0 - (sint32_t) line_size);
+
+        if (decode_bitmap_rle_lines(band, size, compression, lines, x, rt_bitmap_region->width, first + i, band_num, line, stride) < 0)
+            break;
+    }
+
+    if (band)
+        mem_free(band);
+
+    if (i < height)
+        return -1;
+
+    end_cancel_units();
+
+    return 0;
+}
+
+// Columns of line start at any bit of first byte, last byte is cleared after them
+static void_t shift_line(uint8_t* dst, const uint8_t* src, uint32_t span, uint32_t shift, uint32_t bits)
+{
+    uint32_t size = (bits + 7) / 8;
+    uint32_t i;
+
+    if (shift)
+    {
+        for (i = 0; i < size; i ++)
+            dst[i] = (uint8_t) ((src[i] << shift) | ((i + 1 < span) ? (src[i + 1] >> (8 - shift)) : 0));
+    }
+    else
+        memcpy(dst, src, size);
+
+    if (bits & 7)
+        dst[size - 1] &= (uint8_t) (0xFF << (8 - (bits & 7)));
+}
+
+sint_t load_rt_bitmap_region(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t y, rt_bitmap_data_t* rt_bitmap_region)
+{
+    STATS_SCOPE(STATS_LOAD_RT_BITMAP_REGION);
+
+    rt_bitmap_data_t image;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap_region) || (! rt_bitmap_region->data)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &image) < 0))
+        return -1;
+
+    uint32_t width  = rt_bitmap_region->width;
+    uint32_t height = rt_bitmap_region->height;
+
+    if ((rt_bitmap_region->bit_count != image.bit_count)
+    ||  (! width)  || (x >= image.width)  || (width  > image.width  - x)
+    ||  (! height) || (y >= image.height) || (height > image.height - y))
+        return -1;
+
+    // Buffer is owned by caller, its stride can be wider than line of region
+    uint64_t bit_first = (uint64_t) x * image.bit_count;
+    uint32_t bits      = width * image.bit_count;
+
+    if ((rt_bitmap_region->line_size < (bits + 7) / 8)
+    ||  (rt_bitmap_region->size / rt_bitmap_region->line_size < height))
+        return -1;
+
+    TRACE_SCOPE(TRACE_DECODE, RT_BITMAP, rt_bitmap->data_offset);
+
+    // First line of region in file
+    bool_e   top_down    = is_top_down(rt_bitmap);
+    uint32_t first       = (top_down) ? y : (image.height - y - height);
+    uint32_t compression = get_compression(rt_bitmap);
+
+    if ((compression == BI_RLE8) || (compression == BI_RLE4))
+        return load_rle_region(stream, rt_bitmap, x, first, rt_bitmap_region, compression, image.height);
+
+    uint32_t data_line = rt_bitmap->data_line;
+
+    // Range of whole lines is contiguous in file
+    if ((width == image.width) && (rt_bitmap_region->line_size >= data_line))
+    {
+        if (file_seek(stream, rt_bitmap->data_offset + first * data_line, SEEK_SET) != 0)
+            return -1;
+
+        return load_bands(stream, data_line, top_down, rt_bitmap_region);
+    }
+
+    // Parts of lines covering columns are read in bands of lines, unless parts
+    // are far apart (each one is read alone then)
+    uint32_t byte_first = (uint32_t) (bit_first / 8);
+    uint32_t shift      = (uint32_t) (bit_first % 8);
+    uint32_t span       = (uint32_t) ((bit_first + bits + 7) / 8) - byte_first;
+    uint32_t band_max   = ((data_line - span < RT_BITMAP_SKIP_SIZE) && (data_line < RT_BITMAP_BAND_SIZE)) ? (RT_BITMAP_BAND_SIZE / data_line) : 1;
+
+    band_max = (band_max < height) ? band_max : height;
+
+    uint8_t* band = (uint8_t*) mem_alloc((size_t) data_line * (band_max - 1) + span);
+
+    if (! band)
+        return -1;
+
+    begin_cancel_units(height);
+
+    uint32_t i, j, band_num;
+    for (i = 0; i < height; i += j)
+    {
+        // Lines already placed stay in buffer
+        if (! check_cancel_units(i))
+            break;
+
+        band_num = ((height - i) < band_max) ? (height - i) : band_max;
+
+        size_t size = (size_t) data_line * (band_num - 1) + span;
+
+        if ((file_seek(stream, rt_bitmap->data_offset + (first + i) * data_line + byte_first, SEEK_SET) != 0)
+        ||  (file_read(band, 1, size, stream) != size))
+            break;
+
+        // Lines are stored from bottom to top, token is checked on every line
+        for (j = 0; (j < band_num) && ((! j) || (check_cancel_units(i + j))); j ++)
+        {
+            uint32_t line = (top_down) ? (i + j) : (height - i - j - 1);
+
+            shift_line((uint8_t*) rt_bitmap_region->data + (size_t) rt_bitmap_region->line_size * line, band + (size_t) data_line * j, span, shift, bits);
+        }
+
+        if (j < band_num)
+        {
+            i += j;
+            break;
+        }
+    }
+
+    mem_free(band);
+
+    if (i < height)
+        return -1;
+
+    end_cancel_units();
+
+    return 0;
+}
+
+rt_bitmap_data_t* get_rt_bitmap_region(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    STATS_SCOPE(STATS_GET_RT_BITMAP_REGION);
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap->data_size))
+        return NULL;
+
+    rt_bitmap_data_t* rt_bitmap_region = (rt_bitmap_data_t*) mem_alloc(sizeof(rt_bitmap_data_t));
+
+    if (! rt_bitmap_region)
+        return NULL;
+
+    if (calc_rt_bitmap_region(rt_bitmap, x, y, width, height, 0, rt_bitmap_region) < 0)
+    {
+        mem_free(rt_bitmap_region);
+        return NULL;
+    }
+
+    rt_bitmap_region->data = mem_alloc(rt_bitmap_region->size);
+
+    if (! rt_bitmap_region->data)
+    {
+        mem_free(rt_bitmap_region);
+        return NULL;
+    }
+
+    if (load_rt_bitmap_region(stream, rt_bitmap, x, y, rt_bitmap_region) < 0)
+    {
+        del_rt_bitmap_data(rt_bitmap_region);
+        return NULL;
+    }
+
+    return rt_bitmap_region;
+}
+
+sint_t index_rt_bitmap_rle(FILE* stream, rt_bitmap_t* rt_bitmap)
+{
+    rt_bitmap_data_t image;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap->data_size)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &image) < 0))
+        return -1;
+
+    uint32_t compression = get_compression(rt_bitmap);
+
+    // Lines of uncompressed data have fixed positions
+    if ((compression != BI_RLE8) && (compression != BI_RLE4))
+        return 0;
+
+    return (index_rle_data(stream, rt_bitmap, compression, image.height)) ? 0 : -1;
+}
+
+sint_t load_rt_bitmap_lines(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t y, rt_bitmap_data_t* rt_bitmap_lines)
+{
+    STATS_SCOPE(STATS_LOAD_RT_BITMAP_LINES);
+
+    rt_bitmap_data_t image;
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap->data_offset) || (! rt_bitmap_lines) || (! rt_bitmap_lines->data)
+    ||  (calc_rt_bitmap_data(rt_bitmap, 0, &image) < 0))
+        return -1;
+
+    uint32_t data_line = rt_bitmap->data_line;
+    uint32_t line_size = rt_bitmap_lines->line_size;
+    uint32_t height    = rt_bitmap_lines->height;
+
+    if ((rt_bitmap_lines->bit_count != image.bit_count) || (rt_bitmap_lines->width != image.width)
+    ||  (! height) || (y >= image.height) || (height > image.height - y)
+    ||  (line_size < data_line) || (rt_bitmap_lines->size / line_size < height))
+        return -1;
+
+    TRACE_SCOPE(TRACE_DECODE, RT_BITMAP, rt_bitmap->data_offset);
+
+    // Token is only polled, units of token belong to operation of caller
+    if (! poll_cancel_token(get_cancel_token()))
+        return -1;
+
+    // First line of range in file
+    bool_e   top_down    = is_top_down(rt_bitmap);
+    uint32_t first       = (top_down) ? y : (image.height - y - height);
+    uint32_t compression = get_compression(rt_bitmap);
+    uint8_t* data        = (uint8_t*) rt_bitmap_lines->data;
+
+    if ((compression != BI_RLE8) && (compression != BI_RLE4))
+    {
+        if (file_read_at(stream, rt_bitmap->data_offset + first * data_line, data, (size_t) data_line * height) != (size_t) data_line * height)
+            return -1;
+
+        place_band(data, height, data_line, line_size, top_down);
+
+        return 0;
+    }
+
+    // Index is only read here, so it is shared by threads
+    bitmap_rle_index_t* index = rt_bitmap->rle_index;
+
+    if ((! index) || (! index->done) || (index->height != image.height) || (image.bit_count != ((compression == BI_RLE8) ? 8 : 4)))
+        return -1;
+
+    // Skipped pixels have first color
+    memset(data, 0, (size_t) line_size * height);
+
+    const bitmap_rle_line_t* lines = index->lines + first;
+
+    uint32_t end  = (lines[height].pos < rt_bitmap->data_size) ? lines[height].pos : rt_bitmap->data_size;
+    uint32_t size = (end > lines[0].pos) ? (end - lines[0].pos) : 0;
+
+    if (! size)
+        return 0;
+
+    uint8_t* band = (uint8_t*) mem_alloc(size);
+
+    if (! band)
+        return -1;
+
+    // Lines are stored from bottom to top
+    uint8_t* line   = data + (size_t) line_size * ((top_down) ? 0 : (height - 1));
+    sint32_t stride = (top_down) ? (sint32_t) line_size : (0 - (sint32_t) line_size);
+    sint_t   result = -1;
+
+    if (file_read_at(stream, rt_bitmap->data_offset + lines[0].pos, band, size) == (size_t) size)
+        result = decode_bitmap_rle_lines(band, size, compression, lines, 0, image.width, first, height, line, stride);
+
+    mem_free(band);
+
+    return result;
+}
+
+sint_t calc_rt_bitmap_view(rt_bitmap_t* rt_bitmap, const void_t* image, uint32_t image_size, rt_bitmap_view_t* rt_bitmap_view)
+{
+    if ((! rt_bitmap) || (! image) || (! rt_bitmap_view))
+        return -1;
+
+    // Only uncompressed lines can be addressed
+    if (BITMAP_CORE != rt_bitmap->info_type)
+    {
+        uint32_t compression = ((bitmap_info_header_t*) rt_bitmap->info_header)->compression;
+
+        if ((compression != BI_RGB) && (compression != BI_BITFIELDS))
+            return -1;
+    }
+
+    rt_bitmap_data_t rt_bitmap_data;
+
+    if (calc_rt_bitmap_data(rt_bitmap, 0, &rt_bitmap_data) < 0)
+        return -1;
+
+    // Whole pixel array is inside image
+    if ((! rt_bitmap_data.height) || (rt_bitmap->data_line > 0x7FFFFFFF)
+    ||  ((uint64_t) rt_bitmap->data_offset + (uint64_t) rt_bitmap->data_line * rt_bitmap_data.height > image_size))
+        return -1;
+
+    const uint8_t* data = (const uint8_t*) image + rt_bitmap->data_offset;
+
+    rt_bitmap_view->bit_count = rt_bitmap_data.bit_count;
+    rt_bitmap_view->width     = rt_bitmap_data.width;
+    rt_bitmap_view->height    = rt_bitmap_data.height;
+    rt_bitmap_view->line_size = rt_bitmap->data_line;
+
+    if (is_top_down(rt_bitmap))
+    {
+        rt_bitmap_view->first  = data;
+        rt_bitmap_view->stride = (sint32_t) rt_bitmap->data_line;
+    }
+    else
+    {
+        rt_bitmap_view->first  = data + (size_t) rt_bitmap->data_line * (rt_bitmap_data.height - 1);
+        rt_bitmap_view->stride = 0 - (sint32_t) rt_bitmap->data_line;
+    }
+
+    return 0;
+}
+
+sint_t calc_rt_bitmap_quads(rt_bitmap_data_t* rt_bitmap_data, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_quads)
+{
+    if ((! rt_bitmap_data) || (! rt_bitmap_quads) || (! get_colors_num(rt_bitmap_data->bit_count)))
+        return -1;
+
+    // Stride of 32-bit pixels stays multiple of pixel size
+    alignment = calc_aligned_line_size(((alignment) ? alignment : sizeof(rgb_quad_t)), sizeof(rgb_quad_t));
+
+    rt_bitmap_quads->bit_count = 32;
+    rt_bitmap_quads->width     = rt_bitmap_data->width;
+    rt_bitmap_quads->height    = rt_bitmap_data->height;
+    rt_bitmap_quads->line_size = calc_aligned_line_size(rt_bitmap_data->width * sizeof(rgb_quad_t), alignment);
+    rt_bitmap_quads->size      = rt_bitmap_quads->line_size * rt_bitmap_quads->height;
+    rt_bitmap_quads->data      = NULL;
+
+    return 0;
+}
+
+sint_t expand_rt_bitmap_data(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, rt_bitmap_data_t* rt_bitmap_quads)
+{
+    STATS_SCOPE(STATS_EXPAND_RT_BITMAP_DATA);
+
+    if ((! rt_bitmap) || (! rt_bitmap->color_table) || (! rt_bitmap_data) || (! rt_bitmap_data->data)
+    ||  (! rt_bitmap_quads) || (! rt_bitmap_quads->data))
+        return -1;
+
+    if ((rt_bitmap_quads->width != rt_bitmap_data->width) || (rt_bitmap_quads->height != rt_bitmap_data->height)
+    ||  (rt_bitmap_quads->line_size < rt_bitmap_data->width * sizeof(rgb_quad_t)) || (rt_bitmap_quads->line_size % sizeof(rgb_quad_t))
+    ||  (rt_bitmap_quads->size / rt_bitmap_quads->line_size < rt_bitmap_quads->height))
+        return -1;
+
+    const cpu_kernels_t* kernels = get_cpu_kernels();
+    void_t (*expand)(const uint8_t* src, uint32_t* dst, uint32_t width, const uint32_t* palette) = NULL;
+
+    switch (rt_bitmap_data->bit_count)
+    {
+        case  1: expand = kernels->expand_1_bit; break;
+        case  4: expand = kernels->expand_4_bit; break;
+        case  8: expand = kernels->expand_8_bit; break;
+        default: return -1;
+    }
+
+    // Palette has entry for every index (colors missing in table are black)
+    uint32_t palette [COLORS_IN_8_BIT_TABLE];
+    uint32_t colors_num = get_colors_num(rt_bitmap_data->bit_count);
+
+    if (colors_num > rt_bitmap->color_nums)
+        colors_num = rt_bitmap->color_nums;
+
+    memset(palette, 0, sizeof(palette));
+    memcpy(palette, rt_bitmap->color_table, sizeof(rgb_quad_t) * colors_num);
+
+    const uint8_t* src = (const uint8_t*) rt_bitmap_data->data;
+          uint8_t* dst = (uint8_t*) rt_bitmap_quads->data;
+
+    begin_cancel_units(rt_bitmap_data->height);
+
+    uint32_t i;
+    for (i = 0; i < rt_bitmap_data->height; i ++)
+    {
+        if (! check_cancel_units(i))
+            return -1;
+
+        expand(src, (uint32_t*) dst, rt_bitmap_data->width, palette);
+
+        src += rt_bitmap_data->line_size;
+        dst += rt_bitmap_quads->line_size;
+    }
+
+    end_cancel_units();
+
+    return 0;
+}
+
+rt_bitmap_data_t* get_rt_bitmap_quads(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data)
+{
+    STATS_SCOPE(STATS_GET_RT_BITMAP_QUADS);
+
+    rt_bitmap_data_t* rt_bitmap_quads = (rt_bitmap_data_t*) mem_alloc(sizeof(rt_bitmap_data_t));
+
+    if (! rt_bitmap_quads)
+        return NULL;
+
+    if (calc_rt_bitmap_quads(rt_bitmap_data, 0, rt_bitmap_quads) < 0)
+    {
+        mem_free(rt_bitmap_quads);
+        return NULL;
+    }
+
+    rt_bitmap_quads->data = mem_alloc(rt_bitmap_quads->size);
+
+    if (! rt_bitmap_quads->data)
+    {
+        mem_free(rt_bitmap_quads);
+        return NULL;
+    }
+
+    if (expand_rt_bitmap_data(rt_bitmap, rt_bitmap_data, rt_bitmap_quads) < 0)
+    {
+        del_rt_bitmap_data(rt_bitmap_quads);
+        return NULL;
+    }
+
+    return rt_bitmap_quads;
+}
+
+sint_t put_rt_bitmap_data(FILE* stream, uint32_t offset, rt_bitmap_data_t* rt_bitmap_data)
+{
+    STATS_SCOPE(STATS_PUT_RT_BITMAP_DATA);
+
+    if ((! stream) || (! rt_bitmap_data))
+        return -1;
+
+    // Stride of data can be wider than line in file
+    uint32_t line_size = calc_bitmap_line_size(rt_bitmap_data->width, rt_bitmap_data->bit_count);
+
+    if (line_size > rt_bitmap_data->line_size)
+        return -1;
+
+    if (! rt_bitmap_data->height)
+        return 0;
+
+    // Lines are gathered from bottom to top
+    file_vector_t* vectors = (file_vector_t*) mem_alloc(sizeof(file_vector_t) * rt_bitmap_data->height);
+
+    if (! vectors)
+        return -1;
+
+    uint8_t* line  = (uint8_t*) rt_bitmap_data->data;
+             line += (size_t) rt_bitmap_data->line_size * rt_bitmap_data->height;
+
+    uint32_t i;
+    for (i = 0; i < rt_bitmap_data->height; i ++)
+    {
+        line -= rt_bitmap_data->line_size;
+
+        vectors[i].iov_base = line;
+        vectors[i].iov_len  = line_size;
+    }
+
+    size_t size = (size_t) line_size * rt_bitmap_data->height;
+
+    if (rt_bitmap_data->height > FILE_VECTORS_MAX)
+        file_reserve(stream, offset, (uint32_t) size);
+
+    sint_t ret = (file_write_vector(stream, offset, vectors, rt_bitmap_data->height) != size) ? -1 : 0;
+
+    mem_free(vectors);
+
+    return ret;
+}
+
+sint_t put_rt_bitmap_data_rle(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data)
+{
+    STATS_SCOPE(STATS_PUT_RT_BITMAP_DATA_RLE);
+
+    if ((! stream) || (! rt_bitmap) || (! rt_bitmap_data) || (! rt_bitmap_data->data))
+        return -1;
+
+    uint32_t compression = get_compression(rt_bitmap);
+
+    if (((compression != BI_RLE8) || (rt_bitmap_data->bit_count != 8))
+    &&  ((compression != BI_RLE4) || (rt_bitmap_data->bit_count != 4)))
+        return -1;
+
+    uint32_t size = calc_bitmap_rle_size(rt_bitmap_data->width, rt_bitmap_data->height);
+    uint8_t* data = (uint8_t*) mem_alloc(size);
+
+    if (! data)
+        return -1;
+
+    // Data lines are top to bottom, file lines are bottom to top
+    const uint8_t* line   = (const uint8_t*) rt_bitmap_data->data;
+    sint32_t       stride = (sint32_t) rt_bitmap_data->line_size;
+
+    if (rt_bitmap_data->height)
+    {
+        line  += (size_t) rt_bitmap_data->line_size * (rt_bitmap_data->height - 1);
+        stride = 0 - stride;
+    }
+
+    size = encode_bitmap_rle(line, stride, compression, rt_bitmap_data->width, rt_bitmap_data->height, data, size);
+
+    if ((! size) || (file_seek(stream, offset, SEEK_SET) != 0) || (file_write(data, 1, size, stream) != (size_t) size))
+    {
+        mem_free(data);
+        return -1;
+    }
+
+    mem_free(data);
+
+    return set_rt_bitmap_data_size(rt_bitmap, size);
+}
+
+void_t del_rt_bitmap_data(rt_bitmap_data_t* rt_bitmap_data)
+{
+    mem_free(rt_bitmap_data->data);
+    mem_free(rt_bitmap_data);
+}
+
+sint_t calc_rt_bitmap_payload(rt_bitmap_t* rt_bitmap, rt_bitmap_payload_t* rt_bitmap_payload)
+{
+    if ((! rt_bitmap) || (! rt_bitmap_payload) || (! rt_bitmap->data_offset) || (! rt_bitmap->data_size))
+        return -1;
+
+    switch (get_compression(rt_bitmap))
+    {
+        case BI_JPEG: rt_bitmap_payload->mime_type = "image/jpeg"; break;
+        case BI_PNG:  rt_bitmap_payload->mime_type = "image/png";  break;
+        default:
+            return -1;
+    }
+
+    // Whole payload is addressable by 32-bit offsets
+    if ((uint64_t) rt_bitmap->data_offset + rt_bitmap->data_size > 0xFFFFFFFF)
+        return -1;
+
+    rt_bitmap_payload->offset = rt_bitmap->data_offset;
+    rt_bitmap_payload->size   = rt_bitmap->data_size;
+
+    return 0;
+}
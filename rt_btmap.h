@@ -1,247 +1,417 @@
-#ifndef __RT_BTMAP_H__
-#define __RT_BTMAP_H__
-
-#include <stdio.h>
-
-#include "inttypes.h"
-#include "platform.h"
-#include "colortbl.h"
-
-// Bitmap file header
-//
-// 0x0000 : "BM"    : 0x42 0x4D
-// 0x0002 : 4 bytes : File size in bytes
-// 0x0006 : 4 bytes : Reserved
-// 0x000A : 4 bytes : Offset to pixel array
-
-// Bitmap info header (BITMAPCOREHEADER)
-//
-// 0x0000 : 4 bytes : Header size
-// 0x0004 : 2 bytes : Image width
-// 0x0006 : 2 bytes : Image height
-// 0x0008 : 2 bytes : Number of planes (always 1)
-// 0x000A : 2 bytes : Bits per pixel   (1, 4, 8 or 24)
-
-// Bitmap info header (BITMAPINFOHEADER)
-//
-// 0x0000 : 4 bytes : Header size
-// 0x0004 : 4 bytes : Image width
-// 0x0008 : 4 bytes : Image height
-// 0x000C : 2 bytes : Number of planes (always 1)
-// 0x000E : 2 bytes : Bits per pixel   (0, 1, 4, 8, 16, 24 or 32)
-// 0x0010 : 4 bytes : Compression type (see compression_e enum)
-// 0x0014 : 4 bytes : Image size in bytes
-// 0x0018 : 4 bytes : Horizontal resolution (in pixels per meter)
-// 0x001C : 4 bytes : Vertical resolution (in pixels per meter)
-// 0x0020 : 4 bytes : Number of colors in table
-// 0x0024 : 4 bytes : Number of colors in image
-
-// Bitmap info header (BITMAPV4HEADER)
-//
-// 0x0000 :  4 bytes : Header size
-// 0x0004 :  4 bytes : Image width
-// 0x0008 :  4 bytes : Image height
-// 0x000C :  2 bytes : Number of planes (always 1)
-// 0x000E :  2 bytes : Bits per pixel   (0, 1, 4, 8, 16, 24 or 32)
-// 0x0010 :  4 bytes : Compression type (see compression_e enum)
-// 0x0014 :  4 bytes : Image size in bytes
-// 0x0018 :  4 bytes : Horizontal resolution (in pixels per meter)
-// 0x001C :  4 bytes : Vertical resolution (in pixels per meter)
-// 0x0020 :  4 bytes : Number of colors in table
-// 0x0024 :  4 bytes : Number of colors in image
-// 0x0028 :  4 bytes : Red color mask   (for BI_BITFIELDS compression only)
-// 0x002C :  4 bytes : Green color mask (for BI_BITFIELDS compression only)
-// 0x0030 :  4 bytes : Blue color mask  (for BI_BITFIELDS compression only)
-// 0x0034 :  4 bytes : Alpha channel mask
-// 0x0038 :  4 bytes : Color space type
-// 0x003C : 12 bytes : Red color endpoint   (4 bytes for each: X, Y, Z)
-// 0x0048 : 12 bytes : Green color endpoint (4 bytes for each: X, Y, Z)
-// 0x0054 : 12 bytes : Blue color endpoint  (4 bytes for each: X, Y, Z)
-// 0x0060 :  4 bytes : Gamma (tone response curve) for red color   (in unsigned fixed 16.16 format)
-// 0x0064 :  4 bytes : Gamma (tone response curve) for green color (in unsigned fixed 16.16 format)
-// 0x0068 :  4 bytes : Gamma (tone response curve) for blue color  (in unsigned fixed 16.16 format)
-
-// Bitmap info header (BITMAPV5HEADER)
-//
-// 0x0000 :  4 bytes : Header size
-// 0x0004 :  4 bytes : Image width
-// 0x0008 :  4 bytes : Image height
-// 0x000C :  2 bytes : Number of planes (always 1)
-// 0x000E :  2 bytes : Bits per pixel   (0, 1, 4, 8, 16, 24 or 32)
-// 0x0010 :  4 bytes : Compression type (see compression_e enum)
-// 0x0014 :  4 bytes : Image size in bytes
-// 0x0018 :  4 bytes : Horizontal resolution (in pixels per meter)
-// 0x001C :  4 bytes : Vertical resolution (in pixels per meter)
-// 0x0020 :  4 bytes : Number of colors in table
-// 0x0024 :  4 bytes : Number of colors in image
-// 0x0028 :  4 bytes : Red color mask   (for BI_BITFIELDS compression only)
-// 0x002C :  4 bytes : Green color mask (for BI_BITFIELDS compression only)
-// 0x0030 :  4 bytes : Blue color mask  (for BI_BITFIELDS compression only)
-// 0x0034 :  4 bytes : Alpha channel mask
-// 0x0038 :  4 bytes : Color space type
-// 0x003C : 12 bytes : Red color endpoint   (4 bytes for each: X, Y, Z)
-// 0x0048 : 12 bytes : Green color endpoint (4 bytes for each: X, Y, Z)
-// 0x0054 : 12 bytes : Blue color endpoint  (4 bytes for each: X, Y, Z)
-// 0x0060 :  4 bytes : Gamma (tone response curve) for red color   (in unsigned fixed 16.16 format)
-// 0x0064 :  4 bytes : Gamma (tone response curve) for green color (in unsigned fixed 16.16 format)
-// 0x0068 :  4 bytes : Gamma (tone response curve) for blue color  (in unsigned fixed 16.16 format)
-// 0x006C :  4 bytes : Rendering intent
-// 0x0070 :  4 bytes : Offset from beginning of info header to profile data (in bytes)
-// 0x0074 :  4 bytes : Size of profile data (in bytes)
-// 0x0078 :  4 bytes : Reserved
-
-#define BITMAP_FILE_HEADER_SIZE 0x0E
-#define BITMAP_FILE_HEADER_SYNC 0x4D42
-
-#define BITMAP_CORE_HEADER_SIZE 0x0C
-#define BITMAP_INFO_HEADER_SIZE 0x28
-#define BITMAP_V4_HEADER_SIZE   0x6C
-#define BITMAP_V5_HEADER_SIZE   0x7C
-
-typedef enum _info_types_e {
-    BITMAP_CORE,
-    BITMAP_INFO,
-    BITMAP_V4,
-    BITMAP_V5,
-    BITMAP_UNKNOWN
-} info_types_e;
-
-typedef enum _compression_e {
-  BI_RGB       = 0x0000,
-  BI_RLE8      = 0x0001,
-  BI_RLE4      = 0x0002,
-  BI_BITFIELDS = 0x0003,
-  BI_JPEG      = 0x0004,
-  BI_PNG       = 0x0005,
-  BI_CMYK      = 0x000B,
-  BI_CMYKRLE8  = 0x000C,
-  BI_CMYKRLE4  = 0x000D
-} compression_e;
-
-#pragma pack(1)
-typedef struct _endpoint_t {
-    uint32_t x;
-    uint32_t y;
-    uint32_t z;
-} endpoint_t PACKED_STRUCT;
-
-typedef struct _bitmap_file_header_t {
-    uint16_t syncword;
-    uint32_t file_size;
-    uint32_t reserved;
-    uint32_t data_offset;
-} bitmap_file_header_t PACKED_STRUCT;
-
-typedef struct _bitmap_core_header_t {
-    uint32_t info_size;
-    uint16_t data_width;
-    uint16_t data_height;
-    uint16_t planes_num;
-    uint16_t bit_count;
-} bitmap_core_header_t PACKED_STRUCT;
-
-typedef struct _bitmap_info_header_t {
-    uint32_t info_size;
-    uint32_t data_width;
-    uint32_t data_height;
-    uint16_t planes_num;
-    uint16_t bit_count;
-    uint32_t compression;
-    uint32_t data_size;
-    uint32_t ppm_vertical;
-    uint32_t ppm_horizontal;
-    uint32_t colors_num_table;
-    uint32_t colors_num_data;
-} bitmap_info_header_t PACKED_STRUCT;
-
-typedef struct _bitmap_v4_header_t {
-    uint32_t   info_size;
-    uint32_t   data_width;
-    uint32_t   data_height;
-    uint16_t   planes_num;
-    uint16_t   bit_count;
-    uint32_t   compression;
-    uint32_t   data_size;
-    uint32_t   ppm_vertical;
-    uint32_t   ppm_horizontal;
-    uint32_t   colors_num_table;
-    uint32_t   colors_num_data;
-    uint32_t   mask_red;
-    uint32_t   mask_green;
-    uint32_t   mask_blue;
-    uint32_t   mask_alpha;
-    uint32_t   color_space;
-    endpoint_t endpoint_red;
-    endpoint_t endpoint_green;
-    endpoint_t endpoint_blue;
-    uint32_t   gamma_red;
-    uint32_t   gamma_green;
-    uint32_t   gamma_blue;
-} bitmap_v4_header_t PACKED_STRUCT;
-
-typedef struct _bitmap_v5_header_t {
-    uint32_t   info_size;
-    uint32_t   data_width;
-    uint32_t   data_height;
-    uint16_t   planes_num;
-    uint16_t   bit_count;
-    uint32_t   compression;
-    uint32_t   data_size;
-    uint32_t   ppm_vertical;
-    uint32_t   ppm_horizontal;
-    uint32_t   colors_num_table;
-    uint32_t   colors_num_data;
-    uint32_t   mask_red;
-    uint32_t   mask_green;
-    uint32_t   mask_blue;
-    uint32_t   mask_alpha;
-    uint32_t   color_space;
-    endpoint_t endpoint_red;
-    endpoint_t endpoint_green;
-    endpoint_t endpoint_blue;
-    uint32_t   gamma_red;
-    uint32_t   gamma_green;
-    uint32_t   gamma_blue;
-    uint32_t   intent;
-    uint32_t   profile_offset;
-    uint32_t   profile_size;
-    uint32_t   reserved;
-} bitmap_v5_header_t PACKED_STRUCT;
-#pragma pack()
-
-uint32_t calc_bitmap_line_size(uint32_t data_width, uint32_t bit_count);
-
-typedef struct _rt_bitmap_t {
-    bitmap_file_header_t* file_header;
-    info_types_e          info_type;
-    void_t*               info_header;
-    rgb_quad_t*           color_table;
-    uint32_t              color_nums;
-    uint32_t              data_offset;
-    uint32_t              data_line;
-    uint32_t              data_size;
-} rt_bitmap_t;
-
-rt_bitmap_t* get_rt_bitmap(FILE* stream, uint32_t offset);
-rt_bitmap_t* gen_rt_bitmap(info_types_e info_type,
-                           uint32_t     compression,
-                           uint32_t     bit_count,
-                           uint32_t     data_width,
-                           uint32_t     data_height);
-sint_t       put_rt_bitmap(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap);
-void_t       del_rt_bitmap(rt_bitmap_t* rt_bitmap);
-
-typedef struct _rt_bitmap_data_t {
-    void_t*  data;
-    uint32_t size;
-    uint32_t bit_count;
-    uint32_t width;
-    uint32_t height;
-    uint32_t line_size;
-} rt_bitmap_data_t;
-
-rt_bitmap_data_t* get_rt_bitmap_data(FILE* stream, rt_bitmap_t* rt_bitmap);
-sint_t            put_rt_bitmap_data(FILE* stream, uint32_t offset, rt_bitmap_data_t* rt_bitmap_data);
-void_t            del_rt_bitmap_data(rt_bitmap_data_t* rt_bitmap_data);
-
-#endif // __RT_FONT_H__
+#ifndef __RT_BTMAP_H__
+#define __RT_BTMAP_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "colortbl.h"
+#include "bmp_rle.h"
+
+// Bitmap file header
+//
+// 0x0000 : "BM"    : 0x42 0x4D
+// 0x0002 : 4 bytes : File size in bytes
+// 0x0006 : 4 bytes : Reserved
+// 0x000A : 4 bytes : Offset to pixel array
+
+// Bitmap info header (BITMAPCOREHEADER)
+//
+// 0x0000 : 4 bytes : Header size
+// 0x0004 : 2 bytes : Image width
+// 0x0006 : 2 bytes : Image height
+// 0x0008 : 2 bytes : Number of planes (always 1)
+// 0x000A : 2 bytes : Bits per pixel   (1, 4, 8 or 24)
+
+// Bitmap info header (BITMAPINFOHEADER)
+//
+// 0x0000 : 4 bytes : Header size
+// 0x0004 : 4 bytes : Image width
+// 0x0008 : 4 bytes : Image height
+// 0x000C : 2 bytes : Number of planes (always 1)
+// 0x000E : 2 bytes : Bits per pixel   (0, 1, 4, 8, 16, 24 or 32)
+// 0x0010 : 4 bytes : Compression type (see compression_e enum)
+// 0x0014 : 4 bytes : Image size in bytes
+// 0x0018 : 4 bytes : Horizontal resolution (in pixels per meter)
+// 0x001C : 4 bytes : Vertical resolution (in pixels per meter)
+// 0x0020 : 4 bytes : Number of colors in table
+// 0x0024 : 4 bytes : Number of colors in image
+
+// Bitmap info header (BITMAPV4HEADER)
+//
+// 0x0000 :  4 bytes : Header size
+// 0x0004 :  4 bytes : Image width
+// 0x0008 :  4 bytes : Image height
+// 0x000C :  2 bytes : Number of planes (always 1)
+// 0x000E :  2 bytes : Bits per pixel   (0, 1, 4, 8, 16, 24 or 32)
+// 0x0010 :  4 bytes : Compression type (see compression_e enum)
+// 0x0014 :  4 bytes : Image size in bytes
+// 0x0018 :  4 bytes : Horizontal resolution (in pixels per meter)
+// 0x001C :  4 bytes : Vertical resolution (in pixels per meter)
+// 0x0020 :  4 bytes : Number of colors in table
+// 0x0024 :  4 bytes : Number of colors in image
+// 0x0028 :  4 bytes : Red color mask   (for BI_BITFIELDS compression only)
+// 0x002C :  4 bytes : Green color mask (for BI_BITFIELDS compression only)
+// 0x0030 :  4 bytes : Blue color mask  (for BI_BITFIELDS compression only)
+// 0x0034 :  4 bytes : Alpha channel mask
+// 0x0038 :  4 bytes : Color space type
+// 0x003C : 12 bytes : Red color endpoint   (4 bytes for each: X, Y, Z)
+// 0x0048 : 12 bytes : Green color endpoint (4 bytes for each: X, Y, Z)
+// 0x0054 : 12 bytes : Blue color endpoint  (4 bytes for each: X, Y, Z)
+// 0x0060 :  4 bytes : Gamma (tone response curve) for red color   (in unsigned fixed 16.16 format)
+// 0x0064 :  4 bytes : Gamma (tone response curve) for green color (in unsigned fixed 16.16 format)
+// 0x0068 :  4 bytes : Gamma (tone response curve) for blue color  (in unsigned fixed 16.16 format)
+
+// Bitmap info header (BITMAPV5HEADER)
+//
+// 0x0000 :  4 bytes : Header size
+// 0x0004 :  4 bytes : Image width
+// 0x0008 :  4 bytes : Image height
+// 0x000C :  2 bytes : Number of planes (always 1)
+// 0x000E :  2 bytes : Bits per pixel   (0, 1, 4, 8, 16, 24 or 32)
+// 0x0010 :  4 bytes : Compression type (see compression_e enum)
+// 0x0014 :  4 bytes : Image size in bytes
+// 0x0018 :  4 bytes : Horizontal resolution (in pixels per meter)
+// 0x001C :  4 bytes : Vertical resolution (in pixels per meter)
+// 0x0020 :  4 bytes : Number of colors in table
+// 0x0024 :  4 bytes : Number of colors in image
+// 0x0028 :  4 bytes : Red color mask   (for BI_BITFIELDS compression only)
+// 0x002C :  4 bytes : Green color mask (for BI_BITFIELDS compression only)
+// 0x0030 :  4 bytes : Blue color mask  (for BI_BITFIELDS compression only)
+// 0x0034 :  4 bytes : Alpha channel mask
+// 0x0038 :  4 bytes : Color space type
+// 0x003C : 12 bytes : Red color endpoint   (4 bytes for each: X, Y, Z)
+// 0x0048 : 12 bytes : Green color endpoint (4 bytes for each: X, Y, Z)
+// 0x0054 : 12 bytes : Blue color endpoint  (4 bytes for each: X, Y, Z)
+// 0x0060 :  4 bytes : Gamma (tone response curve) for red color   (in unsigned fixed 16.16 format)
+// 0x0064 :  4 bytes : Gamma (tone response curve) for green color (in unsigned fixed 16.16 format)
+// 0x0068 :  4 bytes : Gamma (tone response curve) for blue color  (in unsigned fixed 16.16 format)
+// 0x006C :  4 bytes : Rendering intent
+// 0x0070 :  4 bytes : Offset from beginning of info header to profile data (in bytes)
+// 0x0074 :  4 bytes : Size of profile data (in bytes)
+// 0x0078 :  4 bytes : Reserved
+
+#define BITMAP_FILE_HEADER_SIZE 0x0E
+#define BITMAP_FILE_HEADER_SYNC 0x4D42
+
+#define BITMAP_CORE_HEADER_SIZE 0x0C
+#define BITMAP_INFO_HEADER_SIZE 0x28
+#define BITMAP_V4_HEADER_SIZE   0x6C
+#define BITMAP_V5_HEADER_SIZE   0x7C
+
+typedef enum _info_types_e {
+    BITMAP_CORE,
+    BITMAP_INFO,
+    BITMAP_V4,
+    BITMAP_V5,
+    BITMAP_UNKNOWN
+} info_types_e;
+
+typedef enum _compression_e {
+  BI_RGB       = 0x0000,
+  BI_RLE8      = 0x0001,
+  BI_RLE4      = 0x0002,
+  BI_BITFIELDS = 0x0003,
+  BI_JPEG      = 0x0004,
+  BI_PNG       = 0x0005,
+  BI_CMYK      = 0x000B,
+  BI_CMYKRLE8  = 0x000C,
+  BI_CMYKRLE4  = 0x000D
+} compression_e;
+
+typedef enum _color_space_e {
+  LCS_CALIBRATED_RGB      = 0x00000000,
+  LCS_sRGB                = 0x73524742, // 'sRGB'
+  LCS_WINDOWS_COLOR_SPACE = 0x57696E20, // 'Win '
+  PROFILE_LINKED          = 0x4C494E4B, // 'LINK'
+  PROFILE_EMBEDDED        = 0x4D424544  // 'MBED'
+} color_space_e;
+
+typedef enum _intent_e {
+  LCS_GM_BUSINESS         = 0x0001,
+  LCS_GM_GRAPHICS         = 0x0002,
+  LCS_GM_IMAGES           = 0x0004,
+  LCS_GM_ABS_COLORIMETRIC = 0x0008
+} intent_e;
+
+#pragma pack(1)
+typedef struct _endpoint_t {
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+} endpoint_t PACKED_STRUCT;
+
+typedef struct _bitmap_file_header_t {
+    uint16_t syncword;
+    uint32_t file_size;
+    uint32_t reserved;
+    uint32_t data_offset;
+} bitmap_file_header_t PACKED_STRUCT;
+
+typedef struct _bitmap_core_header_t {
+    uint32_t info_size;
+    uint16_t data_width;
+    uint16_t data_height;
+    uint16_t planes_num;
+    uint16_t bit_count;
+} bitmap_core_header_t PACKED_STRUCT;
+
+typedef struct _bitmap_info_header_t {
+    uint32_t info_size;
+    uint32_t data_width;
+    uint32_t data_height;
+    uint16_t planes_num;
+    uint16_t bit_count;
+    uint32_t compression;
+    uint32_t data_size;
+    uint32_t ppm_vertical;
+    uint32_t ppm_horizontal;
+    uint32_t colors_num_table;
+    uint32_t colors_num_data;
+} bitmap_info_header_t PACKED_STRUCT;
+
+typedef struct _bitmap_v4_header_t {
+    uint32_t   info_size;
+    uint32_t   data_width;
+    uint32_t   data_height;
+    uint16_t   planes_num;
+    uint16_t   bit_count;
+    uint32_t   compression;
+    uint32_t   data_size;
+    uint32_t   ppm_vertical;
+    uint32_t   ppm_horizontal;
+    uint32_t   colors_num_table;
+    uint32_t   colors_num_data;
+    uint32_t   mask_red;
+    uint32_t   mask_green;
+    uint32_t   mask_blue;
+    uint32_t   mask_alpha;
+    uint32_t   color_space;
+    endpoint_t endpoint_red;
+    endpoint_t endpoint_green;
+    endpoint_t endpoint_blue;
+    uint32_t   gamma_red;
+    uint32_t   gamma_green;
+    uint32_t   gamma_blue;
+} bitmap_v4_header_t PACKED_STRUCT;
+
+typedef struct _bitmap_v5_header_t {
+    uint32_t   info_size;
+    uint32_t   data_width;
+    uint32_t   data_height;
+    uint16_t   planes_num;
+    uint16_t   bit_count;
+    uint32_t   compression;
+    uint32_t   data_size;
+    uint32_t   ppm_vertical;
+    uint32_t   ppm_horizontal;
+    uint32_t   colors_num_table;
+    uint32_t   colors_num_data;
+    uint32_t   mask_red;
+    uint32_t   mask_green;
+    uint32_t   mask_blue;
+    uint32_t   mask_alpha;
+    uint32_t   color_space;
+    endpoint_t endpoint_red;
+    endpoint_t endpoint_green;
+    endpoint_t endpoint_blue;
+    uint32_t   gamma_red;
+    uint32_t   gamma_green;
+    uint32_t   gamma_blue;
+    uint32_t   intent;
+    uint32_t   profile_offset;
+    uint32_t   profile_size;
+    uint32_t   reserved;
+} bitmap_v5_header_t PACKED_STRUCT;
+#pragma pack()
+
+// Color masks of 16-bit and 32-bit pixels (BI_BITFIELDS)
+//
+// Masks are part of V4 and V5 headers, BITMAPINFOHEADER is followed by red,
+// green and blue masks (before color table). Uncompressed pixels have
+// default masks: 5-5-5 for 16 bits and 8-8-8 for 32 bits (without alpha).
+
+typedef struct _bitmap_masks_t {
+    uint32_t red;
+    uint32_t green;
+    uint32_t blue;
+    uint32_t alpha;
+} bitmap_masks_t;
+
+#define BITMAP_INFO_MASKS_SIZE 0x0C
+
+uint32_t calc_bitmap_line_size(uint32_t data_width, uint32_t bit_count);
+uint32_t calc_aligned_line_size(uint32_t line_size, uint32_t alignment);
+
+typedef struct _rt_bitmap_t {
+    bitmap_file_header_t* file_header;
+    info_types_e          info_type;
+    void_t*               info_header;
+    bitmap_masks_t*       color_masks;      // Following BITMAPINFOHEADER only
+    color_palette_t*      color_palette;    // Shared colors of table (see colortbl.h)
+    const rgb_quad_t*     color_table;      // Colors of palette (read-only, see set_rt_bitmap_palette)
+    uint32_t              color_nums;
+    void_t*               profile;          // Embedded ICC profile (V5 header only, profile_size bytes)
+    bitmap_rle_index_t*   rle_index;        // Lines of RLE data (built by first region loading)
+    uint32_t              data_offset;
+    uint32_t              data_line;
+    uint32_t              data_size;
+} rt_bitmap_t;
+
+rt_bitmap_t* get_rt_bitmap(FILE* stream, uint32_t offset);
+rt_bitmap_t* get_rt_bitmap_dib(FILE* stream, uint32_t offset); // Packed DIB (info header first), file header is made up
+rt_bitmap_t* gen_rt_bitmap(info_types_e info_type,
+                           uint32_t     compression,
+                           uint32_t     bit_count,
+                           uint32_t     data_width,
+                           uint32_t     data_height);
+sint_t       put_rt_bitmap(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap);
+void_t       del_rt_bitmap(rt_bitmap_t* rt_bitmap);
+
+// Generated BI_BITFIELDS bitmap gets 5-6-5 or 8-8-8 masks (8-8-8-8 with V4
+// and V5 headers), alpha mask can be set for V4 and V5 headers only
+sint_t       calc_rt_bitmap_masks(rt_bitmap_t* rt_bitmap, bitmap_masks_t* bitmap_masks);
+sint_t       set_rt_bitmap_masks(rt_bitmap_t* rt_bitmap, const bitmap_masks_t* bitmap_masks);
+
+// Color table of bitmap is read-only view of shared palette (generated 1, 4
+// and 8-bit bitmaps get default one). Colors are copied into new palette of
+// same number of colors, previous palette is released (converters keep it).
+sint_t       set_rt_bitmap_palette(rt_bitmap_t* rt_bitmap, const rgb_quad_t* colors, uint32_t colors_num);
+
+// Generated V4 and V5 headers are sRGB (V5 with LCS_GM_IMAGES intent), color
+// space, endpoints and gamma can be changed in header. Profile is copied and
+// placed after pixel data (color space becomes PROFILE_EMBEDDED), NULL
+// profile removes it.
+sint_t       set_rt_bitmap_profile(rt_bitmap_t* rt_bitmap, const void_t* profile, uint32_t profile_size);
+
+typedef struct _rt_bitmap_data_t {
+    void_t*  data;
+    uint32_t size;
+    uint32_t bit_count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t line_size;
+} rt_bitmap_data_t;
+
+rt_bitmap_data_t* get_rt_bitmap_data(FILE* stream, rt_bitmap_t* rt_bitmap);
+sint_t            put_rt_bitmap_data(FILE* stream, uint32_t offset, rt_bitmap_data_t* rt_bitmap_data);
+void_t            del_rt_bitmap_data(rt_bitmap_data_t* rt_bitmap_data);
+
+// Whole file of uncompressed bitmap (headers, tables, lines and profile)
+//
+// calc_rt_bitmap_full_size() returns size of file (zero on error).
+// put_rt_bitmap_full() gathers headers and lines of data (in file order,
+// without copying them) into single write, space of large file is reserved
+// first. fill_rt_bitmap_full() assembles file in caller memory (for example
+// mapped output file), lines are flipped during copy.
+
+uint32_t          calc_rt_bitmap_full_size(rt_bitmap_t* rt_bitmap);
+sint_t            put_rt_bitmap_full(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data);
+sint_t            fill_rt_bitmap_full(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, void_t* image, uint32_t image_size);
+
+// RLE data (BI_RLE8 and BI_RLE4) is decoded by load_rt_bitmap_data() as well,
+// data_size of rt_bitmap is size of compressed data in that case.
+// put_rt_bitmap_data_rle() encodes lines with compression of rt_bitmap and
+// updates sizes in its headers (as set_rt_bitmap_data_size does), so they are
+// put after data.
+
+sint_t            put_rt_bitmap_data_rle(FILE* stream, uint32_t offset, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data);
+sint_t            set_rt_bitmap_data_size(rt_bitmap_t* rt_bitmap, uint32_t data_size); // Size of data encoded by caller
+
+// Decoding into caller-owned buffer (nothing is allocated)
+//
+// calc_rt_bitmap_data() fills dimensions, stride (line_size rounded up to alignment)
+// and required size. Caller sets data (and may widen line_size/size), then
+// load_rt_bitmap_data() reads pixel array in large bands (usually at once) and
+// puts lines top to bottom into that buffer. Loading and expansion check
+// cancel token (see cancel.h) on every line (lines are read one by one while
+// token is set).
+
+sint_t calc_rt_bitmap_data(rt_bitmap_t* rt_bitmap, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_data);
+sint_t load_rt_bitmap_data(FILE* stream, rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data);
+
+// Decoding of region (rectangle or range of lines) into caller-owned buffer
+//
+// Region is placed at column x and line y counted from top of image.
+// calc_rt_bitmap_region() fills dimensions and stride of region, then
+// load_rt_bitmap_region() reads only bytes of file covering it: lines in bands
+// (parts of lines far apart one by one), 1-bit and 4-bit pixels are shifted to
+// start of line. RLE lines have no fixed position, so first
+// loading scans compressed data once and keeps index of lines in rt_bitmap,
+// then only data of region lines is read. Memory used depends on region only.
+// Index belongs to rt_bitmap, it is allocated by allocator which made rt_bitmap
+// (not by current one), so regions can be loaded under any allocator.
+
+sint_t            calc_rt_bitmap_region(rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_region);
+sint_t            load_rt_bitmap_region(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t y, rt_bitmap_data_t* rt_bitmap_region);
+rt_bitmap_data_t* get_rt_bitmap_region(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+// Loading of whole lines by several threads (see bmp_band.h)
+//
+// load_rt_bitmap_lines() puts lines y..y+height-1 (whole width) into buffer as
+// load_rt_bitmap_data() does, but reads them by positional reads (see
+// file_read_at), so threads can load lines of same stream at once. Reads are
+// charged to budget and cancel token is checked first (both of calling
+// thread, see budget.h and cancel.h). RLE lines must be indexed by
+// index_rt_bitmap_rle() first (it does nothing for uncompressed data), index
+// is only read then (compressed lines are read into buffer of their own).
+
+sint_t index_rt_bitmap_rle(FILE* stream, rt_bitmap_t* rt_bitmap);
+sint_t load_rt_bitmap_lines(FILE* stream, rt_bitmap_t* rt_bitmap, uint32_t y, rt_bitmap_data_t* rt_bitmap_lines);
+
+// Expansion of indexed data (1, 4 or 8 bits) to 32-bit pixels (rgb_quad_t)
+//
+// Same rules for caller-owned buffer: calc_rt_bitmap_quads() fills dimensions
+// and stride, expand_rt_bitmap_data() converts lines using color table of bitmap
+// with best kernel for CPU (see cpufeat.h). Result is freed by del_rt_bitmap_data().
+
+sint_t            calc_rt_bitmap_quads(rt_bitmap_data_t* rt_bitmap_data, uint32_t alignment, rt_bitmap_data_t* rt_bitmap_quads);
+sint_t            expand_rt_bitmap_data(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data, rt_bitmap_data_t* rt_bitmap_quads);
+rt_bitmap_data_t* get_rt_bitmap_quads(rt_bitmap_t* rt_bitmap, rt_bitmap_data_t* rt_bitmap_data);
+
+// Zero-copy view of uncompressed lines in memory image of stream
+//
+// calc_rt_bitmap_view() points view at top line of pixel array inside image
+// (whole file or module, mapped or read by caller) and sets stride to reach
+// line below it, negative for bottom-up bitmaps. Nothing is copied or flipped,
+// view is valid as long as image is.
+
+typedef struct _rt_bitmap_view_t {
+    const uint8_t* first;       // Top line
+    sint32_t       stride;      // Offset from line to line below it
+    uint32_t       bit_count;
+    uint32_t       width;
+    uint32_t       height;
+    uint32_t       line_size;   // Bytes of line in image (stride can be negative)
+} rt_bitmap_view_t;
+
+sint_t calc_rt_bitmap_view(rt_bitmap_t* rt_bitmap, const void_t* image, uint32_t image_size, rt_bitmap_view_t* rt_bitmap_view);
+
+static inline const uint8_t* get_rt_bitmap_view_line(const rt_bitmap_view_t* rt_bitmap_view, uint32_t line)
+{
+    return rt_bitmap_view->first + (sint64_t) rt_bitmap_view->stride * line;
+}
+
+// Embedded JPEG or PNG image (BI_JPEG and BI_PNG)
+//
+// Pixel array of such bitmap is complete image file without lines, functions
+// of data above fail for it (its size is set by set_rt_bitmap_data_size for
+// generated bitmap). calc_rt_bitmap_payload() fills place of that file in
+// stream and its MIME type, so it can be forwarded untouched (read from
+// stream, or pointed at in memory image) instead of being decoded.
+
+typedef struct _rt_bitmap_payload_t {
+    uint32_t      offset;       // In stream
+    uint32_t      size;
+    const char_t* mime_type;    // "image/jpeg" or "image/png"
+} rt_bitmap_payload_t;
+
+sint_t calc_rt_bitmap_payload(rt_bitmap_t* rt_bitmap, rt_bitmap_payload_t* rt_bitmap_payload);
+
+static inline const uint8_t* get_rt_bitmap_payload_view(const rt_bitmap_payload_t* rt_bitmap_payload, const void_t* image, uint32_t image_size)
+{
+    return ((uint64_t) rt_bitmap_payload->offset + rt_bitmap_payload->size <= image_size) ? (const uint8_t*) image + rt_bitmap_payload->offset : NULL;
+}
+
+#endif // __RT_FONT_H__
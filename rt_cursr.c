@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "fileio.h"
+#include "stats.h"
+#include "budget.h"
+#include "trace.h"
+
+#include "resource.h"
+#include "rt_btmap.h"
+#include "rt_icon.h"
+#include "rt_cursr.h"
+
+#define RIFF_ID_RIFF RIFF_ID('R', 'I', 'F', 'F')
+#define RIFF_ID_LIST RIFF_ID('L', 'I', 'S', 'T')
+#define RIFF_ID_ACON RIFF_ID('A', 'C', 'O', 'N')
+#define RIFF_ID_ANIH RIFF_ID('a', 'n', 'i', 'h')
+#define RIFF_ID_RATE RIFF_ID('r', 'a', 't', 'e')
+#define RIFF_ID_SEQ  RIFF_ID('s', 'e', 'q', ' ')
+#define RIFF_ID_FRAM RIFF_ID('f', 'r', 'a', 'm')
+#define RIFF_ID_ICON RIFF_ID('i', 'c', 'o', 'n')
+
+rt_cursor_t* get_rt_cursor(FILE* stream, uint32_t offset, uint32_t size)
+{
+    STATS_SCOPE(STATS_GET_RT_CURSOR);
+
+    if (size <= CURSOR_HOTSPOT_SIZE)
+        return NULL;
+
+    // Go to begining of resource data
+    if (file_seek(stream, offset, SEEK_SET) != 0)
+        return NULL;
+
+    uint16_t hotspot [2];
+
+    if (file_read(hotspot, 1, CURSOR_HOTSPOT_SIZE, stream) != CURSOR_HOTSPOT_SIZE)
+        return NULL;
+
+    rt_cursor_t* rt_cursor = (rt_cursor_t*) mem_alloc(sizeof(rt_cursor_t));
+
+    if (! rt_cursor)
+        return NULL;
+
+    rt_cursor->rt_icon   = get_rt_icon(stream, offset + CURSOR_HOTSPOT_SIZE, size - CURSOR_HOTSPOT_SIZE);
+    rt_cursor->hotspot_x = hotspot[0];
+    rt_cursor->hotspot_y = hotspot[1];
+
+    if (! rt_cursor->rt_icon)
+    {
+        mem_free(rt_cursor);
+        return NULL;
+    }
+
+    return rt_cursor;
+}
+
+void_t del_rt_cursor(rt_cursor_t* rt_cursor)
+{
+    del_rt_icon(rt_cursor->rt_icon);
+    mem_free(rt_cursor);
+}
+
+// Chunk of single step (four bytes per step) must cover all steps
+static uint32_t get_steps_offset(uint32_t offset, uint32_t size, uint32_t steps_num)
+{
+    return (size / sizeof(uint32_t) >= steps_num) ? offset : 0;
+}
+
+// Frames are 'icon' chunks of LIST 'fram' (other chunks are skipped)
+static sint_t find_ani_frames(FILE* stream, uint32_t offset, uint32_t end, ani_frame_t* frames, uint32_t frames_num)
+{
+    uint32_t i = 0;
+
+    while ((i < frames_num) && (end - offset >= RIFF_CHUNK_HEADER_SIZE))
+    {
+        riff_chunk_header_t chunk_header;
+
+        if ((file_seek(stream, offset, SEEK_SET) != 0)
+        ||  (file_read(&chunk_header, 1, sizeof(riff_chunk_header_t), stream) != sizeof(riff_chunk_header_t)))
+            return -1;
+
+        offset += RIFF_CHUNK_HEADER_SIZE;
+
+        if (chunk_header.chunk_size > end - offset)
+            return -1;
+
+        if (chunk_header.chunk_id == RIFF_ID_ICON)
+        {
+            frames[i].offset = offset;
+            frames[i].size   = chunk_header.chunk_size;
+            i ++;
+        }
+
+        // Data of chunk is padded to even size
+        offset += chunk_header.chunk_size;
+        offset += (offset < end) ? (chunk_header.chunk_size & 1) : 0;
+    }
+
+    return (i == frames_num) ? 0 : -1;
+}
+
+rt_anicursor_t* get_rt_anicursor(FILE* stream, uint32_t offset, uint32_t size)
+{
+    STATS_SCOPE(STATS_GET_RT_ANICURSOR);
+
+    // Check for correct compilation
+    if ((sizeof(riff_chunk_header_t) != RIFF_CHUNK_HEADER_SIZE) || (sizeof(ani_header_t) != ANI_HEADER_SIZE)
+    ||  (sizeof(icon_file_entry_t) != ICON_FILE_ENTRY_SIZE))
+        return NULL;
+
+    // Go to begining of resource data
+    if (file_seek(stream, offset, SEEK_SET) != 0)
+        return NULL;
+
+    // Get RIFF header and form type
+    riff_chunk_header_t riff_header;
+    uint32_t            form_type = 0;
+
+    if ((file_read(&riff_header, 1, sizeof(riff_chunk_header_t), stream) != sizeof(riff_chunk_header_t))
+    ||  (file_read(&form_type, 1, sizeof(uint32_t), stream) != sizeof(uint32_t)))
+        return NULL;
+
+    if ((riff_header.chunk_id != RIFF_ID_RIFF) || (form_type != RIFF_ID_ACON) || (size < RIFF_CHUNK_HEADER_SIZE)
+    ||  (riff_header.chunk_size < sizeof(uint32_t)) || (riff_header.chunk_size > size - RIFF_CHUNK_HEADER_SIZE))
+        return NULL;
+
+    rt_anicursor_t* rt_anicursor = (rt_anicursor_t*) mem_calloc(1, sizeof(rt_anicursor_t));
+
+    if (! rt_anicursor)
+        return NULL;
+
+    // Walk chunks, only header is read
+    uint32_t end         = offset + RIFF_CHUNK_HEADER_SIZE + riff_header.chunk_size;
+    uint32_t frames_list = 0, frames_end = 0;
+    uint32_t rate_size   = 0, seq_size   = 0;
+    bool_e   has_header  = FALSE;
+
+    offset += RIFF_CHUNK_HEADER_SIZE + sizeof(uint32_t);
+
+    while (end - offset >= RIFF_CHUNK_HEADER_SIZE)
+    {
+        riff_chunk_header_t chunk_header;
+        uint32_t            list_type = 0;
+
+        if ((file_seek(stream, offset, SEEK_SET) != 0)
+        ||  (file_read(&chunk_header, 1, sizeof(riff_chunk_header_t), stream) != sizeof(riff_chunk_header_t)))
+        {
+            del_rt_anicursor(rt_anicursor);
+            return NULL;
+        }
+
+        offset += RIFF_CHUNK_HEADER_SIZE;
+
+        if (chunk_header.chunk_size > end - offset)
+        {
+            del_rt_anicursor(rt_anicursor);
+            return NULL;
+        }
+
+        switch (chunk_header.chunk_id)
+        {
+            case RIFF_ID_ANIH:
+                if ((chunk_header.chunk_size < ANI_HEADER_SIZE)
+                ||  (file_read(&rt_anicursor->header, 1, sizeof(ani_header_t), stream) != sizeof(ani_header_t)))
+                {
+                    del_rt_anicursor(rt_anicursor);
+                    return NULL;
+                }
+
+                has_header = TRUE;
+                break;
+
+            case RIFF_ID_RATE:
+                rt_anicursor->rate_offset = offset;
+                rate_size                 = chunk_header.chunk_size;
+                break;
+
+            case RIFF_ID_SEQ:
+                rt_anicursor->seq_offset = offset;
+                seq_size                 = chunk_header.chunk_size;
+                break;
+
+            case RIFF_ID_LIST:
+                if ((chunk_header.chunk_size >= sizeof(uint32_t))
+                &&  (file_read(&list_type, 1, sizeof(uint32_t), stream) == sizeof(uint32_t))
+                &&  (list_type == RIFF_ID_FRAM))
+                {
+                    frames_list = offset + sizeof(uint32_t);
+                    frames_end  = offset + chunk_header.chunk_size;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        // Data of chunk is padded to even size
+        offset += chunk_header.chunk_size;
+        offset += (offset < end) ? (chunk_header.chunk_size & 1) : 0;
+    }
+
+    // Frames of raw bitmaps are not supported
+    ani_header_t* header = &rt_anicursor->header;
+
+    if ((! has_header) || (! frames_list) || (! (header->flags & ANI_FLAG_ICON))
+    ||  (header->frames_num < 1) || (header->steps_num < 1) || (! use_budget_entries(header->frames_num)))
+    {
+        del_rt_anicursor(rt_anicursor);
+        return NULL;
+    }
+
+    rt_anicursor->rate_offset = get_steps_offset(rt_anicursor->rate_offset, rate_size, header->steps_num);
+    rt_anicursor->seq_offset  = get_steps_offset(rt_anicursor->seq_offset, seq_size, header->steps_num);
+
+    // Without sequence steps show frames in order
+    if ((! rt_anicursor->seq_offset) && (header->steps_num > header->frames_num))
+    {
+        del_rt_anicursor(rt_anicursor);
+        return NULL;
+    }
+
+    rt_anicursor->frames = (ani_frame_t*) mem_alloc(sizeof(ani_frame_t) * header->frames_num);
+
+    if ((! rt_anicursor->frames) || (find_ani_frames(stream, frames_list, frames_end, rt_anicursor->frames, header->frames_num) < 0))
+    {
+        del_rt_anicursor(rt_anicursor);
+        return NULL;
+    }
+
+    return rt_anicursor;
+}
+
+void_t del_rt_anicursor(rt_anicursor_t* rt_anicursor)
+{
+    if (rt_anicursor->frames)
+        mem_free(rt_anicursor->frames);
+
+    mem_free(rt_anicursor);
+}
+
+sint_t load_rt_anicursor_step(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t step, ani_step_t* ani_step)
+{
+    if ((! stream) || (! rt_anicursor) || (! ani_step) || (step >= rt_anicursor->header.steps_num))
+        return -1;
+
+    ani_step->frame        = step;
+    ani_step->display_rate = rt_anicursor->header.display_rate;
+
+    if (rt_anicursor->seq_offset)
+    {
+        if ((file_seek(stream, rt_anicursor->seq_offset + step * sizeof(uint32_t), SEEK_SET) != 0)
+        ||  (file_read(&ani_step->frame, 1, sizeof(uint32_t), stream) != sizeof(uint32_t)))
+            return -1;
+    }
+
+    if (rt_anicursor->rate_offset)
+    {
+        if ((file_seek(stream, rt_anicursor->rate_offset + step * sizeof(uint32_t), SEEK_SET) != 0)
+        ||  (file_read(&ani_step->display_rate, 1, sizeof(uint32_t), stream) != sizeof(uint32_t)))
+            return -1;
+    }
+
+    return (ani_step->frame < rt_anicursor->header.frames_num) ? 0 : -1;
+}
+
+rt_cursor_t* get_rt_anicursor_frame(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t frame)
+{
+    STATS_SCOPE(STATS_GET_RT_ANICURSOR_FRAME);
+
+    if ((! stream) || (! rt_anicursor) || (frame >= rt_anicursor->header.frames_num))
+        return NULL;
+
+    ani_frame_t* ani_frame = &rt_anicursor->frames[frame];
+
+    if (file_seek(stream, ani_frame->offset, SEEK_SET) != 0)
+        return NULL;
+
+    // Header of icon or cursor file and its first entry
+    group_icon_header_t icon_file_header;
+    icon_file_entry_t   icon_file_entry;
+
+    if ((file_read(&icon_file_header, 1, sizeof(group_icon_header_t), stream) != sizeof(group_icon_header_t))
+    ||  (file_read(&icon_file_entry, 1, sizeof(icon_file_entry_t), stream) != sizeof(icon_file_entry_t)))
+        return NULL;
+
+    if (((icon_file_header.type != GROUP_ICON_TYPE_ICON) && (icon_file_header.type != GROUP_ICON_TYPE_CURSOR))
+    ||  (icon_file_header.entries_num < 1)
+    ||  (icon_file_entry.data_offset > ani_frame->size) || (icon_file_entry.data_size > ani_frame->size - icon_file_entry.data_offset))
+        return NULL;
+
+    rt_cursor_t* rt_cursor = (rt_cursor_t*) mem_alloc(sizeof(rt_cursor_t));
+
+    if (! rt_cursor)
+        return NULL;
+
+    rt_cursor->rt_icon   = get_rt_icon(stream, ani_frame->offset + icon_file_entry.data_offset, icon_file_entry.data_size);
+    rt_cursor->hotspot_x = (icon_file_header.type == GROUP_ICON_TYPE_CURSOR) ? icon_file_entry.hotspot_x : 0;
+    rt_cursor->hotspot_y = (icon_file_header.type == GROUP_ICON_TYPE_CURSOR) ? icon_file_entry.hotspot_y : 0;
+
+    if (! rt_cursor->rt_icon)
+    {
+        mem_free(rt_cursor);
+        return NULL;
+    }
+
+    return rt_cursor;
+}
+
+sint_t calc_rt_anicursor_pixels(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t alignment, rt_bitmap_data_t* rt_frame_pixels)
+{
+    rt_cursor_t* rt_cursor = get_rt_anicursor_frame(stream, rt_anicursor, 0);
+
+    if (! rt_cursor)
+        return -1;
+
+    sint_t result = calc_rt_icon_pixels(rt_cursor->rt_icon, alignment, rt_frame_pixels);
+
+    del_rt_cursor(rt_cursor);
+
+    return result;
+}
+
+sint_t load_rt_anicursor_frame(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t frame, rt_bitmap_data_t* rt_frame_pixels)
+{
+    STATS_SCOPE(STATS_LOAD_RT_ANICURSOR_FRAME);
+
+    if ((! rt_anicursor) || (frame >= rt_anicursor->header.frames_num))
+        return -1;
+
+    TRACE_SCOPE(TRACE_DECODE, RT_ANICURSOR, rt_anicursor->frames[frame].offset);
+
+    // Only headers of frame are kept while it is decoded
+    rt_cursor_t* rt_cursor = get_rt_anicursor_frame(stream, rt_anicursor, frame);
+
+    if (! rt_cursor)
+        return -1;
+
+    sint_t result = load_rt_icon_pixels(stream, rt_cursor->rt_icon, rt_frame_pixels);
+
+    del_rt_cursor(rt_cursor);
+
+    return result;
+}
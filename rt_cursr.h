@@ -0,0 +1,149 @@
+#ifndef __RT_CURSR_H__
+#define __RT_CURSR_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "rt_btmap.h"
+#include "rt_icon.h"
+
+// Cursor resource
+//
+// 0x0000 : 2 bytes : Horizontal position of hotspot
+// 0x0002 : 2 bytes : Vertical position of hotspot
+// 0x0004 : N bytes : Icon image (see rt_icon.h)
+//
+// Image of cursor is decoded as icon, by load_rt_icon_pixels() (inverted
+// screen pixels of monochrome cursors are transparent).
+
+#define CURSOR_HOTSPOT_SIZE 0x04
+
+typedef struct _rt_cursor_t {
+    rt_icon_t* rt_icon;
+    uint16_t   hotspot_x;
+    uint16_t   hotspot_y;
+} rt_cursor_t;
+
+rt_cursor_t* get_rt_cursor(FILE* stream, uint32_t offset, uint32_t size);
+void_t       del_rt_cursor(rt_cursor_t* rt_cursor);
+
+// Animated cursor or icon resource (RT_ANICURSOR and RT_ANIICON)
+//
+// RIFF file of form 'ACON', every chunk is:
+//
+// 0x0000 : 4 bytes : Chunk ID
+// 0x0004 : 4 bytes : Size of chunk data
+// 0x0008 : N bytes : Chunk data (padded to even size)
+//
+// Chunks of form:
+//
+// 'anih'      : Animation header (see ani_header_t)
+// 'rate'      : Display rate of every step (optional)
+// 'seq '      : Frame of every step (optional, frames are shown in order)
+// LIST 'fram' : Frames, 'icon' chunk with icon or cursor file each
+// LIST 'INFO' : Title and author (skipped)
+
+// Animation header
+//
+// 0x0000 : 4 bytes : Size of header
+// 0x0004 : 4 bytes : Number of frames
+// 0x0008 : 4 bytes : Number of steps
+// 0x000C : 4 bytes : Width (zero, frames have their own)
+// 0x0010 : 4 bytes : Height (zero, frames have their own)
+// 0x0014 : 4 bytes : Bits per pixel (zero, frames have their own)
+// 0x0018 : 4 bytes : Number of planes
+// 0x001C : 4 bytes : Default display rate (in 1/60 of second)
+// 0x0020 : 4 bytes : Flags
+
+// Icon or cursor file of frame
+//
+// 0x0000 : 6 bytes  : Header (same as one of group icon resource)
+// 0x0006 : 16 bytes : Entries (images are addressed by offset in file)
+//
+// Entry
+//
+// 0x0000 : 1 byte  : Width in pixels (zero means 256)
+// 0x0001 : 1 byte  : Height in pixels (zero means 256)
+// 0x0002 : 1 byte  : Number of colors
+// 0x0003 : 1 byte  : Reserved
+// 0x0004 : 2 bytes : Number of planes (horizontal position of hotspot for cursor)
+// 0x0006 : 2 bytes : Bits per pixel (vertical position of hotspot for cursor)
+// 0x0008 : 4 bytes : Size of image
+// 0x000C : 4 bytes : Offset of image
+
+#define RIFF_CHUNK_HEADER_SIZE 0x08
+#define ANI_HEADER_SIZE        0x24
+#define ICON_FILE_ENTRY_SIZE   0x10
+
+#define ANI_FLAG_ICON          0x01 // Frames are icon or cursor files (raw bitmaps otherwise)
+#define ANI_FLAG_SEQUENCE      0x02 // 'seq ' chunk is present
+
+#define RIFF_ID(a, b, c, d) ((uint32_t) (a) | ((uint32_t) (b) << 8) | ((uint32_t) (c) << 16) | ((uint32_t) (d) << 24))
+
+#pragma pack(1)
+typedef struct _riff_chunk_header_t {
+    uint32_t chunk_id;
+    uint32_t chunk_size;
+} riff_chunk_header_t PACKED_STRUCT;
+
+typedef struct _ani_header_t {
+    uint32_t header_size;
+    uint32_t frames_num;
+    uint32_t steps_num;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bit_count;
+    uint32_t planes_num;
+    uint32_t display_rate;
+    uint32_t flags;
+} ani_header_t PACKED_STRUCT;
+
+typedef struct _icon_file_entry_t {
+    uint8_t  width;
+    uint8_t  height;
+    uint8_t  colors_num;
+    uint8_t  reserved;
+    uint16_t hotspot_x;
+    uint16_t hotspot_y;
+    uint32_t data_size;
+    uint32_t data_offset;
+} icon_file_entry_t PACKED_STRUCT;
+#pragma pack()
+
+typedef struct _ani_frame_t {
+    uint32_t offset;    // Icon or cursor file
+    uint32_t size;
+} ani_frame_t;
+
+typedef struct _ani_step_t {
+    uint32_t frame;
+    uint32_t display_rate;  // In 1/60 of second
+} ani_step_t;
+
+typedef struct _rt_anicursor_t {
+    ani_header_t header;
+    ani_frame_t* frames;        // Places of frames only, they are parsed on demand
+    uint32_t     rate_offset;   // Zero if all steps have default rate
+    uint32_t     seq_offset;    // Zero if steps show frames in order
+} rt_anicursor_t;
+
+// get_rt_anicursor() walks chunks once and keeps places of frames, rates and
+// sequence, nothing of them is read. load_rt_anicursor_step() reads frame
+// and rate of single step. get_rt_anicursor_frame() parses headers of single
+// frame (first image of its file), hotspot is zero for icon frames.
+//
+// Frames are decoded one at a time into same caller-owned buffer:
+// calc_rt_anicursor_pixels() fills dimensions and stride by first frame,
+// load_rt_anicursor_frame() decodes any frame of same dimensions into it
+// (see load_rt_icon_pixels).
+
+rt_anicursor_t* get_rt_anicursor(FILE* stream, uint32_t offset, uint32_t size);
+void_t          del_rt_anicursor(rt_anicursor_t* rt_anicursor);
+sint_t          load_rt_anicursor_step(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t step, ani_step_t* ani_step);
+rt_cursor_t*    get_rt_anicursor_frame(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t frame);
+
+sint_t          calc_rt_anicursor_pixels(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t alignment, rt_bitmap_data_t* rt_frame_pixels);
+sint_t          load_rt_anicursor_frame(FILE* stream, rt_anicursor_t* rt_anicursor, uint32_t frame, rt_bitmap_data_t* rt_frame_pixels);
+
+#endif // __RT_CURSR_H__
@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+#include "fileio.h"
+#include "stats.h"
+#include "budget.h"
+#include "cancel.h"
+#include "trace.h"
+#include "cpufeat.h"
+
+#include "resource.h"
+#include "rt_btmap.h"
+#include "rt_icon.h"
+#include "pixconv.h"
+
+#define ICON_PNG_HEADER_SIZE 0x18 // Signature and IHDR chunk up to height
+
+static const uint8_t icon_png_signature [8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+// PNG integers are big-endian
+static inline uint32_t get_png_uint32(const uint8_t* data)
+{
+    return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | (uint32_t) data[3];
+}
+
+// Entry without bit count (old icons) has number of colors
+static uint32_t get_entry_bit_count(group_icon_entry_t* group_icon_entry)
+{
+    if (group_icon_entry->bit_count)
+        return group_icon_entry->bit_count;
+
+    switch (group_icon_entry->colors_num)
+    {
+        case 2:
+            return 1;
+
+        case 16:
+            return 4;
+
+        default:
+            return 0;
+    }
+}
+
+// Entries of both groups have same size, only their fields differ
+static sint_t read_group_entry(FILE* stream, uint16_t type, icon_entry_t* entry)
+{
+    if (type == GROUP_ICON_TYPE_ICON)
+    {
+        group_icon_entry_t group_icon_entry;
+
+        if (file_read(&group_icon_entry, 1, sizeof(group_icon_entry_t), stream) != sizeof(group_icon_entry_t))
+            return -1;
+
+        entry->width     = group_icon_entry.width  ? group_icon_entry.width  : 256;
+        entry->height    = group_icon_entry.height ? group_icon_entry.height : 256;
+        entry->bit_count = get_entry_bit_count(&group_icon_entry);
+        entry->data_size = group_icon_entry.data_size;
+        entry->icon_id   = group_icon_entry.icon_id;
+    }
+    else
+    {
+        group_cursor_entry_t group_cursor_entry;
+
+        if (file_read(&group_cursor_entry, 1, sizeof(group_cursor_entry_t), stream) != sizeof(group_cursor_entry_t))
+            return -1;
+
+        entry->width     = group_cursor_entry.width;
+        entry->height    = group_cursor_entry.height / 2;
+        entry->bit_count = group_cursor_entry.bit_count;
+        entry->data_size = group_cursor_entry.data_size;
+        entry->icon_id   = group_cursor_entry.cursor_id;
+    }
+
+    return 0;
+}
+
+static rt_group_icon_t* read_rt_group(FILE* stream, uint32_t offset, uint16_t type)
+{
+    // Check for correct compilation
+    if ((sizeof(group_icon_header_t) != GROUP_ICON_HEADER_SIZE) || (sizeof(group_icon_entry_t) != GROUP_ICON_ENTRY_SIZE)
+    ||  (sizeof(group_cursor_entry_t) != GROUP_CURSOR_ENTRY_SIZE))
+        return NULL;
+
+    // Go to begining of resource data
+    if (file_seek(stream, offset, SEEK_SET) != 0)
+        return NULL;
+
+    // Get header
+    group_icon_header_t group_icon_header;
+
+    if (file_read(&group_icon_header, 1, sizeof(group_icon_header_t), stream) != sizeof(group_icon_header_t))
+        return NULL;
+
+    if ((group_icon_header.type != type) || (group_icon_header.entries_num < 1)
+    ||  (! use_budget_entries(group_icon_header.entries_num)))
+        return NULL;
+
+    // Get entries (they follow header)
+    rt_group_icon_t* rt_group_icon = (rt_group_icon_t*) mem_alloc(sizeof(rt_group_icon_t));
+
+    if (! rt_group_icon)
+        return NULL;
+
+    rt_group_icon->type        = group_icon_header.type;
+    rt_group_icon->entries_num = group_icon_header.entries_num;
+    rt_group_icon->entries     = (icon_entry_t*) mem_alloc(sizeof(icon_entry_t) * group_icon_header.entries_num);
+
+    if (! rt_group_icon->entries)
+    {
+        mem_free(rt_group_icon);
+        return NULL;
+    }
+
+    uint16_t i;
+    for (i = 0; i < group_icon_header.entries_num; i ++)
+    {
+        if (read_group_entry(stream, type, &rt_group_icon->entries[i]) < 0)
+        {
+            del_rt_group_icon(rt_group_icon);
+            return NULL;
+        }
+    }
+
+    return rt_group_icon;
+}
+
+rt_group_icon_t* get_rt_group_icon(FILE* stream, uint32_t offset)
+{
+    STATS_SCOPE(STATS_GET_RT_GROUP_ICON);
+
+    return read_rt_group(stream, offset, GROUP_ICON_TYPE_ICON);
+}
+
+rt_group_icon_t* get_rt_group_cursor(FILE* stream, uint32_t offset)
+{
+    STATS_SCOPE(STATS_GET_RT_GROUP_CURSOR);
+
+    return read_rt_group(stream, offset, GROUP_ICON_TYPE_CURSOR);
+}
+
+void_t del_rt_group_icon(rt_group_icon_t* rt_group_icon)
+{
+    mem_free(rt_group_icon->entries);
+    mem_free(rt_group_icon);
+}
+
+sint_t find_rt_group_icon_entry(rt_group_icon_t* rt_group_icon, uint32_t size, uint32_t bit_count)
+{
+    if ((! rt_group_icon) || (! rt_group_icon->entries_num))
+        return -1;
+
+    sint_t   best      = -1;
+    uint32_t best_size = 0;
+    uint32_t best_bits = 0;
+
+    uint16_t i;
+    for (i = 0; i < rt_group_icon->entries_num; i ++)
+    {
+        icon_entry_t* entry = &rt_group_icon->entries[i];
+
+        uint32_t entry_size = (entry->width > entry->height) ? entry->width : entry->height;
+        uint32_t entry_bits = ((bit_count) && (entry->bit_count > bit_count)) ? 0 : entry->bit_count;
+
+        if (best >= 0)
+        {
+            bool_e fits      = (entry_size >= size) ? TRUE : FALSE;
+            bool_e best_fits = (best_size  >= size) ? TRUE : FALSE;
+
+            // Size first (fitting one over smaller one), then bits
+            if (fits != best_fits)
+            {
+                if (! fits)
+                    continue;
+            }
+            else if (entry_size != best_size)
+            {
+                if ((fits) ? (entry_size > best_size) : (entry_size < best_size))
+                    continue;
+            }
+            else if (entry_bits <= best_bits)
+                continue;
+        }
+
+        best      = (sint_t) i;
+        best_size = entry_size;
+        best_bits = entry_bits;
+    }
+
+    return best;
+}
+
+// Info header of icon has height of XOR image and mask together, it gets
+// height of XOR image, so headers and data describe bitmap of its own
+static sint_t split_icon_height(rt_bitmap_t* rt_bitmap, uint32_t* p_width, uint32_t* p_height, uint32_t* p_bit_count)
+{
+    uint32_t width, height, bit_count;
+
+    if (BITMAP_CORE == rt_bitmap->info_type)
+    {
+        bitmap_core_header_t* core_header = (bitmap_core_header_t*) rt_bitmap->info_header;
+
+        width     = core_header->data_width;
+        height    = core_header->data_height / 2;
+        bit_count = core_header->bit_count;
+
+        if ((! height) || (core_header->data_height % 2))
+            return -1;
+
+        core_header->data_height = (uint16_t) height;
+    }
+    else
+    {
+        bitmap_info_header_t* info_header = (bitmap_info_header_t*) rt_bitmap->info_header;
+
+        // Lines of icons are stored from bottom to top only
+        if ((info_header->compression != BI_RGB) && (info_header->compression != BI_BITFIELDS))
+            return -1;
+
+        if (((sint32_t) info_header->data_height <= 0) || (info_header->data_height % 2))
+            return -1;
+
+        width     = info_header->data_width;
+        height    = info_header->data_height / 2;
+        bit_count = info_header->bit_count;
+
+        info_header->data_height = height;
+        info_header->data_size   = height * rt_bitmap->data_line;
+    }
+
+    if ((! width) || (! rt_bitmap->data_line))
+        return -1;
+
+    rt_bitmap->data_size              = height * rt_bitmap->data_line;
+    rt_bitmap->file_header->file_size = rt_bitmap->file_header->data_offset + rt_bitmap->data_size;
+
+    *p_width     = width;
+    *p_height    = height;
+    *p_bit_count = bit_count;
+
+    return 0;
+}
+
+rt_icon_t* get_rt_icon(FILE* stream, uint32_t offset, uint32_t size)
+{
+    STATS_SCOPE(STATS_GET_RT_ICON);
+
+    // Go to begining of resource data
+    if (file_seek(stream, offset, SEEK_SET) != 0)
+        return NULL;
+
+    uint8_t header [ICON_PNG_HEADER_SIZE];
+
+    if ((size < ICON_PNG_HEADER_SIZE) || (file_read(header, 1, ICON_PNG_HEADER_SIZE, stream) != ICON_PNG_HEADER_SIZE))
+        return NULL;
+
+    rt_icon_t* rt_icon = (rt_icon_t*) mem_calloc(1, sizeof(rt_icon_t));
+
+    if (! rt_icon)
+        return NULL;
+
+    // PNG icon is forwarded as it is
+    if (memcmp(header, icon_png_signature, sizeof(icon_png_signature)) == 0)
+    {
+        rt_icon->png.offset    = offset;
+        rt_icon->png.size      = size;
+        rt_icon->png.mime_type = "image/png";
+        rt_icon->width         = get_png_uint32(header + 16);
+        rt_icon->height        = get_png_uint32(header + 20);
+        rt_icon->bit_count     = 32;
+
+        return rt_icon;
+    }
+
+    rt_icon->rt_bitmap = get_rt_bitmap_dib(stream, offset);
+
+    if (! rt_icon->rt_bitmap)
+    {
+        mem_free(rt_icon);
+        return NULL;
+    }
+
+    if (split_icon_height(rt_icon->rt_bitmap, &rt_icon->width, &rt_icon->height, &rt_icon->bit_count) < 0)
+    {
+        del_rt_icon(rt_icon);
+        return NULL;
+    }
+
+    // AND mask follows XOR image, 32-bit icon can do without it
+    uint64_t xor_end   = (uint64_t) rt_icon->rt_bitmap->data_offset + rt_icon->rt_bitmap->data_size;
+    uint32_t mask_line = calc_bitmap_line_size(rt_icon->width, 1);
+
+    if (xor_end > (uint64_t) offset + size)
+    {
+        del_rt_icon(rt_icon);
+        return NULL;
+    }
+
+    if (xor_end + (uint64_t) mask_line * rt_icon->height <= (uint64_t) offset + size)
+    {
+        rt_icon->mask_offset = (uint32_t) xor_end;
+        rt_icon->mask_line   = mask_line;
+    }
+    else if (rt_icon->bit_count != 32)
+    {
+        del_rt_icon(rt_icon);
+        return NULL;
+    }
+
+    return rt_icon;
+}
+
+void_t del_rt_icon(rt_icon_t* rt_icon)
+{
+    if (rt_icon->rt_bitmap)
+        del_rt_bitmap(rt_icon->rt_bitmap);
+
+    mem_free(rt_icon);
+}
+
+sint_t calc_rt_icon_pixels(rt_icon_t* rt_icon, uint32_t alignment, rt_bitmap_data_t* rt_icon_pixels)
+{
+    if ((! rt_icon) || (! rt_icon->rt_bitmap) || (! rt_icon_pixels))
+        return -1;
+
+    rt_icon_pixels->bit_count = 32;
+    rt_icon_pixels->width     = rt_icon->width;
+    rt_icon_pixels->height    = rt_icon->height;
+    rt_icon_pixels->line_size = calc_aligned_line_size(rt_icon->width * sizeof(uint32_t), alignment);
+    rt_icon_pixels->size      = rt_icon_pixels->line_size * rt_icon_pixels->height;
+    rt_icon_pixels->data      = NULL;
+
+    return 0;
+}
+
+static inline uint32_t get_icon_compression(rt_bitmap_t* rt_bitmap)
+{
+    return (BITMAP_CORE == rt_bitmap->info_type) ? BI_RGB : ((bitmap_info_header_t*) rt_bitmap->info_header)->compression;
+}
+
+// Icon has alpha channel if any pixel has alpha (old icons leave it zero)
+static bool_e has_icon_alpha(rt_icon_t* rt_icon, const uint8_t* data)
+{
+    if (rt_icon->bit_count != 32)
+        return FALSE;
+
+    bitmap_masks_t bitmap_masks;
+
+    if (calc_rt_bitmap_masks(rt_icon->rt_bitmap, &bitmap_masks) < 0)
+        return FALSE;
+
+    if (bitmap_masks.alpha)
+        return TRUE;
+
+    // Unused high byte of BI_RGB pixels
+    if (get_icon_compression(rt_icon->rt_bitmap) == BI_RGB)
+    {
+        uint32_t i;
+        for (i = 3; i < rt_icon->rt_bitmap->data_size; i += sizeof(uint32_t))
+            if (data[i])
+                return TRUE;
+    }
+
+    return FALSE;
+}
+
+sint_t load_rt_icon_pixels(FILE* stream, rt_icon_t* rt_icon, rt_bitmap_data_t* rt_icon_pixels)
+{
+    STATS_SCOPE(STATS_LOAD_RT_ICON_PIXELS);
+
+    if ((! stream) || (! rt_icon) || (! rt_icon->rt_bitmap) || (! rt_icon_pixels) || (! rt_icon_pixels->data))
+        return -1;
+
+    // Buffer is owned by caller, its stride can be wider than line of pixels
+    if ((rt_icon_pixels->bit_count != 32) || (rt_icon_pixels->width != rt_icon->width)
+    ||  (rt_icon_pixels->height != rt_icon->height) || (rt_icon_pixels->line_size % sizeof(uint32_t))
+    ||  (rt_icon_pixels->line_size < rt_icon->width * sizeof(uint32_t))
+    ||  (rt_icon_pixels->size / rt_icon_pixels->line_size < rt_icon_pixels->height))
+        return -1;
+
+    rt_bitmap_t* rt_bitmap = rt_icon->rt_bitmap;
+
+    TRACE_SCOPE(TRACE_DECODE, RT_ICON, rt_bitmap->data_offset);
+
+    // XOR image and mask are adjacent, they are read at once
+    uint32_t mask_size = rt_icon->mask_line * rt_icon->height;
+    uint8_t* data      = (uint8_t*) mem_alloc(rt_bitmap->data_size + mask_size);
+
+    if (! data)
+        return -1;
+
+    if ((file_seek(stream, rt_bitmap->data_offset, SEEK_SET) != 0)
+    ||  (file_read(data, 1, rt_bitmap->data_size + mask_size, stream) != rt_bitmap->data_size + mask_size))
+    {
+        mem_free(data);
+        return -1;
+    }
+
+    const uint8_t* mask = data + rt_bitmap->data_size;
+
+    // Alpha channel replaces mask, it passes 32-bit BI_RGB pixels untouched
+    bool_e alpha = has_icon_alpha(rt_icon, data);
+    bool_e raw   = ((alpha) && (get_icon_compression(rt_bitmap) == BI_RGB)) ? TRUE : FALSE;
+
+    pixel_conv_t* pixel_conv = (raw) ? NULL : new_pixel_conv(rt_bitmap, rt_icon->bit_count, rt_icon->width, PIXEL_RGBA32);
+
+    if ((! raw) && (! pixel_conv))
+    {
+        mem_free(data);
+        return -1;
+    }
+
+    const cpu_kernels_t* kernels = get_cpu_kernels();
+
+    begin_cancel_units(rt_icon->height);
+
+    uint32_t y;
+    for (y = 0; y < rt_icon->height; y ++)
+    {
+        if (! check_cancel_units(y))
+        {
+            if (pixel_conv)
+                del_pixel_conv(pixel_conv);
+            mem_free(data);
+            return -1;
+        }
+
+        // Lines are stored from bottom to top
+        uint32_t  line = rt_icon->height - 1 - y;
+        uint32_t* dst  = (uint32_t*) ((uint8_t*) rt_icon_pixels->data + y * rt_icon_pixels->line_size);
+
+        if (raw)
+            kernels->swap_red_blue((const uint32_t*) (data + line * rt_bitmap->data_line), dst, rt_icon->width);
+        else
+            convert_pixel_line(pixel_conv, data + line * rt_bitmap->data_line, dst);
+
+        kernels->premultiply_mask(dst, ((alpha) || (! rt_icon->mask_line)) ? NULL : mask + line * rt_icon->mask_line, rt_icon->width);
+    }
+
+    end_cancel_units();
+
+    if (pixel_conv)
+        del_pixel_conv(pixel_conv);
+    mem_free(data);
+
+    return 0;
+}
+
+rt_bitmap_data_t* get_rt_icon_pixels(FILE* stream, rt_icon_t* rt_icon)
+{
+    STATS_SCOPE(STATS_GET_RT_ICON_PIXELS);
+
+    rt_bitmap_data_t* rt_icon_pixels = (rt_bitmap_data_t*) mem_alloc(sizeof(rt_bitmap_data_t));
+
+    if (! rt_icon_pixels)
+        return NULL;
+
+    if (calc_rt_icon_pixels(rt_icon, 0, rt_icon_pixels) < 0)
+    {
+        mem_free(rt_icon_pixels);
+        return NULL;
+    }
+
+    rt_icon_pixels->data = mem_alloc(rt_icon_pixels->size);
+
+    if (! rt_icon_pixels->data)
+    {
+        mem_free(rt_icon_pixels);
+        return NULL;
+    }
+
+    if (load_rt_icon_pixels(stream, rt_icon, rt_icon_pixels) < 0)
+    {
+        del_rt_bitmap_data(rt_icon_pixels);
+        return NULL;
+    }
+
+    return rt_icon_pixels;
+}
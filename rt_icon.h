@@ -0,0 +1,134 @@
+#ifndef __RT_ICON_H__
+#define __RT_ICON_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+#include "rt_btmap.h"
+
+// Group icon resource
+//
+// 0x0000 : 2 bytes : Reserved (zero)
+// 0x0002 : 2 bytes : Type of resources (1 = icon)
+// 0x0004 : 2 bytes : Number of entries
+// 0x0006 : N bytes : Entries
+
+// Entry of group icon resource
+//
+// 0x0000 : 1 byte  : Width in pixels (zero means 256)
+// 0x0001 : 1 byte  : Height in pixels (zero means 256)
+// 0x0002 : 1 byte  : Number of colors (zero for 8 bits per pixel and more)
+// 0x0003 : 1 byte  : Reserved
+// 0x0004 : 2 bytes : Number of planes
+// 0x0006 : 2 bytes : Bits per pixel
+// 0x0008 : 4 bytes : Size of icon resource
+// 0x000C : 2 bytes : Ordinal number of icon resource (RT_ICON)
+
+// Entry of group cursor resource (same header with type 2)
+//
+// 0x0000 : 2 bytes : Width in pixels
+// 0x0002 : 2 bytes : Height in pixels (doubled, as in info header)
+// 0x0004 : 2 bytes : Number of planes
+// 0x0006 : 2 bytes : Bits per pixel
+// 0x0008 : 4 bytes : Size of cursor resource
+// 0x000C : 2 bytes : Ordinal number of cursor resource (RT_CURSOR)
+
+#define GROUP_ICON_HEADER_SIZE  0x06
+#define GROUP_ICON_ENTRY_SIZE   0x0E
+#define GROUP_CURSOR_ENTRY_SIZE 0x0E
+#define GROUP_ICON_TYPE_ICON    0x01
+#define GROUP_ICON_TYPE_CURSOR  0x02
+
+#pragma pack(1)
+typedef struct _group_icon_header_t {
+    uint16_t reserved;
+    uint16_t type;
+    uint16_t entries_num;
+} group_icon_header_t PACKED_STRUCT;
+
+typedef struct _group_icon_entry_t {
+    uint8_t  width;
+    uint8_t  height;
+    uint8_t  colors_num;
+    uint8_t  reserved;
+    uint16_t planes_num;
+    uint16_t bit_count;
+    uint32_t data_size;
+    uint16_t icon_id;
+} group_icon_entry_t PACKED_STRUCT;
+
+typedef struct _group_cursor_entry_t {
+    uint16_t width;
+    uint16_t height;
+    uint16_t planes_num;
+    uint16_t bit_count;
+    uint32_t data_size;
+    uint16_t cursor_id;
+} group_cursor_entry_t PACKED_STRUCT;
+#pragma pack()
+
+typedef struct _icon_entry_t {
+    uint32_t width;
+    uint32_t height;
+    uint32_t bit_count;     // Taken from number of colors if entry has none, zero if unknown
+    uint32_t data_size;
+    uint16_t icon_id;       // RT_ICON or RT_CURSOR
+} icon_entry_t;
+
+typedef struct _rt_group_icon_t {
+    uint16_t      type;         // GROUP_ICON_TYPE_ICON or GROUP_ICON_TYPE_CURSOR
+    uint16_t      entries_num;
+    icon_entry_t* entries;
+} rt_group_icon_t;
+
+// find_rt_group_icon_entry() returns index of entry which fits size best:
+// smallest one not smaller than size (larger one of width and height), largest
+// one if all are smaller. Entries of same size are told by bits, most bits up
+// to bit_count (zero means any) win. Result is -1 for group without entries.
+// Group cursor has same entries (height of cursor image, not doubled one).
+
+rt_group_icon_t* get_rt_group_icon(FILE* stream, uint32_t offset);
+rt_group_icon_t* get_rt_group_cursor(FILE* stream, uint32_t offset);
+void_t           del_rt_group_icon(rt_group_icon_t* rt_group_icon);
+sint_t           find_rt_group_icon_entry(rt_group_icon_t* rt_group_icon, uint32_t size, uint32_t bit_count);
+
+// Icon resource
+//
+// Packed DIB: info header (its height covers both images), color table, XOR
+// image and AND mask (1-bit lines aligned to 4 bytes), lines of both stored
+// from bottom to top. Or complete PNG file (mostly icons of 256 pixels).
+//
+// get_rt_icon() parses headers of DIB by rt_btmap (see get_rt_bitmap_dib),
+// rt_bitmap gets height of XOR image, so it is bitmap of its own. PNG icon has
+// no rt_bitmap, its payload is forwarded untouched (see rt_bitmap_payload_t),
+// dimensions are taken from its header.
+
+typedef struct _rt_icon_t {
+    rt_bitmap_t*        rt_bitmap;      // XOR image (NULL for PNG icon)
+    rt_bitmap_payload_t png;            // Zero size for DIB icon
+    uint32_t            width;
+    uint32_t            height;
+    uint32_t            bit_count;
+    uint32_t            mask_offset;    // AND mask follows XOR image
+    uint32_t            mask_line;      // Zero if 32-bit icon has no mask
+} rt_icon_t;
+
+rt_icon_t* get_rt_icon(FILE* stream, uint32_t offset, uint32_t size);
+void_t     del_rt_icon(rt_icon_t* rt_icon);
+
+// Decoding of DIB icon to premultiplied 32-bit RGBA pixels (PIXEL_RGBA32)
+//
+// Same rules for caller-owned buffer as for bitmaps: calc_rt_icon_pixels()
+// fills dimensions and stride, load_rt_icon_pixels() reads XOR image and mask
+// at once, converts lines (see pixconv.h) and combines them with best kernel
+// for CPU (see cpufeat.h). Pixels under AND mask are transparent (inverted
+// screen pixels are not kept). Alpha channel of 32-bit icon replaces mask,
+// unless all of it is zero. Cancel token (see cancel.h) is checked on every
+// line. Result of get_rt_icon_pixels() is freed by del_rt_bitmap_data().
+
+sint_t            calc_rt_icon_pixels(rt_icon_t* rt_icon, uint32_t alignment, rt_bitmap_data_t* rt_icon_pixels);
+sint_t            load_rt_icon_pixels(FILE* stream, rt_icon_t* rt_icon, rt_bitmap_data_t* rt_icon_pixels);
+rt_bitmap_data_t* get_rt_icon_pixels(FILE* stream, rt_icon_t* rt_icon);
+
+#endif // __RT_ICON_H__
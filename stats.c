@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "stats.h"
+#include "trace.h"
+
+static const char_t* stats_func_str [STATS_FUNC_NUM] = {
+    "validate_mz_checksum",
+    "get_exe_info",
+    "get_resource_table_info",
+    "get_resident_table_info",
+    "get_entry_table_info",
+    "put_exe_stream",
+    "get_calculated_string",
+    "get_terminated_string",
+    "get_rt_bitmap",
+    "get_rt_bitmap_dib",
+    "gen_rt_bitmap",
+    "put_rt_bitmap",
+    "put_rt_bitmap_full",
+    "get_rt_bitmap_data",
+    "load_rt_bitmap_data",
+    "put_rt_bitmap_data",
+    "put_rt_bitmap_data_rle",
+    "get_rt_bitmap_region",
+    "load_rt_bitmap_region",
+    "load_rt_bitmap_lines",
+    "load_rt_bitmap_bands",
+    "convert_rt_bitmap_bands",
+    "put_resampler_line",
+    "resample_rt_bitmap_pixels",
+    "load_rt_bitmap_resampled",
+    "put_deflate",
+    "put_png_data",
+    "put_rt_bitmap_png",
+    "put_bitmap_stream",
+    "run_bitmap_stream",
+    "get_rt_bitmap_quads",
+    "expand_rt_bitmap_data",
+    "get_rt_bitmap_pixels",
+    "convert_rt_bitmap_data",
+    "convert_rt_bitmap_pixels",
+    "get_rt_fontdir",
+    "get_rt_font",
+    "get_rt_font_bitmap_full",
+    "load_rt_font_bitmap_full",
+    "get_rt_font_bitmap_char",
+    "load_rt_font_bitmap_char",
+    "get_rt_group_icon",
+    "get_rt_icon",
+    "get_rt_icon_pixels",
+    "load_rt_icon_pixels",
+    "get_rt_group_cursor",
+    "get_rt_cursor",
+    "get_rt_anicursor",
+    "get_rt_anicursor_frame",
+    "load_rt_anicursor_frame"
+};
+
+#ifdef USE_STATS
+static THREAD_LOCAL res_stats_t thread_stats;
+#endif
+
+void_t get_stats_snapshot(res_stats_t* snapshot)
+{
+#ifdef USE_STATS
+    memcpy(snapshot, &thread_stats, sizeof(res_stats_t));
+#else
+    memset(snapshot, 0, sizeof(res_stats_t));
+#endif
+}
+
+void_t reset_stats(void_t)
+{
+#ifdef USE_STATS
+    memset(&thread_stats, 0, sizeof(res_stats_t));
+#endif
+}
+
+void_t add_stats(res_stats_t* total, const res_stats_t* snapshot)
+{
+    uint32_t i;
+
+    total->seeks           += snapshot->seeks;
+    total->reads           += snapshot->reads;
+    total->bytes_read      += snapshot->bytes_read;
+    total->writes          += snapshot->writes;
+    total->bytes_written   += snapshot->bytes_written;
+    total->allocs          += snapshot->allocs;
+    total->bytes_allocated += snapshot->bytes_allocated;
+    total->frees           += snapshot->frees;
+
+    for (i = 0; i < STATS_FUNC_NUM; i ++)
+    {
+        total->funcs[i].calls   += snapshot->funcs[i].calls;
+        total->funcs[i].time_ns += snapshot->funcs[i].time_ns;
+    }
+}
+
+const char_t* convert_stats_func_to_text(stats_func_e func)
+{
+    return ((uint32_t) func < STATS_FUNC_NUM) ? stats_func_str[func] : NULL;
+}
+
+uint64_t get_time_ns(void_t)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return (uint64_t) ((counter.QuadPart / frequency.QuadPart) * 1000000000ULL
+                    + ((counter.QuadPart % frequency.QuadPart) * 1000000000ULL) / frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+#if defined(USE_STATS) || defined(USE_TRACE)
+
+stats_scope_t enter_stats_scope(stats_func_e func)
+{
+    stats_scope_t scope = { func, 0 };
+
+    TRACE_EVENT(TRACE_PARSE, TRACE_BEGIN, func, 0);
+
+#ifdef USE_STATS
+    scope.start = get_time_ns();
+    thread_stats.funcs[func].calls ++;
+#endif
+
+    return scope;
+}
+
+void_t leave_stats_scope(stats_scope_t* scope)
+{
+#ifdef USE_STATS
+    thread_stats.funcs[scope->func].time_ns += get_time_ns() - scope->start;
+#endif
+
+    TRACE_EVENT(TRACE_PARSE, TRACE_END, scope->func, 0);
+}
+
+#endif // USE_STATS || USE_TRACE
+
+#ifdef USE_STATS
+
+void_t add_stats_seek(void_t)
+{
+    thread_stats.seeks ++;
+}
+
+void_t add_stats_read(size_t bytes)
+{
+    thread_stats.reads ++;
+    thread_stats.bytes_read += bytes;
+}
+
+void_t add_stats_write(size_t bytes)
+{
+    thread_stats.writes ++;
+    thread_stats.bytes_written += bytes;
+}
+
+void_t add_stats_alloc(size_t bytes)
+{
+    thread_stats.allocs ++;
+    thread_stats.bytes_allocated += bytes;
+}
+
+void_t add_stats_free(void_t)
+{
+    thread_stats.frees ++;
+}
+
+#endif // USE_STATS
@@ -0,0 +1,130 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+// I/O, allocation and timing statistics
+//
+// Counters are collected only if library is compiled with USE_STATS
+// (otherwise every hook is compiled out and snapshots are zero).
+// Counters are thread-local: each worker takes its own snapshot and
+// snapshots are summed with add_stats().
+
+typedef enum _stats_func_e {
+    STATS_VALIDATE_MZ_CHECKSUM,
+    STATS_GET_EXE_INFO,
+    STATS_GET_RESOURCE_TABLE_INFO,
+    STATS_GET_RESIDENT_TABLE_INFO,
+    STATS_GET_ENTRY_TABLE_INFO,
+    STATS_PUT_EXE_STREAM,
+    STATS_GET_CALCULATED_STRING,
+    STATS_GET_TERMINATED_STRING,
+    STATS_GET_RT_BITMAP,
+    STATS_GET_RT_BITMAP_DIB,
+    STATS_GEN_RT_BITMAP,
+    STATS_PUT_RT_BITMAP,
+    STATS_PUT_RT_BITMAP_FULL,
+    STATS_GET_RT_BITMAP_DATA,
+    STATS_LOAD_RT_BITMAP_DATA,
+    STATS_PUT_RT_BITMAP_DATA,
+    STATS_PUT_RT_BITMAP_DATA_RLE,
+    STATS_GET_RT_BITMAP_REGION,
+    STATS_LOAD_RT_BITMAP_REGION,
+    STATS_LOAD_RT_BITMAP_LINES,
+    STATS_LOAD_RT_BITMAP_BANDS,
+    STATS_CONVERT_RT_BITMAP_BANDS,
+    STATS_PUT_RESAMPLER_LINE,
+    STATS_RESAMPLE_RT_BITMAP_PIXELS,
+    STATS_LOAD_RT_BITMAP_RESAMPLED,
+    STATS_PUT_DEFLATE,
+    STATS_PUT_PNG_DATA,
+    STATS_PUT_RT_BITMAP_PNG,
+    STATS_PUT_BITMAP_STREAM,
+    STATS_RUN_BITMAP_STREAM,
+    STATS_GET_RT_BITMAP_QUADS,
+    STATS_EXPAND_RT_BITMAP_DATA,
+    STATS_GET_RT_BITMAP_PIXELS,
+    STATS_CONVERT_RT_BITMAP_DATA,
+    STATS_CONVERT_RT_BITMAP_PIXELS,
+    STATS_GET_RT_FONTDIR,
+    STATS_GET_RT_FONT,
+    STATS_GET_RT_FONT_BITMAP_FULL,
+    STATS_LOAD_RT_FONT_BITMAP_FULL,
+    STATS_GET_RT_FONT_BITMAP_CHAR,
+    STATS_LOAD_RT_FONT_BITMAP_CHAR,
+    STATS_GET_RT_GROUP_ICON,
+    STATS_GET_RT_ICON,
+    STATS_GET_RT_ICON_PIXELS,
+    STATS_LOAD_RT_ICON_PIXELS,
+    STATS_GET_RT_GROUP_CURSOR,
+    STATS_GET_RT_CURSOR,
+    STATS_GET_RT_ANICURSOR,
+    STATS_GET_RT_ANICURSOR_FRAME,
+    STATS_LOAD_RT_ANICURSOR_FRAME,
+    STATS_FUNC_NUM
+} stats_func_e;
+
+typedef struct _func_stats_t {
+    uint64_t calls;
+    uint64_t time_ns; // Wall time (nested calls are included into caller time too)
+} func_stats_t;
+
+typedef struct _res_stats_t {
+    uint64_t     seeks;
+    uint64_t     reads;
+    uint64_t     bytes_read;
+    uint64_t     writes;
+    uint64_t     bytes_written;
+    uint64_t     allocs;
+    uint64_t     bytes_allocated;
+    uint64_t     frees;
+    func_stats_t funcs [STATS_FUNC_NUM];
+} res_stats_t;
+
+void_t        get_stats_snapshot(res_stats_t* snapshot); // Counters of calling thread
+void_t        reset_stats(void_t);
+void_t        add_stats(res_stats_t* total, const res_stats_t* snapshot);
+const char_t* convert_stats_func_to_text(stats_func_e func);
+uint64_t      get_time_ns(void_t);
+
+// Library hooks
+
+#ifdef USE_STATS
+
+void_t add_stats_seek  (void_t);
+void_t add_stats_read  (size_t bytes);
+void_t add_stats_write (size_t bytes);
+void_t add_stats_alloc (size_t bytes);
+void_t add_stats_free  (void_t);
+
+#endif // USE_STATS
+
+#if defined(USE_STATS) || defined(USE_TRACE)
+
+typedef struct _stats_scope_t {
+    stats_func_e func;
+    uint64_t     start;
+} stats_scope_t;
+
+stats_scope_t enter_stats_scope(stats_func_e func);
+void_t        leave_stats_scope(stats_scope_t* scope);
+
+// Measures (and traces) enclosing function until any of its returns. It needs
+// cleanup attribute (GCC, Clang), other compilers measure no scopes unless
+// caller pairs enter_stats_scope() and leave_stats_scope() itself.
+#if defined(__GNUC__) || defined(__clang__)
+    #define STATS_SCOPE(func) stats_scope_t stats_scope __attribute__((cleanup(leave_stats_scope))) = enter_stats_scope(func)
+#else
+    #define STATS_SCOPE(func)
+#endif
+
+#else
+
+#define STATS_SCOPE(func)
+
+#endif // USE_STATS || USE_TRACE
+
+#endif // __STATS_H__
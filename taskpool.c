@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#include "inttypes.h"
+#include "platform.h"
+#include "memalloc.h"
+
+#include "taskpool.h"
+
+// Threads of platform
+
+#ifdef _WIN32
+typedef HANDLE             thread_t;
+typedef CRITICAL_SECTION   mutex_t;
+typedef CONDITION_VARIABLE cond_t;
+#else
+typedef pthread_t          thread_t;
+typedef pthread_mutex_t    mutex_t;
+typedef pthread_cond_t     cond_t;
+#endif
+
+struct _task_pool_t {
+    uint32_t    workers_num;    // Threads besides calling one
+    thread_t*   workers;
+    mutex_t     mutex;
+    cond_t      start;          // New run (or stop) for workers
+    cond_t      done;           // Last worker finished run
+    uint32_t    run;            // Number of current run
+    uint32_t    left;           // Workers not finished with current run
+    bool_e      stop;
+    task_func_t func;
+    void_t*     context;
+    uint32_t    tasks_num;
+    uint32_t    next;           // Task taken next (atomic)
+    uint32_t    failed;         // Atomic
+};
+
+#ifdef _WIN32
+
+static inline void_t init_mutex(mutex_t* mutex)  { InitializeCriticalSection(mutex); }
+static inline void_t free_mutex(mutex_t* mutex)  { DeleteCriticalSection(mutex); }
+static inline void_t lock_mutex(mutex_t* mutex)  { EnterCriticalSection(mutex); }
+static inline void_t unlock_mutex(mutex_t* mutex){ LeaveCriticalSection(mutex); }
+static inline void_t init_cond(cond_t* cond)     { InitializeConditionVariable(cond); }
+static inline void_t free_cond(cond_t* cond)     { }
+static inline void_t wait_cond(cond_t* cond, mutex_t* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+static inline void_t wake_cond(cond_t* cond)     { WakeAllConditionVariable(cond); }
+
+#else
+
+static inline void_t init_mutex(mutex_t* mutex)  { pthread_mutex_init(mutex, NULL); }
+static inline void_t free_mutex(mutex_t* mutex)  { pthread_mutex_destroy(mutex); }
+static inline void_t lock_mutex(mutex_t* mutex)  { pthread_mutex_lock(mutex); }
+static inline void_t unlock_mutex(mutex_t* mutex){ pthread_mutex_unlock(mutex); }
+static inline void_t init_cond(cond_t* cond)     { pthread_cond_init(cond, NULL); }
+static inline void_t free_cond(cond_t* cond)     { pthread_cond_destroy(cond); }
+static inline void_t wait_cond(cond_t* cond, mutex_t* mutex) { pthread_cond_wait(cond, mutex); }
+static inline void_t wake_cond(cond_t* cond)     { pthread_cond_broadcast(cond); }
+
+#endif
+
+// Tasks of current run are taken until none is left
+static void_t run_tasks(task_pool_t* task_pool)
+{
+    uint32_t task;
+
+    while ((task = ATOMIC_ADD(&task_pool->next, 1) - 1) < task_pool->tasks_num)
+    {
+        if (task_pool->func(task_pool->context, task) < 0)
+            ATOMIC_STORE(&task_pool->failed, 1);
+    }
+}
+
+// Every worker takes part in every run, so next run is set only after all of
+// them left current one
+static void_t work(task_pool_t* task_pool)
+{
+    uint32_t run = 0;
+
+    lock_mutex(&task_pool->mutex);
+
+    for (;;)
+    {
+        while ((! task_pool->stop) && (task_pool->run == run))
+            wait_cond(&task_pool->start, &task_pool->mutex);
+
+        if (task_pool->stop)
+            break;
+
+        run = task_pool->run;
+
+        unlock_mutex(&task_pool->mutex);
+        run_tasks(task_pool);
+        lock_mutex(&task_pool->mutex);
+
+        if (-- task_pool->left == 0)
+            wake_cond(&task_pool->done);
+    }
+
+    unlock_mutex(&task_pool->mutex);
+}
+
+#ifdef _WIN32
+
+static DWORD WINAPI worker_entry(LPVOID parameter)
+{
+    work((task_pool_t*) parameter);
+    return 0;
+}
+
+static bool_e start_worker(thread_t* thread, task_pool_t* task_pool)
+{
+    *thread = CreateThread(NULL, 0, worker_entry, task_pool, 0, NULL);
+
+    return (*thread) ? TRUE : FALSE;
+}
+
+static void_t join_worker(thread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#else
+
+static void_t* worker_entry(void_t* parameter)
+{
+    work((task_pool_t*) parameter);
+    return NULL;
+}
+
+static bool_e start_worker(thread_t* thread, task_pool_t* task_pool)
+{
+    return (pthread_create(thread, NULL, worker_entry, task_pool) == 0) ? TRUE : FALSE;
+}
+
+static void_t join_worker(thread_t thread)
+{
+    pthread_join(thread, NULL);
+}
+
+#endif
+
+uint32_t get_cpu_count(void_t)
+{
+#ifdef _WIN32
+    SYSTEM_INFO system_info;
+
+    GetSystemInfo(&system_info);
+
+    return (system_info.dwNumberOfProcessors) ? (uint32_t) system_info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (count > 0) ? (uint32_t) count : 1;
+#endif
+}
+
+task_pool_t* new_task_pool(uint32_t threads_num)
+{
+    if (! threads_num)
+        threads_num = get_cpu_count();
+
+    if (threads_num > TASK_POOL_THREADS_MAX)
+        threads_num = TASK_POOL_THREADS_MAX;
+
+    task_pool_t* task_pool = (task_pool_t*) mem_calloc(1, sizeof(task_pool_t));
+
+    if (! task_pool)
+        return NULL;
+
+    if (threads_num > 1)
+    {
+        task_pool->workers = (thread_t*) mem_alloc(sizeof(thread_t) * (threads_num - 1));
+
+        if (! task_pool->workers)
+        {
+            mem_free(task_pool);
+            return NULL;
+        }
+    }
+
+    init_mutex(&task_pool->mutex);
+    init_cond(&task_pool->start);
+    init_cond(&task_pool->done);
+
+    // Pool works with fewer threads if some can not be started
+    for ( ; task_pool->workers_num < threads_num - 1; task_pool->workers_num ++)
+    {
+        if (! start_worker(task_pool->workers + task_pool->workers_num, task_pool))
+            break;
+    }
+
+    return task_pool;
+}
+
+uint32_t get_task_pool_threads(task_pool_t* task_pool)
+{
+    return (task_pool) ? task_pool->workers_num + 1 : 1;
+}
+
+sint_t run_task_pool(task_pool_t* task_pool, uint32_t tasks_num, task_func_t func, void_t* context)
+{
+    if (! func)
+        return -1;
+
+    // Single task is not worth waking workers
+    if ((! task_pool) || (! task_pool->workers_num) || (tasks_num < 2))
+    {
+        sint_t   result = 0;
+        uint32_t task;
+
+        for (task = 0; task < tasks_num; task ++)
+        {
+            if (func(context, task) < 0)
+                result = -1;
+        }
+
+        return result;
+    }
+
+    lock_mutex(&task_pool->mutex);
+
+    task_pool->func      = func;
+    task_pool->context   = context;
+    task_pool->tasks_num = tasks_num;
+    task_pool->next      = 0;
+    task_pool->failed    = 0;
+    task_pool->left      = task_pool->workers_num;
+    task_pool->run      ++;
+
+    wake_cond(&task_pool->start);
+    unlock_mutex(&task_pool->mutex);
+
+    run_tasks(task_pool);
+
+    lock_mutex(&task_pool->mutex);
+
+    while (task_pool->left)
+        wait_cond(&task_pool->done, &task_pool->mutex);
+
+    unlock_mutex(&task_pool->mutex);
+
+    return (task_pool->failed) ? -1 : 0;
+}
+
+void_t del_task_pool(task_pool_t* task_pool)
+{
+    if (! task_pool)
+        return;
+
+    lock_mutex(&task_pool->mutex);
+
+    task_pool->stop = TRUE;
+
+    wake_cond(&task_pool->start);
+    unlock_mutex(&task_pool->mutex);
+
+    uint32_t i;
+    for (i = 0; i < task_pool->workers_num; i ++)
+        join_worker(task_pool->workers[i]);
+
+    free_cond(&task_pool->done);
+    free_cond(&task_pool->start);
+    free_mutex(&task_pool->mutex);
+
+    if (task_pool->workers)
+        mem_free(task_pool->workers);
+
+    mem_free(task_pool);
+}
@@ -0,0 +1,32 @@
+#ifndef __TASKPOOL_H__
+#define __TASKPOOL_H__
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Pool of worker threads for data-parallel operations
+//
+// Workers are started once and wait between runs. Run numbers tasks from zero,
+// workers and calling thread take them in order of numbers until none is left,
+// and returns when all of them are done (-1 if some task failed, remaining
+// tasks are still run). Task must not depend on thread running it: state of
+// library kept per thread (allocator, parse budget, cancel token, stats) is
+// state of calling thread for tasks it runs and default one for workers.
+//
+// NULL pool (or pool without workers) runs tasks in calling thread. Pool is
+// used by one run at a time.
+
+#define TASK_POOL_THREADS_MAX 64
+
+typedef sint_t (*task_func_t)(void_t* context, uint32_t task);
+
+typedef struct _task_pool_t task_pool_t;
+
+task_pool_t* new_task_pool(uint32_t threads_num); // Threads including calling one, zero means number of CPUs
+uint32_t     get_task_pool_threads(task_pool_t* task_pool);
+sint_t       run_task_pool(task_pool_t* task_pool, uint32_t tasks_num, task_func_t func, void_t* context);
+void_t       del_task_pool(task_pool_t* task_pool);
+
+uint32_t     get_cpu_count(void_t);
+
+#endif // __TASKPOOL_H__
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+    #define USE_TRACE_TSC
+#endif
+
+#include "inttypes.h"
+#include "platform.h"
+
+#include "trace.h"
+#include "stats.h"
+#include "resource.h"
+
+#ifdef USE_TRACE
+
+typedef struct _trace_ring_t trace_ring_t;
+
+struct _trace_ring_t {
+    trace_ring_t* next;
+    uint32_t      thread_num;
+    uint32_t      head; // Number of events written so far
+    trace_event_t events [TRACE_RING_SIZE];
+};
+
+static trace_ring_t* trace_rings      = NULL;
+static uint32_t      trace_threads    = 0;
+static sint_t        trace_enabled    = 0;
+static uint64_t      trace_base_ticks = 0;
+static uint64_t      trace_base_ns    = 0;
+
+static THREAD_LOCAL trace_ring_t* thread_ring = NULL;
+
+static inline uint64_t get_trace_ticks(void_t)
+{
+#ifdef USE_TRACE_TSC
+    return __rdtsc();
+#else
+    return get_time_ns();
+#endif
+}
+
+static trace_ring_t* new_trace_ring(void_t)
+{
+    // Rings are never released (events of finished threads stay available for dump)
+    trace_ring_t* ring = (trace_ring_t*) calloc(1, sizeof(trace_ring_t));
+
+    if (! ring)
+        return NULL;
+
+    ring->thread_num = ATOMIC_ADD(&trace_threads, 1);
+
+    // Lock-free push into list of rings
+    ring->next = (trace_ring_t*) ATOMIC_LOAD_PTR(&trace_rings);
+
+    while (! ATOMIC_EXCHANGE_PTR(&trace_rings, &ring->next, ring))
+        ;
+
+    thread_ring = ring;
+
+    return ring;
+}
+
+void_t add_trace_event(trace_event_e type, trace_phase_e phase, uint16_t name, uint32_t arg)
+{
+    if (! ATOMIC_LOAD(&trace_enabled))
+        return;
+
+    trace_ring_t* ring = (thread_ring) ? thread_ring : new_trace_ring();
+
+    if (! ring)
+        return;
+
+    uint32_t       head  = ring->head;
+    trace_event_t* event = &ring->events[head & (TRACE_RING_SIZE - 1)];
+
+    event->timestamp = get_trace_ticks();
+    event->type      = (uint8_t) type;
+    event->phase     = (uint8_t) phase;
+    event->name      = name;
+    event->arg       = arg;
+
+    ATOMIC_STORE(&ring->head, head + 1);
+}
+
+trace_scope_t enter_trace_scope(trace_event_e type, uint16_t name, uint32_t arg)
+{
+    trace_scope_t scope = { type, name, arg };
+
+    add_trace_event(type, TRACE_BEGIN, name, arg);
+
+    return scope;
+}
+
+void_t leave_trace_scope(trace_scope_t* scope)
+{
+    add_trace_event(scope->type, TRACE_END, scope->name, scope->arg);
+}
+
+static void_t get_trace_event_info(trace_event_t* event, const char_t** p_name, const char_t** p_category, const char_t** p_arg_name)
+{
+    const char_t* name     = NULL;
+    const char_t* category = NULL;
+    const char_t* arg_name = NULL;
+
+    switch (event->type)
+    {
+        case TRACE_PARSE:
+            name     = convert_stats_func_to_text((stats_func_e) event->name);
+            category = "parse";
+            break;
+
+        case TRACE_READ:
+            name     = "read";
+            category = "io";
+            arg_name = "bytes";
+            break;
+
+        case TRACE_DECODE:
+            name     = convert_resource_type_id_to_text(event->name);
+            category = "decode";
+            arg_name = "offset";
+            break;
+
+        case TRACE_RESOURCE:
+            name     = convert_resource_type_id_to_text(event->name);
+            category = "resource";
+            arg_name = "id";
+            break;
+
+        default:
+            break;
+    }
+
+    *p_name     = (name) ? name : "unknown";
+    *p_category = category;
+    *p_arg_name = arg_name;
+}
+
+#endif // USE_TRACE
+
+void_t set_trace_enabled(bool_e enabled)
+{
+#ifdef USE_TRACE
+    if ((enabled) && (! trace_base_ns))
+    {
+        trace_base_ns    = get_time_ns();
+        trace_base_ticks = get_trace_ticks();
+    }
+
+    ATOMIC_STORE(&trace_enabled, (enabled) ? 1 : 0);
+#endif
+}
+
+void_t reset_trace(void_t)
+{
+#ifdef USE_TRACE
+    trace_ring_t* ring;
+
+    for (ring = (trace_ring_t*) ATOMIC_LOAD_PTR(&trace_rings); ring; ring = ring->next)
+        ATOMIC_STORE(&ring->head, 0);
+#endif
+}
+
+sint_t dump_trace_json(FILE* stream)
+{
+    if (! stream)
+        return -1;
+
+    if (fprintf(stream, "{\"traceEvents\":[") < 0)
+        return -1;
+
+#ifdef USE_TRACE
+    // Ticks to microseconds
+    double scale = 0.001;
+
+#ifdef USE_TRACE_TSC
+    uint64_t ticks = get_trace_ticks() - trace_base_ticks;
+    uint64_t ns    = get_time_ns()     - trace_base_ns;
+
+    scale = (ticks) ? (0.001 * (double) ns / (double) ticks) : 0.0;
+#endif
+
+    trace_ring_t* ring;
+    bool_e        first = TRUE;
+
+    for (ring = (trace_ring_t*) ATOMIC_LOAD_PTR(&trace_rings); ring; ring = ring->next)
+    {
+        uint32_t head  = ATOMIC_LOAD(&ring->head);
+        uint32_t count = (head < TRACE_RING_SIZE) ? head : TRACE_RING_SIZE;
+        uint32_t i;
+
+        for (i = head - count; i != head; i ++)
+        {
+            trace_event_t* event = &ring->events[i & (TRACE_RING_SIZE - 1)];
+            const char_t*  name;
+            const char_t*  category;
+            const char_t*  arg_name;
+
+            get_trace_event_info(event, &name, &category, &arg_name);
+
+            if (fprintf(stream, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+                        (first) ? "" : ",",
+                        name,
+                        category,
+                        (event->phase == TRACE_BEGIN) ? 'B' : 'E',
+                        (double) (event->timestamp - trace_base_ticks) * scale,
+                        ring->thread_num) < 0)
+                return -1;
+
+            if ((arg_name) && (fprintf(stream, ",\"args\":{\"%s\":%u}", arg_name, event->arg) < 0))
+                return -1;
+
+            if (fprintf(stream, "}") < 0)
+                return -1;
+
+            first = FALSE;
+        }
+    }
+#endif
+
+    if (fprintf(stream, "\n]}\n") < 0)
+        return -1;
+
+    return 0;
+}
+
+void_t begin_trace_resource(uint16_t type_id, uint16_t resource_id)
+{
+    TRACE_EVENT(TRACE_RESOURCE, TRACE_BEGIN, type_id & ~0x8000, resource_id);
+}
+
+void_t end_trace_resource(uint16_t type_id, uint16_t resource_id)
+{
+    TRACE_EVENT(TRACE_RESOURCE, TRACE_END, type_id & ~0x8000, resource_id);
+}
@@ -0,0 +1,77 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdio.h>
+
+#include "inttypes.h"
+#include "platform.h"
+
+// Event trace
+//
+// Events are recorded only if library is compiled with USE_TRACE and tracing
+// is enabled at runtime. Every thread writes into its own ring buffer (no locks,
+// oldest events are overwritten). dump_trace_json() writes all rings in Chrome
+// trace-event format, it should be called when workers are idle.
+
+#define TRACE_RING_SIZE 0x4000 // Events per thread (power of 2)
+
+typedef enum _trace_event_e {
+    TRACE_PARSE,    // Public function, name is stats_func_e
+    TRACE_READ,     // Stream read, arg is number of bytes
+    TRACE_DECODE,   // Resource decoding, name is resource type, arg is data offset
+    TRACE_RESOURCE  // Caller annotation, name is resource type, arg is resource ID
+} trace_event_e;
+
+typedef enum _trace_phase_e {
+    TRACE_BEGIN,
+    TRACE_END
+} trace_phase_e;
+
+typedef struct _trace_event_t {
+    uint64_t timestamp;
+    uint8_t  type;
+    uint8_t  phase;
+    uint16_t name;
+    uint32_t arg;
+} trace_event_t;
+
+void_t set_trace_enabled(bool_e enabled);
+void_t reset_trace(void_t);
+sint_t dump_trace_json(FILE* stream);
+
+// Annotations for caller (batch worker can mark resource being processed)
+void_t begin_trace_resource(uint16_t type_id, uint16_t resource_id);
+void_t end_trace_resource(uint16_t type_id, uint16_t resource_id);
+
+// Library hooks
+
+#ifdef USE_TRACE
+
+typedef struct _trace_scope_t {
+    trace_event_e type;
+    uint16_t      name;
+    uint32_t      arg;
+} trace_scope_t;
+
+void_t        add_trace_event(trace_event_e type, trace_phase_e phase, uint16_t name, uint32_t arg);
+trace_scope_t enter_trace_scope(trace_event_e type, uint16_t name, uint32_t arg);
+void_t        leave_trace_scope(trace_scope_t* scope);
+
+#define TRACE_EVENT(type, phase, name, arg) add_trace_event(type, phase, name, arg)
+
+// Traces enclosing block until any of its returns (needs cleanup attribute
+// as STATS_SCOPE does, see stats.h)
+#if defined(__GNUC__) || defined(__clang__)
+    #define TRACE_SCOPE(type, name, arg) trace_scope_t trace_scope __attribute__((cleanup(leave_trace_scope))) = enter_trace_scope(type, name, arg)
+#else
+    #define TRACE_SCOPE(type, name, arg)
+#endif
+
+#else
+
+#define TRACE_EVENT(type, phase, name, arg)
+#define TRACE_SCOPE(type, name, arg)
+
+#endif // USE_TRACE
+
+#endif // __TRACE_H__